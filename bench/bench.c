@@ -0,0 +1,736 @@
+// HAL计算原语微基准
+// 用法: bench [--json FILE] [--filter STR] [--min-time MS] [--quick]
+//             [--peak-gflops X] [--peak-gbps X]
+// 每个用例先预热，再重复执行直到累计时间不少于min-time，按单次耗时的p50计算吞吐量
+// 占峰值比例按roofline计算：可达性能 = min(计算峰值, 算术强度 * 带宽峰值)
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "hal.h"
+#include "cpu_features.h"
+#include "thread_pool.h"
+#include "quantization.h"
+#include "fp16.h"
+#include "attention.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_WARMUP 2
+#define BENCH_MIN_SAMPLES 5
+#define BENCH_MAX_SAMPLES 2000
+#define BENCH_DEFAULT_MIN_TIME_MS 200.0
+
+// 带宽测量缓冲区（需远大于末级缓存）
+#define BENCH_BW_BYTES ((size_t)256 << 20)
+
+// 注意力用例的头数（7B级模型），均使用因果屏蔽
+#define BENCH_ATTENTION_HEADS 32
+
+typedef enum {
+    KERNEL_MATMUL,
+    KERNEL_GEMV,
+    KERNEL_VECTOR_ADD,
+    KERNEL_QUANTIZE,
+    KERNEL_DEQUANTIZE,
+    KERNEL_FP16_ENCODE,
+    KERNEL_FP16_DECODE,
+    KERNEL_ATTENTION,
+    KERNEL_SOFTMAX,
+    KERNEL_GELU,
+    KERNEL_GELU_BACKWARD
+} KernelKind;
+
+// 基准用例
+typedef struct {
+    const char* name;
+    KernelKind kind;
+    size_t m, n, k;            // 矩阵形状；逐元素用例只使用n；注意力为查询数、KV长度、头维度；softmax为行数、行宽
+    QuantType quant_type;      // 量化用例
+} BenchCase;
+
+// 单个用例的运行时状态
+typedef struct {
+    const BenchCase* bc;
+    HAL_Device* dev;
+    float* a;
+    float* b;
+    float* c;
+    void* q;                   // 量化/半精度数据
+    QuantParams qparams;
+    QuantConfig qconfig;
+} BenchState;
+
+// 结果
+typedef struct {
+    const BenchCase* bc;
+    double flops;
+    double bytes;
+    size_t samples;
+    double p50_us;
+    double p99_us;
+    double mean_us;
+    double gflops;
+    double gbps;
+    double pct_peak;           // < 0 表示峰值未知
+    const char* bound;         // "compute" / "memory" / "cache"（工作集驻留末级缓存）
+} BenchResult;
+
+// 机器峰值
+typedef struct {
+    const char* brand;
+    const char* tier;
+    size_t threads;
+    double freq_ghz;           // 0表示未知
+    double flops_per_cycle;    // 单核每周期fp32浮点运算数
+    double peak_gflops;        // 0表示未知
+    double peak_gbps;
+    size_t llc_bytes;          // 末级缓存大小，工作集不超过它时不适用内存带宽上限
+} MachinePeak;
+
+// LLM中常见的形状：hidden=4096、ffn=11008（7B级模型）的解码和预填充，以及不对齐的尾部
+static const BenchCase g_full_cases[] = {
+    { "matmul_decode_qkv",      KERNEL_MATMUL, 1,   4096, 4096,  0 },
+    { "matmul_decode_ffn_up",   KERNEL_MATMUL, 1,   11008, 4096, 0 },
+    { "matmul_decode_batch8",   KERNEL_MATMUL, 8,   4096, 4096,  0 },
+    { "matmul_prefill_qkv",     KERNEL_MATMUL, 128, 4096, 4096,  0 },
+    { "matmul_prefill_ffn_down",KERNEL_MATMUL, 128, 4096, 11008, 0 },
+    { "matmul_square_1024",     KERNEL_MATMUL, 1024, 1024, 1024, 0 },
+    { "matmul_tail_odd",        KERNEL_MATMUL, 33,  1001, 517,   0 },
+    { "matmul_tail_thin",       KERNEL_MATMUL, 7,   13,   4097,  0 },
+    { "gemv_decode_4096",       KERNEL_GEMV,   4096, 4096, 0,    0 },
+    { "gemv_decode_ffn_down",   KERNEL_GEMV,   4096, 11008, 0,   0 },
+    { "gemv_tail_odd",          KERNEL_GEMV,   4093, 4091, 0,    0 },
+    { "vector_add_l1",          KERNEL_VECTOR_ADD, 0, 2048, 0,   0 },
+    { "vector_add_l2",          KERNEL_VECTOR_ADD, 0, 65536, 0,  0 },
+    { "vector_add_dram",        KERNEL_VECTOR_ADD, 0, (16u << 20) + 7, 0, 0 },
+    { "quantize_int8",          KERNEL_QUANTIZE,   0, 4u << 20, 0, QUANT_TYPE_INT8 },
+    { "dequantize_int8",        KERNEL_DEQUANTIZE, 0, 4u << 20, 0, QUANT_TYPE_INT8 },
+    { "quantize_int4",          KERNEL_QUANTIZE,   0, (4u << 20) + 1, 0, QUANT_TYPE_INT4 },
+    { "dequantize_int4",        KERNEL_DEQUANTIZE, 0, (4u << 20) + 1, 0, QUANT_TYPE_INT4 },
+    { "quantize_fp8",           KERNEL_QUANTIZE,   0, 1u << 20, 0, QUANT_TYPE_FP8 },
+    { "dequantize_fp8",         KERNEL_DEQUANTIZE, 0, 1u << 20, 0, QUANT_TYPE_FP8 },
+    { "fp16_encode",            KERNEL_FP16_ENCODE, 0, 4u << 20, 0, 0 },
+    { "fp16_decode",            KERNEL_FP16_DECODE, 0, 4u << 20, 0, 0 },
+    { "fp16_encode_tail",       KERNEL_FP16_ENCODE, 0, 4093, 0, 0 },
+    { "fp16_decode_tail",       KERNEL_FP16_DECODE, 0, 4093, 0, 0 },
+    { "attention_decode_2k",    KERNEL_ATTENTION, 1,   2048, 128, 0 },
+    { "attention_prefill_512",  KERNEL_ATTENTION, 512, 512,  128, 0 },
+    { "attention_tail_odd",     KERNEL_ATTENTION, 7,   1001, 80,  0 },
+    { "softmax_ffn_11008",      KERNEL_SOFTMAX,  64, 11008, 0,    0 },
+    { "softmax_tail_odd",       KERNEL_SOFTMAX,  7,  4093,  0,    0 },
+    { "gelu_ffn_11008",         KERNEL_GELU,     0, 64 * 11008, 0, 0 },
+    { "gelu_backward_ffn_11008",KERNEL_GELU_BACKWARD, 0, 64 * 11008, 0, 0 },
+};
+
+// --quick：缩小的形状，用于冒烟检查
+static const BenchCase g_quick_cases[] = {
+    { "matmul_decode_qkv",      KERNEL_MATMUL, 1,   1024, 1024,  0 },
+    { "matmul_prefill_qkv",     KERNEL_MATMUL, 32,  1024, 1024,  0 },
+    { "matmul_tail_odd",        KERNEL_MATMUL, 33,  101,  77,    0 },
+    { "gemv_decode_1024",       KERNEL_GEMV,   1024, 1024, 0,    0 },
+    { "gemv_tail_odd",          KERNEL_GEMV,   1021, 1019, 0,    0 },
+    { "vector_add_l1",          KERNEL_VECTOR_ADD, 0, 2048, 0,   0 },
+    { "vector_add_tail",        KERNEL_VECTOR_ADD, 0, 65543, 0,  0 },
+    { "quantize_int8",          KERNEL_QUANTIZE,   0, 1u << 18, 0, QUANT_TYPE_INT8 },
+    { "dequantize_int4",        KERNEL_DEQUANTIZE, 0, (1u << 18) + 1, 0, QUANT_TYPE_INT4 },
+    { "quantize_fp8",           KERNEL_QUANTIZE,   0, 1u << 16, 0, QUANT_TYPE_FP8 },
+    { "fp16_encode",            KERNEL_FP16_ENCODE, 0, 1u << 18, 0, 0 },
+    { "fp16_decode_tail",       KERNEL_FP16_DECODE, 0, 4093, 0, 0 },
+    { "attention_decode_512",   KERNEL_ATTENTION, 1,   512,  128, 0 },
+    { "attention_prefill_64",   KERNEL_ATTENTION, 64,  64,   128, 0 },
+    { "softmax_ffn_11008",      KERNEL_SOFTMAX,  8,  11008, 0,    0 },
+    { "gelu_backward_tail",     KERNEL_GELU_BACKWARD, 0, 11008 + 7, 0, 0 },
+};
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec * 1e-3;
+}
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static float* alloc_random_flags(HAL_Device* dev, size_t count, uint32_t seed, uint32_t flags) {
+    float* p = (float*)(dev->allocate_memory_flags ?
+                        dev->allocate_memory_flags(count * sizeof(float), flags) :
+                        dev->allocate_memory(count * sizeof(float)));
+    if (!p) return NULL;
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        p[i] = (float)(seed >> 8) / (float)(1u << 24) * 2.0f - 1.0f;
+    }
+    return p;
+}
+
+static float* alloc_random(HAL_Device* dev, size_t count, uint32_t seed) {
+    return alloc_random_flags(dev, count, seed, 0);
+}
+
+static const char* kernel_name(KernelKind kind) {
+    switch (kind) {
+        case KERNEL_MATMUL: return "matrix_multiply";
+        case KERNEL_GEMV: return "gemv";
+        case KERNEL_VECTOR_ADD: return "vector_add";
+        case KERNEL_QUANTIZE: return "quant_quantize";
+        case KERNEL_DEQUANTIZE: return "quant_dequantize";
+        case KERNEL_FP16_ENCODE: return "float_to_fp16_array";
+        case KERNEL_FP16_DECODE: return "fp16_to_float_array";
+        case KERNEL_ATTENTION: return "attention";
+        case KERNEL_SOFTMAX: return "softmax";
+        case KERNEL_GELU: return "activation";
+        case KERNEL_GELU_BACKWARD: return "activation_backward";
+    }
+    return "unknown";
+}
+
+static const char* quant_type_name(QuantType type) {
+    switch (type) {
+        case QUANT_TYPE_INT8: return "int8";
+        case QUANT_TYPE_INT4: return "int4";
+        case QUANT_TYPE_FP16: return "fp16";
+        case QUANT_TYPE_FP8: return "fp8";
+        case QUANT_TYPE_DYNAMIC: return "dynamic";
+    }
+    return "unknown";
+}
+
+// 浮点运算数与强制内存流量（每个操作数读写一次）
+static void case_cost(const BenchCase* bc, double* flops, double* bytes) {
+    double m = (double)bc->m, n = (double)bc->n, k = (double)bc->k;
+    switch (bc->kind) {
+        case KERNEL_MATMUL:
+            *flops = 2.0 * m * n * k;
+            *bytes = 4.0 * (m * k + k * n + m * n);
+            break;
+        case KERNEL_GEMV:
+            *flops = 2.0 * m * n;
+            *bytes = 4.0 * (m * n + n + m);
+            break;
+        case KERNEL_VECTOR_ADD:
+            *flops = n;
+            *bytes = 12.0 * n;
+            break;
+        case KERNEL_QUANTIZE:
+        case KERNEL_DEQUANTIZE:
+            *flops = 0;
+            *bytes = 4.0 * n + (double)quant_get_size(bc->n, bc->quant_type);
+            break;
+        case KERNEL_FP16_ENCODE:
+        case KERNEL_FP16_DECODE:
+            *flops = 0;
+            *bytes = 6.0 * n;
+            break;
+        case KERNEL_ATTENTION: {
+            // 因果屏蔽下第i个查询可见 n - m + i + 1 个键
+            double h = BENCH_ATTENTION_HEADS;
+            double visible = m * (n - m) + m * (m + 1.0) / 2.0;
+            *flops = 4.0 * h * k * visible;
+            *bytes = 4.0 * h * k * (2.0 * m + 2.0 * n);
+            break;
+        }
+        // 超越函数不计入浮点运算数，只按读写字节统计
+        case KERNEL_SOFTMAX:
+            *flops = 0;
+            *bytes = 8.0 * m * n;
+            break;
+        case KERNEL_GELU:
+            *flops = 0;
+            *bytes = 8.0 * n;
+            break;
+        case KERNEL_GELU_BACKWARD:
+            *flops = 0;
+            *bytes = 12.0 * n;
+            break;
+    }
+}
+
+static int state_init(BenchState* st, const BenchCase* bc, HAL_Device* dev) {
+    memset(st, 0, sizeof(*st));
+    st->bc = bc;
+    st->dev = dev;
+
+    switch (bc->kind) {
+        case KERNEL_MATMUL:
+            st->a = alloc_random(dev, bc->m * bc->k, 1);
+            st->b = alloc_random(dev, bc->k * bc->n, 2);
+            st->c = alloc_random(dev, bc->m * bc->n, 3);
+            return st->a && st->b && st->c ? 0 : -1;
+        case KERNEL_GEMV:
+            st->a = alloc_random(dev, bc->m * bc->n, 1);
+            st->b = alloc_random(dev, bc->n, 2);
+            st->c = alloc_random(dev, bc->m, 3);
+            return st->a && st->b && st->c ? 0 : -1;
+        case KERNEL_VECTOR_ADD:
+            st->a = alloc_random(dev, bc->n, 1);
+            st->b = alloc_random(dev, bc->n, 2);
+            st->c = alloc_random(dev, bc->n, 3);
+            return st->a && st->b && st->c ? 0 : -1;
+        case KERNEL_QUANTIZE:
+        case KERNEL_DEQUANTIZE:
+            st->a = alloc_random(dev, bc->n, 1);
+            st->q = dev->allocate_memory(quant_get_size(bc->n, bc->quant_type));
+            if (!st->a || !st->q) return -1;
+            st->qconfig.type = bc->quant_type;
+            st->qconfig.per_channel = 0;
+            st->qconfig.symmetric = 0;
+            st->qconfig.clip_ratio = 1.0f;
+            if (quant_init_params(&st->qparams, st->a, bc->n, &st->qconfig) != 0) return -1;
+            return quant_quantize(st->q, st->a, bc->n, &st->qparams, &st->qconfig);
+        case KERNEL_FP16_ENCODE:
+        case KERNEL_FP16_DECODE:
+            st->a = alloc_random(dev, bc->n, 1);
+            st->q = dev->allocate_memory(bc->n * sizeof(uint16_t));
+            if (!st->a || !st->q) return -1;
+            float_to_fp16_array((uint16_t*)st->q, st->a, bc->n);
+            return 0;
+        case KERNEL_ATTENTION: {
+            size_t row = BENCH_ATTENTION_HEADS * bc->k;
+            st->a = alloc_random(dev, bc->m * row, 1);
+            // K和V，与KV缓存一样使用大页
+            st->b = alloc_random_flags(dev, 2 * bc->n * row, 2, HAL_ALLOC_HUGEPAGE);
+            st->c = alloc_random(dev, bc->m * row, 3);
+            return st->a && st->b && st->c && dev->attention ? 0 : -1;
+        }
+        case KERNEL_SOFTMAX:
+            st->a = alloc_random(dev, bc->m * bc->n, 1);
+            st->c = alloc_random(dev, bc->m * bc->n, 3);
+            return st->a && st->c && dev->softmax ? 0 : -1;
+        case KERNEL_GELU:
+        case KERNEL_GELU_BACKWARD:
+            st->a = alloc_random(dev, bc->n, 1);
+            st->b = alloc_random(dev, bc->n, 2);
+            st->c = alloc_random(dev, bc->n, 3);
+            return st->a && st->b && st->c && dev->activation && dev->activation_backward ? 0 : -1;
+    }
+    return -1;
+}
+
+static void state_free(BenchState* st) {
+    HAL_Device* dev = st->dev;
+    if (st->a) dev->free_memory(st->a);
+    if (st->b) dev->free_memory(st->b);
+    if (st->c) dev->free_memory(st->c);
+    if (st->q) dev->free_memory(st->q);
+}
+
+static void state_run(BenchState* st) {
+    const BenchCase* bc = st->bc;
+    HAL_Device* dev = st->dev;
+    switch (bc->kind) {
+        case KERNEL_MATMUL:
+            dev->matrix_multiply(st->a, st->b, st->c, bc->m, bc->n, bc->k);
+            break;
+        case KERNEL_GEMV:
+            dev->gemv(st->a, st->b, st->c, bc->m, bc->n);
+            break;
+        case KERNEL_VECTOR_ADD:
+            dev->vector_add(st->a, st->b, st->c, bc->n);
+            break;
+        case KERNEL_QUANTIZE:
+            quant_quantize(st->q, st->a, bc->n, &st->qparams, &st->qconfig);
+            break;
+        case KERNEL_DEQUANTIZE:
+            quant_dequantize(st->a, st->q, bc->n, &st->qparams, &st->qconfig);
+            break;
+        case KERNEL_FP16_ENCODE:
+            float_to_fp16_array((uint16_t*)st->q, st->a, bc->n);
+            break;
+        case KERNEL_FP16_DECODE:
+            fp16_to_float_array(st->a, (const uint16_t*)st->q, bc->n);
+            break;
+        case KERNEL_ATTENTION: {
+            AttentionParams params = { .num_heads = BENCH_ATTENTION_HEADS, .head_dim = bc->k,
+                                       .causal = 1, .kv_precision = KV_CACHE_FP32 };
+            dev->attention(&params, st->a, st->b, st->b + bc->n * BENCH_ATTENTION_HEADS * bc->k,
+                           NULL, bc->n, NULL, bc->m, st->c);
+            break;
+        }
+        case KERNEL_SOFTMAX:
+            dev->softmax(st->a, st->c, bc->m, bc->n);
+            break;
+        case KERNEL_GELU:
+            dev->activation(st->a, st->c, bc->n, ACTIVATION_GELU_ERF);
+            break;
+        case KERNEL_GELU_BACKWARD:
+            dev->activation_backward(st->a, st->b, NULL, st->c, bc->n, ACTIVATION_GELU_ERF);
+            break;
+    }
+}
+
+static int run_case(const BenchCase* bc, HAL_Device* dev, const MachinePeak* peak,
+                    double min_time_us, BenchResult* res) {
+    BenchState st;
+    if (state_init(&st, bc, dev) != 0) {
+        state_free(&st);
+        return -1;
+    }
+
+    for (int i = 0; i < BENCH_WARMUP; i++) {
+        state_run(&st);
+    }
+
+    double* samples = (double*)malloc(sizeof(double) * BENCH_MAX_SAMPLES);
+    if (!samples) {
+        state_free(&st);
+        return -1;
+    }
+    size_t count = 0;
+    double total = 0;
+    while (count < BENCH_MAX_SAMPLES && (count < BENCH_MIN_SAMPLES || total < min_time_us)) {
+        double t0 = now_us();
+        state_run(&st);
+        double dt = now_us() - t0;
+        samples[count++] = dt;
+        total += dt;
+    }
+    state_free(&st);
+
+    qsort(samples, count, sizeof(double), cmp_double);
+    memset(res, 0, sizeof(*res));
+    res->bc = bc;
+    res->samples = count;
+    res->p50_us = samples[count / 2];
+    res->p99_us = samples[(count * 99) / 100 < count ? (count * 99) / 100 : count - 1];
+    res->mean_us = total / (double)count;
+    free(samples);
+
+    case_cost(bc, &res->flops, &res->bytes);
+    double seconds = res->p50_us * 1e-6;
+    if (seconds <= 0) seconds = 1e-9;
+    res->gflops = res->flops / seconds * 1e-9;
+    res->gbps = res->bytes / seconds * 1e-9;
+
+    // roofline：算术强度低于机器平衡点时受带宽限制
+    // 驻留缓存的工作集只与计算峰值比较（纯数据搬运的用例不给出比例）
+    res->pct_peak = -1;
+    res->bound = "memory";
+    if (res->bytes <= (double)peak->llc_bytes) {
+        res->bound = "cache";
+        if (res->flops > 0 && peak->peak_gflops > 0) {
+            res->pct_peak = 100.0 * res->gflops / peak->peak_gflops;
+        }
+    } else if (res->flops > 0 && peak->peak_gflops > 0) {
+        double intensity = res->flops / res->bytes;
+        double attainable = intensity * peak->peak_gbps;
+        if (attainable >= peak->peak_gflops) {
+            attainable = peak->peak_gflops;
+            res->bound = "compute";
+        }
+        res->pct_peak = 100.0 * res->gflops / attainable;
+    } else if (res->flops == 0 && peak->peak_gbps > 0) {
+        res->pct_peak = 100.0 * res->gbps / peak->peak_gbps;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// 机器峰值
+// ---------------------------------------------------------------------------
+
+// 单核每周期fp32浮点运算数：两个FMA端口 * 向量宽度 * 2
+static double tier_flops_per_cycle(CpuTier tier) {
+    switch (tier) {
+        case CPU_TIER_AVX512:
+        case CPU_TIER_AVX512_VNNI: return 64.0;
+        case CPU_TIER_AVX2: return 32.0;
+        case CPU_TIER_SSE42: return 8.0;
+        default: return 2.0;
+    }
+}
+
+// 最高主频（GHz），无法查询时返回0
+static double cpu_max_freq_ghz(void) {
+    FILE* fp = fopen("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq", "r");
+    if (fp) {
+        unsigned long long khz;
+        int ok = fscanf(fp, "%llu", &khz) == 1;
+        fclose(fp);
+        if (ok && khz > 0) return (double)khz * 1e-6;
+    }
+
+    fp = fopen("/proc/cpuinfo", "r");
+    if (!fp) return 0;
+    char line[256];
+    double mhz = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "cpu MHz : %lf", &mhz) == 1) break;
+    }
+    fclose(fp);
+    return mhz * 1e-3;
+}
+
+typedef struct {
+    char* dst;
+    const char* src;
+    size_t chunk;
+    size_t total;
+} CopyArgs;
+
+static void copy_task(void* arg, size_t task_idx, size_t thread_idx) {
+    (void)thread_idx;
+    CopyArgs* args = (CopyArgs*)arg;
+    size_t begin = task_idx * args->chunk;
+    size_t end = begin + args->chunk;
+    if (end > args->total) end = args->total;
+    memcpy(args->dst + begin, args->src + begin, end - begin);
+}
+
+// 用多线程memcpy测量可持续带宽（读+写，GB/s）
+static double measure_copy_gbps(size_t threads) {
+    size_t bytes = BENCH_BW_BYTES;
+    char* src = (char*)malloc(bytes);
+    char* dst = (char*)malloc(bytes);
+    if (!src || !dst) {
+        free(src);
+        free(dst);
+        return 0;
+    }
+    memset(src, 1, bytes);
+    memset(dst, 0, bytes);
+
+    ThreadPool* pool = NULL;
+    if (threads > 1) thread_pool_create(&pool, threads);
+
+    CopyArgs args = { dst, src, 0, bytes };
+    args.chunk = (bytes / threads + 4095) & ~(size_t)4095;
+    size_t num_tasks = (bytes + args.chunk - 1) / args.chunk;
+
+    double best = 1e30;
+    for (int rep = 0; rep < 5; rep++) {
+        double t0 = now_us();
+        thread_pool_parallel_for(pool, num_tasks, copy_task, &args);
+        double dt = now_us() - t0;
+        if (dt < best) best = dt;
+    }
+
+    thread_pool_destroy(pool);
+    free(src);
+    free(dst);
+    return 2.0 * (double)bytes / (best * 1e-6) * 1e-9;
+}
+
+static void machine_peak(HAL_Device* dev, double peak_gflops, double peak_gbps, MachinePeak* peak) {
+    const CpuInfo* info = cpu_features_get();
+    memset(peak, 0, sizeof(*peak));
+    peak->brand = info->brand;
+    peak->tier = cpu_tier_name(info->tier);
+
+    peak->threads = dev->capabilities.compute_units;
+    const char* env = getenv(HAL_NUM_THREADS_ENV);
+    if (env && strtol(env, NULL, 10) > 0) peak->threads = (size_t)strtol(env, NULL, 10);
+    if (peak->threads == 0) peak->threads = 1;
+
+    peak->freq_ghz = cpu_max_freq_ghz();
+    peak->flops_per_cycle = tier_flops_per_cycle(info->tier);
+    peak->peak_gflops = peak_gflops > 0 ? peak_gflops
+                      : (double)peak->threads * peak->freq_ghz * peak->flops_per_cycle;
+    peak->peak_gbps = peak_gbps > 0 ? peak_gbps : measure_copy_gbps(peak->threads);
+    peak->llc_bytes = cpu_cache_size(3);
+}
+
+// ---------------------------------------------------------------------------
+// 输出
+// ---------------------------------------------------------------------------
+
+static void format_shape(const BenchCase* bc, char* buf, size_t size) {
+    switch (bc->kind) {
+        case KERNEL_MATMUL:
+            snprintf(buf, size, "m=%zu n=%zu k=%zu", bc->m, bc->n, bc->k);
+            break;
+        case KERNEL_GEMV:
+        case KERNEL_SOFTMAX:
+            snprintf(buf, size, "m=%zu n=%zu", bc->m, bc->n);
+            break;
+        case KERNEL_ATTENTION:
+            snprintf(buf, size, "q=%zu kv=%zu h=%d d=%zu", bc->m, bc->n,
+                     BENCH_ATTENTION_HEADS, bc->k);
+            break;
+        case KERNEL_QUANTIZE:
+        case KERNEL_DEQUANTIZE:
+            snprintf(buf, size, "n=%zu %s", bc->n, quant_type_name(bc->quant_type));
+            break;
+        default:
+            snprintf(buf, size, "n=%zu", bc->n);
+            break;
+    }
+}
+
+static void print_result(FILE* fp, const BenchResult* res) {
+    char shape[64];
+    char pct[16] = "-";
+    char gflops[16] = "-";
+    format_shape(res->bc, shape, sizeof(shape));
+    if (res->pct_peak >= 0) snprintf(pct, sizeof(pct), "%.1f%%", res->pct_peak);
+    if (res->flops > 0) snprintf(gflops, sizeof(gflops), "%.2f", res->gflops);
+    fprintf(fp, "%-26s %-26s %10.2f %10.2f %10s %10.2f %8s %s\n",
+           res->bc->name, shape, res->p50_us, res->p99_us, gflops, res->gbps, pct, res->bound);
+}
+
+// 输出JSON字符串（转义引号和反斜杠）
+static void json_string(FILE* fp, const char* s) {
+    fputc('"', fp);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', fp);
+        if ((unsigned char)*s >= 0x20) fputc(*s, fp);
+    }
+    fputc('"', fp);
+}
+
+static int write_json(const char* path, const MachinePeak* peak,
+                      const BenchResult* results, size_t count) {
+    FILE* fp = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (!fp) return -1;
+
+    fprintf(fp, "{\n  \"machine\": {\n    \"cpu\": ");
+    json_string(fp, peak->brand);
+    fprintf(fp, ",\n    \"isa_tier\": ");
+    json_string(fp, peak->tier);
+    fprintf(fp, ",\n    \"threads\": %zu,\n", peak->threads);
+    fprintf(fp, "    \"freq_ghz\": %.3f,\n", peak->freq_ghz);
+    fprintf(fp, "    \"flops_per_cycle\": %.1f,\n", peak->flops_per_cycle);
+    fprintf(fp, "    \"peak_gflops\": %.3f,\n", peak->peak_gflops);
+    fprintf(fp, "    \"peak_gbps\": %.3f,\n", peak->peak_gbps);
+    fprintf(fp, "    \"llc_bytes\": %zu\n  },\n  \"results\": [\n", peak->llc_bytes);
+
+    for (size_t i = 0; i < count; i++) {
+        const BenchResult* r = &results[i];
+        const BenchCase* bc = r->bc;
+        fprintf(fp, "    {\"name\": ");
+        json_string(fp, bc->name);
+        fprintf(fp, ", \"kernel\": ");
+        json_string(fp, kernel_name(bc->kind));
+        if (bc->kind == KERNEL_MATMUL || bc->kind == KERNEL_GEMV) {
+            fprintf(fp, ", \"m\": %zu", bc->m);
+        }
+        fprintf(fp, ", \"n\": %zu", bc->n);
+        if (bc->kind == KERNEL_MATMUL) fprintf(fp, ", \"k\": %zu", bc->k);
+        if (bc->kind == KERNEL_QUANTIZE || bc->kind == KERNEL_DEQUANTIZE) {
+            fprintf(fp, ", \"quant_type\": ");
+            json_string(fp, quant_type_name(bc->quant_type));
+        }
+        fprintf(fp, ", \"flops\": %.0f, \"bytes\": %.0f, \"samples\": %zu",
+                r->flops, r->bytes, r->samples);
+        fprintf(fp, ", \"p50_us\": %.3f, \"p99_us\": %.3f, \"mean_us\": %.3f",
+                r->p50_us, r->p99_us, r->mean_us);
+        if (r->flops > 0) {
+            fprintf(fp, ", \"gflops\": %.3f", r->gflops);
+        } else {
+            fprintf(fp, ", \"gflops\": null");
+        }
+        fprintf(fp, ", \"gbps\": %.3f", r->gbps);
+        if (r->pct_peak >= 0) {
+            fprintf(fp, ", \"pct_peak\": %.2f", r->pct_peak);
+        } else {
+            fprintf(fp, ", \"pct_peak\": null");
+        }
+        fprintf(fp, ", \"bound\": \"%s\"}%s\n", r->bound, i + 1 < count ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+
+    if (fp != stdout) fclose(fp);
+    return 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "用法: %s [--json FILE|-] [--filter STR] [--min-time MS] [--quick]\n"
+            "          [--peak-gflops X] [--peak-gbps X]\n", prog);
+}
+
+int main(int argc, char** argv) {
+    const char* json_path = NULL;
+    const char* filter = NULL;
+    double min_time_ms = BENCH_DEFAULT_MIN_TIME_MS;
+    double peak_gflops = 0;
+    double peak_gbps = 0;
+    int quick = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--quick") == 0) {
+            quick = 1;
+            continue;
+        }
+        if (!value) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(arg, "--json") == 0) {
+            json_path = value;
+        } else if (strcmp(arg, "--filter") == 0) {
+            filter = value;
+        } else if (strcmp(arg, "--min-time") == 0) {
+            min_time_ms = strtod(value, NULL);
+        } else if (strcmp(arg, "--peak-gflops") == 0) {
+            peak_gflops = strtod(value, NULL);
+        } else if (strcmp(arg, "--peak-gbps") == 0) {
+            peak_gbps = strtod(value, NULL);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    if (hal_init() != 0) {
+        fprintf(stderr, "HAL初始化失败\n");
+        return 1;
+    }
+    HAL_Device* dev = hal_select_optimal_device();
+    if (!dev || dev->device_type != DEVICE_TYPE_CPU) {
+        fprintf(stderr, "没有可用的CPU设备\n");
+        hal_cleanup();
+        return 1;
+    }
+
+    MachinePeak peak;
+    machine_peak(dev, peak_gflops, peak_gbps, &peak);
+
+    // JSON写到标准输出时，表格改写到标准错误
+    FILE* table = json_path && strcmp(json_path, "-") == 0 ? stderr : stdout;
+    fprintf(table, "cpu: %s  tier: %s  threads: %zu  peak: %.1f GFLOP/s, %.1f GB/s\n",
+            peak.brand, peak.tier, peak.threads, peak.peak_gflops, peak.peak_gbps);
+    fprintf(table, "%-26s %-26s %10s %10s %10s %10s %8s %s\n",
+            "case", "shape", "p50(us)", "p99(us)", "GFLOP/s", "GB/s", "peak", "bound");
+    fflush(table);
+
+    const BenchCase* cases = quick ? g_quick_cases : g_full_cases;
+    size_t num_cases = quick ? sizeof(g_quick_cases) / sizeof(g_quick_cases[0])
+                             : sizeof(g_full_cases) / sizeof(g_full_cases[0]);
+    BenchResult* results = (BenchResult*)calloc(num_cases, sizeof(BenchResult));
+    if (!results) {
+        hal_cleanup();
+        return 1;
+    }
+
+    size_t count = 0;
+    int failed = 0;
+    for (size_t i = 0; i < num_cases; i++) {
+        if (filter && !strstr(cases[i].name, filter)) continue;
+        if (run_case(&cases[i], dev, &peak, min_time_ms * 1e3, &results[count]) != 0) {
+            fprintf(stderr, "%s: 运行失败\n", cases[i].name);
+            failed = 1;
+            continue;
+        }
+        print_result(table, &results[count]);
+        fflush(table);
+        count++;
+    }
+
+    if (json_path && write_json(json_path, &peak, results, count) != 0) {
+        fprintf(stderr, "无法写入 %s\n", json_path);
+        failed = 1;
+    }
+
+    free(results);
+    hal_cleanup();
+    return failed;
+}
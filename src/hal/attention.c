@@ -0,0 +1,581 @@
+#include "attention.h"
+#include "cpu_features.h"
+#include "fp8.h"
+#include "hal.h"
+#include "thread_scratch.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+// x86_64 内核（src/hal/x86_64/attention_*.c）
+extern void attention_tile_avx2(const float* q, size_t q_ld, size_t rows,
+                                const float* k, const float* v, size_t ld,
+                                size_t count, size_t head_dim, float scale,
+                                const unsigned char* valid, float* scores,
+                                float* acc, float* max, float* sum);
+extern void attention_tile_avx512(const float* q, size_t q_ld, size_t rows,
+                                  const float* k, const float* v, size_t ld,
+                                  size_t count, size_t head_dim, float scale,
+                                  const unsigned char* valid, float* scores,
+                                  float* acc, float* max, float* sum);
+extern void attention_dequant_int8_avx2(const uint8_t* codes, float scale, size_t n, float* out);
+extern void attention_dequant_fp8_avx2(const uint8_t* codes, float scale, size_t n, float* out);
+extern void attention_dequant_int8_avx512(const uint8_t* codes, float scale, size_t n, float* out);
+extern void attention_dequant_fp8_avx512(const uint8_t* codes, float scale, size_t n, float* out);
+#endif
+
+// 每个任务的最小计算量（查询数 x 键数 x 头维度），低于该值不切分
+#define ATTENTION_MIN_WORK_PER_TASK (1u << 16)
+
+// 因果屏蔽下各查询块的工作量不均，多切分一些任务交给线程池动态分配
+#define ATTENTION_CAUSAL_TASKS_PER_THREAD 4
+
+// 标量实现
+static void attention_row_scalar(const float* q, const float* k, const float* v,
+                                 size_t ld, size_t count, size_t head_dim, float scale,
+                                 const unsigned char* valid, float* scores,
+                                 float* acc, float* max, float* sum) {
+    float tile_max = -INFINITY;
+    for (size_t j = 0; j < count; j++) {
+        if (valid && !valid[j]) {
+            scores[j] = -INFINITY;
+            continue;
+        }
+        const float* k_row = k + j * ld;
+        float dot = 0.0f;
+        for (size_t d = 0; d < head_dim; d++) {
+            dot += q[d] * k_row[d];
+        }
+        scores[j] = dot * scale;
+        if (scores[j] > tile_max) tile_max = scores[j];
+    }
+    if (tile_max == -INFINITY) return;
+
+    // 最大值变大时按 exp(旧最大值 - 新最大值) 缩放已有的累加结果
+    float new_max = tile_max > *max ? tile_max : *max;
+    float alpha = expf(*max - new_max);
+    float s = *sum * alpha;
+    for (size_t d = 0; d < head_dim; d++) {
+        acc[d] *= alpha;
+    }
+    for (size_t j = 0; j < count; j++) {
+        if (scores[j] == -INFINITY) continue;
+        float p = expf(scores[j] - new_max);
+        const float* v_row = v + j * ld;
+        s += p;
+        for (size_t d = 0; d < head_dim; d++) {
+            acc[d] += p * v_row[d];
+        }
+    }
+    *max = new_max;
+    *sum = s;
+}
+
+static void attention_tile_scalar(const float* q, size_t q_ld, size_t rows,
+                                  const float* k, const float* v, size_t ld,
+                                  size_t count, size_t head_dim, float scale,
+                                  const unsigned char* valid, float* scores,
+                                  float* acc, float* max, float* sum) {
+    for (size_t r = 0; r < rows; r++) {
+        attention_row_scalar(q + r * q_ld, k, v, ld, count, head_dim, scale,
+                             valid ? valid + r * count : NULL, scores + r * count,
+                             acc + r * head_dim, max + r, sum + r);
+    }
+}
+
+// 对称INT8，零点128
+static void attention_dequant_int8_scalar(const uint8_t* codes, float scale, size_t n, float* out) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (float)((int)codes[i] - 128) * scale;
+    }
+}
+
+// FP8 E4M3查表
+static float g_fp8_table[256];
+
+static void attention_dequant_fp8_scalar(const uint8_t* codes, float scale, size_t n, float* out) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = g_fp8_table[codes[i]] * scale;
+    }
+}
+
+static AttentionTileKernel g_tile_kernel = attention_tile_scalar;
+static AttentionDequantKernel g_dequant_int8 = attention_dequant_int8_scalar;
+static AttentionDequantKernel g_dequant_fp8 = attention_dequant_fp8_scalar;
+
+void attention_init(void) {
+    for (int i = 0; i < 256; i++) {
+        FP8 code = { (uint8_t)i };
+        g_fp8_table[i] = fp8_to_float(code, FP8_E4M3);
+    }
+    g_tile_kernel = attention_tile_scalar;
+    g_dequant_int8 = attention_dequant_int8_scalar;
+    g_dequant_fp8 = attention_dequant_fp8_scalar;
+#if defined(__x86_64__) || defined(_M_X64)
+    CpuTier tier = cpu_features_tier();
+    if (tier >= CPU_TIER_AVX512) {
+        g_tile_kernel = attention_tile_avx512;
+        g_dequant_int8 = attention_dequant_int8_avx512;
+        g_dequant_fp8 = attention_dequant_fp8_avx512;
+    } else if (tier >= CPU_TIER_AVX2) {
+        g_tile_kernel = attention_tile_avx2;
+        g_dequant_int8 = attention_dequant_int8_avx2;
+        g_dequant_fp8 = attention_dequant_fp8_avx2;
+    }
+#endif
+}
+
+static size_t div_round_up(size_t a, size_t b) {
+    return (a + b - 1) / b;
+}
+
+// 每个任务同时保存在线softmax状态的行数（头数 x 查询行数）
+// 解码时一个任务处理多个相邻的头：同一块K/V中这些头的数据在每行内连续，
+// 按行连续读取比单个头的跨步读取更能发挥硬件预取和内存带宽
+#define ATTENTION_STATE_ROWS 8
+
+// 注意力任务参数
+typedef struct {
+    size_t num_heads;
+    size_t head_dim;
+    float scale;
+    int causal;
+    const float* q;
+    const AttentionKVSpan* spans;
+    size_t num_spans;
+    size_t kv_len;             // 各段行数之和
+    AttentionDequantKernel dequant;  // K/V为FP32时为NULL
+    size_t kv_row_bytes;       // 量化K/V的行跨度
+    size_t kv_scale_offset;    // 量化K/V行内scale的偏移
+    size_t kv_group_size;
+    size_t tile;               // 每块的K/V行数
+    const size_t* q_positions;
+    size_t num_queries;
+    float* out;
+    size_t heads_per_task;
+    size_t queries_per_task;
+    size_t q_blocks;
+} AttentionArgs;
+
+static size_t query_position(const AttentionArgs* args, size_t qi) {
+    return args->q_positions ? args->q_positions[qi] : args->kv_len - args->num_queries + qi;
+}
+
+// 把count行量化K/V中一个头的数据反量化为 [count][head_dim] 的float
+static void dequant_head(const AttentionArgs* args, const uint8_t* rows, size_t count,
+                         size_t head_off, float* out) {
+    const size_t head_end = head_off + args->head_dim;
+    const size_t group = args->kv_group_size;
+    for (size_t j = 0; j < count; j++) {
+        const uint8_t* codes = rows + j * args->kv_row_bytes;
+        const float* scales = (const float*)(codes + args->kv_scale_offset);
+        float* y = out + j * args->head_dim;
+        // 头内按scale分组的段依次反量化
+        for (size_t e = head_off, stop; e < head_end; e = stop) {
+            stop = (e / group + 1) * group;
+            if (stop > head_end) stop = head_end;
+            args->dequant(codes + e, scales[e / group], stop - e, y + (e - head_off));
+        }
+    }
+}
+
+// 计算 [head0, head0 + heads) 个头的 [q0, q0 + rows) 查询行
+// 逐块更新在线softmax状态，最后归一化写出；heads * rows 不超过ATTENTION_STATE_ROWS
+static void attention_block(const AttentionArgs* args, size_t head0, size_t heads,
+                            size_t q0, size_t rows) {
+    const size_t row = args->num_heads * args->head_dim;
+    const size_t head_dim = args->head_dim;
+    const size_t state = rows * head_dim;      // 每个头的累加器大小
+
+    float acc[ATTENTION_STATE_ROWS * ATTENTION_MAX_HEAD_DIM];
+    float max[ATTENTION_STATE_ROWS];
+    float sum[ATTENTION_STATE_ROWS];
+    float scores[ATTENTION_QUERY_BLOCK * ATTENTION_TILE];
+    unsigned char valid[ATTENTION_QUERY_BLOCK * ATTENTION_TILE];
+    float k_tile[ATTENTION_DEQUANT_FLOATS];
+    float v_tile[ATTENTION_DEQUANT_FLOATS];
+    size_t q_pos[ATTENTION_QUERY_BLOCK];
+    size_t last_pos = 0;
+    for (size_t r = 0; r < rows; r++) {
+        q_pos[r] = query_position(args, q0 + r);
+        if (q_pos[r] > last_pos) last_pos = q_pos[r];
+    }
+    for (size_t i = 0; i < heads * rows; i++) {
+        max[i] = -INFINITY;
+        sum[i] = 0.0f;
+    }
+    memset(acc, 0, heads * state * sizeof(float));
+
+    size_t base = 0;           // 当前段首行的逻辑行号
+    for (size_t si = 0; si < args->num_spans; si++) {
+        const AttentionKVSpan* span = &args->spans[si];
+        for (size_t t0 = 0; t0 < span->len; t0 += args->tile) {
+            // 位置连续时，块内所有查询位置之后的行全部被因果屏蔽（后续段的位置更大）
+            if (args->causal && !span->positions && base + t0 > last_pos) break;
+
+            // 屏蔽只取决于位置，各个头共用
+            size_t count = span->len - t0 < args->tile ? span->len - t0 : args->tile;
+            size_t visible = 0;
+            for (size_t r = 0; r < rows; r++) {
+                for (size_t j = 0; j < count; j++) {
+                    size_t pos = span->positions ? span->positions[t0 + j] : base + t0 + j;
+                    int ok = pos != ATTENTION_INVALID_POSITION && (!args->causal || pos <= q_pos[r]);
+                    valid[r * count + j] = (unsigned char)ok;
+                    visible += (size_t)ok;
+                }
+            }
+            if (visible == 0) continue;
+
+            for (size_t h = 0; h < heads; h++) {
+                size_t head_off = (head0 + h) * head_dim;
+                const float* k;
+                const float* v;
+                size_t ld;
+                if (args->dequant) {
+                    // 量化K/V先把这个头的一块反量化到栈上
+                    dequant_head(args, (const uint8_t*)span->k + t0 * args->kv_row_bytes,
+                                 count, head_off, k_tile);
+                    dequant_head(args, (const uint8_t*)span->v + t0 * args->kv_row_bytes,
+                                 count, head_off, v_tile);
+                    k = k_tile;
+                    v = v_tile;
+                    ld = head_dim;
+                } else {
+                    k = (const float*)span->k + t0 * row + head_off;
+                    v = (const float*)span->v + t0 * row + head_off;
+                    ld = row;
+                }
+                g_tile_kernel(args->q + q0 * row + head_off, row, rows, k, v, ld,
+                              count, head_dim, args->scale,
+                              visible == rows * count ? NULL : valid, scores,
+                              acc + h * state, max + h * rows, sum + h * rows);
+            }
+        }
+        base += span->len;
+    }
+
+    for (size_t h = 0; h < heads; h++) {
+        for (size_t r = 0; r < rows; r++) {
+            const float* a = acc + h * state + r * head_dim;
+            float* out_row = args->out + (q0 + r) * row + (head0 + h) * head_dim;
+            float s = sum[h * rows + r];
+            float inv = s > 0.0f ? 1.0f / s : 0.0f;
+            for (size_t d = 0; d < head_dim; d++) {
+                out_row[d] = a[d] * inv;
+            }
+        }
+    }
+}
+
+static void attention_task(void* arg, size_t task_idx, size_t thread_idx) {
+    const AttentionArgs* args = (const AttentionArgs*)arg;
+    (void)thread_idx;
+    size_t head0 = (task_idx / args->q_blocks) * args->heads_per_task;
+    size_t head1 = head0 + args->heads_per_task;
+    if (head1 > args->num_heads) head1 = args->num_heads;
+    size_t q0 = (task_idx % args->q_blocks) * args->queries_per_task;
+    size_t q1 = q0 + args->queries_per_task;
+    if (q1 > args->num_queries) q1 = args->num_queries;
+
+    for (size_t i = q0; i < q1; i += ATTENTION_QUERY_BLOCK) {
+        size_t rows = q1 - i < ATTENTION_QUERY_BLOCK ? q1 - i : ATTENTION_QUERY_BLOCK;
+        size_t group = ATTENTION_STATE_ROWS / rows;
+        for (size_t h = head0; h < head1; h += group) {
+            size_t heads = head1 - h < group ? head1 - h : group;
+            attention_block(args, h, heads, i, rows);
+        }
+    }
+}
+
+// 检查参数并填充一组K/V的任务参数（切分方式由调用者设置），参数无效时返回-1
+static int attention_setup(const AttentionParams* params, const float* q,
+                           const AttentionKVSpan* spans, size_t num_spans,
+                           const size_t* q_positions, size_t num_queries, float* out,
+                           AttentionArgs* out_args) {
+    if (!params || !q || !out || params->num_heads == 0 || params->head_dim == 0 ||
+        params->head_dim > ATTENTION_MAX_HEAD_DIM || (num_spans > 0 && !spans)) {
+        return -1;
+    }
+    size_t kv_len = 0;
+    for (size_t i = 0; i < num_spans; i++) {
+        if (spans[i].len > 0 && (!spans[i].k || !spans[i].v)) return -1;
+        kv_len += spans[i].len;
+    }
+    if (!q_positions && num_queries > kv_len) return -1;
+    size_t row_elems = params->num_heads * params->head_dim;
+    size_t group = params->kv_group_size ? params->kv_group_size : params->head_dim;
+    if (params->kv_precision != KV_CACHE_FP32 && row_elems % group != 0) return -1;
+
+    AttentionArgs args;
+    args.num_heads = params->num_heads;
+    args.head_dim = params->head_dim;
+    args.scale = params->scale != 0.0f ? params->scale : 1.0f / sqrtf((float)params->head_dim);
+    args.causal = params->causal;
+    args.q = q;
+    args.spans = spans;
+    args.num_spans = num_spans;
+    args.kv_len = kv_len;
+    args.dequant = NULL;
+    args.tile = ATTENTION_TILE;
+    if (params->kv_precision != KV_CACHE_FP32) {
+        args.dequant = params->kv_precision == KV_CACHE_INT8 ? g_dequant_int8 : g_dequant_fp8;
+        args.kv_row_bytes = kv_cache_row_bytes(params->kv_precision, row_elems, group);
+        args.kv_scale_offset = div_round_up(row_elems, sizeof(float)) * sizeof(float);
+        args.kv_group_size = group;
+        if (args.tile * params->head_dim > ATTENTION_DEQUANT_FLOATS) {
+            args.tile = ATTENTION_DEQUANT_FLOATS / params->head_dim;
+        }
+    }
+    args.q_positions = q_positions;
+    args.num_queries = num_queries;
+    args.out = out;
+    *out_args = args;
+    return 0;
+}
+
+int attention_forward_spans(ThreadPool* pool, const AttentionParams* params, const float* q,
+                            const AttentionKVSpan* spans, size_t num_spans,
+                            const size_t* q_positions, size_t num_queries, float* out) {
+    AttentionArgs args;
+    if (attention_setup(params, q, spans, num_spans, q_positions, num_queries, out, &args) != 0) {
+        return -1;
+    }
+    if (num_queries == 0) return 0;
+    size_t kv_len = args.kv_len;
+
+    // 先按头切分，线程多于头数时再切分查询
+    size_t num_threads = thread_pool_size(pool);
+    size_t work = num_queries * (kv_len > 0 ? kv_len : 1) * params->head_dim * params->num_heads;
+    size_t max_tasks = div_round_up(work, ATTENTION_MIN_WORK_PER_TASK);
+    size_t target = num_threads * (params->causal ? ATTENTION_CAUSAL_TASKS_PER_THREAD : 1);
+    if (target > max_tasks) target = max_tasks;
+
+    size_t q_blocks = div_round_up(target, params->num_heads);
+    if (q_blocks > num_queries) q_blocks = num_queries;
+    if (q_blocks == 0) q_blocks = 1;
+    args.queries_per_task = div_round_up(num_queries, q_blocks);
+    if (args.queries_per_task > ATTENTION_QUERY_BLOCK) {
+        args.queries_per_task = div_round_up(args.queries_per_task, ATTENTION_QUERY_BLOCK) *
+                                ATTENTION_QUERY_BLOCK;
+    }
+    args.q_blocks = div_round_up(num_queries, args.queries_per_task);
+
+    // 查询切分后任务数仍不足时，每个任务只分到少量头
+    size_t head_groups = div_round_up(target, args.q_blocks);
+    if (head_groups > params->num_heads) head_groups = params->num_heads;
+    if (head_groups == 0) head_groups = 1;
+    args.heads_per_task = div_round_up(params->num_heads, head_groups);
+    head_groups = div_round_up(params->num_heads, args.heads_per_task);
+
+    thread_pool_parallel_for(pool, head_groups * args.q_blocks, attention_task, &args);
+    return 0;
+}
+
+int attention_forward(ThreadPool* pool, const AttentionParams* params,
+                      const float* q, const float* k, const float* v,
+                      const size_t* kv_positions, size_t kv_len,
+                      const size_t* q_positions, size_t num_queries, float* out) {
+    if (!params || params->kv_precision != KV_CACHE_FP32) return -1;
+    AttentionKVSpan span = { k, v, kv_positions, kv_len };
+    return attention_forward_spans(pool, params, q, &span, 1, q_positions, num_queries, out);
+}
+
+// 批量注意力任务参数：每组一份AttentionArgs，任务按 (组, 头组) 编号
+typedef struct {
+    const AttentionArgs* args;
+    size_t num_heads;
+    size_t heads_per_task;
+    size_t head_groups;
+} AttentionBatchArgs;
+
+static void attention_batch_task(void* arg, size_t task_idx, size_t thread_idx) {
+    const AttentionBatchArgs* batch = (const AttentionBatchArgs*)arg;
+    (void)thread_idx;
+    const AttentionArgs* args = &batch->args[task_idx / batch->head_groups];
+    size_t head0 = (task_idx % batch->head_groups) * batch->heads_per_task;
+    size_t head1 = head0 + batch->heads_per_task;
+    if (head1 > batch->num_heads) head1 = batch->num_heads;
+    for (size_t h = head0; h < head1; h += ATTENTION_STATE_ROWS) {
+        size_t heads = head1 - h < ATTENTION_STATE_ROWS ? head1 - h : ATTENTION_STATE_ROWS;
+        attention_block(args, h, heads, 0, 1);
+    }
+}
+
+int attention_forward_batch(ThreadPool* pool, const AttentionParams* params, const float* q,
+                            const AttentionKVSpan* spans, const size_t* span_offsets,
+                            const size_t* q_positions, size_t num_batches, float* out) {
+    if (!params || !q || !out || !span_offsets || num_batches == 0) return -1;
+    AttentionArgs* args = (AttentionArgs*)thread_scratch(SCRATCH_ATTENTION_ARGS,
+                                                         num_batches * sizeof(AttentionArgs));
+    if (!args) return -1;
+
+    size_t row = params->num_heads * params->head_dim;
+    size_t work = 0;
+    for (size_t b = 0; b < num_batches; b++) {
+        if (span_offsets[b + 1] < span_offsets[b]) return -1;
+        if (attention_setup(params, q + b * row, spans + span_offsets[b],
+                            span_offsets[b + 1] - span_offsets[b],
+                            q_positions ? q_positions + b : NULL, 1, out + b * row, &args[b]) != 0) {
+            return -1;
+        }
+        work += (args[b].kv_len > 0 ? args[b].kv_len : 1) * row;
+    }
+
+    // 各组的头合在一起切分：任务数不少于线程数（计算量允许时），每个任务至少一个头
+    AttentionBatchArgs batch;
+    batch.args = args;
+    batch.num_heads = params->num_heads;
+    size_t target = thread_pool_size(pool);
+    size_t max_tasks = div_round_up(work, ATTENTION_MIN_WORK_PER_TASK);
+    if (target > max_tasks) target = max_tasks;
+    batch.head_groups = div_round_up(target, num_batches);
+    if (batch.head_groups > params->num_heads) batch.head_groups = params->num_heads;
+    if (batch.head_groups == 0) batch.head_groups = 1;
+    batch.heads_per_task = div_round_up(params->num_heads, batch.head_groups);
+    batch.head_groups = div_round_up(params->num_heads, batch.heads_per_task);
+
+    thread_pool_parallel_for(pool, num_batches * batch.head_groups, attention_batch_task, &batch);
+    return 0;
+}
+
+// kv_cache_attention在栈上收集的段数，更多时临时分配
+#define ATTENTION_STACK_SPANS 32
+
+int kv_cache_attention(KVCacheManager* manager, size_t layer_idx,
+                       const float* q, const size_t* q_positions, size_t num_queries,
+                       int causal, float scale, float* out) {
+    return kv_cache_attention_seq(manager, 0, layer_idx, q, q_positions, num_queries,
+                                  causal, scale, out);
+}
+
+int kv_cache_attention_seq(KVCacheManager* manager, size_t seq_idx, size_t layer_idx,
+                           const float* q, const size_t* q_positions, size_t num_queries,
+                           int causal, float scale, float* out) {
+    if (!manager || layer_idx >= manager->num_items || seq_idx >= manager->num_seqs ||
+        !manager->seq_active[seq_idx] || !q || !out) {
+        return -1;
+    }
+
+    KVCacheItem* item = manager->items[seq_idx * manager->num_items + layer_idx];
+    HAL_Device* device = (HAL_Device*)manager->device;
+    if (!item || !device || !device->attention_spans) return -1;
+
+    // 按存储连续的段收集K/V（连续模式为一段，环形模式最多两段，分页模式每块一段）
+    size_t num_spans = 0;
+    const void* k;
+    const void* v;
+    const size_t* pos;
+    for (size_t start = 0, n; start < item->current_length; start += n) {
+        n = kv_cache_span_seq(manager, seq_idx, layer_idx, start, &k, &v, &pos);
+        if (n == 0) return -1;     // 已卸载到磁盘
+        num_spans++;
+    }
+
+    // 默认查询为缓存中最后num_queries个令牌，其位置映射跨段时拼接到临时区
+    size_t* q_gather = NULL;
+    if (!q_positions && num_queries > 0) {
+        if (num_queries > item->current_length) return -1;
+        size_t first = item->current_length - num_queries;
+        if (kv_cache_span_seq(manager, seq_idx, layer_idx, first, &k, &v, &pos) >= num_queries) {
+            q_positions = pos;
+        } else {
+            q_gather = (size_t*)malloc(num_queries * sizeof(size_t));
+            if (!q_gather) return -1;
+            for (size_t start = first, n; start < item->current_length; start += n) {
+                n = kv_cache_span_seq(manager, seq_idx, layer_idx, start, &k, &v, &pos);
+                memcpy(q_gather + (start - first), pos, n * sizeof(size_t));
+            }
+            q_positions = q_gather;
+        }
+    }
+
+    AttentionKVSpan local[ATTENTION_STACK_SPANS];
+    AttentionKVSpan* spans = local;
+    if (num_spans > ATTENTION_STACK_SPANS) {
+        spans = (AttentionKVSpan*)malloc(num_spans * sizeof(AttentionKVSpan));
+        if (!spans) {
+            free(q_gather);
+            return -1;
+        }
+    }
+    size_t idx = 0;
+    for (size_t start = 0, n; start < item->current_length; start += n) {
+        n = kv_cache_span_seq(manager, seq_idx, layer_idx, start, &k, &v, &pos);
+        spans[idx].k = k;
+        spans[idx].v = v;
+        spans[idx].positions = pos;
+        spans[idx].len = n;
+        idx++;
+    }
+
+    AttentionParams params;
+    params.num_heads = manager->config.num_heads;
+    params.head_dim = manager->config.head_dim;
+    params.scale = scale;
+    params.causal = causal;
+    params.kv_precision = manager->config.precision;
+    params.kv_group_size = manager->config.quant_group_size;
+    int ret = device->attention_spans(&params, q, spans, num_spans, q_positions, num_queries, out);
+    if (spans != local) free(spans);
+    free(q_gather);
+    return ret;
+}
+
+int kv_cache_attention_batch(KVCacheManager* manager, size_t layer_idx,
+                             const size_t* seq_indices, size_t num_seqs,
+                             const float* q, int causal, float scale, float* out) {
+    if (!manager || !seq_indices || !q || !out || layer_idx >= manager->num_items) return -1;
+    HAL_Device* device = (HAL_Device*)manager->device;
+    if (!device || !device->attention_spans_batch) return -1;
+    if (num_seqs == 0) return 0;
+
+    // 统计各序列的段数，每个序列的查询为最后一行
+    size_t total = 0;
+    const void* k;
+    const void* v;
+    const size_t* pos;
+    for (size_t i = 0; i < num_seqs; i++) {
+        size_t s = seq_indices[i];
+        if (s >= manager->num_seqs || !manager->seq_active[s]) return -1;
+        KVCacheItem* item = manager->items[s * manager->num_items + layer_idx];
+        if (!item || item->current_length == 0) return -1;
+        for (size_t start = 0, n; start < item->current_length; start += n) {
+            n = kv_cache_span_seq(manager, s, layer_idx, start, &k, &v, &pos);
+            if (n == 0) return -1;     // 已卸载到磁盘
+            total++;
+        }
+    }
+
+    // 段、各序列的段偏移和查询位置放在同一块暂存区
+    size_t bytes = total * sizeof(AttentionKVSpan) + (2 * num_seqs + 1) * sizeof(size_t);
+    AttentionKVSpan* spans = (AttentionKVSpan*)thread_scratch(SCRATCH_ATTENTION_SPANS, bytes);
+    if (!spans) return -1;
+    size_t* offsets = (size_t*)(spans + total);
+    size_t* q_positions = offsets + num_seqs + 1;
+    size_t idx = 0;
+    for (size_t i = 0; i < num_seqs; i++) {
+        size_t s = seq_indices[i];
+        KVCacheItem* item = manager->items[s * manager->num_items + layer_idx];
+        offsets[i] = idx;
+        for (size_t start = 0, n; start < item->current_length; start += n) {
+            n = kv_cache_span_seq(manager, s, layer_idx, start, &k, &v, &pos);
+            spans[idx].k = k;
+            spans[idx].v = v;
+            spans[idx].positions = pos;
+            spans[idx].len = n;
+            q_positions[i] = pos[n - 1];
+            idx++;
+        }
+    }
+    offsets[num_seqs] = idx;
+
+    AttentionParams params;
+    params.num_heads = manager->config.num_heads;
+    params.head_dim = manager->config.head_dim;
+    params.scale = scale;
+    params.causal = causal;
+    params.kv_precision = manager->config.precision;
+    params.kv_group_size = manager->config.quant_group_size;
+    return device->attention_spans_batch(&params, q, spans, offsets, q_positions, num_seqs, out);
+}
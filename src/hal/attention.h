@@ -0,0 +1,103 @@
+#ifndef ATTENTION_H
+#define ATTENTION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "kv_cache.h"
+#include "thread_pool.h"
+
+// 融合的缩放点积注意力：out = softmax(scale * Q * K^T + mask) * V
+// 按块遍历K/V，在线softmax只保留每个查询的最大值、指数和与输出累加器，
+// 不生成完整的分数矩阵，每个线程的额外内存为 O(ATTENTION_QUERY_BLOCK * head_dim)
+
+// 支持的最大头维度（累加器放在栈上）
+#define ATTENTION_MAX_HEAD_DIM 512
+
+// 每块的K/V行数
+#define ATTENTION_TILE 64
+
+// 被标记为无效的位置（kv_cache_compact移除的位置）
+#define ATTENTION_INVALID_POSITION ((size_t)-1)
+
+// 注意力参数
+typedef struct AttentionParams {
+    size_t num_heads;          // 注意力头数
+    size_t head_dim;           // 每个头的维度
+    float scale;               // 分数缩放，0表示 1/sqrt(head_dim)
+    int causal;                // 非0时查询只关注位置不大于自身的键
+    KVCachePrecision kv_precision;  // K/V的存储精度，非FP32时按kv_cache.h的行布局逐块反量化
+    size_t kv_group_size;      // 量化K/V每个scale覆盖的元素数（0表示head_dim）
+} AttentionParams;
+
+// 量化K/V的反量化内核：out[i] = decode(codes[i]) * scale
+typedef void (*AttentionDequantKernel)(const uint8_t* codes, float scale, size_t n, float* out);
+
+// 量化K/V每块反量化到栈上的float数（K和V各一份），块的行数相应减少
+#define ATTENTION_DEQUANT_FLOATS (ATTENTION_TILE * 128)
+
+// 每次同时计算的查询行数（同一块K/V由这些行共享）
+#define ATTENTION_QUERY_BLOCK 4
+
+// rows个查询行（行跨度q_ld，rows不超过ATTENTION_QUERY_BLOCK）对一块K/V的在线softmax更新
+// k/v为块内第一行，行跨度为ld；valid为NULL时整块可见，否则valid[r * count + j]为0的位置被屏蔽
+// scores为 rows * count 个float的临时区，acc[rows][head_dim]、max[rows]、sum[rows]为各行的运行状态
+typedef void (*AttentionTileKernel)(const float* q, size_t q_ld, size_t rows,
+                                    const float* k, const float* v, size_t ld,
+                                    size_t count, size_t head_dim, float scale,
+                                    const unsigned char* valid, float* scores,
+                                    float* acc, float* max, float* sum);
+
+// K/V中存储连续的一段行（分页KV缓存的一个块）
+typedef struct AttentionKVSpan {
+    const void* k;             // 首行，FP32时行布局同attention_forward的k/v
+    const void* v;
+    const size_t* positions;   // 各行的位置，NULL时为该段首行的逻辑行号 + j
+    size_t len;                // 行数
+} AttentionKVSpan;
+
+// 初始化（按指令集层级选择内核）
+void attention_init(void);
+
+// q/out: [num_queries][num_heads][head_dim]，k/v: [kv_len][num_heads][head_dim]（即KV缓存的行布局）
+// kv_positions为NULL时第j行的位置为j，q_positions为NULL时第i个查询的位置为 kv_len - num_queries + i
+// 位置为ATTENTION_INVALID_POSITION的K/V行总被屏蔽；没有任何可见键的查询输出0
+// 按 (头, 查询块) 切分到线程池，返回0成功
+int attention_forward(ThreadPool* pool, const AttentionParams* params,
+                      const float* q, const float* k, const float* v,
+                      const size_t* kv_positions, size_t kv_len,
+                      const size_t* q_positions, size_t num_queries, float* out);
+
+// 同attention_forward，K/V由num_spans段依次拼接而成（逻辑行号按段的顺序连续编号）
+// params->kv_precision非FP32时各段的k/v为量化行（布局见kv_cache.h），attention_forward只接受FP32
+int attention_forward_spans(ThreadPool* pool, const AttentionParams* params, const float* q,
+                            const AttentionKVSpan* spans, size_t num_spans,
+                            const size_t* q_positions, size_t num_queries, float* out);
+
+// 批量注意力：num_batches组独立的K/V各一个查询，第b组的段为 spans[span_offsets[b], span_offsets[b + 1])
+// q_positions为各组查询的位置（NULL时为各组的 kv_len - 1），q/out: [num_batches][num_heads][head_dim]
+// 所有组按 (组, 头) 切分到一次thread_pool_parallel_for
+int attention_forward_batch(ThreadPool* pool, const AttentionParams* params, const float* q,
+                            const AttentionKVSpan* spans, const size_t* span_offsets,
+                            const size_t* q_positions, size_t num_batches, float* out);
+
+// 直接读取某层KV缓存计算注意力（不经过kv_cache_lookup的收集拷贝）
+// q_positions为NULL时查询对应缓存中最后num_queries个位置（先append当前令牌的K/V再调用）
+// causal非0时使用因果屏蔽，scale为0时取 1/sqrt(head_dim)
+// 经过设备的attention_spans函数计算（环形模式最多两段，分页模式每块一段），缓存须位于主机可访问的内存中
+int kv_cache_attention(KVCacheManager* manager, size_t layer_idx,
+                       const float* q, const size_t* q_positions, size_t num_queries,
+                       int causal, float scale, float* out);
+
+// 同kv_cache_attention，作用于序列seq_idx
+int kv_cache_attention_seq(KVCacheManager* manager, size_t seq_idx, size_t layer_idx,
+                           const float* q, const size_t* q_positions, size_t num_queries,
+                           int causal, float scale, float* out);
+
+// 批量解码：num_seqs个序列各一个查询（即各序列最后追加的令牌）
+// q/out: [num_seqs][num_heads][head_dim]，通常在kv_cache_append_batch之后调用
+// 经过设备的attention_spans_batch函数，所有序列的所有头在一次并行调度中计算
+int kv_cache_attention_batch(KVCacheManager* manager, size_t layer_idx,
+                             const size_t* seq_indices, size_t num_seqs,
+                             const float* q, int causal, float scale, float* out);
+
+#endif // ATTENTION_H
@@ -0,0 +1,187 @@
+#include "cpu_features.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <cpuid.h>
+#define CPU_FEATURES_X86 1
+#endif
+
+static CpuInfo g_cpu_info;
+static int g_detected = 0;
+
+static const char* tier_names[CPU_TIER_COUNT] = {
+    "scalar", "sse4.2", "avx2", "avx512", "vnni"
+};
+
+#ifdef CPU_FEATURES_X86
+// 读取XCR0，确认操作系统保存了对应的寄存器状态
+static uint64_t read_xcr0(void) {
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+}
+
+static void detect_x86(CpuInfo* info) {
+    uint32_t eax, ebx, ecx, edx;
+    uint32_t max_leaf = __get_cpuid_max(0, NULL);
+
+    __cpuid(0, eax, ebx, ecx, edx);
+    memcpy(info->vendor, &ebx, 4);
+    memcpy(info->vendor + 4, &edx, 4);
+    memcpy(info->vendor + 8, &ecx, 4);
+    info->vendor[12] = '\0';
+
+    if (__get_cpuid_max(0x80000000, NULL) >= 0x80000004) {
+        uint32_t* brand = (uint32_t*)info->brand;
+        for (uint32_t leaf = 0; leaf < 3; leaf++) {
+            __cpuid(0x80000002 + leaf, brand[leaf * 4], brand[leaf * 4 + 1],
+                    brand[leaf * 4 + 2], brand[leaf * 4 + 3]);
+        }
+        info->brand[48] = '\0';
+    }
+
+    if (max_leaf < 1) return;
+    __cpuid(1, eax, ebx, ecx, edx);
+
+    int os_avx = 0;
+    int os_avx512 = 0;
+    if (ecx & bit_OSXSAVE) {
+        uint64_t xcr0 = read_xcr0();
+        os_avx = (xcr0 & 0x6) == 0x6;            // XMM + YMM
+        os_avx512 = (xcr0 & 0xE6) == 0xE6;       // + opmask/ZMM
+    }
+
+    if (ecx & bit_SSE4_2) info->features |= CPU_FEATURE_SSE42;
+    if (os_avx) {
+        if (ecx & bit_AVX) info->features |= CPU_FEATURE_AVX;
+        if (ecx & bit_FMA) info->features |= CPU_FEATURE_FMA;
+        if (ecx & bit_F16C) info->features |= CPU_FEATURE_F16C;
+    }
+
+    if (max_leaf < 7) return;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    if (os_avx && (ebx & bit_AVX2)) info->features |= CPU_FEATURE_AVX2;
+    if (os_avx512) {
+        if (ebx & bit_AVX512F) info->features |= CPU_FEATURE_AVX512F;
+        if (ebx & bit_AVX512BW) info->features |= CPU_FEATURE_AVX512BW;
+        if (ebx & bit_AVX512VL) info->features |= CPU_FEATURE_AVX512VL;
+        if (ecx & (1u << 11)) info->features |= CPU_FEATURE_AVX512_VNNI;
+    }
+
+    __cpuid_count(7, 1, eax, ebx, ecx, edx);
+    if (os_avx && (eax & (1u << 4))) info->features |= CPU_FEATURE_AVX_VNNI;
+}
+#endif
+
+// 根据特性位推导最高层级
+static CpuTier tier_from_features(uint32_t f) {
+    const uint32_t avx2 = CPU_FEATURE_AVX | CPU_FEATURE_AVX2 | CPU_FEATURE_FMA;
+    const uint32_t avx512 = avx2 | CPU_FEATURE_AVX512F | CPU_FEATURE_AVX512BW |
+                            CPU_FEATURE_AVX512VL;
+
+    if ((f & avx512) == avx512) {
+        return (f & CPU_FEATURE_AVX512_VNNI) ? CPU_TIER_AVX512_VNNI : CPU_TIER_AVX512;
+    }
+    if ((f & avx2) == avx2) return CPU_TIER_AVX2;
+    if (f & CPU_FEATURE_SSE42) return CPU_TIER_SSE42;
+    return CPU_TIER_SCALAR;
+}
+
+// 各层级允许使用的特性位，降级时屏蔽更高层级的特性
+static uint32_t tier_feature_mask(CpuTier tier) {
+    uint32_t mask = CPU_FEATURE_NEON;
+    if (tier >= CPU_TIER_SSE42) mask |= CPU_FEATURE_SSE42;
+    if (tier >= CPU_TIER_AVX2) {
+        mask |= CPU_FEATURE_AVX | CPU_FEATURE_AVX2 | CPU_FEATURE_FMA |
+                CPU_FEATURE_F16C | CPU_FEATURE_AVX_VNNI;
+    }
+    if (tier >= CPU_TIER_AVX512) {
+        mask |= CPU_FEATURE_AVX512F | CPU_FEATURE_AVX512BW | CPU_FEATURE_AVX512VL;
+    }
+    if (tier >= CPU_TIER_AVX512_VNNI) mask |= CPU_FEATURE_AVX512_VNNI;
+    return mask;
+}
+
+// 解析环境变量强制指定的层级，无效时返回-1
+static int parse_tier(const char* name) {
+    if (!name || !*name) return -1;
+    for (int i = 0; i < CPU_TIER_COUNT; i++) {
+        if (strcmp(name, tier_names[i]) == 0) return i;
+    }
+    if (strcmp(name, "sse42") == 0) return CPU_TIER_SSE42;
+    if (strcmp(name, "avx512_vnni") == 0) return CPU_TIER_AVX512_VNNI;
+    return -1;
+}
+
+static void detect(void) {
+    memset(&g_cpu_info, 0, sizeof(g_cpu_info));
+
+#ifdef CPU_FEATURES_X86
+    detect_x86(&g_cpu_info);
+#elif defined(__aarch64__)
+    g_cpu_info.features |= CPU_FEATURE_NEON;
+    strcpy(g_cpu_info.vendor, "ARM");
+#endif
+
+    g_cpu_info.detected_tier = tier_from_features(g_cpu_info.features);
+    g_cpu_info.tier = g_cpu_info.detected_tier;
+
+    int forced = parse_tier(getenv(CPU_TIER_ENV));
+    if (forced >= 0) {
+        // 只能降级，不能启用硬件不支持的指令
+        if ((CpuTier)forced <= g_cpu_info.detected_tier) {
+            g_cpu_info.tier = (CpuTier)forced;
+            g_cpu_info.features &= tier_feature_mask(g_cpu_info.tier);
+        } else {
+            fprintf(stderr, "%s=%s 超出硬件支持，使用 %s\n", CPU_TIER_ENV,
+                    tier_names[forced], tier_names[g_cpu_info.detected_tier]);
+        }
+    }
+}
+
+const CpuInfo* cpu_features_get(void) {
+    if (!g_detected) {
+        detect();
+        g_detected = 1;
+    }
+    return &g_cpu_info;
+}
+
+CpuTier cpu_features_tier(void) {
+    return cpu_features_get()->tier;
+}
+
+int cpu_has_feature(uint32_t feature) {
+    return (cpu_features_get()->features & feature) == feature;
+}
+
+const char* cpu_tier_name(CpuTier tier) {
+    if ((unsigned)tier >= CPU_TIER_COUNT) return "unknown";
+    return tier_names[tier];
+}
+
+// 默认缓存大小（无法查询时使用）
+#define DEFAULT_L1_SIZE (32 * 1024)
+#define DEFAULT_L2_SIZE (512 * 1024)
+#define DEFAULT_L3_SIZE (8 * 1024 * 1024)
+
+size_t cpu_cache_size(int level) {
+    long size = -1;
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+    switch (level) {
+        case 1: size = sysconf(_SC_LEVEL1_DCACHE_SIZE); break;
+        case 2: size = sysconf(_SC_LEVEL2_CACHE_SIZE); break;
+        case 3: size = sysconf(_SC_LEVEL3_CACHE_SIZE); break;
+    }
+#endif
+    if (size > 0) return (size_t)size;
+
+    switch (level) {
+        case 1: return DEFAULT_L1_SIZE;
+        case 2: return DEFAULT_L2_SIZE;
+        default: return DEFAULT_L3_SIZE;
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 指令集层级（按能力从低到高排列）
+typedef enum {
+    CPU_TIER_SCALAR = 0,       // 纯C实现
+    CPU_TIER_SSE42,            // SSE4.2
+    CPU_TIER_AVX2,             // AVX2 + FMA
+    CPU_TIER_AVX512,           // AVX-512 F/BW/VL
+    CPU_TIER_AVX512_VNNI,      // AVX-512 + VNNI
+    CPU_TIER_COUNT
+} CpuTier;
+
+// CPU特性位
+#define CPU_FEATURE_SSE42        (1u << 0)
+#define CPU_FEATURE_AVX          (1u << 1)
+#define CPU_FEATURE_AVX2         (1u << 2)
+#define CPU_FEATURE_FMA          (1u << 3)
+#define CPU_FEATURE_F16C         (1u << 4)
+#define CPU_FEATURE_AVX512F      (1u << 5)
+#define CPU_FEATURE_AVX512BW     (1u << 6)
+#define CPU_FEATURE_AVX512VL     (1u << 7)
+#define CPU_FEATURE_AVX512_VNNI  (1u << 8)
+#define CPU_FEATURE_AVX_VNNI     (1u << 9)
+#define CPU_FEATURE_NEON         (1u << 10)
+
+// 强制指定层级的环境变量（scalar/sse4.2/avx2/avx512/vnni）
+#define CPU_TIER_ENV "LOWMEM_CPU_TIER"
+
+// CPU信息
+typedef struct {
+    uint32_t features;         // 可用的特性位（已按实际层级屏蔽）
+    CpuTier detected_tier;     // 硬件支持的最高层级
+    CpuTier tier;              // 实际使用的层级（可被环境变量降级）
+    char vendor[13];           // 厂商字符串
+    char brand[49];            // 型号字符串
+} CpuInfo;
+
+// 探测CPU特性（只在第一次调用时执行CPUID）
+const CpuInfo* cpu_features_get(void);
+
+// 当前使用的层级
+CpuTier cpu_features_tier(void);
+
+// 是否具备某个特性
+int cpu_has_feature(uint32_t feature);
+
+// 层级名称
+const char* cpu_tier_name(CpuTier tier);
+
+// 缓存大小（字节，level为1/2/3，无法查询时返回默认值）
+size_t cpu_cache_size(int level);
+
+#endif // CPU_FEATURES_H
@@ -1,6 +1,12 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "device_manager.h"
+#include "cpu_features.h"
+#include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 // 全局设备管理器实例
 static DeviceManager* g_device_manager = NULL;
@@ -13,6 +19,7 @@ int device_manager_init(void) {
     if (!g_device_manager) return -1;
     
     g_device_manager->devices = NULL;
+    g_device_manager->calibration = NULL;
     g_device_manager->num_devices = 0;
     g_device_manager->current_device = NULL;
     
@@ -23,28 +30,37 @@ int device_manager_init(void) {
         return -1;
     }
     
-    return device_manager_scan_devices();
+    if (device_manager_scan_devices() != 0) return -1;
+    
+    // 启动时校准（有缓存时只读文件）
+    device_manager_calibrate(0);
+    return 0;
 }
 
 // 扫描可用设备
 int device_manager_scan_devices(void) {
     if (!g_device_manager) return -1;
     
-    HAL_Device* devices;
-    int num_devices;
+    int num_devices = hal_get_device_count();
+    if (num_devices <= 0) return -1;
     
-    if (hal_get_devices(&devices, &num_devices) != 0) {
+    // 分配设备列表和校准结果（重复扫描时替换旧列表）
+    HAL_Device** list = (HAL_Device**)malloc(sizeof(HAL_Device*) * num_devices);
+    DeviceCalibration* calibration = (DeviceCalibration*)calloc(num_devices, sizeof(DeviceCalibration));
+    if (!list || !calibration) {
+        free(list);
+        free(calibration);
         return -1;
     }
     
-    // 分配设备列表内存
-    g_device_manager->devices = (HAL_Device**)malloc(sizeof(HAL_Device*) * num_devices);
-    if (!g_device_manager->devices) return -1;
-    
     // 复制设备列表
     for (int i = 0; i < num_devices; i++) {
-        g_device_manager->devices[i] = &devices[i];
+        list[i] = hal_get_device(i);
     }
+    free(g_device_manager->devices);
+    free(g_device_manager->calibration);
+    g_device_manager->devices = list;
+    g_device_manager->calibration = calibration;
     g_device_manager->num_devices = num_devices;
     
     // 设置默认设备
@@ -55,48 +71,344 @@ int device_manager_scan_devices(void) {
     return 0;
 }
 
-// 根据任务特征选择最优设备
-HAL_Device* device_manager_select_device(const char* task_type, size_t memory_requirement) {
-    if (!g_device_manager || !task_type) return NULL;
-    
-    HAL_Device* best_device = NULL;
-    float best_score = -1.0f;
-    
+// ---------------------------------------------------------------------------
+// 校准
+// ---------------------------------------------------------------------------
+
+// GEMM校准的方阵大小、带宽校准的向量长度
+#define CALIB_GEMM_DIM 1024
+#define CALIB_VECTOR_SIZE ((size_t)4 << 20)
+// 大操作取最短耗时的次数，固定开销取平均的次数
+#define CALIB_REPS 3
+#define CALIB_SMALL_REPS 200
+#define CALIB_SMALL_SIZE 16
+
+#define CALIB_FILE_HEADER "# LowMemoryLLM device calibration v1"
+#define CALIB_MAX_ENTRIES 64
+#define CALIB_KEY_SIZE 128
+
+typedef struct {
+    char key[CALIB_KEY_SIZE];
+    DeviceCalibration cal;
+} CalibrationEntry;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int device_index(const HAL_Device* device) {
+    if (!g_device_manager) return -1;
+    for (int i = 0; i < g_device_manager->num_devices; i++) {
+        if (g_device_manager->devices[i] == device) return i;
+    }
+    return -1;
+}
+
+// 缓存键：设备类型和决定性能的参数，CPU还包含型号和指令集层级
+static void device_key(const HAL_Device* device, char* buf, size_t size) {
+    static const char* const type_names[] = { "cpu", "gpu", "tpu", "other" };
+    const char* type = (unsigned)device->device_type < 4 ? type_names[device->device_type] : "other";
+
+    if (device->device_type == DEVICE_TYPE_CPU) {
+        const CpuInfo* info = cpu_features_get();
+        snprintf(buf, size, "%s:%s:%s:%u", type, info->brand, cpu_tier_name(info->tier),
+                 device->capabilities.compute_units);
+    } else {
+        snprintf(buf, size, "%s:%u:%llu", type, device->capabilities.compute_units,
+                 (unsigned long long)device->capabilities.memory_size);
+    }
+
+    // 键在文件中占一列，不能包含空白
+    for (char* p = buf; *p; p++) {
+        if (*p == ' ' || *p == '\t') *p = '_';
+    }
+}
+
+// 通过设备函数指针实测，适用于任何设备
+static int measure_device(HAL_Device* device, DeviceCalibration* cal) {
+    memset(cal, 0, sizeof(*cal));
+    cal->unified_memory = device->device_type == DEVICE_TYPE_CPU;
+
+    size_t bytes = CALIB_VECTOR_SIZE * sizeof(float);
+    float* host = (float*)malloc(bytes);
+    void* a = device->allocate_memory(bytes);
+    void* b = device->allocate_memory(bytes);
+    void* c = device->allocate_memory(bytes);
+    if (!host || !a || !b || !c) {
+        free(host);
+        if (a) device->free_memory(a);
+        if (b) device->free_memory(b);
+        if (c) device->free_memory(c);
+        return -1;
+    }
+    for (size_t i = 0; i < CALIB_VECTOR_SIZE; i++) {
+        host[i] = (float)(i % 17) * 0.0625f;
+    }
+
+    // 主机到设备的传输（同时初始化设备缓冲区）
+    device->memcpy_to_device(a, host, bytes);
+    device->memcpy_to_device(b, host, bytes);
+    double best = INFINITY;
+    for (int rep = 0; rep < CALIB_REPS; rep++) {
+        double t0 = now_seconds();
+        device->memcpy_to_device(c, host, bytes);
+        double dt = now_seconds() - t0;
+        if (dt < best) best = dt;
+    }
+    cal->transfer_gbps = (double)bytes / best * 1e-9;
+
+    double t0 = now_seconds();
+    for (int rep = 0; rep < CALIB_SMALL_REPS; rep++) {
+        device->memcpy_to_device(c, host, CALIB_SMALL_SIZE * sizeof(float));
+    }
+    cal->transfer_latency_us = (now_seconds() - t0) / CALIB_SMALL_REPS * 1e6;
+
+    // GEMM吞吐量
+    const size_t dim = CALIB_GEMM_DIM;
+    device->matrix_multiply(a, b, c, dim, dim, dim);
+    best = INFINITY;
+    for (int rep = 0; rep < CALIB_REPS; rep++) {
+        t0 = now_seconds();
+        device->matrix_multiply(a, b, c, dim, dim, dim);
+        double dt = now_seconds() - t0;
+        if (dt < best) best = dt;
+    }
+    cal->gemm_gflops = 2.0 * (double)dim * (double)dim * (double)dim / best * 1e-9;
+
+    // 内存带宽：读两个向量写一个向量
+    device->vector_add(a, b, c, CALIB_VECTOR_SIZE);
+    best = INFINITY;
+    for (int rep = 0; rep < CALIB_REPS; rep++) {
+        t0 = now_seconds();
+        device->vector_add(a, b, c, CALIB_VECTOR_SIZE);
+        double dt = now_seconds() - t0;
+        if (dt < best) best = dt;
+    }
+    cal->memory_gbps = 3.0 * (double)bytes / best * 1e-9;
+
+    // 调用开销
+    t0 = now_seconds();
+    for (int rep = 0; rep < CALIB_SMALL_REPS; rep++) {
+        device->vector_add(a, b, c, CALIB_SMALL_SIZE);
+    }
+    cal->launch_latency_us = (now_seconds() - t0) / CALIB_SMALL_REPS * 1e6;
+
+    free(host);
+    device->free_memory(a);
+    device->free_memory(b);
+    device->free_memory(c);
+    return 0;
+}
+
+// 缓存文件路径，不使用缓存时返回-1（缓存需显式开启，避免写入用户目录）
+static int calibration_path(char* buf, size_t size) {
+    const char* env = getenv(DEVICE_CALIBRATION_ENV);
+    if (!env || !*env || strcmp(env, "0") == 0) return -1;
+    if (strcmp(env, "1") != 0) {
+        int len = snprintf(buf, size, "%s", env);
+        return len > 0 && (size_t)len < size ? 0 : -1;
+    }
+
+    char dir[512];
+    if (hal_cache_dir(dir, sizeof(dir)) != 0) return -1;
+    int len = snprintf(buf, size, "%s/devices.cal", dir);
+    return len > 0 && (size_t)len < size ? 0 : -1;
+}
+
+// 读取缓存文件中的全部条目，返回条目数
+static size_t load_calibration_file(const char* path, CalibrationEntry* entries, size_t max_entries) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) return 0;
+
+    char line[512];
+    size_t count = 0;
+    while (count < max_entries && fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+
+        CalibrationEntry* e = &entries[count];
+        memset(e, 0, sizeof(*e));
+        if (sscanf(line, "%127s %lf %lf %lf %lf %lf %d", e->key, &e->cal.gemm_gflops,
+                   &e->cal.memory_gbps, &e->cal.transfer_gbps, &e->cal.transfer_latency_us,
+                   &e->cal.launch_latency_us, &e->cal.unified_memory) != 7) {
+            continue;
+        }
+        if (e->cal.gemm_gflops <= 0 || e->cal.memory_gbps <= 0) continue;
+        count++;
+    }
+    fclose(fp);
+    return count;
+}
+
+static int save_calibration_file(const char* path, const CalibrationEntry* entries, size_t count) {
+    if (hal_create_parent_dirs(path) != 0) return -1;
+
+    char tmp[576];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE* fp = fopen(tmp, "w");
+    if (!fp) return -1;
+
+    fprintf(fp, "%s\n", CALIB_FILE_HEADER);
+    fprintf(fp, "# key gemm_gflops memory_gbps transfer_gbps transfer_latency_us "
+                "launch_latency_us unified_memory\n");
+    for (size_t i = 0; i < count; i++) {
+        const DeviceCalibration* cal = &entries[i].cal;
+        fprintf(fp, "%s %.3f %.3f %.3f %.3f %.3f %d\n", entries[i].key, cal->gemm_gflops,
+                cal->memory_gbps, cal->transfer_gbps, cal->transfer_latency_us,
+                cal->launch_latency_us, cal->unified_memory);
+    }
+
+    int ok = fflush(fp) == 0;
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+int device_manager_calibrate(int force) {
+    if (!g_device_manager) return -1;
+
+    char path[512];
+    int use_cache = calibration_path(path, sizeof(path)) == 0;
+    CalibrationEntry entries[CALIB_MAX_ENTRIES];
+    size_t count = use_cache ? load_calibration_file(path, entries, CALIB_MAX_ENTRIES) : 0;
+
+    int measured = 0;
+    int ret = 0;
     for (int i = 0; i < g_device_manager->num_devices; i++) {
         HAL_Device* device = g_device_manager->devices[i];
-        
-        // 检查内存要求
-        if (device->capabilities.memory_size < memory_requirement) {
+        DeviceCalibration* cal = &g_device_manager->calibration[i];
+        char key[CALIB_KEY_SIZE];
+        device_key(device, key, sizeof(key));
+
+        size_t slot = count;
+        for (size_t e = 0; e < count; e++) {
+            if (strcmp(entries[e].key, key) == 0) {
+                slot = e;
+                break;
+            }
+        }
+        if (!force && slot < count) {
+            *cal = entries[slot].cal;
             continue;
         }
-        
-        // 计算设备得分
-        float score = 0.0f;
-        
-        // 根据任务类型评分
-        if (strcmp(task_type, "matrix_multiply") == 0) {
-            // 矩阵乘法更看重计算单元数量
-            score = device->capabilities.compute_units * 2.0f;
-        } else if (strcmp(task_type, "vector_add") == 0) {
-            // 向量加法更看重内存带宽
-            score = device->capabilities.compute_units * 1.0f;
-        } else {
-            // 默认评分
-            score = device->capabilities.compute_units * 1.5f;
+
+        if (measure_device(device, cal) != 0) {
+            // 标记为未校准，查询返回NULL
+            memset(cal, 0, sizeof(*cal));
+            fprintf(stderr, "设备校准失败: %s\n", key);
+            ret = -1;
+            continue;
         }
-        
-        // 考虑内存大小
-        score *= (float)device->capabilities.memory_size / (float)memory_requirement;
-        
-        if (score > best_score) {
-            best_score = score;
+        measured = 1;
+
+        // 写回缓存：替换同键条目或追加
+        if (slot == count && count < CALIB_MAX_ENTRIES) count++;
+        if (slot < count) {
+            snprintf(entries[slot].key, sizeof(entries[slot].key), "%s", key);
+            entries[slot].cal = *cal;
+        }
+    }
+
+    if (use_cache && measured && save_calibration_file(path, entries, count) != 0) {
+        fprintf(stderr, "无法保存设备校准文件 %s\n", path);
+    }
+    return ret;
+}
+
+const DeviceCalibration* device_manager_get_calibration(const HAL_Device* device) {
+    int idx = device_index(device);
+    if (idx < 0) return NULL;
+
+    // 实测失败的设备已标记为未校准，不在查询路径上重试
+    const DeviceCalibration* cal = &g_device_manager->calibration[idx];
+    return cal->gemm_gflops > 0 ? cal : NULL;
+}
+
+// ---------------------------------------------------------------------------
+// 代价模型
+// ---------------------------------------------------------------------------
+
+DeviceTask device_task_matmul(size_t m, size_t n, size_t k) {
+    DeviceTask task;
+    double bytes = 4.0 * ((double)m * k + (double)k * n + (double)m * n);
+    task.flops = 2.0 * (double)m * (double)n * (double)k;
+    task.device_bytes = bytes;
+    task.transfer_bytes = bytes;
+    task.memory_requirement = (size_t)bytes;
+    return task;
+}
+
+DeviceTask device_task_vector_add(size_t size) {
+    DeviceTask task;
+    double bytes = 12.0 * (double)size;
+    task.flops = (double)size;
+    task.device_bytes = bytes;
+    task.transfer_bytes = bytes;
+    task.memory_requirement = (size_t)bytes;
+    return task;
+}
+
+double device_manager_predict_time(const HAL_Device* device, const DeviceTask* task) {
+    if (!device || !task) return -1.0;
+    if (device->capabilities.memory_size < task->memory_requirement) return -1.0;
+
+    const DeviceCalibration* cal = device_manager_get_calibration(device);
+    if (!cal) return -1.0;
+
+    // roofline：计算与访存重叠，取两者中的较大者
+    double compute = task->flops / (cal->gemm_gflops * 1e9);
+    double memory = task->device_bytes / (cal->memory_gbps * 1e9);
+    double seconds = cal->launch_latency_us * 1e-6 + (compute > memory ? compute : memory);
+
+    if (!cal->unified_memory && task->transfer_bytes > 0 && cal->transfer_gbps > 0) {
+        seconds += cal->transfer_latency_us * 1e-6 + task->transfer_bytes / (cal->transfer_gbps * 1e9);
+    }
+    return seconds;
+}
+
+HAL_Device* device_manager_select_for_task(const DeviceTask* task, double* predicted_seconds) {
+    if (!g_device_manager || !task) return NULL;
+
+    HAL_Device* best_device = NULL;
+    double best_time = 0;
+    for (int i = 0; i < g_device_manager->num_devices; i++) {
+        HAL_Device* device = g_device_manager->devices[i];
+        double t = device_manager_predict_time(device, task);
+        if (t < 0) continue;
+        if (!best_device || t < best_time) {
             best_device = device;
+            best_time = t;
         }
     }
-    
+
+    if (predicted_seconds) *predicted_seconds = best_device ? best_time : -1.0;
     return best_device;
 }
 
+// 根据任务特征选择最优设备
+HAL_Device* device_manager_select_device(const char* task_type, size_t memory_requirement) {
+    if (!g_device_manager || !task_type) return NULL;
+    
+    DeviceTask task;
+    if (strcmp(task_type, "matrix_multiply") == 0) {
+        size_t dim = (size_t)sqrt((double)memory_requirement / 12.0);
+        task = device_task_matmul(dim, dim, dim);
+    } else if (strcmp(task_type, "vector_add") == 0) {
+        task = device_task_vector_add(memory_requirement / 12);
+    } else {
+        task.flops = 0;
+        task.device_bytes = (double)memory_requirement;
+        task.transfer_bytes = (double)memory_requirement;
+    }
+    task.memory_requirement = memory_requirement;
+    
+    return device_manager_select_for_task(&task, NULL);
+}
+
 // 获取当前设备
 HAL_Device* device_manager_get_current_device(void) {
     if (!g_device_manager) return NULL;
@@ -126,38 +438,13 @@ int device_manager_switch_device(HAL_Device* device) {
 void device_manager_cleanup(void) {
     if (!g_device_manager) return;
     
-    if (g_device_manager->devices) {
-        // 清理设备资源
-        for (int i = 0; i < g_device_manager->num_devices; i++) {
-            if (g_device_manager->devices[i]) {
-                // 释放设备特定资源
-                if (g_device_manager->devices[i]->device_type == DEVICE_TYPE_GPU) {
-                    // 释放GPU内存
-                    if (g_device_manager->devices[i]->allocate_memory) {
-                        void* gpu_memory = g_device_manager->devices[i]->device_specific_data;
-                        if (gpu_memory) {
-                            g_device_manager->devices[i]->free_memory(gpu_memory);
-                        }
-                    }
-                    
-                    // 释放GPU上下文
-                    if (g_device_manager->devices[i]->device_specific_data) {
-                        // 假设device_specific_data指向GPU上下文结构
-                        GPUContext* ctx = (GPUContext*)g_device_manager->devices[i]->device_specific_data;
-                        if (ctx->command_queue) {
-                            clReleaseCommandQueue(ctx->command_queue);
-                        }
-                        if (ctx->context) {
-                            clReleaseContext(ctx->context);
-                        }
-                        free(ctx);
-                    }
-                }
-            }
-        }
-        free(g_device_manager->devices);
-    }
+    // 设备及其上下文归HAL所有，由hal_cleanup释放，这里只释放指针数组
+    free(g_device_manager->devices);
+    free(g_device_manager->calibration);
     
     free(g_device_manager);
     g_device_manager = NULL;
+    
+    // 释放HAL设备（包括CPU线程池）
+    hal_cleanup();
 } 
\ No newline at end of file
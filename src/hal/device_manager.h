@@ -3,20 +3,62 @@
 
 #include "hal.h"
 
+// 设备实测能力（启动时校准，设置DEVICE_CALIBRATION_ENV时结果缓存在磁盘上）
+typedef struct {
+    double gemm_gflops;            // 单精度GEMM吞吐量
+    double memory_gbps;            // 设备内存带宽（vector_add读写）
+    double transfer_gbps;          // 主机与设备之间的传输带宽
+    double transfer_latency_us;    // 单次传输的固定开销
+    double launch_latency_us;      // 单次计算调用的固定开销
+    int unified_memory;            // 设备直接使用主机内存，数据无需搬运
+} DeviceCalibration;
+
+// 任务的代价描述
+typedef struct {
+    double flops;                  // 浮点运算数
+    double device_bytes;           // 计算过程中读写的设备内存字节数
+    double transfer_bytes;         // 需要在主机与设备之间搬运的字节数
+    size_t memory_requirement;     // 需要的设备内存
+} DeviceTask;
+
 // 设备管理器结构体
 typedef struct {
     HAL_Device** devices;
+    DeviceCalibration* calibration;    // 与devices一一对应
     int num_devices;
     HAL_Device* current_device;
 } DeviceManager;
 
+// 校准缓存文件的环境变量：未设置或为0时不读写缓存，为1时使用hal_cache_dir下的devices.cal，其他值为文件路径
+#define DEVICE_CALIBRATION_ENV "LOWMEM_DEVICE_CALIBRATION"
+
 // 初始化设备管理器
 int device_manager_init(void);
 
 // 扫描可用设备
 int device_manager_scan_devices(void);
 
-// 根据任务特征选择最优设备
+// 校准所有设备：优先读取缓存，force非0或缓存缺失时实测并写回缓存
+// 实测失败的设备标记为未校准，直到下次显式校准
+int device_manager_calibrate(int force);
+
+// 设备的校准结果，未校准、校准失败或设备不在列表中时返回NULL（查询本身不会触发校准）
+const DeviceCalibration* device_manager_get_calibration(const HAL_Device* device);
+
+// 常见任务的代价描述（fp32，输入从主机传入、输出传回主机）
+DeviceTask device_task_matmul(size_t m, size_t n, size_t k);
+DeviceTask device_task_vector_add(size_t size);
+
+// 预测任务在设备上的耗时（秒）：调用开销 + max(计算时间, 访存时间) + 数据搬运时间
+// 设备内存不足时返回负数
+double device_manager_predict_time(const HAL_Device* device, const DeviceTask* task);
+
+// 选择预测耗时最短的设备，predicted_seconds可为NULL
+HAL_Device* device_manager_select_for_task(const DeviceTask* task, double* predicted_seconds);
+
+// 根据任务特征选择最优设备（按预测耗时）
+// task_type为"matrix_multiply"时把memory_requirement视为三个方阵的总大小，
+// "vector_add"时视为三个向量的总大小，其他类型只考虑访存
 HAL_Device* device_manager_select_device(const char* task_type, size_t memory_requirement);
 
 // 获取当前设备
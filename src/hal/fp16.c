@@ -0,0 +1,99 @@
+#include "fp16.h"
+#include "cpu_features.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+// x86_64 F16C批量转换（src/hal/x86_64/fp16_f16c.c）
+extern void fp16_to_float_f16c(float* dst, const uint16_t* src, size_t count);
+extern void float_to_fp16_f16c(uint16_t* dst, const float* src, size_t count);
+#endif
+
+uint16_t float_to_fp16(float value) {
+    uint32_t x;
+    memcpy(&x, &value, sizeof(x));
+
+    uint16_t sign = (uint16_t)((x >> 16) & 0x8000);
+    uint32_t abs = x & 0x7FFFFFFF;
+
+    // Inf / NaN（NaN保留高位尾数并置静默位）
+    if (abs >= 0x7F800000) {
+        if (abs == 0x7F800000) return sign | 0x7C00;
+        return sign | 0x7E00 | (uint16_t)((abs >> 13) & 0x3FF);
+    }
+
+    // 舍入后超过65504的值溢出为Inf
+    if (abs >= 0x477FF000) return sign | 0x7C00;
+
+    // 次正规数（|x| < 2^-14）：按 2^-24 的步长舍入
+    if (abs < 0x38800000) {
+        if (abs <= 0x33000000) return sign;
+        uint32_t exp = abs >> 23;
+        uint32_t mant = (abs & 0x7FFFFF) | 0x800000;
+        uint32_t shift = 126 - exp;
+        uint32_t h = mant >> shift;
+        uint32_t rem = mant & ((1u << shift) - 1);
+        uint32_t half = 1u << (shift - 1);
+        if (rem > half || (rem == half && (h & 1))) h++;
+        return sign | (uint16_t)h;
+    }
+
+    // 正规数：指数偏置从127调整为15，尾数进位可自然进入指数位
+    uint32_t h = (abs - 0x38000000) >> 13;
+    uint32_t rem = abs & 0x1FFF;
+    if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) h++;
+    return sign | (uint16_t)h;
+}
+
+float fp16_to_float(uint16_t value) {
+    uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+    uint32_t exp = (value >> 10) & 0x1F;
+    uint32_t mant = value & 0x3FF;
+    uint32_t bits;
+
+    if (exp == 0) {
+        if (mant == 0) {
+            bits = sign;
+        } else {
+            // 次正规数：规格化为单精度正规数
+            uint32_t e = 113;
+            while (!(mant & 0x400)) {
+                mant <<= 1;
+                e--;
+            }
+            bits = sign | (e << 23) | ((mant & 0x3FF) << 13);
+        }
+    } else if (exp == 31) {
+        // NaN转换后为静默NaN（与vcvtph2ps一致）
+        bits = sign | 0x7F800000 | (mant << 13) | (mant ? 0x400000 : 0);
+    } else {
+        bits = sign | ((exp + 112) << 23) | (mant << 13);
+    }
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+void fp16_to_float_array(float* dst, const uint16_t* src, size_t count) {
+#if defined(__x86_64__) || defined(_M_X64)
+    if (cpu_has_feature(CPU_FEATURE_F16C)) {
+        fp16_to_float_f16c(dst, src, count);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = fp16_to_float(src[i]);
+    }
+}
+
+void float_to_fp16_array(uint16_t* dst, const float* src, size_t count) {
+#if defined(__x86_64__) || defined(_M_X64)
+    if (cpu_has_feature(CPU_FEATURE_F16C)) {
+        float_to_fp16_f16c(dst, src, count);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = float_to_fp16(src[i]);
+    }
+}
@@ -0,0 +1,15 @@
+#ifndef FP16_H
+#define FP16_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// IEEE 754 半精度转换：就近舍入到偶数，正确处理次正规数、Inf与NaN
+uint16_t float_to_fp16(float value);
+float fp16_to_float(uint16_t value);
+
+// 批量转换（CPU支持F16C时使用vcvtph2ps/vcvtps2ph，每次8个元素）
+void fp16_to_float_array(float* dst, const uint16_t* src, size_t count);
+void float_to_fp16_array(uint16_t* dst, const float* src, size_t count);
+
+#endif // FP16_H
@@ -4,7 +4,7 @@
 // 常量定义
 #define FP8_E4M3_BIAS 7
 #define FP8_E5M2_BIAS 15
-#define FP8_E4M3_MAX_EXP 8
+#define FP8_E4M3_MAX_EXP 15
 #define FP8_E5M2_MAX_EXP 16
 #define FP8_E4M3_INFINITY 0x7F
 #define FP8_E5M2_INFINITY 0x7F
@@ -54,7 +54,7 @@ FP8 float_to_fp8(float value, FP8Format format) {
     }
     
     if (format == FP8_E4M3) {
-        // E4M3格式
+        // E4M3格式：指数偏置7，支持非规格化数，最大有限值448
         if (value == 0.0f) {
             result.bits = 0;
             return result;
@@ -65,18 +65,21 @@ FP8 float_to_fp8(float value, FP8Format format) {
         exp += FP8_E4M3_BIAS - 1;
         mant = mant * 16.0f - 8.0f;
         
-        if (exp < -FP8_E4M3_BIAS) {
-            // 下溢出到0
-            result.bits = 0;
-        } else if (exp > FP8_E4M3_MAX_EXP) {
-            // 上溢出到无穷大
-            result.bits = FP8_E4M3_INFINITY;
+        if (exp < 1) {
+            // 非规格化数：value = mant * 2^-9，进位到8时为最小规格化数
+            int mant_int = (int)(roundf(ldexpf(value, 9)));
+            result.bits = (mant_int == 8) ? pack_e4m3(sign, 1, 0) : pack_e4m3(sign, 0, mant_int);
         } else {
             int mant_int = (int)(roundf(mant));
             if (mant_int == 8) {
                 exp++;
                 mant_int = 0;
             }
+            if (exp > FP8_E4M3_MAX_EXP || (exp == FP8_E4M3_MAX_EXP && mant_int == 7)) {
+                // 上溢出时饱和到最大有限值448（全1编码为NaN）
+                exp = FP8_E4M3_MAX_EXP;
+                mant_int = 6;
+            }
             result.bits = pack_e4m3(sign, exp, mant_int);
         }
     } else {
@@ -117,12 +120,11 @@ float fp8_to_float(FP8 value, FP8Format format) {
         unpack_e4m3(value.bits, &sign, &exp, &mant);
         
         // 处理特殊值
-        if (value.bits == FP8_E4M3_NAN) return NAN;
-        if (value.bits == FP8_E4M3_INFINITY) return INFINITY;
-        if (value.bits == 0) return 0.0f;
+        if ((value.bits & 0x7F) == FP8_E4M3_NAN) return NAN;
         
-        float result = (mant + 8.0f) / 16.0f;
-        result = ldexpf(result, exp - FP8_E4M3_BIAS + 1);
+        // 指数为0时为非规格化数 mant * 2^-9
+        float result = exp == 0 ? ldexpf((float)mant, -9) :
+                       ldexpf((mant + 8.0f) / 16.0f, exp - FP8_E4M3_BIAS + 1);
         return sign ? -result : result;
     } else {
         unpack_e5m2(value.bits, &sign, &exp, &mant);
@@ -0,0 +1,709 @@
+#include "gemm.h"
+#include "cpu_features.h"
+#include "fp16.h"
+#include "gemv.h"
+#include "thread_scratch.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+// x86_64 微内核（src/hal/x86_64/gemm_*.c）
+extern void gemm_kernel_sse_6x8(size_t kc, const float* a_panel, const float* b_panel,
+                                float* c, size_t ldc, size_t mr, size_t nr,
+                                int accumulate);
+extern void gemm_kernel_avx2_6x16(size_t kc, const float* a_panel, const float* b_panel,
+                                  float* c, size_t ldc, size_t mr, size_t nr,
+                                  int accumulate);
+extern void gemm_kernel_avx512_12x32(size_t kc, const float* a_panel, const float* b_panel,
+                                     float* c, size_t ldc, size_t mr, size_t nr,
+                                     int accumulate);
+#endif
+
+// 通用微内核尺寸
+#define GENERIC_MR 4
+#define GENERIC_NR 8
+
+// 通用C微内核（无SIMD的平台使用）
+static void gemm_kernel_generic(size_t kc, const float* a_panel, const float* b_panel,
+                                float* c, size_t ldc, size_t mr, size_t nr,
+                                int accumulate) {
+    float acc[GENERIC_MR][GENERIC_NR] = {{0}};
+
+    for (size_t p = 0; p < kc; p++) {
+        const float* a = a_panel + p * GENERIC_MR;
+        const float* b = b_panel + p * GENERIC_NR;
+        for (size_t i = 0; i < GENERIC_MR; i++) {
+            for (size_t j = 0; j < GENERIC_NR; j++) {
+                acc[i][j] += a[i] * b[j];
+            }
+        }
+    }
+
+    for (size_t i = 0; i < mr; i++) {
+        float* c_row = c + i * ldc;
+        for (size_t j = 0; j < nr; j++) {
+            c_row[j] = accumulate ? c_row[j] + acc[i][j] : acc[i][j];
+        }
+    }
+}
+
+// 各指令集层级对应的微内核
+static const GemmKernelInfo gemm_kernels[CPU_TIER_COUNT] = {
+    [CPU_TIER_SCALAR]      = { gemm_kernel_generic, GENERIC_MR, GENERIC_NR, "generic_4x8" },
+#if defined(__x86_64__) || defined(_M_X64)
+    [CPU_TIER_SSE42]       = { gemm_kernel_sse_6x8, 6, 8, "sse_6x8" },
+    [CPU_TIER_AVX2]        = { gemm_kernel_avx2_6x16, 6, 16, "avx2_6x16" },
+    [CPU_TIER_AVX512]      = { gemm_kernel_avx512_12x32, 12, 32, "avx512_12x32" },
+    [CPU_TIER_AVX512_VNNI] = { gemm_kernel_avx512_12x32, 12, 32, "avx512_12x32" },
+#endif
+};
+
+static GemmKernelInfo g_kernel = {
+    gemm_kernel_generic, GENERIC_MR, GENERIC_NR, "generic_4x8"
+};
+static GemmBlocking g_blocking = { 0, 0, 0 };
+
+// 形状调优表：按 (m, n, k) 排序的不可变快照，查询时原子读取当前快照后二分查找
+// 更新时加锁复制出新快照再替换，被替换的快照挂在退役链表上，gemm_tuning_clear时释放
+typedef struct GemmTuningTable {
+    struct GemmTuningTable* retired;   // 更早被替换的快照
+    size_t count;
+    GemmTuningEntry entries[];
+} GemmTuningTable;
+
+static _Atomic(GemmTuningTable*) g_tuning_table;
+static GemmTuningTable* g_tuning_retired;
+static pthread_mutex_t g_tuning_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// 根据缓存大小计算分块参数
+static void compute_blocking(const GemmKernelInfo* kernel, GemmBlocking* blocking) {
+    size_t l1 = cpu_cache_size(1);
+    size_t l2 = cpu_cache_size(2);
+    size_t l3 = cpu_cache_size(3);
+
+    // A和B的微面板共同占用一半L1
+    size_t kc = (l1 / 2) / ((kernel->mr + kernel->nr) * sizeof(float));
+    kc &= ~(size_t)7;
+    if (kc < 64) kc = 64;
+    if (kc > 512) kc = 512;
+
+    // A块占用一半L2
+    size_t mc = (l2 / 2) / (kc * sizeof(float));
+    mc -= mc % kernel->mr;
+    if (mc < kernel->mr) mc = kernel->mr;
+    if (mc > 960) mc = 960 - 960 % kernel->mr;
+
+    // B块占用一半L3
+    size_t nc = (l3 / 2) / (kc * sizeof(float));
+    nc -= nc % kernel->nr;
+    if (nc < kernel->nr) nc = kernel->nr;
+    if (nc > 8192) nc = 8192 - 8192 % kernel->nr;
+
+    blocking->mc = mc;
+    blocking->kc = kc;
+    blocking->nc = nc;
+}
+
+void gemm_init(void) {
+    // 选择当前层级可用的最高级微内核
+    for (int tier = cpu_features_tier(); tier >= CPU_TIER_SCALAR; tier--) {
+        if (gemm_kernels[tier].kernel) {
+            g_kernel = gemm_kernels[tier];
+            break;
+        }
+    }
+    compute_blocking(&g_kernel, &g_blocking);
+}
+
+const GemmKernelInfo* gemm_get_kernel(void) {
+    return &g_kernel;
+}
+
+const GemmBlocking* gemm_get_blocking(void) {
+    return &g_blocking;
+}
+
+const GemmKernelInfo* gemm_kernel_for_tier(int tier) {
+    if (tier < CPU_TIER_SCALAR || tier >= CPU_TIER_COUNT) return NULL;
+    if (tier > (int)cpu_features_tier()) return NULL;
+    return gemm_kernels[tier].kernel ? &gemm_kernels[tier] : NULL;
+}
+
+// 按配置确定微内核和分块，分块参数对齐到微内核尺寸
+static const GemmKernelInfo* resolve_config(const GemmConfig* config, GemmBlocking* blocking) {
+    const GemmKernelInfo* kernel = &g_kernel;
+    *blocking = g_blocking;
+    if (!config) return kernel;
+
+    const GemmKernelInfo* tuned = gemm_kernel_for_tier(config->kernel_tier);
+    if (tuned && tuned->kernel != kernel->kernel) {
+        kernel = tuned;
+        compute_blocking(kernel, blocking);
+    }
+
+    if (config->blocking.kc) blocking->kc = config->blocking.kc;
+    if (config->blocking.mc) {
+        blocking->mc = config->blocking.mc - config->blocking.mc % kernel->mr;
+        if (blocking->mc < kernel->mr) blocking->mc = kernel->mr;
+    }
+    if (config->blocking.nc) {
+        blocking->nc = config->blocking.nc - config->blocking.nc % kernel->nr;
+        if (blocking->nc < kernel->nr) blocking->nc = kernel->nr;
+    }
+    return kernel;
+}
+
+static int compare_shape(size_t m, size_t n, size_t k, const GemmTuningEntry* e) {
+    if (m != e->m) return m < e->m ? -1 : 1;
+    if (n != e->n) return n < e->n ? -1 : 1;
+    if (k != e->k) return k < e->k ? -1 : 1;
+    return 0;
+}
+
+// 二分查找：命中时返回1，否则返回0；*pos为命中位置或插入位置
+static int table_search(const GemmTuningTable* table, size_t m, size_t n, size_t k, size_t* pos) {
+    size_t lo = 0;
+    size_t hi = table ? table->count : 0;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = compare_shape(m, n, k, &table->entries[mid]);
+        if (cmp == 0) {
+            *pos = mid;
+            return 1;
+        }
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    *pos = lo;
+    return 0;
+}
+
+size_t gemm_tuning_set_many(const GemmTuningEntry* entries, size_t count) {
+    if (!entries || count == 0) return 0;
+
+    pthread_mutex_lock(&g_tuning_lock);
+    GemmTuningTable* old = atomic_load_explicit(&g_tuning_table, memory_order_relaxed);
+    size_t old_count = old ? old->count : 0;
+    size_t capacity = old_count + count;
+    if (capacity > GEMM_TUNING_MAX) capacity = GEMM_TUNING_MAX;
+    GemmTuningTable* table = (GemmTuningTable*)malloc(sizeof(GemmTuningTable) +
+                                                      capacity * sizeof(GemmTuningEntry));
+    if (!table) {
+        pthread_mutex_unlock(&g_tuning_lock);
+        return 0;
+    }
+    table->retired = NULL;
+    table->count = old_count;
+    if (old_count) memcpy(table->entries, old->entries, old_count * sizeof(GemmTuningEntry));
+
+    // 逐条插入：已有形状原地更新，表满后的新形状丢弃
+    size_t stored = 0;
+    for (size_t i = 0; i < count; i++) {
+        const GemmTuningEntry* e = &entries[i];
+        size_t pos;
+        if (table_search(table, e->m, e->n, e->k, &pos)) {
+            table->entries[pos].config = e->config;
+        } else if (table->count < capacity) {
+            memmove(&table->entries[pos + 1], &table->entries[pos],
+                    (table->count - pos) * sizeof(GemmTuningEntry));
+            table->entries[pos] = *e;
+            table->count++;
+        } else {
+            continue;
+        }
+        stored++;
+    }
+
+    if (stored == 0) {
+        free(table);
+    } else {
+        atomic_store_explicit(&g_tuning_table, table, memory_order_release);
+        if (old) {
+            old->retired = g_tuning_retired;
+            g_tuning_retired = old;
+        }
+    }
+    pthread_mutex_unlock(&g_tuning_lock);
+    return stored;
+}
+
+int gemm_tuning_set(size_t m, size_t n, size_t k, const GemmConfig* config) {
+    if (!config) return -1;
+    GemmTuningEntry entry = { m, n, k, *config };
+    return gemm_tuning_set_many(&entry, 1) == 1 ? 0 : -1;
+}
+
+int gemm_tuning_find(size_t m, size_t n, size_t k, GemmConfig* config) {
+    const GemmTuningTable* table = atomic_load_explicit(&g_tuning_table, memory_order_acquire);
+    size_t pos;
+    if (!table_search(table, m, n, k, &pos)) return -1;
+    if (config) *config = table->entries[pos].config;
+    return 0;
+}
+
+size_t gemm_tuning_count(void) {
+    const GemmTuningTable* table = atomic_load_explicit(&g_tuning_table, memory_order_acquire);
+    return table ? table->count : 0;
+}
+
+int gemm_tuning_get(size_t index, size_t* m, size_t* n, size_t* k, GemmConfig* config) {
+    const GemmTuningTable* table = atomic_load_explicit(&g_tuning_table, memory_order_acquire);
+    if (!table || index >= table->count) return -1;
+    const GemmTuningEntry* e = &table->entries[index];
+    if (m) *m = e->m;
+    if (n) *n = e->n;
+    if (k) *k = e->k;
+    if (config) *config = e->config;
+    return 0;
+}
+
+size_t gemm_tuning_copy(GemmTuningEntry* entries, size_t max) {
+    const GemmTuningTable* table = atomic_load_explicit(&g_tuning_table, memory_order_acquire);
+    if (!table || !entries) return 0;
+    size_t count = table->count < max ? table->count : max;
+    memcpy(entries, table->entries, count * sizeof(GemmTuningEntry));
+    return count;
+}
+
+void gemm_tuning_clear(void) {
+    pthread_mutex_lock(&g_tuning_lock);
+    GemmTuningTable* table = atomic_exchange_explicit(&g_tuning_table, NULL, memory_order_acq_rel);
+    if (table) {
+        table->retired = g_tuning_retired;
+        g_tuning_retired = table;
+    }
+    while (g_tuning_retired) {
+        GemmTuningTable* next = g_tuning_retired->retired;
+        free(g_tuning_retired);
+        g_tuning_retired = next;
+    }
+    pthread_mutex_unlock(&g_tuning_lock);
+}
+
+// 打包A块: [mb x kb] -> 按MR行切分的微面板，每个面板布局为 [kb][MR]，尾部补零
+static void pack_a(size_t mb, size_t kb, const float* a, size_t lda,
+                   float* packed, size_t mr) {
+    for (size_t i = 0; i < mb; i += mr) {
+        size_t rows = (mb - i < mr) ? mb - i : mr;
+        for (size_t p = 0; p < kb; p++) {
+            size_t r = 0;
+            for (; r < rows; r++) {
+                packed[r] = a[(i + r) * lda + p];
+            }
+            for (; r < mr; r++) {
+                packed[r] = 0.0f;
+            }
+            packed += mr;
+        }
+    }
+}
+
+// 打包转置存储的A块（A按 [k x m] 存储）：每个p对应的MR个元素在内存中连续
+static void pack_a_t(size_t mb, size_t kb, const float* a, size_t lda,
+                     float* packed, size_t mr) {
+    for (size_t i = 0; i < mb; i += mr) {
+        size_t rows = (mb - i < mr) ? mb - i : mr;
+        for (size_t p = 0; p < kb; p++) {
+            memcpy(packed, a + p * lda + i, rows * sizeof(float));
+            if (rows < mr) {
+                memset(packed + rows, 0, (mr - rows) * sizeof(float));
+            }
+            packed += mr;
+        }
+    }
+}
+
+// 打包B块中 [j0, j1) 列范围: [kb x nb] -> 按NR列切分的微面板，每个面板布局为 [kb][NR]，尾部补零
+// j0必须是NR的整数倍
+static void pack_b(size_t kb, size_t nb, size_t j0, size_t j1,
+                   const float* b, size_t ldb, float* packed, size_t nr) {
+    if (j1 > nb) j1 = nb;
+    packed += j0 * kb;
+    for (size_t j = j0; j < j1; j += nr) {
+        size_t cols = (nb - j < nr) ? nb - j : nr;
+        for (size_t p = 0; p < kb; p++) {
+            const float* src = b + p * ldb + j;
+            memcpy(packed, src, cols * sizeof(float));
+            if (cols < nr) {
+                memset(packed + cols, 0, (nr - cols) * sizeof(float));
+            }
+            packed += nr;
+        }
+    }
+}
+
+// 打包转置存储的B块（B按 [n x k] 存储）：逐列连续读取kb个元素，按NR步长写入面板
+static void pack_b_t(size_t kb, size_t nb, size_t j0, size_t j1,
+                     const float* b, size_t ldb, float* packed, size_t nr) {
+    if (j1 > nb) j1 = nb;
+    packed += j0 * kb;
+    for (size_t j = j0; j < j1; j += nr) {
+        size_t cols = (nb - j < nr) ? nb - j : nr;
+        for (size_t c = 0; c < nr; c++) {
+            if (c < cols) {
+                const float* src = b + (j + c) * ldb;
+                for (size_t p = 0; p < kb; p++) {
+                    packed[p * nr + c] = src[p];
+                }
+            } else {
+                for (size_t p = 0; p < kb; p++) {
+                    packed[p * nr + c] = 0.0f;
+                }
+            }
+        }
+        packed += kb * nr;
+    }
+}
+
+// 打包fp16的B块：与pack_b布局相同，打包时转换为fp32（F16C每次8个元素）
+static void pack_b_f16(size_t kb, size_t nb, size_t j0, size_t j1,
+                       const uint16_t* b, size_t ldb, float* packed, size_t nr) {
+    if (j1 > nb) j1 = nb;
+    packed += j0 * kb;
+    for (size_t j = j0; j < j1; j += nr) {
+        size_t cols = (nb - j < nr) ? nb - j : nr;
+        for (size_t p = 0; p < kb; p++) {
+            fp16_to_float_array(packed, b + p * ldb + j, cols);
+            if (cols < nr) {
+                memset(packed + cols, 0, (nr - cols) * sizeof(float));
+            }
+            packed += nr;
+        }
+    }
+}
+
+// 并行计算时单个任务的最小浮点运算量，低于该值直接单线程执行
+#define GEMM_PARALLEL_MIN_FLOPS (1u << 20)
+
+// 一次 (jc, pc) 迭代中共享的计算参数
+typedef struct {
+    const GemmKernelInfo* kernel;
+    size_t m;                  // 总行数
+    size_t kb;                 // 当前K分块
+    size_t nb;                 // 当前N分块
+    const float* a;            // A在当前K分块的起点
+    size_t lda;
+    const float* b;            // B在当前 (pc, jc) 分块的起点
+    const uint16_t* b_f16;     // B为fp16时使用（与b二选一）
+    size_t ldb;
+    float* b_packed;           // 共享的B打包缓冲区
+    float* c;                  // C在当前N分块的起点
+    size_t ldc;
+    size_t mc;                 // A块行数
+    int accumulate;
+    int trans_a;               // A按 [k x m] 存储
+    int trans_b;               // B按 [n x k] 存储
+
+    // 任务划分：m_tasks x n_tasks 个二维任务
+    size_t rows_per_task;      // 每个任务的行数（MR的整数倍）
+    size_t cols_per_task;      // 每个任务的列数（NR的整数倍）
+    size_t n_tasks;
+    size_t pack_cols_per_task; // B打包任务的列数
+} GemmMacroArgs;
+
+// 宏内核：计算行 [i0, i1) 与列 [j0, j1) 的C块，A由当前线程打包
+static void gemm_macro_kernel(const GemmMacroArgs* args, size_t i0, size_t i1,
+                              size_t j0, size_t j1) {
+    const size_t mr = args->kernel->mr;
+    const size_t nr = args->kernel->nr;
+    const size_t kb = args->kb;
+
+    if (i1 > args->m) i1 = args->m;
+    if (j1 > args->nb) j1 = args->nb;
+    if (i0 >= i1 || j0 >= j1) return;
+
+    size_t mc_eff = args->mc;
+    if (i1 - i0 < mc_eff) mc_eff = ((i1 - i0 + mr - 1) / mr) * mr;
+    float* a_buf = (float*)thread_scratch(SCRATCH_GEMM_PACK_A, mc_eff * kb * sizeof(float));
+    if (!a_buf) return;
+
+    for (size_t ic = i0; ic < i1; ic += args->mc) {
+        size_t mb = (i1 - ic < args->mc) ? i1 - ic : args->mc;
+
+        if (args->trans_a) {
+            pack_a_t(mb, kb, args->a + ic, args->lda, a_buf, mr);
+        } else {
+            pack_a(mb, kb, args->a + ic * args->lda, args->lda, a_buf, mr);
+        }
+
+        for (size_t jr = j0; jr < j1; jr += nr) {
+            size_t cols = (j1 - jr < nr) ? j1 - jr : nr;
+            const float* b_panel = args->b_packed + jr * kb;
+
+            for (size_t ir = 0; ir < mb; ir += mr) {
+                size_t rows = (mb - ir < mr) ? mb - ir : mr;
+                args->kernel->kernel(kb, a_buf + ir * kb, b_panel,
+                                     args->c + (ic + ir) * args->ldc + jr, args->ldc,
+                                     rows, cols, args->accumulate);
+            }
+        }
+    }
+}
+
+static void gemm_pack_b_task(void* arg, size_t task_idx, size_t thread_idx) {
+    const GemmMacroArgs* args = (const GemmMacroArgs*)arg;
+    (void)thread_idx;
+    size_t j0 = task_idx * args->pack_cols_per_task;
+    if (args->b_f16) {
+        pack_b_f16(args->kb, args->nb, j0, j0 + args->pack_cols_per_task,
+                   args->b_f16, args->ldb, args->b_packed, args->kernel->nr);
+        return;
+    }
+    if (args->trans_b) {
+        pack_b_t(args->kb, args->nb, j0, j0 + args->pack_cols_per_task,
+                 args->b, args->ldb, args->b_packed, args->kernel->nr);
+        return;
+    }
+    pack_b(args->kb, args->nb, j0, j0 + args->pack_cols_per_task,
+           args->b, args->ldb, args->b_packed, args->kernel->nr);
+}
+
+static void gemm_macro_task(void* arg, size_t task_idx, size_t thread_idx) {
+    const GemmMacroArgs* args = (const GemmMacroArgs*)arg;
+    (void)thread_idx;
+    size_t mi = task_idx / args->n_tasks;
+    size_t ni = task_idx % args->n_tasks;
+    size_t i0 = mi * args->rows_per_task;
+    size_t j0 = ni * args->cols_per_task;
+    gemm_macro_kernel(args, i0, i0 + args->rows_per_task, j0, j0 + args->cols_per_task);
+}
+
+static size_t div_round_up(size_t a, size_t b) {
+    return (a + b - 1) / b;
+}
+
+// B为fp32或fp16（b与b_f16二选一），其余流程相同；fp16的B不支持转置
+// config为NULL时查询形状调优表，未命中则使用默认微内核和分块
+// accumulate非0时结果累加到C（C += op(A) * op(B)）
+static void gemm_driver(ThreadPool* pool, const GemmConfig* config,
+                        int trans_a, int trans_b,
+                        size_t m, size_t n, size_t k,
+                        const float* a, size_t lda,
+                        const float* b, const uint16_t* b_f16, size_t ldb,
+                        float* c, size_t ldc, int accumulate) {
+    if (m == 0 || n == 0) return;
+
+    if (k == 0) {
+        if (accumulate) return;
+        for (size_t i = 0; i < m; i++) {
+            memset(c + i * ldc, 0, n * sizeof(float));
+        }
+        return;
+    }
+
+    if (g_blocking.kc == 0) {
+        gemm_init();
+    }
+
+    GemmConfig tuned;
+    if (!config && gemm_tuning_find(m, n, k, &tuned) == 0) config = &tuned;
+
+    GemmBlocking blocking;
+    const GemmKernelInfo* kernel = resolve_config(config, &blocking);
+    const size_t mr = kernel->mr;
+    const size_t nr = kernel->nr;
+    const size_t kc = blocking.kc;
+    const size_t nc = blocking.nc;
+
+    // 线程数：按总计算量限制，避免小矩阵的调度开销；调优配置可进一步限制
+    size_t num_threads = thread_pool_size(pool);
+    double flops = 2.0 * (double)m * (double)n * (double)k;
+    size_t max_useful = (size_t)(flops / GEMM_PARALLEL_MIN_FLOPS) + 1;
+    if (num_threads > max_useful) num_threads = max_useful;
+    if (config && config->threads && num_threads > config->threads) num_threads = config->threads;
+
+    size_t nc_eff = (n < nc) ? div_round_up(n, nr) * nr : nc;
+    size_t kc_eff = (k < kc) ? k : kc;
+    float* b_buf = (float*)thread_scratch(SCRATCH_GEMM_PACK_B, kc_eff * nc_eff * sizeof(float));
+    if (!b_buf) return;
+
+    GemmMacroArgs args;
+    args.kernel = kernel;
+    args.m = m;
+    args.lda = lda;
+    args.ldb = ldb;
+    args.b_packed = b_buf;
+    args.ldc = ldc;
+    args.trans_a = trans_a;
+    args.trans_b = trans_b;
+
+    for (size_t jc = 0; jc < n; jc += nc) {
+        size_t nb = (n - jc < nc) ? n - jc : nc;
+        size_t n_panels = div_round_up(nb, nr);
+        size_t m_panels = div_round_up(m, mr);
+
+        // 任务划分：优先按M切分（各线程打包各自的A块），M不足时再按N切分
+        size_t m_tasks = (m_panels < num_threads) ? m_panels : num_threads;
+        size_t n_tasks = div_round_up(num_threads, m_tasks);
+        if (n_tasks > n_panels) n_tasks = n_panels;
+
+        args.rows_per_task = div_round_up(m_panels, m_tasks) * mr;
+        args.cols_per_task = div_round_up(n_panels, n_tasks) * nr;
+        args.n_tasks = div_round_up(nb, args.cols_per_task);
+        m_tasks = div_round_up(m, args.rows_per_task);
+
+        // 单个任务内的A块不超过mc
+        args.mc = blocking.mc;
+        if (args.rows_per_task < args.mc) args.mc = args.rows_per_task;
+
+        size_t pack_tasks = (n_panels < num_threads) ? n_panels : num_threads;
+        args.pack_cols_per_task = div_round_up(n_panels, pack_tasks) * nr;
+        pack_tasks = div_round_up(nb, args.pack_cols_per_task);
+
+        args.nb = nb;
+        args.c = c + jc;
+
+        for (size_t pc = 0; pc < k; pc += kc) {
+            args.kb = (k - pc < kc) ? k - pc : kc;
+            args.accumulate = (pc != 0) || accumulate;
+            args.a = trans_a ? a + pc * lda : a + pc;
+            if (!b) {
+                args.b = NULL;
+            } else {
+                args.b = trans_b ? b + jc * ldb + pc : b + pc * ldb + jc;
+            }
+            args.b_f16 = b_f16 ? b_f16 + pc * ldb + jc : NULL;
+
+            thread_pool_parallel_for(pool, pack_tasks, gemm_pack_b_task, &args);
+            thread_pool_parallel_for(pool, m_tasks * args.n_tasks, gemm_macro_task, &args);
+        }
+    }
+}
+
+void gemm_sgemm(ThreadPool* pool, size_t m, size_t n, size_t k,
+                const float* a, size_t lda,
+                const float* b, size_t ldb,
+                float* c, size_t ldc) {
+    gemm_driver(pool, NULL, 0, 0, m, n, k, a, lda, b, NULL, ldb, c, ldc, 0);
+}
+
+void gemm_sgemm_config(ThreadPool* pool, const GemmConfig* config,
+                       size_t m, size_t n, size_t k,
+                       const float* a, size_t lda,
+                       const float* b, size_t ldb,
+                       float* c, size_t ldc) {
+    gemm_driver(pool, config, 0, 0, m, n, k, a, lda, b, NULL, ldb, c, ldc, 0);
+}
+
+void gemm_sgemm_f16(ThreadPool* pool, size_t m, size_t n, size_t k,
+                    const float* a, size_t lda,
+                    const uint16_t* b, size_t ldb,
+                    float* c, size_t ldc) {
+    gemm_driver(pool, NULL, 0, 0, m, n, k, a, lda, NULL, b, ldb, c, ldc, 0);
+}
+
+// 单个矩阵乘：m很小时走GEMV路径（注意力解码阶段每个头只有一行查询）
+// GEMV路径只支持覆盖C，累加时统一走分块路径
+static void gemm_single(ThreadPool* pool, int trans_a, int trans_b,
+                        size_t m, size_t n, size_t k,
+                        const float* a, size_t lda,
+                        const float* b, size_t ldb,
+                        float* c, size_t ldc, int accumulate) {
+    if (!accumulate && !trans_a && !trans_b && m <= GEMV_MAX_M) {
+        gemv_small_m(pool, m, n, k, a, lda, b, ldb, c, ldc);
+        return;
+    }
+    if (!accumulate && !trans_a && trans_b && m == 1) {
+        // q * K^T：即 K[n x k] * q
+        gemv_sgemv(pool, n, k, b, ldb, a, c);
+        return;
+    }
+    gemm_driver(pool, NULL, trans_a, trans_b, m, n, k, a, lda, b, NULL, ldb, c, ldc, accumulate);
+}
+
+void gemm_sgemm_ex(ThreadPool* pool, int trans_a, int trans_b,
+                   size_t m, size_t n, size_t k,
+                   const float* a, size_t lda,
+                   const float* b, size_t ldb,
+                   float* c, size_t ldc, int accumulate) {
+    gemm_single(pool, trans_a, trans_b, m, n, k, a, lda, b, ldb, c, ldc, accumulate);
+}
+
+// 单个矩阵计算量低于该值时按batch维度并行，每个任务串行计算若干个矩阵
+#define GEMM_BATCH_MIN_FLOPS (1u << 24)
+
+typedef struct {
+    int trans_a;
+    int trans_b;
+    size_t m, n, k;
+    const float* a;
+    size_t lda;
+    size_t stride_a;
+    const float* b;
+    size_t ldb;
+    size_t stride_b;
+    float* c;
+    size_t ldc;
+    size_t stride_c;
+    size_t batch;
+    size_t batch_per_task;
+} GemmBatchArgs;
+
+static void gemm_batch_task(void* arg, size_t task_idx, size_t thread_idx) {
+    const GemmBatchArgs* args = (const GemmBatchArgs*)arg;
+    (void)thread_idx;
+    size_t b0 = task_idx * args->batch_per_task;
+    size_t b1 = b0 + args->batch_per_task;
+    if (b1 > args->batch) b1 = args->batch;
+
+    for (size_t i = b0; i < b1; i++) {
+        gemm_single(NULL, args->trans_a, args->trans_b, args->m, args->n, args->k,
+                    args->a + i * args->stride_a, args->lda,
+                    args->b + i * args->stride_b, args->ldb,
+                    args->c + i * args->stride_c, args->ldc, 0);
+    }
+}
+
+void gemm_sgemm_batched(ThreadPool* pool, int trans_a, int trans_b,
+                        size_t m, size_t n, size_t k,
+                        const float* a, size_t lda, size_t stride_a,
+                        const float* b, size_t ldb, size_t stride_b,
+                        float* c, size_t ldc, size_t stride_c,
+                        size_t batch) {
+    if (batch == 0 || m == 0 || n == 0) return;
+
+    if (g_blocking.kc == 0) {
+        gemm_init();
+    }
+
+    size_t num_threads = thread_pool_size(pool);
+    double flops = 2.0 * (double)m * (double)n * (double)k;
+
+    // 大矩阵：逐个计算，每个矩阵内部按M/N并行
+    if (num_threads == 1 || batch == 1 || flops >= GEMM_BATCH_MIN_FLOPS) {
+        for (size_t i = 0; i < batch; i++) {
+            gemm_single(pool, trans_a, trans_b, m, n, k,
+                        a + i * stride_a, lda, b + i * stride_b, ldb,
+                        c + i * stride_c, ldc, 0);
+        }
+        return;
+    }
+
+    // 小矩阵（多头注意力）：按batch切分，每个线程使用各自的打包缓冲区
+    GemmBatchArgs args;
+    args.trans_a = trans_a;
+    args.trans_b = trans_b;
+    args.m = m;
+    args.n = n;
+    args.k = k;
+    args.a = a;
+    args.lda = lda;
+    args.stride_a = stride_a;
+    args.b = b;
+    args.ldb = ldb;
+    args.stride_b = stride_b;
+    args.c = c;
+    args.ldc = ldc;
+    args.stride_c = stride_c;
+    args.batch = batch;
+
+    size_t tasks = (batch < num_threads) ? batch : num_threads;
+    args.batch_per_task = div_round_up(batch, tasks);
+    thread_pool_parallel_for(pool, div_round_up(batch, args.batch_per_task),
+                             gemm_batch_task, &args);
+}
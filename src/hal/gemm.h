@@ -0,0 +1,107 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "thread_pool.h"
+
+// 微内核：计算 MR x NR 的C块
+// a_panel: 打包后的A微面板 [kc][MR]
+// b_panel: 打包后的B微面板 [kc][NR]
+// mr/nr: 实际有效的行列数（尾部块小于MR/NR）
+// accumulate: 0表示覆盖C，非0表示累加到C
+typedef void (*GemmMicroKernel)(size_t kc, const float* a_panel, const float* b_panel,
+                                float* c, size_t ldc, size_t mr, size_t nr,
+                                int accumulate);
+
+// 微内核描述
+typedef struct {
+    GemmMicroKernel kernel;
+    size_t mr;                 // 微内核行数
+    size_t nr;                 // 微内核列数
+    const char* name;
+} GemmKernelInfo;
+
+// 分块参数
+typedef struct {
+    size_t mc;                 // A块行数（驻留L2）
+    size_t kc;                 // K方向分块（微面板驻留L1）
+    size_t nc;                 // B块列数（驻留L3）
+} GemmBlocking;
+
+// 调优配置
+typedef struct {
+    int kernel_tier;           // 微内核所属层级（CpuTier），不可用时使用默认微内核
+    GemmBlocking blocking;     // 为0的字段使用默认值，mc/nc向下对齐到微内核尺寸
+    size_t threads;            // 线程数上限，0表示按计算量自动选择
+} GemmConfig;
+
+// 形状调优表容量
+#define GEMM_TUNING_MAX 256
+
+// 调优表条目
+typedef struct {
+    size_t m, n, k;
+    GemmConfig config;
+} GemmTuningEntry;
+
+// 初始化GEMM（选择微内核并根据缓存大小计算分块参数）
+void gemm_init(void);
+
+// 获取当前使用的微内核和分块参数
+const GemmKernelInfo* gemm_get_kernel(void);
+const GemmBlocking* gemm_get_blocking(void);
+
+// 某层级的微内核，未编译或超出当前层级时返回NULL
+const GemmKernelInfo* gemm_kernel_for_tier(int tier);
+
+// 形状调优表：gemm_sgemm/gemm_sgemm_f16/gemm_sgemm_batched按 (m, n, k) 精确匹配
+// 命中时使用表中的配置（小M走GEMV路径的形状不受影响）
+// 查询无锁；更新发布新的快照，旧快照保留到gemm_tuning_clear（调用时不得有并发查询）
+int gemm_tuning_set(size_t m, size_t n, size_t k, const GemmConfig* config);
+size_t gemm_tuning_set_many(const GemmTuningEntry* entries, size_t count);   // 返回写入的条目数
+int gemm_tuning_find(size_t m, size_t n, size_t k, GemmConfig* config);   // 未命中返回-1
+size_t gemm_tuning_count(void);
+int gemm_tuning_get(size_t index, size_t* m, size_t* n, size_t* k, GemmConfig* config);
+size_t gemm_tuning_copy(GemmTuningEntry* entries, size_t max);   // 复制同一快照中的条目，返回条目数
+void gemm_tuning_clear(void);
+
+// 单精度行主序GEMM: C[m x n] = A[m x k] * B[k x n]
+// pool不为NULL时按M/N切分到线程池并行计算
+void gemm_sgemm(ThreadPool* pool, size_t m, size_t n, size_t k,
+                const float* a, size_t lda,
+                const float* b, size_t ldb,
+                float* c, size_t ldc);
+
+// 使用指定配置计算（不查询调优表，供自动调优计时）
+void gemm_sgemm_config(ThreadPool* pool, const GemmConfig* config,
+                       size_t m, size_t n, size_t k,
+                       const float* a, size_t lda,
+                       const float* b, size_t ldb,
+                       float* c, size_t ldc);
+
+// B为fp16权重的GEMM：打包B时用F16C转换为fp32，累加仍为fp32
+void gemm_sgemm_f16(ThreadPool* pool, size_t m, size_t n, size_t k,
+                    const float* a, size_t lda,
+                    const uint16_t* b, size_t ldb,
+                    float* c, size_t ldc);
+
+// 单个矩阵的通用GEMM: C[m x n] = op(A) * op(B)，accumulate非0时 C += op(A) * op(B)
+// 转置约定同gemm_sgemm_batched，用于 Q*K^T (NT)、反向传播的 X^T*dY (TN) 和 dY*W^T (NT)
+void gemm_sgemm_ex(ThreadPool* pool, int trans_a, int trans_b,
+                   size_t m, size_t n, size_t k,
+                   const float* a, size_t lda,
+                   const float* b, size_t ldb,
+                   float* c, size_t ldc, int accumulate);
+
+// 跨步批量GEMM: C_i = op(A_i) * op(B_i)，i = 0..batch-1，X_i = X + i * stride_x
+// trans_a非0时A_i按 [k x m] 存储，trans_b非0时B_i按 [n x k] 存储，打包时直接读取无需显式转置
+// 单个矩阵较小时按batch维度切分到线程池，否则逐个计算并在矩阵内部并行
+void gemm_sgemm_batched(ThreadPool* pool, int trans_a, int trans_b,
+                        size_t m, size_t n, size_t k,
+                        const float* a, size_t lda, size_t stride_a,
+                        const float* b, size_t ldb, size_t stride_b,
+                        float* c, size_t ldc, size_t stride_c,
+                        size_t batch);
+
+#endif // GEMM_H
@@ -0,0 +1,313 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "gemm_tune.h"
+#include "cpu_features.h"
+#include "hal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 每个候选至少运行TUNE_MIN_REPS次，累计不少于TUNE_MIN_TIME_NS，取最短耗时
+#define TUNE_MIN_REPS 2
+#define TUNE_MAX_REPS 10
+#define TUNE_MIN_TIME_NS 20000000ull
+
+#define TUNE_FILE_HEADER "# LowMemoryLLM GEMM tuning v1"
+
+// 候选值（mc/nc会向下对齐到微内核尺寸）
+static const size_t g_kc_candidates[] = { 64, 128, 192, 256, 320, 384, 512 };
+static const size_t g_mc_blocks[] = { 4, 8, 16, 24, 32, 48, 80 };   // mc = mr * blocks
+static const size_t g_nc_candidates[] = { 256, 512, 1024, 2048, 4096, 8192 };
+
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
+
+typedef struct {
+    ThreadPool* pool;
+    size_t m, n, k;
+    float* a;
+    float* b;
+    float* c;
+} TuneProblem;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void fill_random(float* p, size_t count, uint32_t seed) {
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        p[i] = (float)(seed >> 8) / (float)(1u << 24) - 0.5f;
+    }
+}
+
+// 单次计算的最短耗时（纳秒）
+static uint64_t time_config(const TuneProblem* prob, const GemmConfig* config) {
+    // 预热：打包缓冲区分配、缓存状态
+    gemm_sgemm_config(prob->pool, config, prob->m, prob->n, prob->k,
+                      prob->a, prob->k, prob->b, prob->n, prob->c, prob->n);
+
+    uint64_t best = UINT64_MAX;
+    uint64_t total = 0;
+    for (int rep = 0; rep < TUNE_MAX_REPS; rep++) {
+        uint64_t t0 = now_ns();
+        gemm_sgemm_config(prob->pool, config, prob->m, prob->n, prob->k,
+                          prob->a, prob->k, prob->b, prob->n, prob->c, prob->n);
+        uint64_t dt = now_ns() - t0;
+        if (dt < best) best = dt;
+        total += dt;
+        if (rep + 1 >= TUNE_MIN_REPS && total >= TUNE_MIN_TIME_NS) break;
+    }
+    return best;
+}
+
+// 候选优于当前最优时替换
+static void try_config(const TuneProblem* prob, const GemmConfig* cand,
+                       GemmConfig* best, uint64_t* best_ns) {
+    uint64_t ns = time_config(prob, cand);
+    if (ns < *best_ns) {
+        *best = *cand;
+        *best_ns = ns;
+    }
+}
+
+static const GemmKernelInfo* config_kernel(const GemmConfig* config) {
+    const GemmKernelInfo* kernel = gemm_kernel_for_tier(config->kernel_tier);
+    return kernel ? kernel : gemm_get_kernel();
+}
+
+int gemm_autotune(ThreadPool* pool, size_t m, size_t n, size_t k,
+                  GemmConfig* best, double* gflops) {
+    if (m == 0 || n == 0 || k == 0) return -1;
+
+    TuneProblem prob = { pool, m, n, k, NULL, NULL, NULL };
+    prob.a = (float*)malloc(m * k * sizeof(float));
+    prob.b = (float*)malloc(k * n * sizeof(float));
+    prob.c = (float*)malloc(m * n * sizeof(float));
+    if (!prob.a || !prob.b || !prob.c) {
+        free(prob.a);
+        free(prob.b);
+        free(prob.c);
+        return -1;
+    }
+    fill_random(prob.a, m * k, 1);
+    fill_random(prob.b, k * n, 2);
+
+    // 起点：默认微内核和分块
+    if (gemm_get_blocking()->kc == 0) gemm_init();
+    GemmConfig cur;
+    memset(&cur, 0, sizeof(cur));
+    cur.kernel_tier = -1;
+    for (int tier = cpu_features_tier(); tier >= CPU_TIER_SCALAR; tier--) {
+        const GemmKernelInfo* kernel = gemm_kernel_for_tier(tier);
+        if (kernel && kernel->kernel == gemm_get_kernel()->kernel) {
+            cur.kernel_tier = tier;
+            break;
+        }
+    }
+    uint64_t cur_ns = time_config(&prob, &cur);
+
+    // 微内核（同一内核在多个层级共用时只测一次）
+    GemmMicroKernel tried[CPU_TIER_COUNT];
+    size_t num_tried = 0;
+    tried[num_tried++] = config_kernel(&cur)->kernel;
+    for (int tier = CPU_TIER_SCALAR; tier < CPU_TIER_COUNT; tier++) {
+        const GemmKernelInfo* kernel = gemm_kernel_for_tier(tier);
+        if (!kernel) continue;
+        int seen = 0;
+        for (size_t i = 0; i < num_tried; i++) {
+            if (tried[i] == kernel->kernel) seen = 1;
+        }
+        if (seen) continue;
+        tried[num_tried++] = kernel->kernel;
+
+        GemmConfig cand = cur;
+        cand.kernel_tier = tier;
+        try_config(&prob, &cand, &cur, &cur_ns);
+    }
+
+    // kc：不小于k的候选结果相同，只测第一个
+    for (size_t i = 0; i < ARRAY_SIZE(g_kc_candidates); i++) {
+        GemmConfig cand = cur;
+        cand.blocking.kc = g_kc_candidates[i];
+        try_config(&prob, &cand, &cur, &cur_ns);
+        if (g_kc_candidates[i] >= k) break;
+    }
+
+    // mc
+    size_t mr = config_kernel(&cur)->mr;
+    for (size_t i = 0; i < ARRAY_SIZE(g_mc_blocks); i++) {
+        GemmConfig cand = cur;
+        cand.blocking.mc = mr * g_mc_blocks[i];
+        try_config(&prob, &cand, &cur, &cur_ns);
+        if (cand.blocking.mc >= m) break;
+    }
+
+    // nc
+    for (size_t i = 0; i < ARRAY_SIZE(g_nc_candidates); i++) {
+        GemmConfig cand = cur;
+        cand.blocking.nc = g_nc_candidates[i];
+        try_config(&prob, &cand, &cur, &cur_ns);
+        if (g_nc_candidates[i] >= n) break;
+    }
+
+    // 线程数：2的幂次直到线程池大小（0即全部线程）
+    size_t pool_threads = thread_pool_size(pool);
+    for (size_t threads = 1; threads < pool_threads; threads *= 2) {
+        GemmConfig cand = cur;
+        cand.threads = threads;
+        try_config(&prob, &cand, &cur, &cur_ns);
+    }
+
+    free(prob.a);
+    free(prob.b);
+    free(prob.c);
+
+    if (gemm_tuning_set(m, n, k, &cur) != 0) return -1;
+    if (best) *best = cur;
+    if (gflops) *gflops = 2.0 * (double)m * (double)n * (double)k / (double)cur_ns;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// 调优文件
+// ---------------------------------------------------------------------------
+
+// 去掉首尾空白后复制
+static void copy_trimmed(char* dst, size_t size, const char* src) {
+    while (*src == ' ' || *src == '\t') src++;
+    size_t len = strlen(src);
+    while (len > 0 && (src[len - 1] == ' ' || src[len - 1] == '\t' ||
+                       src[len - 1] == '\n' || src[len - 1] == '\r')) {
+        len--;
+    }
+    if (len >= size) len = size - 1;
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+int gemm_tuning_default_path(char* buf, size_t size) {
+    if (!buf || size == 0) return -1;
+
+    const char* env = getenv(GEMM_TUNING_FILE_ENV);
+    if (env && *env) {
+        int len = snprintf(buf, size, "%s", env);
+        return len > 0 && (size_t)len < size ? 0 : -1;
+    }
+
+    char dir[512];
+    if (hal_cache_dir(dir, sizeof(dir)) != 0) return -1;
+
+    // 文件名由CPU型号和指令集层级组成，只保留字母数字
+    const CpuInfo* info = cpu_features_get();
+    char model[64];
+    copy_trimmed(model, sizeof(model), info->brand[0] ? info->brand : info->vendor);
+    if (!model[0]) snprintf(model, sizeof(model), "unknown");
+    for (char* p = model; *p; p++) {
+        char ch = *p;
+        int alnum = (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+        if (!alnum) *p = '_';
+    }
+
+    int len = snprintf(buf, size, "%s/gemm_%s_%s.tune", dir, model, cpu_tier_name(info->tier));
+    return len > 0 && (size_t)len < size ? 0 : -1;
+}
+
+int gemm_tuning_load(const char* path) {
+    if (!path) return -1;
+    FILE* fp = fopen(path, "r");
+    if (!fp) return -1;
+
+    const CpuInfo* info = cpu_features_get();
+    char brand[64];
+    copy_trimmed(brand, sizeof(brand), info->brand);
+
+    // 先解析全部条目，再一次性发布到调优表
+    GemmTuningEntry* entries = (GemmTuningEntry*)malloc(GEMM_TUNING_MAX * sizeof(GemmTuningEntry));
+    if (!entries) {
+        fclose(fp);
+        return -1;
+    }
+    size_t count = 0;
+    char line[256];
+    int cpu_ok = 0;
+    int tier_ok = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+
+        char value[128];
+        if (strncmp(line, "cpu ", 4) == 0) {
+            copy_trimmed(value, sizeof(value), line + 4);
+            cpu_ok = strcmp(value, brand) == 0;
+            continue;
+        }
+        if (strncmp(line, "tier ", 5) == 0) {
+            copy_trimmed(value, sizeof(value), line + 5);
+            tier_ok = strcmp(value, cpu_tier_name(info->tier)) == 0;
+            continue;
+        }
+
+        // 另一台机器（或降级到其他层级）的调优结果不适用
+        if (!cpu_ok || !tier_ok) break;
+
+        if (count >= GEMM_TUNING_MAX) break;
+        GemmTuningEntry* e = &entries[count];
+        memset(e, 0, sizeof(*e));
+        if (sscanf(line, "%zu %zu %zu %d %zu %zu %zu %zu", &e->m, &e->n, &e->k,
+                   &e->config.kernel_tier, &e->config.blocking.mc, &e->config.blocking.kc,
+                   &e->config.blocking.nc, &e->config.threads) != 8) {
+            continue;
+        }
+        if (!gemm_kernel_for_tier(e->config.kernel_tier)) continue;
+        count++;
+    }
+    fclose(fp);
+
+    int loaded = -1;
+    if (cpu_ok && tier_ok) loaded = (int)gemm_tuning_set_many(entries, count);
+    free(entries);
+    return loaded;
+}
+
+int gemm_tuning_save(const char* path) {
+    if (!path || hal_create_parent_dirs(path) != 0) return -1;
+
+    // 先写临时文件再改名，避免并发进程读到半个文件
+    char tmp[512];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) return -1;
+    GemmTuningEntry* entries = (GemmTuningEntry*)malloc(GEMM_TUNING_MAX * sizeof(GemmTuningEntry));
+    if (!entries) return -1;
+    size_t count = gemm_tuning_copy(entries, GEMM_TUNING_MAX);
+    FILE* fp = fopen(tmp, "w");
+    if (!fp) {
+        free(entries);
+        return -1;
+    }
+
+    const CpuInfo* info = cpu_features_get();
+    char brand[64];
+    copy_trimmed(brand, sizeof(brand), info->brand);
+
+    fprintf(fp, "%s\n", TUNE_FILE_HEADER);
+    fprintf(fp, "cpu %s\n", brand);
+    fprintf(fp, "tier %s\n", cpu_tier_name(info->tier));
+    fprintf(fp, "# m n k kernel_tier mc kc nc threads\n");
+
+    for (size_t i = 0; i < count; i++) {
+        const GemmTuningEntry* e = &entries[i];
+        fprintf(fp, "%zu %zu %zu %d %zu %zu %zu %zu\n", e->m, e->n, e->k, e->config.kernel_tier,
+                e->config.blocking.mc, e->config.blocking.kc, e->config.blocking.nc,
+                e->config.threads);
+    }
+    free(entries);
+
+    int ok = fflush(fp) == 0;
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+#ifndef GEMM_TUNE_H
+#define GEMM_TUNE_H
+
+#include <stddef.h>
+#include "gemm.h"
+#include "thread_pool.h"
+
+// 调优文件路径的环境变量（默认 $XDG_CACHE_HOME 或 ~/.cache 下的 lowmemory_llm/gemm_<CPU型号>.tune）
+#define GEMM_TUNING_FILE_ENV "LOWMEM_GEMM_TUNING"
+
+// 对形状 (m, n, k) 自动调优并写入调优表
+// 依次搜索微内核、kc、mc、nc和线程数（每一维固定其余参数取最快的候选）
+// best/gflops可为NULL，返回0成功
+int gemm_autotune(ThreadPool* pool, size_t m, size_t n, size_t k,
+                  GemmConfig* best, double* gflops);
+
+// 本机的调优文件路径，返回0成功
+int gemm_tuning_default_path(char* buf, size_t size);
+
+// 载入调优文件到调优表，返回载入的条目数
+// 文件不存在、格式错误或CPU型号/指令集层级与本机不一致时返回-1
+int gemm_tuning_load(const char* path);
+
+// 将调优表写入文件（按需创建目录），返回0成功
+int gemm_tuning_save(const char* path);
+
+#endif // GEMM_TUNE_H
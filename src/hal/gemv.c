@@ -0,0 +1,201 @@
+#include "gemv.h"
+#include "cpu_features.h"
+#include "fp16.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+// x86_64 内核（src/hal/x86_64/gemv_*.c）
+extern void gemv_rows_avx2(const float* a, size_t lda, const float* x,
+                           float* y, size_t rows, size_t n);
+extern void gemv_small_m_avx2(size_t m, size_t k, const float* a, size_t lda,
+                              const float* b, size_t ldb,
+                              float* c, size_t ldc, size_t ncols);
+extern void gemv_small_m_f16_f16c(size_t m, size_t k, const float* a, size_t lda,
+                                  const uint16_t* b, size_t ldb,
+                                  float* c, size_t ldc, size_t ncols);
+extern void gemv_rows_avx512(const float* a, size_t lda, const float* x,
+                             float* y, size_t rows, size_t n);
+extern void gemv_small_m_avx512(size_t m, size_t k, const float* a, size_t lda,
+                                const float* b, size_t ldb,
+                                float* c, size_t ldc, size_t ncols);
+#endif
+
+// 每个任务的最小输出规模（按列切分时为列数，按行切分时为行数）
+#define GEMV_MIN_COLS_PER_TASK 256
+#define GEMV_MIN_ROWS_PER_TASK 16
+
+// 按列切分时的对齐粒度（32个float = 两条缓存行，避免C上的伪共享）
+#define GEMV_COL_ALIGN 32
+
+// 标量实现
+static void gemv_rows_scalar(const float* a, size_t lda, const float* x,
+                             float* y, size_t rows, size_t n) {
+    for (size_t i = 0; i < rows; i++) {
+        const float* row = a + i * lda;
+        float sum = 0.0f;
+        for (size_t j = 0; j < n; j++) {
+            sum += row[j] * x[j];
+        }
+        y[i] = sum;
+    }
+}
+
+static void gemv_small_m_scalar(size_t m, size_t k, const float* a, size_t lda,
+                                const float* b, size_t ldb,
+                                float* c, size_t ldc, size_t ncols) {
+    for (size_t i = 0; i < m; i++) {
+        memset(c + i * ldc, 0, ncols * sizeof(float));
+    }
+    for (size_t l = 0; l < k; l++) {
+        const float* b_row = b + l * ldb;
+        for (size_t i = 0; i < m; i++) {
+            float av = a[i * lda + l];
+            float* c_row = c + i * ldc;
+            for (size_t j = 0; j < ncols; j++) {
+                c_row[j] += av * b_row[j];
+            }
+        }
+    }
+}
+
+static void gemv_small_m_f16_scalar(size_t m, size_t k, const float* a, size_t lda,
+                                    const uint16_t* b, size_t ldb,
+                                    float* c, size_t ldc, size_t ncols) {
+    for (size_t i = 0; i < m; i++) {
+        memset(c + i * ldc, 0, ncols * sizeof(float));
+    }
+    for (size_t l = 0; l < k; l++) {
+        const uint16_t* b_row = b + l * ldb;
+        for (size_t i = 0; i < m; i++) {
+            float av = a[i * lda + l];
+            float* c_row = c + i * ldc;
+            for (size_t j = 0; j < ncols; j++) {
+                c_row[j] += av * fp16_to_float(b_row[j]);
+            }
+        }
+    }
+}
+
+static GemvRowsKernel g_rows_kernel = gemv_rows_scalar;
+static GemvSmallMKernel g_small_m_kernel = gemv_small_m_scalar;
+static GemvSmallMF16Kernel g_small_m_f16_kernel = gemv_small_m_f16_scalar;
+
+void gemv_init(void) {
+    g_rows_kernel = gemv_rows_scalar;
+    g_small_m_kernel = gemv_small_m_scalar;
+    g_small_m_f16_kernel = gemv_small_m_f16_scalar;
+
+#if defined(__x86_64__) || defined(_M_X64)
+    CpuTier tier = cpu_features_tier();
+    if (tier >= CPU_TIER_AVX512) {
+        g_rows_kernel = gemv_rows_avx512;
+        g_small_m_kernel = gemv_small_m_avx512;
+    } else if (tier >= CPU_TIER_AVX2) {
+        g_rows_kernel = gemv_rows_avx2;
+        g_small_m_kernel = gemv_small_m_avx2;
+    }
+    if (tier >= CPU_TIER_AVX2 && cpu_has_feature(CPU_FEATURE_F16C)) {
+        g_small_m_f16_kernel = gemv_small_m_f16_f16c;
+    }
+#endif
+}
+
+static size_t div_round_up(size_t a, size_t b) {
+    return (a + b - 1) / b;
+}
+
+// 按行切分的GEMV任务参数
+typedef struct {
+    const float* a;
+    size_t lda;
+    const float* x;
+    float* y;
+    size_t m;
+    size_t n;
+    size_t rows_per_task;
+} GemvRowsArgs;
+
+static void gemv_rows_task(void* arg, size_t task_idx, size_t thread_idx) {
+    const GemvRowsArgs* args = (const GemvRowsArgs*)arg;
+    (void)thread_idx;
+    size_t i0 = task_idx * args->rows_per_task;
+    size_t rows = (args->m - i0 < args->rows_per_task) ? args->m - i0 : args->rows_per_task;
+    g_rows_kernel(args->a + i0 * args->lda, args->lda, args->x, args->y + i0, rows, args->n);
+}
+
+void gemv_sgemv(ThreadPool* pool, size_t m, size_t n,
+                const float* a, size_t lda, const float* x, float* y) {
+    if (m == 0) return;
+    if (n == 0) {
+        memset(y, 0, m * sizeof(float));
+        return;
+    }
+
+    size_t num_threads = thread_pool_size(pool);
+    size_t max_tasks = div_round_up(m, GEMV_MIN_ROWS_PER_TASK);
+    if (num_threads > max_tasks) num_threads = max_tasks;
+
+    GemvRowsArgs args = { a, lda, x, y, m, n, 0 };
+    args.rows_per_task = div_round_up(m, num_threads);
+    thread_pool_parallel_for(pool, div_round_up(m, args.rows_per_task), gemv_rows_task, &args);
+}
+
+// 按列切分的小M任务参数
+typedef struct {
+    size_t m;
+    size_t n;
+    size_t k;
+    const float* a;
+    size_t lda;
+    const float* b;
+    const uint16_t* b_f16;     // B为fp16时使用（与b二选一）
+    size_t ldb;
+    float* c;
+    size_t ldc;
+    size_t cols_per_task;
+} GemvSmallMArgs;
+
+static void gemv_small_m_task(void* arg, size_t task_idx, size_t thread_idx) {
+    const GemvSmallMArgs* args = (const GemvSmallMArgs*)arg;
+    (void)thread_idx;
+    size_t j0 = task_idx * args->cols_per_task;
+    size_t cols = (args->n - j0 < args->cols_per_task) ? args->n - j0 : args->cols_per_task;
+    if (args->b_f16) {
+        g_small_m_f16_kernel(args->m, args->k, args->a, args->lda, args->b_f16 + j0, args->ldb,
+                             args->c + j0, args->ldc, cols);
+        return;
+    }
+    g_small_m_kernel(args->m, args->k, args->a, args->lda, args->b + j0, args->ldb,
+                     args->c + j0, args->ldc, cols);
+}
+
+// B为fp32或fp16（b与b_f16二选一）
+static void gemv_small_m_driver(ThreadPool* pool, size_t m, size_t n, size_t k,
+                                const float* a, size_t lda,
+                                const float* b, const uint16_t* b_f16, size_t ldb,
+                                float* c, size_t ldc) {
+    if (m == 0 || n == 0) return;
+    if (m > GEMV_MAX_M) return;
+
+    size_t num_threads = thread_pool_size(pool);
+    size_t max_tasks = div_round_up(n, GEMV_MIN_COLS_PER_TASK);
+    if (num_threads > max_tasks) num_threads = max_tasks;
+
+    GemvSmallMArgs args = { m, n, k, a, lda, b, b_f16, ldb, c, ldc, 0 };
+    args.cols_per_task = div_round_up(div_round_up(n, num_threads), GEMV_COL_ALIGN) * GEMV_COL_ALIGN;
+    thread_pool_parallel_for(pool, div_round_up(n, args.cols_per_task), gemv_small_m_task, &args);
+}
+
+void gemv_small_m(ThreadPool* pool, size_t m, size_t n, size_t k,
+                  const float* a, size_t lda,
+                  const float* b, size_t ldb,
+                  float* c, size_t ldc) {
+    gemv_small_m_driver(pool, m, n, k, a, lda, b, NULL, ldb, c, ldc);
+}
+
+void gemv_small_m_f16(ThreadPool* pool, size_t m, size_t n, size_t k,
+                      const float* a, size_t lda,
+                      const uint16_t* b, size_t ldb,
+                      float* c, size_t ldc) {
+    gemv_small_m_driver(pool, m, n, k, a, lda, NULL, b, ldb, c, ldc);
+}
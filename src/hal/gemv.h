@@ -0,0 +1,45 @@
+#ifndef GEMV_H
+#define GEMV_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "thread_pool.h"
+
+// matrix_multiply在 m <= GEMV_MAX_M 时走流式小M路径
+#define GEMV_MAX_M 4
+
+// 按行点积的GEMV内核: y[i] = dot(A[i, 0:n], x)，共rows行
+typedef void (*GemvRowsKernel)(const float* a, size_t lda, const float* x,
+                               float* y, size_t rows, size_t n);
+
+// 小M流式内核: C[m x ncols] = A[m x k] * B[k x ncols]，m <= GEMV_MAX_M
+// B按行顺序流式读取一遍，每个元素只从内存读取一次
+typedef void (*GemvSmallMKernel)(size_t m, size_t k, const float* a, size_t lda,
+                                 const float* b, size_t ldb,
+                                 float* c, size_t ldc, size_t ncols);
+
+// 小M流式内核（B为fp16权重，读取时转换为fp32）
+typedef void (*GemvSmallMF16Kernel)(size_t m, size_t k, const float* a, size_t lda,
+                                    const uint16_t* b, size_t ldb,
+                                    float* c, size_t ldc, size_t ncols);
+
+// 初始化（按指令集层级选择内核）
+void gemv_init(void);
+
+// y[m] = A[m x n] * x[n]，A为行主序，按输出行切分到线程池
+void gemv_sgemv(ThreadPool* pool, size_t m, size_t n,
+                const float* a, size_t lda, const float* x, float* y);
+
+// C[m x n] = A[m x k] * B[k x n]，m <= GEMV_MAX_M，按输出列切分到线程池
+void gemv_small_m(ThreadPool* pool, size_t m, size_t n, size_t k,
+                  const float* a, size_t lda,
+                  const float* b, size_t ldb,
+                  float* c, size_t ldc);
+
+// 同上，B为fp16权重
+void gemv_small_m_f16(ThreadPool* pool, size_t m, size_t n, size_t k,
+                      const float* a, size_t lda,
+                      const uint16_t* b, size_t ldb,
+                      float* c, size_t ldc);
+
+#endif // GEMV_H
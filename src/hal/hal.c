@@ -1,23 +1,113 @@
 #include "hal.h"
+#include "gemm.h"
+#include "gemm_tune.h"
+#include "gemv.h"
+#include "qgemm.h"
+#include "qgemv.h"
+#include "ops.h"
+#include "attention.h"
+#include "stream.h"
+#include "mem_pool.h"
+#include "numa_topology.h"
+#include "page_map.h"
+#include "hal_profile.h"
+#include "cpu_features.h"
+#include "thread_pool.h"
+#include "thread_scratch.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#endif
 
 // CPU设备实现声明
-extern void matrix_multiply_asm(const float* a, const float* b, float* c, 
-                              size_t m, size_t n, size_t k);
+#if defined(__x86_64__) || defined(_M_X64)
+extern void vector_add_sse42(const float* a, const float* b, float* c, size_t size);
+extern void vector_add_avx2(const float* a, const float* b, float* c, size_t size);
+extern void vector_add_avx512(const float* a, const float* b, float* c, size_t size);
+#elif defined(__aarch64__)
 extern void vector_add_asm(const float* a, const float* b, float* c, size_t size);
+#endif
+
+// CPU内核分发表（hal_init时按指令集层级填充）
+typedef struct {
+    void (*vector_add)(const float* a, const float* b, float* c, size_t size);
+} CpuKernelTable;
+
+static CpuKernelTable g_cpu_kernels;
+
+// CPU设备运行时上下文（保存在device_specific_data中）
+typedef struct {
+    ThreadPool* pool;          // 持久化工作线程池
+    int numa_node;             // 绑定的NUMA节点（-1表示不限）
+    int autotune;              // 未调优的形状在第一次出现时交给后台调优
+    Stream* tune_stream;       // 后台调优流（按提交顺序逐个搜索）
+    ThreadPool* tune_pool;     // 后台调优专用线程池，不与计算争用设备线程池
+    atomic_int tune_stop;      // 设备释放时置位，尚未开始的调优直接跳过
+} CpuDeviceContext;
+
+static CpuDeviceContext* g_cpu_ctx = NULL;
+
+// vector_add 并行切分的最小元素数和分块粒度
+#define VECTOR_PARALLEL_MIN_SIZE (1u << 16)
+#define VECTOR_CHUNK_ALIGN 1024
 
 // 静态设备列表
-static HAL_Device* devices = NULL;
+static HAL_Device** devices = NULL;
 static int num_devices = 0;
 
 // CPU设备内存管理实现
+// 按尺寸级别池化，64字节对齐，释放的块由线程本地缓存和全局空闲链表复用
+// 设备绑定NUMA节点时，大块分配放在该节点上
 static void* cpu_allocate_memory(size_t size) {
-    return aligned_alloc(32, size); // 32字节对齐以支持AVX/NEON
+    if (g_cpu_ctx && g_cpu_ctx->numa_node >= 0) {
+        return mem_pool_alloc_mapped(size, g_cpu_ctx->numa_node, 0);
+    }
+    return mem_pool_alloc(size);
+}
+
+static void* cpu_allocate_memory_on_node(size_t size, int node) {
+    return mem_pool_alloc_mapped(size, node, 0);
+}
+
+static void* cpu_allocate_interleaved(size_t size) {
+    return mem_pool_alloc_mapped(size, MEM_POOL_NODE_INTERLEAVE, 0);
+}
+
+static void* cpu_allocate_memory_flags(size_t size, uint32_t flags) {
+    uint32_t page_flags = 0;
+    if (flags & HAL_ALLOC_HUGEPAGE) {
+        const char* env = getenv(HAL_HUGETLB_ENV);
+        page_flags |= (env && atoi(env) == 1) ? PAGE_MAP_HUGETLB : PAGE_MAP_THP;
+    }
+    if (flags & HAL_ALLOC_HUGETLB) page_flags |= PAGE_MAP_HUGETLB;
+
+    int node = MEM_POOL_NODE_ANY;
+    if (flags & HAL_ALLOC_INTERLEAVE) {
+        node = MEM_POOL_NODE_INTERLEAVE;
+    } else if (g_cpu_ctx && g_cpu_ctx->numa_node >= 0) {
+        node = g_cpu_ctx->numa_node;
+    }
+    return mem_pool_alloc_mapped(size, node, page_flags);
+}
+
+static size_t cpu_huge_page_bytes(const void* ptr) {
+    return mem_pool_huge_bytes(ptr);
 }
 
 static void cpu_free_memory(void* ptr) {
-    free(ptr);
+    mem_pool_free(ptr);
+}
+
+static size_t cpu_trim_memory(size_t keep_bytes) {
+    return mem_pool_trim(keep_bytes);
 }
 
 static void cpu_memcpy_to_device(void* dst, const void* src, size_t size) {
@@ -28,14 +118,394 @@ static void cpu_memcpy_from_device(void* dst, const void* src, size_t size) {
     memcpy(dst, src, size);
 }
 
+// 标量实现（无SIMD或被强制降级时使用）
+static void vector_add_scalar(const float* a, const float* b, float* c, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        c[i] = a[i] + b[i];
+    }
+}
+
+// 按指令集层级填充分发表
+static void init_cpu_kernels(CpuTier tier) {
+    g_cpu_kernels.vector_add = vector_add_scalar;
+
+#if defined(__x86_64__) || defined(_M_X64)
+    switch (tier) {
+        case CPU_TIER_AVX512_VNNI:
+        case CPU_TIER_AVX512:
+            g_cpu_kernels.vector_add = vector_add_avx512;
+            break;
+        case CPU_TIER_AVX2:
+            g_cpu_kernels.vector_add = vector_add_avx2;
+            break;
+        case CPU_TIER_SSE42:
+            g_cpu_kernels.vector_add = vector_add_sse42;
+            break;
+        default:
+            break;
+    }
+#elif defined(__aarch64__)
+    (void)tier;
+    g_cpu_kernels.vector_add = vector_add_asm;
+#else
+    (void)tier;
+#endif
+
+    // GEMM/GEMV内核同样按层级选择
+    gemm_init();
+    gemv_init();
+    qgemm_init();
+    qgemv_init();
+    ops_init();
+    attention_init();
+}
+
+static ThreadPool* cpu_pool(void) {
+    return g_cpu_ctx ? g_cpu_ctx->pool : NULL;
+}
+
 // CPU设备计算实现包装
+// 自动调优的最小计算量，更小的形状调优收益抵不上搜索开销
+#define CPU_AUTOTUNE_MIN_FLOPS (1u << 24)
+
+// 已交给后台调优的形状（无论成功与否都不再重试）：只追加，写入后发布计数，读取无锁
+static GemmTuningEntry g_tune_tried[GEMM_TUNING_MAX];
+static atomic_size_t g_tune_tried_count;
+static pthread_mutex_t g_tune_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int tune_tried(size_t m, size_t n, size_t k) {
+    size_t count = atomic_load_explicit(&g_tune_tried_count, memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        const GemmTuningEntry* e = &g_tune_tried[i];
+        if (e->m == m && e->n == n && e->k == k) return 1;
+    }
+    return 0;
+}
+
+// 保存调优文件（串行化，避免多个线程同时写临时文件）
+static void save_tuning(void) {
+    char path[512];
+    pthread_mutex_lock(&g_tune_lock);
+    if (gemm_tuning_default_path(path, sizeof(path)) == 0 && gemm_tuning_save(path) != 0) {
+        fprintf(stderr, "无法保存GEMM调优文件 %s\n", path);
+    }
+    pthread_mutex_unlock(&g_tune_lock);
+}
+
+// 调优并保存到调优文件（在调用线程上同步搜索）
+static int cpu_autotune_matmul(size_t m, size_t n, size_t k) {
+    if (m == 0 || n == 0 || k == 0) return -1;
+
+    int ret = gemm_autotune(cpu_pool(), m, n, k, NULL, NULL);
+    if (ret == 0) save_tuning();
+    return ret;
+}
+
+typedef struct {
+    CpuDeviceContext* ctx;
+    size_t m, n, k;
+} CpuTuneTask;
+
+// 后台调优流上执行：用专用线程池搜索，失败的形状已记录为尝试过，不会再次提交
+static void cpu_tune_task(void* arg) {
+    const CpuTuneTask* task = (const CpuTuneTask*)arg;
+    if (atomic_load_explicit(&task->ctx->tune_stop, memory_order_acquire)) return;
+    if (gemm_autotune(task->ctx->tune_pool, task->m, task->n, task->k, NULL, NULL) == 0) {
+        save_tuning();
+    }
+}
+
+// 未调优的形状第一次出现时提交后台调优（已提交、表满或提交失败的形状都不再重试）
+static void cpu_queue_autotune(size_t m, size_t n, size_t k) {
+    if (tune_tried(m, n, k)) return;
+
+    pthread_mutex_lock(&g_tune_lock);
+    // 加锁后重新检查：其他线程可能刚提交或刚完成同一形状
+    size_t count = atomic_load_explicit(&g_tune_tried_count, memory_order_relaxed);
+    if (count < GEMM_TUNING_MAX && !tune_tried(m, n, k) && gemm_tuning_find(m, n, k, NULL) != 0) {
+        GemmTuningEntry* e = &g_tune_tried[count];
+        memset(e, 0, sizeof(*e));
+        e->m = m;
+        e->n = n;
+        e->k = k;
+        atomic_store_explicit(&g_tune_tried_count, count + 1, memory_order_release);
+
+        CpuTuneTask task = { g_cpu_ctx, m, n, k };
+        stream_launch(g_cpu_ctx->tune_stream, cpu_tune_task, &task, sizeof(task));
+    }
+    pthread_mutex_unlock(&g_tune_lock);
+}
+
 static void cpu_matrix_multiply(const void* a, const void* b, void* c,
                               size_t m, size_t n, size_t k) {
-    matrix_multiply_asm((const float*)a, (const float*)b, (float*)c, m, n, k);
+    // m很小时（解码阶段）打包没有复用价值，改为按B行流式读取的带宽优化路径
+    if (m <= GEMV_MAX_M) {
+        gemv_small_m(cpu_pool(), m, n, k, (const float*)a, k, (const float*)b, n, (float*)c, n);
+        return;
+    }
+    
+    if (g_cpu_ctx && g_cpu_ctx->autotune &&
+        2.0 * (double)m * (double)n * (double)k >= CPU_AUTOTUNE_MIN_FLOPS &&
+        gemm_tuning_find(m, n, k, NULL) != 0) {
+        cpu_queue_autotune(m, n, k);
+    }
+    
+    // 分块打包GEMM，行主序且无额外填充
+    gemm_sgemm(cpu_pool(), m, n, k, (const float*)a, k, (const float*)b, n, (float*)c, n);
+}
+
+static void cpu_matrix_multiply_batched(const void* a, size_t lda, size_t stride_a, int trans_a,
+                                        const void* b, size_t ldb, size_t stride_b, int trans_b,
+                                        void* c, size_t ldc, size_t stride_c,
+                                        size_t m, size_t n, size_t k, size_t batch) {
+    gemm_sgemm_batched(cpu_pool(), trans_a, trans_b, m, n, k,
+                       (const float*)a, lda, stride_a,
+                       (const float*)b, ldb, stride_b,
+                       (float*)c, ldc, stride_c, batch);
+}
+
+static void cpu_matrix_multiply_trans(const void* a, size_t lda, int trans_a,
+                                      const void* b, size_t ldb, int trans_b,
+                                      void* c, size_t ldc,
+                                      size_t m, size_t n, size_t k, int accumulate) {
+    gemm_sgemm_ex(cpu_pool(), trans_a, trans_b, m, n, k,
+                  (const float*)a, lda, (const float*)b, ldb, (float*)c, ldc, accumulate);
+}
+
+static void cpu_matrix_multiply_backward(const void* grad_output, const void* input,
+                                         const void* weight, void* grad_input, void* grad_weight,
+                                         size_t m, size_t n, size_t k, int accumulate) {
+    // dX = dY[m x n] * W^T，W按 [k x n] 存储即 trans_b
+    if (grad_input) {
+        gemm_sgemm_ex(cpu_pool(), 0, 1, m, k, n,
+                      (const float*)grad_output, n, (const float*)weight, n,
+                      (float*)grad_input, k, 0);
+    }
+    // dW = X^T * dY，X按 [m x k] 存储即 trans_a
+    if (grad_weight) {
+        gemm_sgemm_ex(cpu_pool(), 1, 0, k, n, m,
+                      (const float*)input, k, (const float*)grad_output, n,
+                      (float*)grad_weight, n, accumulate);
+    }
+}
+
+static void cpu_matrix_multiply_f16(const void* a, const void* b, void* c,
+                                    size_t m, size_t n, size_t k) {
+    if (m <= GEMV_MAX_M) {
+        gemv_small_m_f16(cpu_pool(), m, n, k, (const float*)a, k, (const uint16_t*)b, n,
+                         (float*)c, n);
+        return;
+    }
+    gemm_sgemm_f16(cpu_pool(), m, n, k, (const float*)a, k, (const uint16_t*)b, n,
+                   (float*)c, n);
+}
+
+static void cpu_gemv(const void* a, const void* x, void* y, size_t m, size_t n) {
+    gemv_sgemv(cpu_pool(), m, n, (const float*)a, n, (const float*)x, (float*)y);
+}
+
+static int cpu_matrix_multiply_int8(const void* a, const void* b, void* c,
+                                    size_t m, size_t n, size_t k,
+                                    const QGemmParams* params) {
+    return qgemm_u8u8(cpu_pool(), m, n, k, (const uint8_t*)a, k, (const uint8_t*)b, n,
+                      c, n, params);
+}
+
+static int cpu_gemv_q4(const void* w, const void* x, void* y, size_t m, size_t k,
+                       const Q4GemvParams* params) {
+    return qgemv_q4(cpu_pool(), m, k, (const uint8_t*)w, x, (float*)y, params);
+}
+
+// 融合逐元素算子
+static void cpu_rmsnorm(const void* x, const void* weight, void* out,
+                        size_t rows, size_t dim, float eps) {
+    ops_rmsnorm(cpu_pool(), (const float*)x, (const float*)weight, (float*)out, rows, dim, eps);
+}
+
+static void cpu_layernorm(const void* x, const void* gamma, const void* beta, void* out,
+                          size_t rows, size_t dim, float eps) {
+    ops_layernorm(cpu_pool(), (const float*)x, (const float*)gamma, (const float*)beta,
+                  (float*)out, rows, dim, eps);
+}
+
+static void cpu_softmax(const void* x, void* out, size_t rows, size_t dim) {
+    ops_softmax(cpu_pool(), (const float*)x, (float*)out, rows, dim);
+}
+
+static int cpu_attention(const struct AttentionParams* params,
+                         const void* q, const void* k, const void* v,
+                         const size_t* kv_positions, size_t kv_len,
+                         const size_t* q_positions, size_t num_queries, void* out) {
+    return attention_forward(cpu_pool(), params, (const float*)q, (const float*)k,
+                             (const float*)v, kv_positions, kv_len,
+                             q_positions, num_queries, (float*)out);
+}
+
+static int cpu_attention_spans(const struct AttentionParams* params, const void* q,
+                               const struct AttentionKVSpan* spans, size_t num_spans,
+                               const size_t* q_positions, size_t num_queries, void* out) {
+    return attention_forward_spans(cpu_pool(), params, (const float*)q, spans, num_spans,
+                                   q_positions, num_queries, (float*)out);
+}
+
+static int cpu_attention_spans_batch(const struct AttentionParams* params, const void* q,
+                                     const struct AttentionKVSpan* spans, const size_t* span_offsets,
+                                     const size_t* q_positions, size_t num_batches, void* out) {
+    return attention_forward_batch(cpu_pool(), params, (const float*)q, spans, span_offsets,
+                                   q_positions, num_batches, (float*)out);
+}
+
+static void cpu_silu_mul(const void* gate, const void* up, void* out, size_t size) {
+    ops_silu_mul(cpu_pool(), (const float*)gate, (const float*)up, (float*)out, size);
+}
+
+static void cpu_activation(const void* x, void* out, size_t size, ActivationType type) {
+    ops_activation(cpu_pool(), type, (const float*)x, (float*)out, size);
+}
+
+static void cpu_activation_backward(const void* x, const void* grad_output, void* output,
+                                    void* grad_input, size_t size, ActivationType type) {
+    ops_activation_grad(cpu_pool(), type, (const float*)x, (const float*)grad_output,
+                        (float*)output, (float*)grad_input, size);
+}
+
+static void cpu_add_norm(void* residual, const void* delta, const void* weight, const void* bias,
+                         void* out, size_t rows, size_t dim, float eps, NormType type) {
+    ops_add_norm(cpu_pool(), type, (float*)residual, (const float*)delta, (const float*)weight,
+                 (const float*)bias, (float*)out, rows, dim, eps);
+}
+
+// 异步命令流
+static struct Stream* cpu_stream_create(void) {
+    Stream* stream = NULL;
+    if (stream_create(&stream) != 0) return NULL;
+    return stream;
+}
+
+static void cpu_stream_destroy(struct Stream* stream) {
+    stream_destroy(stream);
+}
+
+static int cpu_stream_synchronize(struct Stream* stream) {
+    return stream_synchronize(stream);
+}
+
+static int cpu_launch_async(struct Stream* stream, void (*func)(void* arg),
+                            const void* arg, size_t arg_size) {
+    return stream_launch(stream, func, arg, arg_size);
+}
+
+static int cpu_memcpy_async(void* dst, const void* src, size_t size, struct Stream* stream) {
+    return stream_memcpy_async(stream, dst, src, size);
+}
+
+// 矩阵乘命令参数（随命令复制）
+typedef struct {
+    const void* a;
+    const void* b;
+    void* c;
+    size_t m, n, k;
+} CpuMatmulCommand;
+
+static void cpu_matmul_command(void* arg) {
+    const CpuMatmulCommand* cmd = (const CpuMatmulCommand*)arg;
+    // 与主线程并发时线程池被占用，内核退化为在流线程上串行执行
+    cpu_matrix_multiply(cmd->a, cmd->b, cmd->c, cmd->m, cmd->n, cmd->k);
+}
+
+static int cpu_matrix_multiply_async(const void* a, const void* b, void* c,
+                                     size_t m, size_t n, size_t k, struct Stream* stream) {
+    CpuMatmulCommand cmd = { a, b, c, m, n, k };
+    return stream_launch(stream, cpu_matmul_command, &cmd, sizeof(cmd));
+}
+
+static struct StreamEvent* cpu_event_create(void) {
+    StreamEvent* event = NULL;
+    if (stream_event_create(&event) != 0) return NULL;
+    return event;
+}
+
+static void cpu_event_destroy(struct StreamEvent* event) {
+    stream_event_destroy(event);
+}
+
+static int cpu_event_record(struct StreamEvent* event, struct Stream* stream) {
+    return stream_event_record(event, stream);
+}
+
+static int cpu_stream_wait_event(struct Stream* stream, struct StreamEvent* event) {
+    return stream_wait_event(stream, event);
+}
+
+static int cpu_event_synchronize(struct StreamEvent* event) {
+    return stream_event_synchronize(event);
+}
+
+static int cpu_event_query(struct StreamEvent* event) {
+    return stream_event_query(event);
+}
+
+// vector_add 分块任务参数
+typedef struct {
+    const float* a;
+    const float* b;
+    float* c;
+    size_t size;
+    size_t chunk;
+} VectorAddArgs;
+
+static void vector_add_task(void* arg, size_t task_idx, size_t thread_idx) {
+    const VectorAddArgs* args = (const VectorAddArgs*)arg;
+    (void)thread_idx;
+    size_t start = task_idx * args->chunk;
+    size_t len = (args->size - start < args->chunk) ? args->size - start : args->chunk;
+    g_cpu_kernels.vector_add(args->a + start, args->b + start, args->c + start, len);
 }
 
 static void cpu_vector_add(const void* a, const void* b, void* c, size_t size) {
-    vector_add_asm((const float*)a, (const float*)b, (float*)c, size);
+    ThreadPool* pool = cpu_pool();
+    size_t num_threads = thread_pool_size(pool);
+
+    if (num_threads == 1 || size < VECTOR_PARALLEL_MIN_SIZE) {
+        g_cpu_kernels.vector_add((const float*)a, (const float*)b, (float*)c, size);
+        return;
+    }
+
+    VectorAddArgs args = { (const float*)a, (const float*)b, (float*)c, size, 0 };
+    args.chunk = (size + num_threads - 1) / num_threads;
+    args.chunk = (args.chunk + VECTOR_CHUNK_ALIGN - 1) & ~(size_t)(VECTOR_CHUNK_ALIGN - 1);
+    size_t num_tasks = (size + args.chunk - 1) / args.chunk;
+    thread_pool_parallel_for(pool, num_tasks, vector_add_task, &args);
+}
+
+// 计算线程池大小：默认每个计算单元一个线程，可由环境变量覆盖，并受上限约束
+static size_t cpu_thread_count(const HAL_Device* dev) {
+    size_t threads = dev->capabilities.compute_units;
+
+    const char* env = getenv(HAL_NUM_THREADS_ENV);
+    if (env && *env) {
+        long value = strtol(env, NULL, 10);
+        if (value > 0) threads = (size_t)value;
+    }
+
+    if (threads > dev->capabilities.max_threads) threads = dev->capabilities.max_threads;
+    if (threads > HAL_CPU_MAX_THREADS) threads = HAL_CPU_MAX_THREADS;
+    if (threads == 0) threads = 1;
+    return threads;
+}
+
+// 环境变量指定的NUMA节点，未设置或节点不存在/没有CPU时返回-1
+static int cpu_numa_node_from_env(void) {
+    const char* env = getenv(HAL_NUMA_NODE_ENV);
+    if (!env || !*env) return -1;
+    
+    char* end;
+    long value = strtol(env, &end, 10);
+    if (end == env || value < 0 || value >= NUMA_MAX_NODES) return -1;
+    
+    const NumaNode* node = numa_topology_find_node((int)value);
+    if (!node || node->num_cpus == 0) return -1;
+    return (int)value;
 }
 
 // 初始化CPU设备
@@ -55,34 +525,148 @@ static HAL_Device* init_cpu_device(void) {
 #endif
     
     dev->capabilities.memory_size = SIZE_MAX; // 使用系统内存
+    
+    // NUMA拓扑：绑定节点时只使用该节点的核心
+    const NumaTopology* topo = numa_topology_get();
+    dev->capabilities.numa_nodes = (uint32_t)topo->num_nodes;
+    dev->capabilities.numa_node = cpu_numa_node_from_env();
+    if (dev->capabilities.numa_node >= 0) {
+        const NumaNode* node = numa_topology_find_node(dev->capabilities.numa_node);
+        dev->capabilities.compute_units = (uint32_t)node->num_cpus;
+        if (node->memory_bytes) dev->capabilities.memory_size = node->memory_bytes;
+    }
     dev->capabilities.max_threads = dev->capabilities.compute_units * 2;
     
+    // 探测CPU特性并填充内核分发表
+    const CpuInfo* cpu_info = cpu_features_get();
+    dev->capabilities.isa_tier = cpu_info->tier;
+    dev->capabilities.cpu_features = cpu_info->features;
+    init_cpu_kernels(cpu_info->tier);
+    
     // 设置函数指针
     dev->allocate_memory = cpu_allocate_memory;
+    dev->allocate_memory_on_node = cpu_allocate_memory_on_node;
+    dev->allocate_interleaved = cpu_allocate_interleaved;
+    dev->allocate_memory_flags = cpu_allocate_memory_flags;
+    dev->huge_page_bytes = cpu_huge_page_bytes;
     dev->free_memory = cpu_free_memory;
+    dev->trim_memory = cpu_trim_memory;
     dev->memcpy_to_device = cpu_memcpy_to_device;
     dev->memcpy_from_device = cpu_memcpy_from_device;
     dev->matrix_multiply = cpu_matrix_multiply;
     dev->vector_add = cpu_vector_add;
+    dev->autotune_matmul = cpu_autotune_matmul;
+    dev->matrix_multiply_batched = cpu_matrix_multiply_batched;
+    dev->matrix_multiply_trans = cpu_matrix_multiply_trans;
+    dev->matrix_multiply_backward = cpu_matrix_multiply_backward;
+    dev->matrix_multiply_f16 = cpu_matrix_multiply_f16;
+    dev->gemv = cpu_gemv;
+    dev->matrix_multiply_int8 = cpu_matrix_multiply_int8;
+    dev->gemv_q4 = cpu_gemv_q4;
+    dev->rmsnorm = cpu_rmsnorm;
+    dev->layernorm = cpu_layernorm;
+    dev->softmax = cpu_softmax;
+    dev->silu_mul = cpu_silu_mul;
+    dev->activation = cpu_activation;
+    dev->activation_backward = cpu_activation_backward;
+    dev->add_norm = cpu_add_norm;
+    dev->attention = cpu_attention;
+    dev->attention_spans = cpu_attention_spans;
+    dev->attention_spans_batch = cpu_attention_spans_batch;
+    dev->stream_create = cpu_stream_create;
+    dev->stream_destroy = cpu_stream_destroy;
+    dev->stream_synchronize = cpu_stream_synchronize;
+    dev->launch_async = cpu_launch_async;
+    dev->memcpy_to_device_async = cpu_memcpy_async;
+    dev->memcpy_from_device_async = cpu_memcpy_async;
+    dev->matrix_multiply_async = cpu_matrix_multiply_async;
+    dev->event_create = cpu_event_create;
+    dev->event_destroy = cpu_event_destroy;
+    dev->event_record = cpu_event_record;
+    dev->stream_wait_event = cpu_stream_wait_event;
+    dev->event_synchronize = cpu_event_synchronize;
+    dev->event_query = cpu_event_query;
+    
+    // 创建设备持有的线程池
+    CpuDeviceContext* ctx = (CpuDeviceContext*)calloc(1, sizeof(CpuDeviceContext));
+    if (!ctx) {
+        free(dev);
+        return NULL;
+    }
+    if (thread_pool_create(&ctx->pool, cpu_thread_count(dev)) != 0) {
+        free(ctx);
+        free(dev);
+        return NULL;
+    }
+    dev->device_specific_data = ctx;
+    g_cpu_ctx = ctx;
+    
+    // 载入本机之前保存的GEMM调优结果
+    char tuning_path[512];
+    if (gemm_tuning_default_path(tuning_path, sizeof(tuning_path)) == 0) {
+        gemm_tuning_load(tuning_path);
+    }
+    const char* autotune = getenv(HAL_AUTOTUNE_ENV);
+    if (autotune && atoi(autotune) == 1) {
+        // 后台调优需要自己的流和线程池，创建失败时不自动调优
+        if (stream_create(&ctx->tune_stream) == 0 &&
+            thread_pool_create(&ctx->tune_pool, thread_pool_size(ctx->pool)) == 0) {
+            ctx->autotune = 1;
+        } else {
+            stream_destroy(ctx->tune_stream);
+            ctx->tune_stream = NULL;
+        }
+    }
+    
+    // 多节点或绑定节点时固定工作线程的位置，避免线程在插槽之间迁移
+    ctx->numa_node = dev->capabilities.numa_node;
+    if (topo->num_nodes > 1 || ctx->numa_node >= 0) {
+        int cpus[NUMA_MAX_CPUS];
+        size_t num_cpus = numa_topology_cpu_order(ctx->numa_node, cpus, NUMA_MAX_CPUS);
+        if (num_cpus > 0) thread_pool_set_affinity(ctx->pool, cpus, num_cpus);
+    }
     
     return dev;
 }
 
+// 释放CPU设备
+static void free_cpu_device(HAL_Device* dev) {
+    if (!dev) return;
+    
+    CpuDeviceContext* ctx = (CpuDeviceContext*)dev->device_specific_data;
+    if (ctx) {
+        // 跳过排队中的调优，等待正在进行的搜索结束
+        atomic_store_explicit(&ctx->tune_stop, 1, memory_order_release);
+        stream_destroy(ctx->tune_stream);
+        thread_pool_destroy(ctx->tune_pool);
+        atomic_store_explicit(&g_tune_tried_count, 0, memory_order_release);
+        thread_pool_destroy(ctx->pool);
+        if (g_cpu_ctx == ctx) g_cpu_ctx = NULL;
+        free(ctx);
+    }
+    free(dev);
+}
+
 // HAL系统初始化
 int hal_init(void) {
+    if (devices) return 0; // 已经初始化
+    
     // 初始化CPU设备
     HAL_Device* cpu_dev = init_cpu_device();
     if (!cpu_dev) return -1;
     
     devices = (HAL_Device**)malloc(sizeof(HAL_Device*));
     if (!devices) {
-        free(cpu_dev);
+        free_cpu_device(cpu_dev);
         return -1;
     }
     
     devices[0] = cpu_dev;
     num_devices = 1;
     
+    // 环境变量启用热路径插桩
+    hal_profile_init_from_env(cpu_dev);
+    
     // TODO: 初始化其他设备（GPU等）
     
     return 0;
@@ -97,6 +681,52 @@ int hal_get_devices(HAL_Device** out_devices, int* out_num_devices) {
     return 0;
 }
 
+int hal_get_device_count(void) {
+    return devices ? num_devices : 0;
+}
+
+HAL_Device* hal_get_device(int index) {
+    if (!devices || index < 0 || index >= num_devices) return NULL;
+    return devices[index];
+}
+
+int hal_cache_dir(char* buf, size_t size) {
+    if (!buf || size == 0) return -1;
+
+    const char* cache = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+    int len;
+    if (cache && *cache) {
+        len = snprintf(buf, size, "%s/lowmemory_llm", cache);
+    } else if (home && *home) {
+        len = snprintf(buf, size, "%s/.cache/lowmemory_llm", home);
+    } else {
+        return -1;
+    }
+    return len > 0 && (size_t)len < size ? 0 : -1;
+}
+
+int hal_create_parent_dirs(const char* path) {
+    if (!path) return -1;
+    char buf[512];
+    size_t len = strlen(path);
+    if (len >= sizeof(buf)) return -1;
+    memcpy(buf, path, len + 1);
+
+    for (char* p = buf + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+#if defined(_WIN32)
+        int ret = _mkdir(buf);
+#else
+        int ret = mkdir(buf, 0755);
+#endif
+        if (ret != 0 && errno != EEXIST) return -1;
+        *p = '/';
+    }
+    return 0;
+}
+
 // 选择最优设备
 HAL_Device* hal_select_optimal_device(void) {
     if (!devices || num_devices == 0) return NULL;
@@ -113,4 +743,28 @@ HAL_Device* hal_select_optimal_device(void) {
     }
     
     return best_device;
-} 
\ No newline at end of file
+}
+
+// 释放HAL系统资源
+void hal_cleanup(void) {
+    if (!devices) return;
+    
+    for (int i = 0; i < num_devices; i++) {
+        hal_profile_shutdown(devices[i]);
+        if (devices[i] && devices[i]->device_type == DEVICE_TYPE_CPU) {
+            free_cpu_device(devices[i]);
+        }
+    }
+    free(devices);
+    devices = NULL;
+    num_devices = 0;
+    
+    // 调优表在下次hal_init时按当时的层级重新载入
+    gemm_tuning_clear();
+    
+    // 工作线程的暂存区随线程退出释放，调用线程的在这里释放
+    thread_scratch_release();
+    
+    // 归还内存池中缓存的空闲块
+    mem_pool_trim(0);
+}
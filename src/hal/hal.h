@@ -4,6 +4,29 @@
 #include <stdint.h>
 #include <stddef.h>
 
+struct QGemmParams;
+struct Q4GemvParams;
+struct AttentionParams;
+struct AttentionKVSpan;
+struct Stream;
+struct StreamEvent;
+
+// 激活函数类型
+typedef enum {
+    ACTIVATION_RELU,
+    ACTIVATION_SILU,           // x * sigmoid(x)（即Swish）
+    ACTIVATION_GELU_TANH,      // tanh近似的GELU
+    ACTIVATION_GELU_ERF,       // 精确（erf）GELU
+    ACTIVATION_TANH,
+    ACTIVATION_COUNT
+} ActivationType;
+
+// 归一化类型
+typedef enum {
+    NORM_RMS,                  // RMSNorm: x / rms(x) * weight
+    NORM_LAYER                 // LayerNorm: (x - mean) / std * gamma + beta
+} NormType;
+
 // 硬件抽象层接口定义
 typedef struct {
     // 设备类型枚举
@@ -19,11 +42,25 @@ typedef struct {
         uint32_t compute_units;
         uint64_t memory_size;
         uint32_t max_threads;
+        uint32_t isa_tier;       // 实际使用的指令集层级（CpuTier）
+        uint32_t cpu_features;   // 可用的CPU特性位（CPU_FEATURE_*）
+        uint32_t numa_nodes;     // 系统NUMA节点数
+        int32_t numa_node;       // 设备绑定的NUMA节点（-1表示不限）
     } capabilities;
     
     // 设备操作函数指针
     void* (*allocate_memory)(size_t size);
+    // NUMA放置：优先放在指定节点上 / 按页交错到所有节点（多路服务器上的大权重矩阵）
+    // 均由free_memory释放
+    void* (*allocate_memory_on_node)(size_t size, int node);
+    void* (*allocate_interleaved)(size_t size);
+    // 按HAL_ALLOC_*选项分配长期存在的大缓冲区（权重、KV缓存），由free_memory释放
+    void* (*allocate_memory_flags)(size_t size, uint32_t flags);
+    // ptr所在分配中实际由大页支撑的字节数
+    size_t (*huge_page_bytes)(const void* ptr);
     void (*free_memory)(void* ptr);
+    // 将分配器缓存的空闲内存归还系统，直到缓存不超过keep_bytes，返回归还的字节数
+    size_t (*trim_memory)(size_t keep_bytes);
     void (*memcpy_to_device)(void* dst, const void* src, size_t size);
     void (*memcpy_from_device)(void* dst, const void* src, size_t size);
     
@@ -31,15 +68,150 @@ typedef struct {
     void (*matrix_multiply)(const void* a, const void* b, void* c, 
                           size_t m, size_t n, size_t k);
     void (*vector_add)(const void* a, const void* b, void* c, size_t size);
+    
+    // 对matrix_multiply的形状 (m, n, k) 搜索最快的微内核、分块和线程数，
+    // 结果立即生效并保存到本机的调优文件，之后的hal_init直接载入
+    int (*autotune_matmul)(size_t m, size_t n, size_t k);
+    
+    // 跨步批量矩阵乘（多头注意力）: C_i = op(A_i) * op(B_i)，i = 0..batch-1
+    // 第i个矩阵起点为 X + i * stride_x（单位为元素），lda/ldb/ldc为行跨度
+    // trans_a非0时A_i按 [k x m] 存储，trans_b非0时B_i按 [n x k] 存储（如 Q * K^T）
+    void (*matrix_multiply_batched)(const void* a, size_t lda, size_t stride_a, int trans_a,
+                                    const void* b, size_t ldb, size_t stride_b, int trans_b,
+                                    void* c, size_t ldc, size_t stride_c,
+                                    size_t m, size_t n, size_t k, size_t batch);
+    
+    // 带转置标志的单个矩阵乘: C[m x n] = op(A) * op(B)，accumulate非0时 C += op(A) * op(B)
+    // 转置约定同matrix_multiply_batched，转置在打包时完成，无需显式转置的临时矩阵
+    void (*matrix_multiply_trans)(const void* a, size_t lda, int trans_a,
+                                  const void* b, size_t ldb, int trans_b,
+                                  void* c, size_t ldc,
+                                  size_t m, size_t n, size_t k, int accumulate);
+    
+    // 线性层 Y[m x n] = X[m x k] * W[k x n] 的反向传播（均为行主序连续存储）:
+    // grad_input[m x k] = grad_output * W^T，grad_weight[k x n] = X^T * grad_output
+    // grad_input/grad_weight为NULL时跳过对应的计算；accumulate非0时梯度累加到grad_weight（梯度累积）
+    void (*matrix_multiply_backward)(const void* grad_output, const void* input, const void* weight,
+                                     void* grad_input, void* grad_weight,
+                                     size_t m, size_t n, size_t k, int accumulate);
+    
+    // B为fp16权重的矩阵乘: C[m x n] = A[m x k] * B[k x n]，A/C为fp32
+    void (*matrix_multiply_f16)(const void* a, const void* b, void* c,
+                                size_t m, size_t n, size_t k);
+    
+    // 矩阵向量乘: y[m] = A[m x n] * x[n]（解码阶段的投影）
+    void (*gemv)(const void* a, const void* x, void* y, size_t m, size_t n);
+    
+    // INT8矩阵乘: C[m x n] = epilogue(A[m x k] * B[k x n])
+    // A、B为quant_quantize输出的uint8数据，C的类型由params->output_type决定
+    int (*matrix_multiply_int8)(const void* a, const void* b, void* c,
+                                size_t m, size_t n, size_t k,
+                                const struct QGemmParams* params);
+    
+    // INT4权重矩阵向量乘: y[m] = dequant(W[m x k]) * x[k]
+    // W为quant_quantize的INT4输出，在寄存器中解包并按组应用scale/零点
+    int (*gemv_q4)(const void* w, const void* x, void* y, size_t m, size_t k,
+                   const struct Q4GemvParams* params);
+    
+    // 融合逐元素算子：每个算子对内存只做一次读写，按行或按块切分到线程池
+    // weight/gamma/beta可为NULL（等价于1/0）
+    void (*rmsnorm)(const void* x, const void* weight, void* out,
+                    size_t rows, size_t dim, float eps);
+    void (*layernorm)(const void* x, const void* gamma, const void* beta, void* out,
+                      size_t rows, size_t dim, float eps);
+    void (*softmax)(const void* x, void* out, size_t rows, size_t dim);
+    // out = silu(gate) * up（SwiGLU）
+    void (*silu_mul)(const void* gate, const void* up, void* out, size_t size);
+    void (*activation)(const void* x, void* out, size_t size, ActivationType type);
+    // 激活反向：grad_input = grad_output * f'(x)，由输入x重新计算，output非NULL时同时写出f(x)
+    void (*activation_backward)(const void* x, const void* grad_output, void* output,
+                                void* grad_input, size_t size, ActivationType type);
+    // residual += delta，out = norm(residual)
+    void (*add_norm)(void* residual, const void* delta, const void* weight, const void* bias,
+                     void* out, size_t rows, size_t dim, float eps, NormType type);
+    
+    // 融合缩放点积注意力：按块读取K/V并在线softmax，不生成分数矩阵（布局和屏蔽规则见attention.h）
+    int (*attention)(const struct AttentionParams* params,
+                     const void* q, const void* k, const void* v,
+                     const size_t* kv_positions, size_t kv_len,
+                     const size_t* q_positions, size_t num_queries, void* out);
+    // 同上，K/V由若干存储连续的段拼接而成（分页KV缓存）
+    int (*attention_spans)(const struct AttentionParams* params, const void* q,
+                           const struct AttentionKVSpan* spans, size_t num_spans,
+                           const size_t* q_positions, size_t num_queries, void* out);
+    // 批量解码：若干组独立的段各一个查询（参数见attention.h的attention_forward_batch）
+    int (*attention_spans_batch)(const struct AttentionParams* params, const void* q,
+                                 const struct AttentionKVSpan* spans, const size_t* span_offsets,
+                                 const size_t* q_positions, size_t num_batches, void* out);
+    
+    // 异步命令流：同一流内的命令按提交顺序执行，不同流之间并发执行
+    // CPU设备上每个流由一个专用工作线程执行；stream为NULL时同步执行
+    // 异步命令引用的缓冲区在命令完成（流或事件同步）前不得释放或修改
+    struct Stream* (*stream_create)(void);
+    void (*stream_destroy)(struct Stream* stream);
+    int (*stream_synchronize)(struct Stream* stream);
+    // 在流上执行任意函数，arg_size > 0 时复制参数块
+    int (*launch_async)(struct Stream* stream, void (*func)(void* arg),
+                        const void* arg, size_t arg_size);
+    int (*memcpy_to_device_async)(void* dst, const void* src, size_t size,
+                                  struct Stream* stream);
+    int (*memcpy_from_device_async)(void* dst, const void* src, size_t size,
+                                    struct Stream* stream);
+    int (*matrix_multiply_async)(const void* a, const void* b, void* c,
+                                 size_t m, size_t n, size_t k, struct Stream* stream);
+    
+    // 事件：记录流中的位置，用于跨流依赖和主机端等待
+    struct StreamEvent* (*event_create)(void);
+    void (*event_destroy)(struct StreamEvent* event);
+    int (*event_record)(struct StreamEvent* event, struct Stream* stream);
+    int (*stream_wait_event)(struct Stream* stream, struct StreamEvent* event);
+    int (*event_synchronize)(struct StreamEvent* event);
+    int (*event_query)(struct StreamEvent* event);
+    
+    // 设备私有数据（CPU设备为线程池等运行时上下文）
+    void* device_specific_data;
 } HAL_Device;
 
+// CPU线程数上限
+#define HAL_CPU_MAX_THREADS 64
+
+// 覆盖CPU线程数的环境变量
+#define HAL_NUM_THREADS_ENV "LOWMEM_NUM_THREADS"
+
+// 将CPU设备限制在指定NUMA节点上的环境变量（线程绑定到该节点的核心，默认分配放在该节点）
+#define HAL_NUMA_NODE_ENV "LOWMEM_NUMA_NODE"
+
+// allocate_memory_flags的选项
+#define HAL_ALLOC_HUGEPAGE    (1u << 0)   // 透明大页（减少大缓冲区随机访问时的TLB缺失）
+#define HAL_ALLOC_HUGETLB     (1u << 1)   // 显式大页（需预留hugetlbfs页），不可用时回退到透明大页
+#define HAL_ALLOC_INTERLEAVE  (1u << 2)   // 按页交错到所有NUMA节点
+
+// 设为1时，HAL_ALLOC_HUGEPAGE的分配优先尝试显式大页
+#define HAL_HUGETLB_ENV "LOWMEM_HUGETLB"
+
+// 设为1时，matrix_multiply遇到未调优的大形状交给后台流调优，当前调用仍用默认配置（每个形状只尝试一次）
+#define HAL_AUTOTUNE_ENV "LOWMEM_AUTOTUNE"
+
 // 初始化HAL系统
 int hal_init(void);
 
 // 获取可用设备列表
 int hal_get_devices(HAL_Device** devices, int* num_devices);
 
+// 设备数量 / 第index个设备（越界返回NULL）
+int hal_get_device_count(void);
+HAL_Device* hal_get_device(int index);
+
 // 选择最优设备
 HAL_Device* hal_select_optimal_device(void);
 
+// 释放HAL系统资源（设备及其线程池）
+void hal_cleanup(void);
+
+// 本机缓存目录（$XDG_CACHE_HOME或~/.cache下的lowmemory_llm，存放调优和校准结果），返回0成功
+int hal_cache_dir(char* buf, size_t size);
+
+// 逐级创建path所在的目录，返回0成功
+int hal_create_parent_dirs(const char* path);
+
 #endif // HAL_H 
\ No newline at end of file
@@ -0,0 +1,488 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE            // dladdr
+#endif
+
+#include "hal_profile.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <dlfcn.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CALL_SITE() __builtin_extract_return_addr(__builtin_return_address(0))
+#else
+#define CALL_SITE() NULL
+#endif
+
+// 调用点哈希表项，key = (地址 << 4) | (op + 1)，0表示空
+typedef struct {
+    _Atomic uint64_t key;
+    _Atomic uint64_t calls;
+    _Atomic uint64_t total_ns;
+    _Atomic uint64_t min_ns;
+    _Atomic uint64_t max_ns;
+    _Atomic uint64_t flops;
+    _Atomic uint64_t bytes;
+    _Atomic uint64_t hist[HAL_PROFILE_HIST_BUCKETS];
+} SiteEntry;
+
+#define MAX_PROBES 32
+
+static SiteEntry g_sites[HAL_PROFILE_MAX_SITES];
+static SiteEntry g_overflow[HAL_PROFILE_OP_COUNT];
+
+// 被插桩的设备及其原函数指针
+static HAL_Device* g_device = NULL;
+static HAL_Device g_orig;
+
+// 环境变量启用时的输出目标
+static char* g_dump_path = NULL;
+static int g_dump_pending = 0;
+static int g_atexit_registered = 0;
+
+static const char* const g_op_names[HAL_PROFILE_OP_COUNT] = {
+    "matrix_multiply",
+    "matrix_multiply_batched",
+    "matrix_multiply_trans",
+    "gemv",
+    "vector_add",
+    "memcpy_to_device",
+    "memcpy_from_device",
+    "allocate_memory",
+    "free_memory",
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static size_t hist_bucket(uint64_t ns) {
+    if (ns < 2) return 0;
+    size_t b = (size_t)(63 - __builtin_clzll(ns));
+    return b < HAL_PROFILE_HIST_BUCKETS ? b : HAL_PROFILE_HIST_BUCKETS - 1;
+}
+
+static uint64_t site_key(HalProfileOp op, const void* site) {
+    return ((uint64_t)(uintptr_t)site << 4) | (uint64_t)(op + 1);
+}
+
+static SiteEntry* find_entry(HalProfileOp op, const void* site) {
+    uint64_t key = site_key(op, site);
+    uint64_t h = key * 0x9E3779B97F4A7C15ull;
+    size_t idx = (size_t)(h >> 32) & (HAL_PROFILE_MAX_SITES - 1);
+
+    for (size_t probe = 0; probe < MAX_PROBES; probe++) {
+        SiteEntry* e = &g_sites[(idx + probe) & (HAL_PROFILE_MAX_SITES - 1)];
+        uint64_t cur = atomic_load_explicit(&e->key, memory_order_acquire);
+        if (cur == key) return e;
+        if (cur == 0) {
+            uint64_t expected = 0;
+            if (atomic_compare_exchange_strong_explicit(&e->key, &expected, key,
+                                                        memory_order_acq_rel,
+                                                        memory_order_acquire)) {
+                return e;
+            }
+            if (expected == key) return e;
+        }
+    }
+    return &g_overflow[op];
+}
+
+static void record(HalProfileOp op, const void* site, uint64_t ns,
+                   uint64_t flops, uint64_t bytes) {
+    SiteEntry* e = find_entry(op, site);
+    atomic_fetch_add_explicit(&e->calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&e->total_ns, ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&e->flops, flops, memory_order_relaxed);
+    atomic_fetch_add_explicit(&e->bytes, bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&e->hist[hist_bucket(ns)], 1, memory_order_relaxed);
+
+    // min_ns为0表示尚无记录
+    uint64_t cur = atomic_load_explicit(&e->min_ns, memory_order_relaxed);
+    while ((cur == 0 || ns < cur) &&
+           !atomic_compare_exchange_weak_explicit(&e->min_ns, &cur, ns ? ns : 1,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+    cur = atomic_load_explicit(&e->max_ns, memory_order_relaxed);
+    while (ns > cur &&
+           !atomic_compare_exchange_weak_explicit(&e->max_ns, &cur, ns,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 包装函数
+// ---------------------------------------------------------------------------
+
+static void prof_matrix_multiply(const void* a, const void* b, void* c,
+                                 size_t m, size_t n, size_t k) {
+    const void* site = CALL_SITE();
+    uint64_t t0 = now_ns();
+    g_orig.matrix_multiply(a, b, c, m, n, k);
+    record(HAL_PROFILE_MATMUL, site, now_ns() - t0,
+           2ull * m * n * k, 4ull * (m * k + k * n + m * n));
+}
+
+static void prof_matrix_multiply_batched(const void* a, size_t lda, size_t stride_a, int trans_a,
+                                         const void* b, size_t ldb, size_t stride_b, int trans_b,
+                                         void* c, size_t ldc, size_t stride_c,
+                                         size_t m, size_t n, size_t k, size_t batch) {
+    const void* site = CALL_SITE();
+    uint64_t t0 = now_ns();
+    g_orig.matrix_multiply_batched(a, lda, stride_a, trans_a, b, ldb, stride_b, trans_b,
+                                   c, ldc, stride_c, m, n, k, batch);
+    record(HAL_PROFILE_MATMUL_BATCHED, site, now_ns() - t0,
+           2ull * m * n * k * batch, 4ull * (m * k + k * n + m * n) * batch);
+}
+
+static void prof_matrix_multiply_trans(const void* a, size_t lda, int trans_a,
+                                       const void* b, size_t ldb, int trans_b,
+                                       void* c, size_t ldc,
+                                       size_t m, size_t n, size_t k, int accumulate) {
+    const void* site = CALL_SITE();
+    uint64_t t0 = now_ns();
+    g_orig.matrix_multiply_trans(a, lda, trans_a, b, ldb, trans_b, c, ldc, m, n, k, accumulate);
+    record(HAL_PROFILE_MATMUL_TRANS, site, now_ns() - t0,
+           2ull * m * n * k, 4ull * (m * k + k * n + (accumulate ? 2 : 1) * m * n));
+}
+
+static void prof_gemv(const void* a, const void* x, void* y, size_t m, size_t n) {
+    const void* site = CALL_SITE();
+    uint64_t t0 = now_ns();
+    g_orig.gemv(a, x, y, m, n);
+    record(HAL_PROFILE_GEMV, site, now_ns() - t0, 2ull * m * n, 4ull * (m * n + n + m));
+}
+
+static void prof_vector_add(const void* a, const void* b, void* c, size_t size) {
+    const void* site = CALL_SITE();
+    uint64_t t0 = now_ns();
+    g_orig.vector_add(a, b, c, size);
+    record(HAL_PROFILE_VECTOR_ADD, site, now_ns() - t0, size, 12ull * size);
+}
+
+static void prof_memcpy_to_device(void* dst, const void* src, size_t size) {
+    const void* site = CALL_SITE();
+    uint64_t t0 = now_ns();
+    g_orig.memcpy_to_device(dst, src, size);
+    record(HAL_PROFILE_MEMCPY_TO_DEVICE, site, now_ns() - t0, 0, size);
+}
+
+static void prof_memcpy_from_device(void* dst, const void* src, size_t size) {
+    const void* site = CALL_SITE();
+    uint64_t t0 = now_ns();
+    g_orig.memcpy_from_device(dst, src, size);
+    record(HAL_PROFILE_MEMCPY_FROM_DEVICE, site, now_ns() - t0, 0, size);
+}
+
+static void* prof_allocate_memory(size_t size) {
+    const void* site = CALL_SITE();
+    uint64_t t0 = now_ns();
+    void* ptr = g_orig.allocate_memory(size);
+    record(HAL_PROFILE_ALLOCATE, site, now_ns() - t0, 0, size);
+    return ptr;
+}
+
+static void prof_free_memory(void* ptr) {
+    const void* site = CALL_SITE();
+    uint64_t t0 = now_ns();
+    g_orig.free_memory(ptr);
+    record(HAL_PROFILE_FREE, site, now_ns() - t0, 0, 0);
+}
+
+// ---------------------------------------------------------------------------
+// 启用/禁用
+// ---------------------------------------------------------------------------
+
+int hal_profile_enable(HAL_Device* device) {
+    if (!device) return -1;
+    if (g_device == device) return 0;
+    if (g_device) return -1;
+
+    g_orig = *device;
+    g_device = device;
+
+    // 只替换设备实现了的函数
+    if (device->matrix_multiply) device->matrix_multiply = prof_matrix_multiply;
+    if (device->matrix_multiply_batched) device->matrix_multiply_batched = prof_matrix_multiply_batched;
+    if (device->matrix_multiply_trans) device->matrix_multiply_trans = prof_matrix_multiply_trans;
+    if (device->gemv) device->gemv = prof_gemv;
+    if (device->vector_add) device->vector_add = prof_vector_add;
+    if (device->memcpy_to_device) device->memcpy_to_device = prof_memcpy_to_device;
+    if (device->memcpy_from_device) device->memcpy_from_device = prof_memcpy_from_device;
+    if (device->allocate_memory) device->allocate_memory = prof_allocate_memory;
+    if (device->free_memory) device->free_memory = prof_free_memory;
+    return 0;
+}
+
+void hal_profile_disable(HAL_Device* device) {
+    if (!device || device != g_device) return;
+
+    device->matrix_multiply = g_orig.matrix_multiply;
+    device->matrix_multiply_batched = g_orig.matrix_multiply_batched;
+    device->matrix_multiply_trans = g_orig.matrix_multiply_trans;
+    device->gemv = g_orig.gemv;
+    device->vector_add = g_orig.vector_add;
+    device->memcpy_to_device = g_orig.memcpy_to_device;
+    device->memcpy_from_device = g_orig.memcpy_from_device;
+    device->allocate_memory = g_orig.allocate_memory;
+    device->free_memory = g_orig.free_memory;
+    g_device = NULL;
+}
+
+int hal_profile_enabled(const HAL_Device* device) {
+    return device && device == g_device;
+}
+
+static void clear_entry(SiteEntry* e) {
+    atomic_store_explicit(&e->calls, 0, memory_order_relaxed);
+    atomic_store_explicit(&e->total_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&e->min_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&e->max_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&e->flops, 0, memory_order_relaxed);
+    atomic_store_explicit(&e->bytes, 0, memory_order_relaxed);
+    for (size_t b = 0; b < HAL_PROFILE_HIST_BUCKETS; b++) {
+        atomic_store_explicit(&e->hist[b], 0, memory_order_relaxed);
+    }
+}
+
+// 调用点的键保留，只清空计数
+void hal_profile_reset(void) {
+    for (size_t i = 0; i < HAL_PROFILE_MAX_SITES; i++) {
+        clear_entry(&g_sites[i]);
+    }
+    for (size_t op = 0; op < HAL_PROFILE_OP_COUNT; op++) {
+        clear_entry(&g_overflow[op]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 查询
+// ---------------------------------------------------------------------------
+
+static void load_entry(const SiteEntry* e, HalProfileStats* stats) {
+    stats->calls = atomic_load_explicit(&e->calls, memory_order_relaxed);
+    stats->total_ns = atomic_load_explicit(&e->total_ns, memory_order_relaxed);
+    stats->min_ns = atomic_load_explicit(&e->min_ns, memory_order_relaxed);
+    stats->max_ns = atomic_load_explicit(&e->max_ns, memory_order_relaxed);
+    stats->flops = atomic_load_explicit(&e->flops, memory_order_relaxed);
+    stats->bytes = atomic_load_explicit(&e->bytes, memory_order_relaxed);
+    for (size_t b = 0; b < HAL_PROFILE_HIST_BUCKETS; b++) {
+        stats->hist[b] = atomic_load_explicit(&e->hist[b], memory_order_relaxed);
+    }
+}
+
+static void merge_stats(HalProfileStats* dst, const HalProfileStats* src) {
+    if (src->calls == 0) return;
+    if (dst->calls == 0 || src->min_ns < dst->min_ns) dst->min_ns = src->min_ns;
+    if (src->max_ns > dst->max_ns) dst->max_ns = src->max_ns;
+    dst->calls += src->calls;
+    dst->total_ns += src->total_ns;
+    dst->flops += src->flops;
+    dst->bytes += src->bytes;
+    for (size_t b = 0; b < HAL_PROFILE_HIST_BUCKETS; b++) {
+        dst->hist[b] += src->hist[b];
+    }
+}
+
+static HalProfileOp entry_op(uint64_t key) {
+    return (HalProfileOp)((key & 0xF) - 1);
+}
+
+void hal_profile_get_stats(HalProfileOp op, HalProfileStats* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (op >= HAL_PROFILE_OP_COUNT) return;
+
+    HalProfileStats entry;
+    for (size_t i = 0; i < HAL_PROFILE_MAX_SITES; i++) {
+        uint64_t key = atomic_load_explicit(&g_sites[i].key, memory_order_acquire);
+        if (key == 0 || entry_op(key) != op) continue;
+        load_entry(&g_sites[i], &entry);
+        merge_stats(stats, &entry);
+    }
+    load_entry(&g_overflow[op], &entry);
+    merge_stats(stats, &entry);
+}
+
+static int cmp_site_total(const void* a, const void* b) {
+    uint64_t x = ((const HalProfileSite*)a)->stats.total_ns;
+    uint64_t y = ((const HalProfileSite*)b)->stats.total_ns;
+    return (x < y) - (x > y);
+}
+
+size_t hal_profile_get_sites(HalProfileSite* sites, size_t max_sites) {
+    if (!sites || max_sites == 0) return 0;
+
+    // 先收集全部调用点再排序，保证截断时保留耗时最高的
+    size_t capacity = HAL_PROFILE_MAX_SITES + HAL_PROFILE_OP_COUNT;
+    HalProfileSite* all = (HalProfileSite*)malloc(sizeof(HalProfileSite) * capacity);
+    if (!all) return 0;
+
+    size_t count = 0;
+    for (size_t i = 0; i < HAL_PROFILE_MAX_SITES; i++) {
+        uint64_t key = atomic_load_explicit(&g_sites[i].key, memory_order_acquire);
+        if (key == 0) continue;
+        HalProfileSite* s = &all[count];
+        load_entry(&g_sites[i], &s->stats);
+        if (s->stats.calls == 0) continue;
+        s->op = entry_op(key);
+        s->site = (const void*)(uintptr_t)(key >> 4);
+        count++;
+    }
+    for (size_t op = 0; op < HAL_PROFILE_OP_COUNT; op++) {
+        HalProfileSite* s = &all[count];
+        load_entry(&g_overflow[op], &s->stats);
+        if (s->stats.calls == 0) continue;
+        s->op = (HalProfileOp)op;
+        s->site = NULL;
+        count++;
+    }
+
+    qsort(all, count, sizeof(HalProfileSite), cmp_site_total);
+    if (count > max_sites) count = max_sites;
+    memcpy(sites, all, sizeof(HalProfileSite) * count);
+    free(all);
+    return count;
+}
+
+uint64_t hal_profile_percentile_ns(const HalProfileStats* stats, double pct) {
+    if (!stats || stats->calls == 0) return 0;
+    if (pct < 0) pct = 0;
+    if (pct > 100) pct = 100;
+
+    uint64_t target = (uint64_t)((double)stats->calls * pct / 100.0 + 0.5);
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < HAL_PROFILE_HIST_BUCKETS; b++) {
+        seen += stats->hist[b];
+        if (seen >= target) {
+            // 上界不超过实际观测到的最大值
+            uint64_t upper = b + 1 < 64 ? (1ull << (b + 1)) : UINT64_MAX;
+            return upper < stats->max_ns ? upper : stats->max_ns;
+        }
+    }
+    return stats->max_ns;
+}
+
+const char* hal_profile_op_name(HalProfileOp op) {
+    return op < HAL_PROFILE_OP_COUNT ? g_op_names[op] : "unknown";
+}
+
+// ---------------------------------------------------------------------------
+// 输出
+// ---------------------------------------------------------------------------
+
+#define DUMP_MAX_SITES 32
+
+static void format_site(const void* site, char* buf, size_t size) {
+    if (!site) {
+        snprintf(buf, size, "(overflow)");
+        return;
+    }
+#if defined(__linux__)
+    Dl_info info;
+    if (dladdr(site, &info) && info.dli_sname) {
+        snprintf(buf, size, "%s+0x%zx", info.dli_sname,
+                 (size_t)((const char*)site - (const char*)info.dli_saddr));
+        return;
+    }
+#endif
+    snprintf(buf, size, "%p", site);
+}
+
+static void dump_row(FILE* fp, const char* label, const char* site, const HalProfileStats* s) {
+    double total_ms = (double)s->total_ns * 1e-6;
+    double mean_us = (double)s->total_ns / (double)s->calls * 1e-3;
+    double seconds = (double)s->total_ns * 1e-9;
+    fprintf(fp, "%-24s %-28s %10llu %11.3f %10.2f %10.2f %10.2f %10.2f",
+            label, site, (unsigned long long)s->calls, total_ms, mean_us,
+            (double)hal_profile_percentile_ns(s, 50) * 1e-3,
+            (double)hal_profile_percentile_ns(s, 99) * 1e-3,
+            (double)s->max_ns * 1e-3);
+    if (s->flops > 0 && seconds > 0) {
+        fprintf(fp, " %9.2f", (double)s->flops / seconds * 1e-9);
+    } else {
+        fprintf(fp, " %9s", "-");
+    }
+    if (s->bytes > 0 && seconds > 0) {
+        fprintf(fp, " %9.2f\n", (double)s->bytes / seconds * 1e-9);
+    } else {
+        fprintf(fp, " %9s\n", "-");
+    }
+}
+
+static void dump_header(FILE* fp, const char* title) {
+    fprintf(fp, "%-24s %-28s %10s %11s %10s %10s %10s %10s %9s %9s\n",
+            title, "site", "calls", "total(ms)", "mean(us)", "p50(us)", "p99(us)",
+            "max(us)", "GFLOP/s", "GB/s");
+}
+
+void hal_profile_dump(FILE* fp) {
+    if (!fp) return;
+
+    fprintf(fp, "==== HAL profile ====\n");
+    dump_header(fp, "op");
+    for (size_t op = 0; op < HAL_PROFILE_OP_COUNT; op++) {
+        HalProfileStats stats;
+        hal_profile_get_stats((HalProfileOp)op, &stats);
+        if (stats.calls == 0) continue;
+        dump_row(fp, g_op_names[op], "(all)", &stats);
+    }
+
+    HalProfileSite sites[DUMP_MAX_SITES];
+    size_t count = hal_profile_get_sites(sites, DUMP_MAX_SITES);
+    if (count == 0) return;
+
+    fprintf(fp, "\n");
+    dump_header(fp, "call site");
+    for (size_t i = 0; i < count; i++) {
+        char site[64];
+        format_site(sites[i].site, site, sizeof(site));
+        dump_row(fp, g_op_names[sites[i].op], site, &sites[i].stats);
+    }
+    fflush(fp);
+}
+
+// ---------------------------------------------------------------------------
+// 环境变量控制（由hal_init/hal_cleanup调用）
+// ---------------------------------------------------------------------------
+
+static void dump_pending(void) {
+    if (!g_dump_pending) return;
+    g_dump_pending = 0;
+
+    FILE* fp = stderr;
+    if (g_dump_path) {
+        fp = fopen(g_dump_path, "w");
+        if (!fp) fp = stderr;
+    }
+    hal_profile_dump(fp);
+    if (fp != stderr) fclose(fp);
+}
+
+void hal_profile_init_from_env(HAL_Device* device) {
+    const char* env = getenv(HAL_PROFILE_ENV);
+    if (!env || !*env || strcmp(env, "0") == 0) return;
+    if (hal_profile_enable(device) != 0) return;
+
+    free(g_dump_path);
+    g_dump_path = strcmp(env, "1") == 0 ? NULL : strdup(env);
+    g_dump_pending = 1;
+
+    // 未调用hal_cleanup时在进程退出时输出
+    if (!g_atexit_registered && atexit(dump_pending) == 0) {
+        g_atexit_registered = 1;
+    }
+}
+
+void hal_profile_shutdown(HAL_Device* device) {
+    if (!hal_profile_enabled(device)) return;
+    dump_pending();
+    hal_profile_disable(device);
+}
@@ -0,0 +1,88 @@
+#ifndef HAL_PROFILE_H
+#define HAL_PROFILE_H
+
+#include "hal.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// HAL热路径插桩
+// 启用时把设备函数指针替换为计时包装函数，禁用时恢复原指针，未启用时没有任何额外开销
+// 按调用点（调用指令的返回地址）分别统计调用次数、耗时直方图、浮点运算数和搬运字节数
+
+// 设为1时hal_init对CPU设备启用插桩并在hal_cleanup/进程退出时输出到标准错误，
+// 设为其他非0值时作为输出文件路径
+#define HAL_PROFILE_ENV "LOWMEM_PROFILE"
+
+// 被插桩的操作
+typedef enum {
+    HAL_PROFILE_MATMUL,
+    HAL_PROFILE_MATMUL_BATCHED,
+    HAL_PROFILE_MATMUL_TRANS,
+    HAL_PROFILE_GEMV,
+    HAL_PROFILE_VECTOR_ADD,
+    HAL_PROFILE_MEMCPY_TO_DEVICE,
+    HAL_PROFILE_MEMCPY_FROM_DEVICE,
+    HAL_PROFILE_ALLOCATE,
+    HAL_PROFILE_FREE,
+    HAL_PROFILE_OP_COUNT
+} HalProfileOp;
+
+// 直方图：第i个桶统计耗时在 [2^i, 2^(i+1)) 纳秒内的调用，最后一个桶包含更长的调用
+#define HAL_PROFILE_HIST_BUCKETS 32
+
+// 最多区分的调用点数，超出后计入地址为0的溢出项
+#define HAL_PROFILE_MAX_SITES 1024
+
+// 统计数据
+typedef struct {
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t flops;
+    uint64_t bytes;            // 读写的字节数（分配操作为分配的字节数）
+    uint64_t hist[HAL_PROFILE_HIST_BUCKETS];
+} HalProfileStats;
+
+// 调用点统计
+typedef struct {
+    HalProfileOp op;
+    const void* site;          // 调用点地址，0表示溢出项
+    HalProfileStats stats;
+} HalProfileSite;
+
+// 对设备启用插桩（同一时间只能插桩一个设备），重复启用同一设备直接返回0
+// 启用和禁用时不能有其他线程正在调用该设备的函数
+int hal_profile_enable(HAL_Device* device);
+
+// 恢复设备原来的函数指针（统计数据保留）
+void hal_profile_disable(HAL_Device* device);
+
+// 设备是否正在被插桩
+int hal_profile_enabled(const HAL_Device* device);
+
+// 清空统计数据
+void hal_profile_reset(void);
+
+// 某个操作在所有调用点上的汇总
+void hal_profile_get_stats(HalProfileOp op, HalProfileStats* stats);
+
+// 复制调用点统计，返回写入的数量（按累计耗时从高到低排列）
+size_t hal_profile_get_sites(HalProfileSite* sites, size_t max_sites);
+
+// 由直方图估计的百分位耗时（所在桶的上界，纳秒），pct取0~100
+uint64_t hal_profile_percentile_ns(const HalProfileStats* stats, double pct);
+
+// 操作名称
+const char* hal_profile_op_name(HalProfileOp op);
+
+// 输出汇总表和各调用点的统计
+void hal_profile_dump(FILE* fp);
+
+// 按HAL_PROFILE_ENV启用插桩（hal_init调用）
+void hal_profile_init_from_env(HAL_Device* device);
+
+// 输出环境变量启用时的统计并恢复设备（hal_cleanup调用）
+void hal_profile_shutdown(HAL_Device* device);
+
+#endif // HAL_PROFILE_H
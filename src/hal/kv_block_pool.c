@@ -0,0 +1,152 @@
+#include "kv_block_pool.h"
+#include "hal.h"
+#include "mem_pool.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct KVBlockPool {
+    HAL_Device* device;
+    size_t block_bytes;
+    size_t max_blocks;
+    size_t blocks_per_chunk;
+    void** chunks;             // 预先按上限分配，增长时不移动（kv_block_pool_data不加锁）
+    size_t num_chunks;
+    size_t* free_list;         // 空闲块编号栈
+    size_t num_free;
+    size_t* refcount;          // 每块的引用计数
+    size_t reserved_blocks;
+    size_t used_blocks;
+    size_t peak_used_blocks;
+    size_t alloc_failures;
+    size_t shared_blocks;
+    pthread_mutex_t lock;
+};
+
+static size_t div_round_up(size_t a, size_t b) {
+    return (a + b - 1) / b;
+}
+
+int kv_block_pool_create(KVBlockPool** pool, void* device, size_t block_bytes, size_t max_blocks) {
+    if (!pool || !device || block_bytes == 0 || max_blocks == 0) return -1;
+
+    KVBlockPool* p = (KVBlockPool*)calloc(1, sizeof(KVBlockPool));
+    if (!p) return -1;
+    p->device = (HAL_Device*)device;
+    p->block_bytes = div_round_up(block_bytes, MEM_POOL_ALIGNMENT) * MEM_POOL_ALIGNMENT;
+    p->max_blocks = max_blocks;
+    p->blocks_per_chunk = div_round_up(KV_BLOCK_POOL_CHUNK_BYTES, p->block_bytes);
+    p->chunks = (void**)calloc(div_round_up(max_blocks, p->blocks_per_chunk), sizeof(void*));
+    p->free_list = (size_t*)malloc(max_blocks * sizeof(size_t));
+    p->refcount = (size_t*)calloc(max_blocks, sizeof(size_t));
+    if (!p->chunks || !p->free_list || !p->refcount || pthread_mutex_init(&p->lock, NULL) != 0) {
+        free(p->chunks);
+        free(p->free_list);
+        free(p->refcount);
+        free(p);
+        return -1;
+    }
+    *pool = p;
+    return 0;
+}
+
+void kv_block_pool_destroy(KVBlockPool* pool) {
+    if (!pool) return;
+    for (size_t i = 0; i < pool->num_chunks; i++) {
+        pool->device->free_memory(pool->chunks[i]);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->chunks);
+    free(pool->free_list);
+    free(pool->refcount);
+    free(pool);
+}
+
+// 申请一个新的块组并把其中的块压入空闲栈（调用时持有锁）
+static int grow(KVBlockPool* pool) {
+    size_t count = pool->max_blocks - pool->reserved_blocks;
+    if (count == 0) return -1;
+    if (count > pool->blocks_per_chunk) count = pool->blocks_per_chunk;
+
+    // 块池在解码期间被反复扫描，使用大页减少TLB缺失
+    HAL_Device* device = pool->device;
+    size_t size = count * pool->block_bytes;
+    void* chunk = device->allocate_memory_flags ?
+                  device->allocate_memory_flags(size, HAL_ALLOC_HUGEPAGE) :
+                  device->allocate_memory(size);
+    if (!chunk) return -1;
+
+    size_t first = pool->num_chunks * pool->blocks_per_chunk;
+    pool->chunks[pool->num_chunks++] = chunk;
+    // 逆序压栈，先分配编号小的块
+    for (size_t i = count; i > 0; i--) {
+        pool->free_list[pool->num_free++] = first + i - 1;
+    }
+    pool->reserved_blocks += count;
+    return 0;
+}
+
+int kv_block_pool_alloc(KVBlockPool* pool, size_t* block) {
+    if (!pool || !block) return -1;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->num_free == 0 && grow(pool) != 0) {
+        pool->alloc_failures++;
+        pthread_mutex_unlock(&pool->lock);
+        return -1;
+    }
+    *block = pool->free_list[--pool->num_free];
+    pool->refcount[*block] = 1;
+    pool->used_blocks++;
+    if (pool->used_blocks > pool->peak_used_blocks) pool->peak_used_blocks = pool->used_blocks;
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+void kv_block_pool_free(KVBlockPool* pool, size_t block) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->refcount[block] == 1) pool->shared_blocks--;
+    if (pool->refcount[block] == 0) {
+        pool->free_list[pool->num_free++] = block;
+        pool->used_blocks--;
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void kv_block_pool_ref(KVBlockPool* pool, size_t block) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    if (++pool->refcount[block] == 2) pool->shared_blocks++;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+size_t kv_block_pool_refcount(KVBlockPool* pool, size_t block) {
+    if (!pool) return 0;
+
+    pthread_mutex_lock(&pool->lock);
+    size_t count = pool->refcount[block];
+    pthread_mutex_unlock(&pool->lock);
+    return count;
+}
+
+void* kv_block_pool_data(const KVBlockPool* pool, size_t block) {
+    return (char*)pool->chunks[block / pool->blocks_per_chunk] +
+           (block % pool->blocks_per_chunk) * pool->block_bytes;
+}
+
+void kv_block_pool_get_stats(KVBlockPool* pool, KVBlockPoolStats* stats) {
+    if (!pool || !stats) return;
+
+    pthread_mutex_lock(&pool->lock);
+    stats->block_bytes = pool->block_bytes;
+    stats->max_blocks = pool->max_blocks;
+    stats->reserved_blocks = pool->reserved_blocks;
+    stats->used_blocks = pool->used_blocks;
+    stats->peak_used_blocks = pool->peak_used_blocks;
+    stats->alloc_failures = pool->alloc_failures;
+    stats->shared_blocks = pool->shared_blocks;
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,50 @@
+#ifndef KV_BLOCK_POOL_H
+#define KV_BLOCK_POOL_H
+
+#include <stddef.h>
+
+// KV缓存块池：固定大小的块由所有层和序列共享，按需分配、用完归还
+// 内存按块组（不小于KV_BLOCK_POOL_CHUNK_BYTES）向设备申请，归还的块进入空闲链表复用，
+// 块组直到销毁块池时才释放；分配和归还是线程安全的，kv_block_pool_data不加锁
+// 每块带引用计数（前缀共享时多个序列和前缀缓存引用同一块），计数降为0时才回到空闲链表
+typedef struct KVBlockPool KVBlockPool;
+
+// 块组的最小大小（大页的整数倍）
+#define KV_BLOCK_POOL_CHUNK_BYTES ((size_t)2 << 20)
+
+// 统计信息
+typedef struct {
+    size_t block_bytes;        // 每块字节数
+    size_t max_blocks;         // 块数上限
+    size_t reserved_blocks;    // 已向设备申请内存的块数
+    size_t used_blocks;        // 正在使用的块数
+    size_t peak_used_blocks;   // 使用块数的峰值
+    size_t alloc_failures;     // 达到上限导致分配失败的次数
+    size_t shared_blocks;      // 引用计数大于1的块数
+} KVBlockPoolStats;
+
+// 创建块池，device为HAL_Device*，最多max_blocks块，返回0成功
+int kv_block_pool_create(KVBlockPool** pool, void* device, size_t block_bytes, size_t max_blocks);
+
+// 销毁块池并释放全部块组
+void kv_block_pool_destroy(KVBlockPool* pool);
+
+// 分配一块，块编号写入block，达到上限或内存不足时返回-1
+int kv_block_pool_alloc(KVBlockPool* pool, size_t* block);
+
+// 归还一块（引用计数减1，降为0时回到空闲链表）
+void kv_block_pool_free(KVBlockPool* pool, size_t block);
+
+// 增加一块的引用计数（块已分配），之后每个引用各自调用一次kv_block_pool_free
+void kv_block_pool_ref(KVBlockPool* pool, size_t block);
+
+// 一块的引用计数（未分配为0）
+size_t kv_block_pool_refcount(KVBlockPool* pool, size_t block);
+
+// 块的数据地址（64字节对齐）
+void* kv_block_pool_data(const KVBlockPool* pool, size_t block);
+
+// 获取统计信息
+void kv_block_pool_get_stats(KVBlockPool* pool, KVBlockPoolStats* stats);
+
+#endif // KV_BLOCK_POOL_H
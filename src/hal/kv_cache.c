@@ -1,17 +1,315 @@
 #include "kv_cache.h"
+#include "hal.h"
+#include "mem_pool.h"
+#include "quantization.h"
+#include "fp8.h"
+#include "thread_scratch.h"
+#include <math.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
-// 计算缓存大小
+static size_t row_bytes(const KVCacheConfig* config);
+
+// 计算每个序列每层的缓存大小
 static size_t calculate_cache_size(const KVCacheConfig* config) {
-    return config->batch_size * config->max_seq_length * 
-           config->num_heads * config->head_dim * sizeof(float);
+    return config->max_seq_length * row_bytes(config);
+}
+
+// KV缓存在解码期间被反复整体扫描，使用大页减少TLB缺失
+static void* kv_cache_alloc(HAL_Device* device, size_t size) {
+    if (device->allocate_memory_flags) {
+        return device->allocate_memory_flags(size, HAL_ALLOC_HUGEPAGE);
+    }
+    return device->allocate_memory(size);
+}
+
+static size_t div_round_up(size_t a, size_t b) {
+    return (a + b - 1) / b;
+}
+
+size_t kv_cache_row_bytes(KVCachePrecision precision, size_t row_elems, size_t group_size) {
+    if (precision == KV_CACHE_FP32) return row_elems * sizeof(float);
+    return div_round_up(row_elems, sizeof(float)) * sizeof(float) +
+           row_elems / group_size * sizeof(float);
+}
+
+static size_t quant_group(const KVCacheConfig* config) {
+    return config->quant_group_size ? config->quant_group_size : config->head_dim;
+}
+
+// 每行（一个令牌所有头）的字节数
+static size_t row_bytes(const KVCacheConfig* config) {
+    return kv_cache_row_bytes(config->precision, config->num_heads * config->head_dim,
+                              quant_group(config));
+}
+
+// 把一行float量化为码字和scale（布局见kv_cache.h）
+static void encode_row(const KVCacheConfig* config, const float* in, uint8_t* out) {
+    size_t elems = config->num_heads * config->head_dim;
+    size_t group = quant_group(config);
+    float* scales = (float*)(out + div_round_up(elems, sizeof(float)) * sizeof(float));
+    for (size_t g = 0; g < elems / group; g++) {
+        const float* x = in + g * group;
+        uint8_t* codes = out + g * group;
+        float abs_max = 0.0f;
+        for (size_t i = 0; i < group; i++) {
+            abs_max = fmaxf(abs_max, fabsf(x[i]));
+        }
+        if (config->precision == KV_CACHE_INT8) {
+            QuantConfig qc = { QUANT_TYPE_INT8, 0, 1, 0.0f };
+            QuantParams qp = { abs_max > 0.0f ? abs_max / 127.0f : 1.0f, 128, -abs_max, abs_max };
+            quant_quantize(codes, x, group, &qp, &qc);
+            scales[g] = qp.scale;
+        } else {
+            float scale = abs_max > 0.0f ? abs_max / KV_CACHE_FP8_MAX : 1.0f;
+            float inv = 1.0f / scale;
+            for (size_t i = 0; i < group; i++) {
+                codes[i] = float_to_fp8(x[i] * inv, FP8_E4M3).bits;
+            }
+            scales[g] = scale;
+        }
+    }
+}
+
+// 把一行码字反量化为float
+static void decode_row(const KVCacheConfig* config, const uint8_t* in, float* out) {
+    size_t elems = config->num_heads * config->head_dim;
+    size_t group = quant_group(config);
+    const float* scales = (const float*)(in + div_round_up(elems, sizeof(float)) * sizeof(float));
+    for (size_t g = 0; g < elems / group; g++) {
+        const uint8_t* codes = in + g * group;
+        float* y = out + g * group;
+        if (config->precision == KV_CACHE_INT8) {
+            QuantConfig qc = { QUANT_TYPE_INT8, 0, 1, 0.0f };
+            QuantParams qp = { scales[g], 128, 0.0f, 0.0f };
+            quant_dequantize(y, codes, group, &qp, &qc);
+        } else {
+            for (size_t i = 0; i < group; i++) {
+                FP8 code = { codes[i] };
+                y[i] = fp8_to_float(code, FP8_E4M3) * scales[g];
+            }
+        }
+    }
+}
+
+// 分页模式下每层块表的容量（环形模式的第一块可能只用到后半部分，多留一块）
+static size_t blocks_per_item(const KVCacheConfig* config) {
+    size_t rows = config->max_seq_length + (config->ring_buffer ? config->block_size - 1 : 0);
+    return div_round_up(rows, config->block_size);
+}
+
+// 第idx行key/value的地址
+static char* key_row(const KVCacheManager* manager, const KVCacheItem* item, size_t idx) {
+    size_t rb = row_bytes(&manager->config);
+    if (!manager->block_pool) {
+        return (char*)item->key_cache + (item->head + idx) % manager->config.max_seq_length * rb;
+    }
+    size_t bs = manager->config.block_size;
+    idx += item->block_offset;
+    return (char*)kv_block_pool_data(manager->block_pool, item->block_table[idx / bs]) +
+           (idx % bs) * rb;
+}
+
+static char* value_row(const KVCacheManager* manager, const KVCacheItem* item, size_t idx) {
+    size_t rb = row_bytes(&manager->config);
+    if (!manager->block_pool) {
+        return (char*)item->value_cache + (item->head + idx) % manager->config.max_seq_length * rb;
+    }
+    size_t bs = manager->config.block_size;
+    idx += item->block_offset;
+    return (char*)kv_block_pool_data(manager->block_pool, item->block_table[idx / bs]) +
+           (bs + idx % bs) * rb;
+}
+
+// 第idx行的位置映射
+static size_t* position_slot(const KVCacheManager* manager, const KVCacheItem* item, size_t idx) {
+    return item->token_positions + (item->head + idx) % manager->config.max_seq_length;
+}
+
+// 该层数据是否在设备内存中（未卸载到磁盘）
+static int item_resident(const KVCacheManager* manager, const KVCacheItem* item) {
+    if (!manager->block_pool) return item->key_cache != NULL;
+    return item->num_blocks * manager->config.block_size >= item->block_offset + item->current_length;
+}
+
+// [start, limit) 中从start开始存储连续的行数（不跨越块尾和位置映射的回绕点）
+static size_t item_span(const KVCacheManager* manager, const KVCacheItem* item,
+                        size_t start, size_t limit) {
+    if (start >= limit) return 0;
+    size_t n = limit - start;
+    size_t cap = manager->config.max_seq_length;
+    size_t wrap = cap - (item->head + start) % cap;
+    if (n > wrap) n = wrap;
+    if (manager->block_pool) {
+        size_t bs = manager->config.block_size;
+        size_t block_end = bs - (item->block_offset + start) % bs;
+        if (n > block_end) n = block_end;
+    }
+    return n;
+}
+
+// 前缀树节点：至多一块令牌及其在各层的块（不满一块的节点没有子节点）
+struct KVPrefixNode {
+    struct KVPrefixNode* parent;
+    struct KVPrefixNode* child;     // 第一个子节点
+    struct KVPrefixNode* sibling;   // 下一个兄弟节点
+    size_t num_tokens;              // 本节点的令牌数
+    uint64_t last_used;             // 最近一次命中或登记的时间戳
+    size_t* blocks;                 // 各层的块编号（前缀树各持有一个引用）
+    int32_t* tokens;                // 令牌ID
+};
+
+// 前缀共享状态：块分配（包括命令流线程上的异步加载）可能淘汰前缀，树、时钟和统计由锁保护
+struct KVPrefixCache {
+    struct KVPrefixNode* root;
+    uint64_t clock;                 // LRU时间戳
+    KVPrefixStats stats;
+    pthread_mutex_t lock;
+};
+
+static struct KVPrefixNode* prefix_node_create(const KVCacheManager* manager) {
+    size_t layers = manager->num_items;
+    struct KVPrefixNode* node = (struct KVPrefixNode*)calloc(1, sizeof(struct KVPrefixNode) +
+        layers * sizeof(size_t) + manager->config.block_size * sizeof(int32_t));
+    if (!node) return NULL;
+    node->blocks = (size_t*)(node + 1);
+    node->tokens = (int32_t*)(node->blocks + layers);
+    return node;
+}
+
+// 摘下并释放一个节点及其子树，归还前缀树对块的引用
+static void prefix_node_destroy(KVCacheManager* manager, struct KVPrefixNode* node) {
+    while (node->child) prefix_node_destroy(manager, node->child);
+    if (node->parent) {
+        struct KVPrefixNode** link = &node->parent->child;
+        while (*link != node) link = &(*link)->sibling;
+        *link = node->sibling;
+        for (size_t l = 0; l < manager->num_items; l++) {
+            kv_block_pool_free(manager->block_pool, node->blocks[l]);
+        }
+        manager->prefix->stats.cached_nodes--;
+    }
+    free(node);
+}
+
+// 节点的块是否只被前缀树引用
+static int prefix_node_unused(const KVCacheManager* manager, const struct KVPrefixNode* node) {
+    for (size_t l = 0; l < manager->num_items; l++) {
+        if (kv_block_pool_refcount(manager->block_pool, node->blocks[l]) > 1) return 0;
+    }
+    return 1;
+}
+
+// 在子树中查找最久未使用、且只被前缀树引用的叶子节点
+static void prefix_find_lru(const KVCacheManager* manager, struct KVPrefixNode* node,
+                            struct KVPrefixNode** lru) {
+    for (struct KVPrefixNode* child = node->child; child; child = child->sibling) {
+        if (child->child) {
+            prefix_find_lru(manager, child, lru);
+        } else if ((!*lru || child->last_used < (*lru)->last_used) &&
+                   prefix_node_unused(manager, child)) {
+            *lru = child;
+        }
+    }
+}
+
+// 淘汰一个节点，没有可淘汰的节点时返回-1（调用时持有前缀锁）
+static int prefix_evict_one(KVCacheManager* manager) {
+    struct KVPrefixNode* lru = NULL;
+    prefix_find_lru(manager, manager->prefix->root, &lru);
+    if (!lru) return -1;
+    prefix_node_destroy(manager, lru);
+    manager->prefix->stats.evictions++;
+    return 0;
+}
+
+// 从块池分配一块，块池耗尽时先淘汰前缀树中的前缀再重试
+static int alloc_block(KVCacheManager* manager, size_t* block) {
+    while (kv_block_pool_alloc(manager->block_pool, block) != 0) {
+        if (!manager->prefix) return -1;
+        pthread_mutex_lock(&manager->prefix->lock);
+        int evicted = prefix_evict_one(manager);
+        pthread_mutex_unlock(&manager->prefix->lock);
+        if (evicted != 0) return -1;
+    }
+    return 0;
+}
+
+// 写时复制：第b块被共享时换成一份私有的拷贝
+static int own_block(KVCacheManager* manager, KVCacheItem* item, size_t b) {
+    KVBlockPool* pool = manager->block_pool;
+    if (!manager->prefix || kv_block_pool_refcount(pool, item->block_table[b]) <= 1) return 0;
+    
+    size_t block;
+    if (alloc_block(manager, &block) != 0) return -1;
+    HAL_Device* device = (HAL_Device*)manager->device;
+    device->memcpy_to_device(kv_block_pool_data(pool, block),
+                             kv_block_pool_data(pool, item->block_table[b]),
+                             2 * manager->config.block_size * row_bytes(&manager->config));
+    kv_block_pool_free(pool, item->block_table[b]);
+    item->block_table[b] = block;
+    pthread_mutex_lock(&manager->prefix->lock);
+    manager->prefix->stats.cow_copies++;
+    pthread_mutex_unlock(&manager->prefix->lock);
+    return 0;
+}
+
+// 改写第first块及之后的块之前确保它们都是私有的
+static int own_blocks(KVCacheManager* manager, KVCacheItem* item, size_t first) {
+    for (size_t b = first; b < item->num_blocks; b++) {
+        if (own_block(manager, item, b) != 0) return -1;
+    }
+    return 0;
+}
+
+// 只保留容纳前rows行所需的块，其余归还
+static void release_blocks(KVCacheManager* manager, KVCacheItem* item, size_t rows) {
+    size_t keep = rows ? div_round_up(item->block_offset + rows, manager->config.block_size) : 0;
+    while (item->num_blocks > keep) {
+        kv_block_pool_free(manager->block_pool, item->block_table[--item->num_blocks]);
+    }
+    if (keep == 0) item->block_offset = 0;
+}
+
+// 分配块直到能容纳rows行
+static int reserve_blocks(KVCacheManager* manager, KVCacheItem* item, size_t rows) {
+    size_t need = div_round_up(item->block_offset + rows, manager->config.block_size);
+    while (item->num_blocks < need) {
+        if (alloc_block(manager, &item->block_table[item->num_blocks]) != 0) {
+            return -1;
+        }
+        item->num_blocks++;
+    }
+    return 0;
+}
+
+// 在 [0, length) 行的key（value非0时为value）与连续的主机缓冲区之间复制
+static void copy_rows(KVCacheManager* manager, KVCacheItem* item, size_t length,
+                      int value, void* host, int to_device) {
+    HAL_Device* device = (HAL_Device*)manager->device;
+    size_t rb = row_bytes(&manager->config);
+    for (size_t start = 0, n; start < length; start += n) {
+        n = item_span(manager, item, start, length);
+        char* rows = value ? value_row(manager, item, start) : key_row(manager, item, start);
+        char* buf = (char*)host + start * rb;
+        if (to_device) {
+            device->memcpy_to_device(rows, buf, n * rb);
+        } else {
+            device->memcpy_from_device(buf, rows, n * rb);
+        }
+    }
 }
 
 // 初始化KV缓存管理器
 int kv_cache_init(KVCacheManager** manager, const KVCacheConfig* config, void* device) {
     if (!manager || !config || !device) return -1;
+    if (config->prefix_cache && config->block_size == 0) return -1;
+    if (config->precision != KV_CACHE_FP32 &&
+        (config->num_heads * config->head_dim) % quant_group(config) != 0) {
+        return -1;
+    }
     
     *manager = (KVCacheManager*)malloc(sizeof(KVCacheManager));
     if (!*manager) return -1;
@@ -20,24 +318,56 @@ int kv_cache_init(KVCacheManager** manager, const KVCacheConfig* config, void* d
     memcpy(&(*manager)->config, config, sizeof(KVCacheConfig));
     (*manager)->device = device;
     
-    // 分配每层的缓存项
+    // 分配每个序列每层的缓存项
     (*manager)->num_items = config->num_layers;
-    (*manager)->items = (KVCacheItem**)malloc(sizeof(KVCacheItem*) * config->num_layers);
-    if (!(*manager)->items) {
-        free(*manager);
-        return -1;
+    (*manager)->num_seqs = config->batch_size > 0 ? config->batch_size : 1;
+    size_t total_items = (*manager)->num_seqs * config->num_layers;
+    (*manager)->items = (KVCacheItem**)calloc(total_items, sizeof(KVCacheItem*));
+    (*manager)->seq_active = (unsigned char*)calloc((*manager)->num_seqs, 1);
+    (*manager)->block_pool = NULL;
+    (*manager)->prefix = NULL;
+    if (!(*manager)->items || !(*manager)->seq_active) goto cleanup;
+    
+    // 槽位0供不带序列号的接口使用
+    (*manager)->seq_active[0] = 1;
+    
+    // 分页模式：所有序列和层共享一个块池，默认上限与连续模式的总容量相同
+    if (config->block_size > 0) {
+        size_t max_blocks = config->max_blocks;
+        if (max_blocks == 0) {
+            max_blocks = total_items * blocks_per_item(config);
+        }
+        if (kv_block_pool_create(&(*manager)->block_pool, device,
+                                 2 * config->block_size * row_bytes(config), max_blocks) != 0) {
+            goto cleanup;
+        }
+    }
+    
+    // 前缀树的根节点不对应任何令牌
+    if (config->prefix_cache) {
+        (*manager)->prefix = (struct KVPrefixCache*)calloc(1, sizeof(struct KVPrefixCache));
+        if (!(*manager)->prefix) goto cleanup;
+        pthread_mutex_init(&(*manager)->prefix->lock, NULL);
+        (*manager)->prefix->root = prefix_node_create(*manager);
+        if (!(*manager)->prefix->root) goto cleanup;
     }
     
     // 初始化每层的缓存
     size_t cache_size = calculate_cache_size(config);
-    for (size_t i = 0; i < config->num_layers; i++) {
-        (*manager)->items[i] = (KVCacheItem*)malloc(sizeof(KVCacheItem));
+    for (size_t i = 0; i < total_items; i++) {
+        (*manager)->items[i] = (KVCacheItem*)calloc(1, sizeof(KVCacheItem));
         if (!(*manager)->items[i]) goto cleanup;
         
-        // 分配key和value缓存
-        (*manager)->items[i]->key_cache = ((HAL_Device*)device)->allocate_memory(cache_size);
-        (*manager)->items[i]->value_cache = ((HAL_Device*)device)->allocate_memory(cache_size);
-        if (!(*manager)->items[i]->key_cache || !(*manager)->items[i]->value_cache) goto cleanup;
+        if ((*manager)->block_pool) {
+            // 分配块表，块在追加时按需分配
+            (*manager)->items[i]->block_table = (size_t*)malloc(sizeof(size_t) * blocks_per_item(config));
+            if (!(*manager)->items[i]->block_table) goto cleanup;
+        } else {
+            // 分配key和value缓存
+            (*manager)->items[i]->key_cache = kv_cache_alloc((HAL_Device*)device, cache_size);
+            (*manager)->items[i]->value_cache = kv_cache_alloc((HAL_Device*)device, cache_size);
+            if (!(*manager)->items[i]->key_cache || !(*manager)->items[i]->value_cache) goto cleanup;
+        }
         
         // 分配位置映射
         (*manager)->items[i]->token_positions = (size_t*)malloc(sizeof(size_t) * config->max_seq_length);
@@ -59,7 +389,7 @@ void kv_cache_cleanup(KVCacheManager* manager) {
     if (!manager) return;
     
     if (manager->items) {
-        for (size_t i = 0; i < manager->num_items; i++) {
+        for (size_t i = 0; i < manager->num_seqs * manager->num_items; i++) {
             if (manager->items[i]) {
                 HAL_Device* device = (HAL_Device*)manager->device;
                 if (manager->items[i]->key_cache)
@@ -68,49 +398,190 @@ void kv_cache_cleanup(KVCacheManager* manager) {
                     device->free_memory(manager->items[i]->value_cache);
                 if (manager->items[i]->token_positions)
                     free(manager->items[i]->token_positions);
+                free(manager->items[i]->block_table);
                 free(manager->items[i]);
             }
         }
         free(manager->items);
     }
     
+    free(manager->seq_active);
+    if (manager->prefix) {
+        if (manager->prefix->root) prefix_node_destroy(manager, manager->prefix->root);
+        pthread_mutex_destroy(&manager->prefix->lock);
+        free(manager->prefix);
+    }
+    kv_block_pool_destroy(manager->block_pool);
     free(manager);
 }
 
+// 释放连续模式的K/V缓冲区
+static void free_item_buffers(KVCacheManager* manager, KVCacheItem* item) {
+    HAL_Device* device = (HAL_Device*)manager->device;
+    if (item->key_cache) device->free_memory(item->key_cache);
+    if (item->value_cache) device->free_memory(item->value_cache);
+    item->key_cache = NULL;
+    item->value_cache = NULL;
+}
+
+// 清空一个缓存项（保留连续模式的缓冲区，归还分页模式的块）
+static void reset_item(KVCacheManager* manager, KVCacheItem* item) {
+    if (manager->block_pool) release_blocks(manager, item, 0);
+    item->current_length = 0;
+    item->head = 0;
+}
+
+// 序列seq_idx第layer_idx层的缓存项，越界或槽位未使用时返回NULL
+static KVCacheItem* get_item(const KVCacheManager* manager, size_t seq_idx, size_t layer_idx) {
+    if (!manager || seq_idx >= manager->num_seqs || layer_idx >= manager->num_items ||
+        !manager->seq_active[seq_idx]) {
+        return NULL;
+    }
+    return manager->items[seq_idx * manager->num_items + layer_idx];
+}
+
 // 重置缓存
 void kv_cache_reset(KVCacheManager* manager) {
     if (!manager) return;
     
-    for (size_t i = 0; i < manager->num_items; i++) {
-        if (manager->items[i]) {
-            manager->items[i]->current_length = 0;
+    for (size_t i = 0; i < manager->num_seqs * manager->num_items; i++) {
+        if (manager->items[i]) reset_item(manager, manager->items[i]);
+    }
+}
+
+int kv_cache_add_sequence(KVCacheManager* manager, size_t* seq_idx) {
+    if (!manager || !seq_idx) return -1;
+    
+    for (size_t s = 0; s < manager->num_seqs; s++) {
+        if (manager->seq_active[s]) continue;
+        
+        // 连续模式的缓冲区可能随上一个使用者卸载到磁盘，重新分配
+        HAL_Device* device = (HAL_Device*)manager->device;
+        size_t cache_size = calculate_cache_size(&manager->config);
+        for (size_t l = 0; l < manager->num_items; l++) {
+            KVCacheItem* item = manager->items[s * manager->num_items + l];
+            reset_item(manager, item);
+            if (manager->block_pool || (item->key_cache && item->value_cache)) continue;
+            free_item_buffers(manager, item);
+            item->key_cache = kv_cache_alloc(device, cache_size);
+            item->value_cache = kv_cache_alloc(device, cache_size);
+            if (!item->key_cache || !item->value_cache) {
+                // 撤销本槽位的分配，槽位保持空闲，下次分配时重新申请
+                for (size_t j = 0; j <= l; j++) {
+                    free_item_buffers(manager, manager->items[s * manager->num_items + j]);
+                }
+                return -1;
+            }
         }
+        manager->seq_active[s] = 1;
+        *seq_idx = s;
+        return 0;
     }
+    return -1;
 }
 
-// 添加KV到缓存
-int kv_cache_append(KVCacheManager* manager, 
-                   size_t layer_idx,
-                   const void* key, 
-                   const void* value,
-                   size_t seq_idx) {
-    if (!manager || layer_idx >= manager->num_items || !key || !value) return -1;
+int kv_cache_release_sequence(KVCacheManager* manager, size_t seq_idx) {
+    if (!get_item(manager, seq_idx, 0)) return -1;
     
-    KVCacheItem* item = manager->items[layer_idx];
+    for (size_t l = 0; l < manager->num_items; l++) {
+        reset_item(manager, manager->items[seq_idx * manager->num_items + l]);
+    }
+    manager->seq_active[seq_idx] = 0;
+    return 0;
+}
+
+size_t kv_cache_seq_length(const KVCacheManager* manager, size_t seq_idx, size_t layer_idx) {
+    const KVCacheItem* item = get_item(manager, seq_idx, layer_idx);
+    return item ? item->current_length : 0;
+}
+
+// 检查能否追加一行，分页模式预先分配所需的块
+static int prepare_append(KVCacheManager* manager, KVCacheItem* item) {
     if (!item || item->current_length >= manager->config.max_seq_length) return -1;
+    if (!item_resident(manager, item)) return -1;
     
+    // 分页模式：写满当前块时从块池取新块，写入共享的块之前先复制
+    if (manager->block_pool) {
+        if (reserve_blocks(manager, item, item->current_length + 1) != 0) return -1;
+        return own_block(manager, item,
+                         (item->block_offset + item->current_length) / manager->config.block_size);
+    }
+    return 0;
+}
+
+// 写入一行（已经过prepare_append），量化模式使用temp作为一行的临时区
+static void append_row(KVCacheManager* manager, KVCacheItem* item, const void* key,
+                       const void* value, size_t position, uint8_t* temp) {
     HAL_Device* device = (HAL_Device*)manager->device;
-    size_t offset = item->current_length * manager->config.num_heads * manager->config.head_dim;
-    size_t size = manager->config.num_heads * manager->config.head_dim * sizeof(float);
+    size_t size = row_bytes(&manager->config);
     
-    // 复制key和value到缓存
-    device->memcpy_to_device((char*)item->key_cache + offset * sizeof(float), key, size);
-    device->memcpy_to_device((char*)item->value_cache + offset * sizeof(float), value, size);
+    if (!temp) {
+        // 复制key和value到缓存
+        device->memcpy_to_device(key_row(manager, item, item->current_length), key, size);
+        device->memcpy_to_device(value_row(manager, item, item->current_length), value, size);
+    } else {
+        // 量化后写入缓存
+        encode_row(&manager->config, (const float*)key, temp);
+        device->memcpy_to_device(key_row(manager, item, item->current_length), temp, size);
+        encode_row(&manager->config, (const float*)value, temp);
+        device->memcpy_to_device(value_row(manager, item, item->current_length), temp, size);
+    }
     
     // 更新位置映射
-    item->token_positions[item->current_length] = seq_idx;
+    *position_slot(manager, item, item->current_length) = position;
     item->current_length++;
+}
+
+// 添加KV到缓存
+int kv_cache_append(KVCacheManager* manager, 
+                   size_t layer_idx,
+                   const void* key, 
+                   const void* value,
+                   size_t position) {
+    return kv_cache_append_seq(manager, 0, layer_idx, key, value, position);
+}
+
+int kv_cache_append_seq(KVCacheManager* manager, size_t seq_idx, size_t layer_idx,
+                        const void* key, const void* value, size_t position) {
+    return kv_cache_append_batch(manager, layer_idx, &seq_idx, 1, key, value, &position);
+}
+
+int kv_cache_append_batch(KVCacheManager* manager, size_t layer_idx,
+                          const size_t* seq_indices, size_t num_seqs,
+                          const void* keys, const void* values, const size_t* positions) {
+    if (!manager || !seq_indices || !keys || !values || !positions) return -1;
+    
+    // 每个序列只预留了一行，重复的序列号会越过预留的块或容量
+    for (size_t i = 0; i < num_seqs; i++) {
+        for (size_t j = 0; j < i; j++) {
+            if (seq_indices[j] == seq_indices[i]) return -1;
+        }
+    }
+    
+    // 先检查所有序列并分配块，失败时归还已预留的块，不写入任何一行
+    size_t prepared = 0;
+    while (prepared < num_seqs &&
+           prepare_append(manager, get_item(manager, seq_indices[prepared], layer_idx)) == 0) {
+        prepared++;
+    }
     
+    uint8_t* temp = NULL;
+    if (prepared == num_seqs && manager->config.precision != KV_CACHE_FP32) {
+        temp = (uint8_t*)thread_scratch(SCRATCH_KV_ROW, row_bytes(&manager->config));
+    }
+    if (prepared < num_seqs || (manager->config.precision != KV_CACHE_FP32 && !temp)) {
+        // 失败的序列也可能已分配了块
+        for (size_t i = 0; manager->block_pool && i <= prepared && i < num_seqs; i++) {
+            KVCacheItem* item = get_item(manager, seq_indices[i], layer_idx);
+            if (item) release_blocks(manager, item, item->current_length);
+        }
+        return -1;
+    }
+    size_t row = manager->config.num_heads * manager->config.head_dim * sizeof(float);
+    for (size_t i = 0; i < num_seqs; i++) {
+        append_row(manager, get_item(manager, seq_indices[i], layer_idx),
+                   (const char*)keys + i * row, (const char*)values + i * row, positions[i], temp);
+    }
     return 0;
 }
 
@@ -121,146 +592,373 @@ int kv_cache_lookup(KVCacheManager* manager,
                    void* value_out,
                    const size_t* positions,
                    size_t num_positions) {
-    if (!manager || layer_idx >= manager->num_items || !key_out || !value_out || !positions) return -1;
+    return kv_cache_lookup_seq(manager, 0, layer_idx, key_out, value_out, positions, num_positions);
+}
+
+int kv_cache_lookup_seq(KVCacheManager* manager, size_t seq_idx, size_t layer_idx,
+                        void* key_out, void* value_out,
+                        const size_t* positions, size_t num_positions) {
+    if (!key_out || !value_out || !positions) return -1;
     
-    KVCacheItem* item = manager->items[layer_idx];
-    if (!item) return -1;
+    KVCacheItem* item = get_item(manager, seq_idx, layer_idx);
+    if (!item || !item_resident(manager, item)) return -1;
     
     HAL_Device* device = (HAL_Device*)manager->device;
     size_t head_size = manager->config.num_heads * manager->config.head_dim * sizeof(float);
+    size_t size = row_bytes(&manager->config);
+    uint8_t* temp = NULL;
+    if (manager->config.precision != KV_CACHE_FP32) {
+        temp = (uint8_t*)thread_scratch(SCRATCH_KV_ROW, size);
+        if (!temp) return -1;
+    }
     
-    // 收集请求的位置的KV
+    // 收集请求的位置的KV，量化模式先取出码字再反量化
     for (size_t i = 0; i < num_positions; i++) {
         if (positions[i] >= item->current_length) return -1;
         
-        size_t offset = positions[i] * head_size;
-        device->memcpy_from_device((char*)key_out + i * head_size,
-                                 (char*)item->key_cache + offset, head_size);
-        device->memcpy_from_device((char*)value_out + i * head_size,
-                                 (char*)item->value_cache + offset, head_size);
+        char* k_out = (char*)key_out + i * head_size;
+        char* v_out = (char*)value_out + i * head_size;
+        if (!temp) {
+            device->memcpy_from_device(k_out, key_row(manager, item, positions[i]), head_size);
+            device->memcpy_from_device(v_out, value_row(manager, item, positions[i]), head_size);
+            continue;
+        }
+        device->memcpy_from_device(temp, key_row(manager, item, positions[i]), size);
+        decode_row(&manager->config, temp, (float*)k_out);
+        device->memcpy_from_device(temp, value_row(manager, item, positions[i]), size);
+        decode_row(&manager->config, temp, (float*)v_out);
+    }
+    
+    return 0;
+}
+
+size_t kv_cache_span(KVCacheManager* manager,
+                    size_t layer_idx,
+                    size_t start,
+                    const void** key,
+                    const void** value,
+                    const size_t** positions) {
+    return kv_cache_span_seq(manager, 0, layer_idx, start, key, value, positions);
+}
+
+size_t kv_cache_span_seq(KVCacheManager* manager, size_t seq_idx, size_t layer_idx, size_t start,
+                         const void** key, const void** value, const size_t** positions) {
+    if (!key || !value) return 0;
+    
+    KVCacheItem* item = get_item(manager, seq_idx, layer_idx);
+    if (!item || !item_resident(manager, item)) return 0;
+    
+    size_t n = item_span(manager, item, start, item->current_length);
+    if (n == 0) return 0;
+    *key = key_row(manager, item, start);
+    *value = value_row(manager, item, start);
+    if (positions) *positions = position_slot(manager, item, start);
+    return n;
+}
+
+int kv_cache_get_pool_stats(KVCacheManager* manager, KVBlockPoolStats* stats) {
+    if (!manager || !stats || !manager->block_pool) return -1;
+    kv_block_pool_get_stats(manager->block_pool, stats);
+    return 0;
+}
+
+// tokens与节点令牌的公共前缀长度（至多n）
+static size_t prefix_match(const struct KVPrefixNode* node, const int32_t* tokens, size_t n) {
+    if (n > node->num_tokens) n = node->num_tokens;
+    size_t i = 0;
+    while (i < n && node->tokens[i] == tokens[i]) i++;
+    return i;
+}
+
+int kv_cache_prefix_attach(KVCacheManager* manager, size_t seq_idx,
+                           const int32_t* tokens, size_t num_tokens, size_t* matched) {
+    if (!manager || !manager->prefix || (!tokens && num_tokens) || !matched) return -1;
+    for (size_t l = 0; l < manager->num_items; l++) {
+        KVCacheItem* item = get_item(manager, seq_idx, l);
+        if (!item || item->current_length || item->num_blocks) return -1;
+    }
+    if (num_tokens > manager->config.max_seq_length) num_tokens = manager->config.max_seq_length;
+    
+    // 逐块沿前缀树下行，每层取公共前缀最长的子节点，部分匹配的块由后续追加触发写时复制
+    size_t bs = manager->config.block_size;
+    pthread_mutex_lock(&manager->prefix->lock);
+    uint64_t now = ++manager->prefix->clock;
+    struct KVPrefixNode* node = manager->prefix->root;
+    size_t count = 0;
+    while (count < num_tokens) {
+        size_t n = num_tokens - count < bs ? num_tokens - count : bs;
+        struct KVPrefixNode* best = NULL;
+        size_t best_len = 0;
+        for (struct KVPrefixNode* child = node->child; child; child = child->sibling) {
+            size_t len = prefix_match(child, tokens + count, n);
+            if (len > best_len) {
+                best = child;
+                best_len = len;
+            }
+        }
+        if (!best) break;
+        
+        best->last_used = now;
+        for (size_t l = 0; l < manager->num_items; l++) {
+            KVCacheItem* item = manager->items[seq_idx * manager->num_items + l];
+            kv_block_pool_ref(manager->block_pool, best->blocks[l]);
+            item->block_table[item->num_blocks++] = best->blocks[l];
+        }
+        count += best_len;
+        if (best_len < bs) break;
+        node = best;
     }
     
+    for (size_t l = 0; l < manager->num_items; l++) {
+        KVCacheItem* item = manager->items[seq_idx * manager->num_items + l];
+        item->head = 0;
+        item->block_offset = 0;
+        for (size_t i = 0; i < count; i++) item->token_positions[i] = i;
+        item->current_length = count;
+    }
+    
+    manager->prefix->stats.lookups++;
+    manager->prefix->stats.hit_tokens += count;
+    manager->prefix->stats.miss_tokens += num_tokens - count;
+    pthread_mutex_unlock(&manager->prefix->lock);
+    *matched = count;
+    return 0;
+}
+
+int kv_cache_prefix_insert(KVCacheManager* manager, size_t seq_idx,
+                           const int32_t* tokens, size_t num_tokens) {
+    if (!manager || !manager->prefix || (!tokens && num_tokens)) return -1;
+    
+    // 只登记所有层都已计算、且第i行位置为i的令牌
+    size_t count = num_tokens;
+    for (size_t l = 0; l < manager->num_items; l++) {
+        KVCacheItem* item = get_item(manager, seq_idx, l);
+        if (!item || !item_resident(manager, item) || item->block_offset) return -1;
+        if (item->current_length < count) count = item->current_length;
+    }
+    for (size_t l = 0; l < manager->num_items; l++) {
+        KVCacheItem* item = manager->items[seq_idx * manager->num_items + l];
+        for (size_t i = 0; i < count; i++) {
+            if (*position_slot(manager, item, i) != i) return -1;
+        }
+    }
+    
+    size_t bs = manager->config.block_size;
+    int ret = 0;
+    pthread_mutex_lock(&manager->prefix->lock);
+    uint64_t now = ++manager->prefix->clock;
+    struct KVPrefixNode* node = manager->prefix->root;
+    for (size_t start = 0; start < count; start += bs) {
+        size_t n = count - start < bs ? count - start : bs;
+        const int32_t* chunk = tokens + start;
+        
+        // 已有覆盖这些令牌的节点时沿用，被本块覆盖的不满一块的节点由本块取代
+        struct KVPrefixNode* found = NULL;
+        struct KVPrefixNode* next;
+        for (struct KVPrefixNode* child = node->child; child; child = next) {
+            next = child->sibling;
+            size_t len = prefix_match(child, chunk, n);
+            if (len == n) {
+                found = child;
+                break;
+            }
+            if (len == child->num_tokens) prefix_node_destroy(manager, child);
+        }
+        
+        if (!found) {
+            found = prefix_node_create(manager);
+            if (!found) {
+                ret = -1;
+                break;
+            }
+            found->parent = node;
+            found->sibling = node->child;
+            node->child = found;
+            found->num_tokens = n;
+            memcpy(found->tokens, chunk, n * sizeof(int32_t));
+            for (size_t l = 0; l < manager->num_items; l++) {
+                KVCacheItem* item = manager->items[seq_idx * manager->num_items + l];
+                found->blocks[l] = item->block_table[start / bs];
+                kv_block_pool_ref(manager->block_pool, found->blocks[l]);
+            }
+            manager->prefix->stats.cached_nodes++;
+        }
+        found->last_used = now;
+        if (n < bs) break;
+        node = found;
+    }
+    pthread_mutex_unlock(&manager->prefix->lock);
+    return ret;
+}
+
+size_t kv_cache_prefix_evict(KVCacheManager* manager, size_t max_nodes) {
+    if (!manager || !manager->prefix) return 0;
+    size_t count = 0;
+    pthread_mutex_lock(&manager->prefix->lock);
+    while (count < max_nodes && prefix_evict_one(manager) == 0) count++;
+    pthread_mutex_unlock(&manager->prefix->lock);
+    return count;
+}
+
+int kv_cache_get_prefix_stats(KVCacheManager* manager, KVPrefixStats* stats) {
+    if (!manager || !stats || !manager->prefix) return -1;
+    pthread_mutex_lock(&manager->prefix->lock);
+    *stats = manager->prefix->stats;
+    pthread_mutex_unlock(&manager->prefix->lock);
     return 0;
 }
 
+// 归还最前面的count块
+static void drop_blocks(KVCacheManager* manager, KVCacheItem* item, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        kv_block_pool_free(manager->block_pool, item->block_table[i]);
+    }
+    memmove(item->block_table, item->block_table + count,
+            (item->num_blocks - count) * sizeof(size_t));
+    item->num_blocks -= count;
+}
+
 // 缓存旋转
 int kv_cache_rotate(KVCacheManager* manager,
                    size_t layer_idx,
                    size_t rotation_offset) {
-    if (!manager || layer_idx >= manager->num_items) return -1;
-    
-    KVCacheItem* item = manager->items[layer_idx];
+    return kv_cache_rotate_seq(manager, 0, layer_idx, rotation_offset);
+}
+
+int kv_cache_rotate_seq(KVCacheManager* manager, size_t seq_idx, size_t layer_idx,
+                        size_t rotation_offset) {
+    KVCacheItem* item = get_item(manager, seq_idx, layer_idx);
     if (!item || rotation_offset >= item->current_length) return -1;
+    if (!item_resident(manager, item)) return -1;
     
     HAL_Device* device = (HAL_Device*)manager->device;
-    size_t head_size = manager->config.num_heads * manager->config.head_dim * sizeof(float);
-    size_t move_size = (item->current_length - rotation_offset) * head_size;
-    
-    // 移动key缓存
-    void* temp = malloc(move_size);
-    if (!temp) return -1;
+    size_t head_size = row_bytes(&manager->config);
+    size_t remaining = item->current_length - rotation_offset;
     
-    device->memcpy_from_device(temp, (char*)item->key_cache + rotation_offset * head_size, move_size);
-    device->memcpy_to_device(item->key_cache, temp, move_size);
-    
-    // 移动value缓存
-    device->memcpy_from_device(temp, (char*)item->value_cache + rotation_offset * head_size, move_size);
-    device->memcpy_to_device(item->value_cache, temp, move_size);
+    if (manager->config.ring_buffer) {
+        // 环形模式只移动起点，分页模式归还已整块移出窗口的块
+        item->head = (item->head + rotation_offset) % manager->config.max_seq_length;
+        if (manager->block_pool) {
+            item->block_offset += rotation_offset;
+            drop_blocks(manager, item, item->block_offset / manager->config.block_size);
+            item->block_offset %= manager->config.block_size;
+        }
+        item->current_length = remaining;
+        return 0;
+    }
     
-    free(temp);
+    if (manager->block_pool) {
+        // 整块丢弃只需移动块表，剩余不足一块的偏移逐行前移
+        size_t shift = rotation_offset % manager->config.block_size;
+        if (shift && own_blocks(manager, item, rotation_offset / manager->config.block_size) != 0) {
+            return -1;
+        }
+        drop_blocks(manager, item, rotation_offset / manager->config.block_size);
+        if (shift) {
+            for (size_t i = 0; i < remaining; i++) {
+                device->memcpy_to_device(key_row(manager, item, i),
+                                       key_row(manager, item, i + shift), head_size);
+                device->memcpy_to_device(value_row(manager, item, i),
+                                       value_row(manager, item, i + shift), head_size);
+            }
+            release_blocks(manager, item, remaining);
+        }
+    } else {
+        size_t move_size = remaining * head_size;
+        
+        // 移动key缓存
+        void* temp = malloc(move_size);
+        if (!temp) return -1;
+        
+        device->memcpy_from_device(temp, (char*)item->key_cache + rotation_offset * head_size, move_size);
+        device->memcpy_to_device(item->key_cache, temp, move_size);
+        
+        // 移动value缓存
+        device->memcpy_from_device(temp, (char*)item->value_cache + rotation_offset * head_size, move_size);
+        device->memcpy_to_device(item->value_cache, temp, move_size);
+        
+        free(temp);
+    }
     
     // 更新位置映射
     memmove(item->token_positions, 
             item->token_positions + rotation_offset,
-            (item->current_length - rotation_offset) * sizeof(size_t));
-    item->current_length -= rotation_offset;
+            remaining * sizeof(size_t));
+    item->current_length = remaining;
     
     return 0;
 }
 
-// 缓存压缩
+// 缓存压缩：有效行原地前移，分页模式归还多余的块
 int kv_cache_compact(KVCacheManager* manager, size_t layer_idx) {
-    if (!manager || layer_idx >= manager->num_items) return -1;
-    
-    KVCacheItem* item = manager->items[layer_idx];
-    if (!item) return -1;
+    return kv_cache_compact_seq(manager, 0, layer_idx);
+}
+
+int kv_cache_compact_seq(KVCacheManager* manager, size_t seq_idx, size_t layer_idx) {
+    KVCacheItem* item = get_item(manager, seq_idx, layer_idx);
+    if (!item || !item_resident(manager, item)) return -1;
     
-    // 标记有效位置
-    char* valid = (char*)calloc(item->current_length, sizeof(char));
-    if (!valid) return -1;
+    HAL_Device* device = (HAL_Device*)manager->device;
+    size_t head_size = row_bytes(&manager->config);
     
-    size_t valid_count = 0;
-    for (size_t i = 0; i < item->current_length; i++) {
-        if (item->token_positions[i] != (size_t)-1) {
-            valid[i] = 1;
-            valid_count++;
+    // 从第一个无效行所在的块开始改写
+    if (manager->block_pool) {
+        size_t first = 0;
+        while (first < item->current_length && *position_slot(manager, item, first) != (size_t)-1) {
+            first++;
+        }
+        if (first < item->current_length &&
+            own_blocks(manager, item, (item->block_offset + first) / manager->config.block_size) != 0) {
+            return -1;
         }
-    }
-    
-    if (valid_count == item->current_length) {
-        free(valid);
-        return 0;  // 无需压缩
-    }
-    
-    // 创建新的缓存
-    HAL_Device* device = (HAL_Device*)manager->device;
-    size_t head_size = manager->config.num_heads * manager->config.head_dim * sizeof(float);
-    void* new_key_cache = device->allocate_memory(valid_count * head_size);
-    void* new_value_cache = device->allocate_memory(valid_count * head_size);
-    if (!new_key_cache || !new_value_cache) {
-        if (new_key_cache) device->free_memory(new_key_cache);
-        if (new_value_cache) device->free_memory(new_value_cache);
-        free(valid);
-        return -1;
     }
     
     // 复制有效数据
     size_t new_idx = 0;
     for (size_t i = 0; i < item->current_length; i++) {
-        if (valid[i]) {
-            device->memcpy_to_device((char*)new_key_cache + new_idx * head_size,
-                                   (char*)item->key_cache + i * head_size, head_size);
-            device->memcpy_to_device((char*)new_value_cache + new_idx * head_size,
-                                   (char*)item->value_cache + i * head_size, head_size);
-            item->token_positions[new_idx] = item->token_positions[i];
-            new_idx++;
+        size_t pos = *position_slot(manager, item, i);
+        if (pos == (size_t)-1) continue;
+        if (new_idx != i) {
+            device->memcpy_to_device(key_row(manager, item, new_idx),
+                                   key_row(manager, item, i), head_size);
+            device->memcpy_to_device(value_row(manager, item, new_idx),
+                                   value_row(manager, item, i), head_size);
+            *position_slot(manager, item, new_idx) = pos;
         }
+        new_idx++;
     }
     
-    // 更新缓存
-    device->free_memory(item->key_cache);
-    device->free_memory(item->value_cache);
-    item->key_cache = new_key_cache;
-    item->value_cache = new_value_cache;
-    item->current_length = valid_count;
+    if (new_idx == item->current_length) return 0;  // 无需压缩
     
-    free(valid);
+    item->current_length = new_idx;
+    if (manager->block_pool) release_blocks(manager, item, new_idx);
     return 0;
 }
 
-// 磁盘卸载
-int kv_cache_offload(KVCacheManager* manager,
-                    size_t layer_idx,
-                    const char* cache_dir) {
-    if (!manager || layer_idx >= manager->num_items || !cache_dir) return -1;
-    
-    KVCacheItem* item = manager->items[layer_idx];
-    if (!item) return -1;
-    
-    char filename[256];
-    snprintf(filename, sizeof(filename), "%s/layer_%zu_kv_cache.bin", cache_dir, layer_idx);
-    
+// 序列seq_idx第layer_idx层的卸载文件名（序列0沿用单序列时的文件名）
+static int item_filename(char* filename, size_t size, const char* cache_dir,
+                         size_t seq_idx, size_t layer_idx) {
+    int n = seq_idx == 0 ?
+            snprintf(filename, size, "%s/layer_%zu_kv_cache.bin", cache_dir, layer_idx) :
+            snprintf(filename, size, "%s/layer_%zu_seq_%zu_kv_cache.bin", cache_dir, layer_idx, seq_idx);
+    return (n < 0 || (size_t)n >= size) ? -1 : 0;
+}
+
+// 卸载一个缓存项
+static int offload_item(KVCacheManager* manager, KVCacheItem* item, const char* filename) {
     FILE* fp = fopen(filename, "wb");
     if (!fp) return -1;
     
     // 写入元数据
     fwrite(&item->current_length, sizeof(size_t), 1, fp);
-    fwrite(item->token_positions, sizeof(size_t), item->current_length, fp);
+    for (size_t start = 0, n; start < item->current_length; start += n) {
+        n = item_span(manager, item, start, item->current_length);
+        fwrite(position_slot(manager, item, start), sizeof(size_t), n, fp);
+    }
     
     // 写入缓存数据
     HAL_Device* device = (HAL_Device*)manager->device;
-    size_t cache_size = item->current_length * manager->config.num_heads * 
-                       manager->config.head_dim * sizeof(float);
+    size_t cache_size = item->current_length * row_bytes(&manager->config);
     
     void* temp = malloc(cache_size);
     if (!temp) {
@@ -269,37 +967,61 @@ int kv_cache_offload(KVCacheManager* manager,
     }
     
     // 写入key缓存
-    device->memcpy_from_device(temp, item->key_cache, cache_size);
+    copy_rows(manager, item, item->current_length, 0, temp, 0);
     fwrite(temp, 1, cache_size, fp);
     
     // 写入value缓存
-    device->memcpy_from_device(temp, item->value_cache, cache_size);
+    copy_rows(manager, item, item->current_length, 1, temp, 0);
     fwrite(temp, 1, cache_size, fp);
     
     free(temp);
     fclose(fp);
     
     // 释放设备内存
-    device->free_memory(item->key_cache);
-    device->free_memory(item->value_cache);
-    item->key_cache = NULL;
-    item->value_cache = NULL;
+    if (manager->block_pool) {
+        release_blocks(manager, item, 0);
+    } else {
+        device->free_memory(item->key_cache);
+        device->free_memory(item->value_cache);
+        item->key_cache = NULL;
+        item->value_cache = NULL;
+    }
     
     return 0;
 }
 
-// 从磁盘加载
-int kv_cache_load(KVCacheManager* manager,
-                 size_t layer_idx,
-                 const char* cache_dir) {
+// 磁盘卸载：卸载该层所有使用中且尚未卸载的序列
+int kv_cache_offload(KVCacheManager* manager,
+                    size_t layer_idx,
+                    const char* cache_dir) {
     if (!manager || layer_idx >= manager->num_items || !cache_dir) return -1;
     
-    KVCacheItem* item = manager->items[layer_idx];
-    if (!item) return -1;
-    
-    char filename[256];
-    snprintf(filename, sizeof(filename), "%s/layer_%zu_kv_cache.bin", cache_dir, layer_idx);
-    
+    size_t count = 0;
+    for (size_t s = 0; s < manager->num_seqs; s++) {
+        KVCacheItem* item = get_item(manager, s, layer_idx);
+        if (!item || !item_resident(manager, item)) continue;
+        
+        char filename[256];
+        if (item_filename(filename, sizeof(filename), cache_dir, s, layer_idx) != 0 ||
+            offload_item(manager, item, filename) != 0) {
+            return -1;
+        }
+        count++;
+    }
+    return count > 0 ? 0 : -1;
+}
+
+// 释放加载失败时分配的设备内存
+static void kv_cache_load_fail(KVCacheManager* manager, KVCacheItem* item) {
+    if (manager->block_pool) {
+        release_blocks(manager, item, 0);
+        return;
+    }
+    free_item_buffers(manager, item);
+}
+
+// 加载一个缓存项
+static int load_item(KVCacheManager* manager, KVCacheItem* item, const char* filename) {
     FILE* fp = fopen(filename, "rb");
     if (!fp) return -1;
     
@@ -315,57 +1037,131 @@ int kv_cache_load(KVCacheManager* manager,
         return -1;
     }
     
+    // 加载后从环形缓冲区的起点开始存放
+    item->head = 0;
     if (fread(item->token_positions, sizeof(size_t), length, fp) != length) {
         fclose(fp);
         return -1;
     }
     
-    // 分配设备内存
+    // 分配设备内存：连续模式按完整容量分配，加载后仍可继续追加
     HAL_Device* device = (HAL_Device*)manager->device;
-    size_t cache_size = length * manager->config.num_heads * 
-                       manager->config.head_dim * sizeof(float);
-    
-    item->key_cache = device->allocate_memory(cache_size);
-    item->value_cache = device->allocate_memory(cache_size);
-    if (!item->key_cache || !item->value_cache) {
-        if (item->key_cache) device->free_memory(item->key_cache);
-        if (item->value_cache) device->free_memory(item->value_cache);
-        fclose(fp);
-        return -1;
+    size_t cache_size = length * row_bytes(&manager->config);
+    
+    if (manager->block_pool) {
+        release_blocks(manager, item, 0);
+        if (reserve_blocks(manager, item, length) != 0) {
+            kv_cache_load_fail(manager, item);
+            fclose(fp);
+            return -1;
+        }
+    } else if (!item->key_cache) {
+        size_t full_size = calculate_cache_size(&manager->config);
+        item->key_cache = kv_cache_alloc(device, full_size);
+        item->value_cache = kv_cache_alloc(device, full_size);
+        if (!item->key_cache || !item->value_cache) {
+            kv_cache_load_fail(manager, item);
+            fclose(fp);
+            return -1;
+        }
     }
     
     // 读取缓存数据
     void* temp = malloc(cache_size);
     if (!temp) {
-        device->free_memory(item->key_cache);
-        device->free_memory(item->value_cache);
-        fclose(fp);
-        return -1;
-    }
-    
-    // 读取并上传key缓存
-    if (fread(temp, 1, cache_size, fp) != cache_size) {
-        free(temp);
-        device->free_memory(item->key_cache);
-        device->free_memory(item->value_cache);
+        kv_cache_load_fail(manager, item);
         fclose(fp);
         return -1;
     }
-    device->memcpy_to_device(item->key_cache, temp, cache_size);
     
-    // 读取并上传value缓存
-    if (fread(temp, 1, cache_size, fp) != cache_size) {
-        free(temp);
-        device->free_memory(item->key_cache);
-        device->free_memory(item->value_cache);
-        fclose(fp);
-        return -1;
-    }
-    device->memcpy_to_device(item->value_cache, temp, cache_size);
+    // 读取并上传key和value缓存
+    if (fread(temp, 1, cache_size, fp) != cache_size) goto fail;
+    copy_rows(manager, item, length, 0, temp, 1);
+    if (fread(temp, 1, cache_size, fp) != cache_size) goto fail;
+    copy_rows(manager, item, length, 1, temp, 1);
     
     item->current_length = length;
     
     free(temp);
     fclose(fp);
     return 0;
-} 
\ No newline at end of file
+    
+fail:
+    free(temp);
+    kv_cache_load_fail(manager, item);
+    fclose(fp);
+    return -1;
+}
+
+// 从磁盘加载：加载该层所有使用中且已卸载的序列
+int kv_cache_load(KVCacheManager* manager,
+                 size_t layer_idx,
+                 const char* cache_dir) {
+    if (!manager || layer_idx >= manager->num_items || !cache_dir) return -1;
+    
+    for (size_t s = 0; s < manager->num_seqs; s++) {
+        KVCacheItem* item = get_item(manager, s, layer_idx);
+        if (!item || item_resident(manager, item)) continue;
+        
+        char filename[256];
+        if (item_filename(filename, sizeof(filename), cache_dir, s, layer_idx) != 0 ||
+            load_item(manager, item, filename) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 异步卸载/加载命令参数（随命令复制）
+typedef struct {
+    KVCacheManager* manager;
+    size_t layer_idx;
+    char cache_dir[256];
+    int* status;
+    int load;
+} KVCacheIOCommand;
+
+static void kv_cache_io_command(void* arg) {
+    const KVCacheIOCommand* cmd = (const KVCacheIOCommand*)arg;
+    int ret = cmd->load ? kv_cache_load(cmd->manager, cmd->layer_idx, cmd->cache_dir)
+                        : kv_cache_offload(cmd->manager, cmd->layer_idx, cmd->cache_dir);
+    if (cmd->status) *cmd->status = ret;
+}
+
+static int kv_cache_io_async(KVCacheManager* manager, size_t layer_idx, const char* cache_dir,
+                             struct Stream* stream, int* status, int load) {
+    if (!manager || layer_idx >= manager->num_items || !cache_dir) return -1;
+
+    KVCacheIOCommand cmd;
+    cmd.manager = manager;
+    cmd.layer_idx = layer_idx;
+    cmd.status = status;
+    cmd.load = load;
+    if (strlen(cache_dir) >= sizeof(cmd.cache_dir)) return -1;
+    strcpy(cmd.cache_dir, cache_dir);
+
+    HAL_Device* device = (HAL_Device*)manager->device;
+    if (!device->launch_async) {
+        kv_cache_io_command(&cmd);
+        return 0;
+    }
+    return device->launch_async(stream, kv_cache_io_command, &cmd, sizeof(cmd));
+}
+
+// 异步磁盘卸载
+int kv_cache_offload_async(KVCacheManager* manager,
+                          size_t layer_idx,
+                          const char* cache_dir,
+                          struct Stream* stream,
+                          int* status) {
+    return kv_cache_io_async(manager, layer_idx, cache_dir, stream, status, 0);
+}
+
+// 异步从磁盘加载
+int kv_cache_load_async(KVCacheManager* manager,
+                       size_t layer_idx,
+                       const char* cache_dir,
+                       struct Stream* stream,
+                       int* status) {
+    return kv_cache_io_async(manager, layer_idx, cache_dir, stream, status, 1);
+}
@@ -3,6 +3,19 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "kv_block_pool.h"
+
+struct Stream;
+
+// KV缓存的存储精度
+typedef enum {
+    KV_CACHE_FP32,              // 32位浮点
+    KV_CACHE_INT8,              // 对称INT8（零点128），每组一个scale
+    KV_CACHE_FP8                // FP8 E4M3，每组一个scale
+} KVCachePrecision;
+
+// FP8 E4M3的最大有限值，每组的最大绝对值映射到该值
+#define KV_CACHE_FP8_MAX 448.0f
 
 // KV缓存配置
 typedef struct {
@@ -10,8 +23,14 @@ typedef struct {
     size_t num_layers;          // Transformer层数
     size_t num_heads;           // 注意力头数
     size_t head_dim;            // 每个头的维度
-    size_t batch_size;          // 批次大小
+    size_t batch_size;          // 批次大小（序列槽位数，0按1处理）
     int use_disk_offload;       // 是否使用磁盘卸载
+    size_t block_size;          // 分页模式每块的令牌数，0为连续模式（每层预分配 batch_size * max_seq_length 行）
+    size_t max_blocks;          // 分页模式所有层共享的块数上限，0表示按连续模式的容量
+    KVCachePrecision precision; // 存储精度，在kv_cache_append时量化
+    size_t quant_group_size;    // 每个scale覆盖的元素数（须整除 num_heads * head_dim），0表示按头
+    int ring_buffer;            // 非0时使用环形布局，kv_cache_rotate只移动起点而不复制数据
+    int prefix_cache;           // 非0时启用跨序列的前缀共享（须为分页模式）
 } KVCacheConfig;
 
 // KV缓存项
@@ -19,17 +38,46 @@ typedef struct {
     void* key_cache;           // Key缓存
     void* value_cache;         // Value缓存
     size_t current_length;     // 当前缓存的序列长度
-    size_t* token_positions;   // 令牌位置映射
+    size_t* token_positions;   // 令牌位置映射（环形模式下第j行的位置为 token_positions[(head + j) % max_seq_length]）
+    size_t* block_table;       // 分页模式：第j行位于块 block_table[j / block_size]（连续模式为NULL）
+    size_t num_blocks;         // 分页模式：已分配的块数
+    size_t head;               // 环形模式：第0行在位置映射（以及连续模式的K/V）中的槽位
+    size_t block_offset;       // 环形分页模式：第0行在第一块内的行号
 } KVCacheItem;
 
+// 前缀缓存统计
+typedef struct {
+    size_t lookups;            // kv_cache_prefix_attach的调用次数
+    size_t hit_tokens;         // 直接复用缓存的令牌数
+    size_t miss_tokens;        // 未命中、需要重新计算的令牌数
+    size_t cached_nodes;       // 前缀树的节点数（每个节点至多block_size个令牌）
+    size_t evictions;          // 被LRU淘汰的节点数
+    size_t cow_copies;         // 写时复制的块数
+} KVPrefixStats;
+
+struct KVPrefixCache;
+
 // KV缓存管理器
 typedef struct {
     KVCacheConfig config;      // 缓存配置
-    KVCacheItem** items;       // 每层的缓存项
-    size_t num_items;          // 缓存项数量
+    KVCacheItem** items;       // 每个序列每层的缓存项，序列s第l层为 items[s * num_items + l]
+    size_t num_items;          // 每个序列的缓存项数量（层数）
     void* device;              // 设备指针
+    KVBlockPool* block_pool;   // 分页模式的共享块池（连续模式为NULL）
+    size_t num_seqs;           // 序列槽位数
+    unsigned char* seq_active; // 各槽位是否在使用
+    struct KVPrefixCache* prefix; // 前缀树、LRU时钟和统计（未启用前缀共享时为NULL）
 } KVCacheManager;
 
+// 分页模式：每块先存block_size行key再存block_size行value，块按需从块池分配
+// 量化模式：每行为码字加每组一个float scale，lookup返回反量化后的float
+// 环形模式：行号一律是逻辑行号（第0行为最早的令牌），旋转只移动起点
+// 多序列：槽位0初始化时即占用，不带序列号的接口作用于槽位0
+// 前缀共享：按令牌ID共享整块，写入共享块前复制，块池耗尽时按LRU淘汰前缀
+
+// 一行的存储字节数
+size_t kv_cache_row_bytes(KVCachePrecision precision, size_t row_elems, size_t group_size);
+
 // 初始化KV缓存管理器
 int kv_cache_init(KVCacheManager** manager, const KVCacheConfig* config, void* device);
 
@@ -39,12 +87,12 @@ void kv_cache_cleanup(KVCacheManager* manager);
 // 重置缓存
 void kv_cache_reset(KVCacheManager* manager);
 
-// 添加KV到缓存
+// 添加KV到缓存（序列槽位0），position为该令牌的位置
 int kv_cache_append(KVCacheManager* manager, 
                    size_t layer_idx,
                    const void* key, 
                    const void* value,
-                   size_t seq_idx);
+                   size_t position);
 
 // 从缓存获取KV
 int kv_cache_lookup(KVCacheManager* manager,
@@ -54,6 +102,61 @@ int kv_cache_lookup(KVCacheManager* manager,
                    const size_t* positions,
                    size_t num_positions);
 
+// 分配一个空闲的序列槽位，序号写入seq_idx，没有空闲槽位时返回-1
+int kv_cache_add_sequence(KVCacheManager* manager, size_t* seq_idx);
+
+// 归还序列槽位，清空其所有层（分页模式的块归还块池）
+int kv_cache_release_sequence(KVCacheManager* manager, size_t seq_idx);
+
+// 序列seq_idx第layer_idx层的长度，槽位未使用时返回0
+size_t kv_cache_seq_length(const KVCacheManager* manager, size_t seq_idx, size_t layer_idx);
+
+// 以下为指定序列的版本，用法同不带序列号的接口（position为该令牌的位置）
+int kv_cache_append_seq(KVCacheManager* manager, size_t seq_idx, size_t layer_idx,
+                        const void* key, const void* value, size_t position);
+
+int kv_cache_lookup_seq(KVCacheManager* manager, size_t seq_idx, size_t layer_idx,
+                        void* key_out, void* value_out,
+                        const size_t* positions, size_t num_positions);
+
+size_t kv_cache_span_seq(KVCacheManager* manager, size_t seq_idx, size_t layer_idx, size_t start,
+                         const void** key, const void** value, const size_t** positions);
+
+int kv_cache_rotate_seq(KVCacheManager* manager, size_t seq_idx, size_t layer_idx,
+                        size_t rotation_offset);
+
+int kv_cache_compact_seq(KVCacheManager* manager, size_t seq_idx, size_t layer_idx);
+
+// 为num_seqs个不同序列各追加一个令牌，任一序列无法追加时返回-1且不写入任何一行
+int kv_cache_append_batch(KVCacheManager* manager, size_t layer_idx,
+                          const size_t* seq_indices, size_t num_seqs,
+                          const void* keys, const void* values, const size_t* positions);
+
+// 从第start行开始存储连续的一段（不跨块尾和回绕点），返回行数，越界或已卸载时返回0
+size_t kv_cache_span(KVCacheManager* manager,
+                    size_t layer_idx,
+                    size_t start,
+                    const void** key,
+                    const void** value,
+                    const size_t** positions);
+
+// 分页模式的块池统计，连续模式返回-1
+int kv_cache_get_pool_stats(KVCacheManager* manager, KVBlockPoolStats* stats);
+
+// 为空的序列挂上与tokens匹配的最长缓存前缀，调用者从第matched个令牌开始计算
+int kv_cache_prefix_attach(KVCacheManager* manager, size_t seq_idx,
+                           const int32_t* tokens, size_t num_tokens, size_t* matched);
+
+// 把序列前num_tokens个令牌的整块登记到前缀树（旋转或压缩过的序列返回-1）
+int kv_cache_prefix_insert(KVCacheManager* manager, size_t seq_idx,
+                           const int32_t* tokens, size_t num_tokens);
+
+// 按LRU淘汰至多max_nodes个只被前缀树引用的叶子节点，返回淘汰的节点数
+size_t kv_cache_prefix_evict(KVCacheManager* manager, size_t max_nodes);
+
+// 前缀缓存统计，未启用前缀共享时返回-1
+int kv_cache_get_prefix_stats(KVCacheManager* manager, KVPrefixStats* stats);
+
 // 缓存旋转（用于滑动窗口）
 int kv_cache_rotate(KVCacheManager* manager,
                    size_t layer_idx,
@@ -63,14 +166,27 @@ int kv_cache_rotate(KVCacheManager* manager,
 int kv_cache_compact(KVCacheManager* manager,
                     size_t layer_idx);
 
-// 磁盘卸载
+// 磁盘卸载：卸载该层所有使用中的序列（序列0以外的文件名带序列号）
 int kv_cache_offload(KVCacheManager* manager,
                     size_t layer_idx,
                     const char* cache_dir);
 
-// 从磁盘加载
+// 从磁盘加载：加载该层所有使用中且已卸载的序列
 int kv_cache_load(KVCacheManager* manager,
                  size_t layer_idx,
                  const char* cache_dir);
 
+// 异步磁盘卸载/加载：在命令流上执行，status可为NULL，完成前不得访问该层缓存
+int kv_cache_offload_async(KVCacheManager* manager,
+                          size_t layer_idx,
+                          const char* cache_dir,
+                          struct Stream* stream,
+                          int* status);
+
+int kv_cache_load_async(KVCacheManager* manager,
+                       size_t layer_idx,
+                       const char* cache_dir,
+                       struct Stream* stream,
+                       int* status);
+
 #endif // KV_CACHE_H 
\ No newline at end of file
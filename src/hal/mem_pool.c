@@ -0,0 +1,389 @@
+#include "mem_pool.h"
+#include "numa_topology.h"
+#include "page_map.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// 尺寸级别：1KB以内按64字节递增（16级），之后每个2的幂区间再分4级，直到MEM_POOL_MAX_CLASS_SIZE
+#define SMALL_CLASS_STEP 64
+#define NUM_SMALL_CLASSES 16
+#define SMALL_CLASS_LIMIT (SMALL_CLASS_STEP * NUM_SMALL_CLASSES)
+#define SMALL_CLASS_LOG2 10
+#define SUBCLASSES_LOG2 2
+#define NUM_CLASSES 80
+
+// 线程本地缓存只保存不超过32KB的块，每级最多缓存的块数
+#define NUM_TLS_CLASSES 36
+#define TLS_CACHE_MAX_BLOCKS 16
+
+// 超过最大尺寸级别的块 / 设置了NUMA放置策略的独立映射
+#define LARGE_CLASS UINT32_MAX
+#define MAPPED_CLASS (UINT32_MAX - 1)
+
+// 块头部，占用用户指针之前的一个对齐单位
+typedef struct MemBlockHeader {
+    struct MemBlockHeader* next;   // 空闲链表
+    size_t size;                   // 块大小（不含头部）
+    uint32_t class_idx;
+    uint32_t page_flags;           // 单独映射的块（MAPPED_CLASS）：请求的大页选项、NUMA放置和映射
+    int node_id;
+    PageMapping mapping;
+} MemBlockHeader;
+
+_Static_assert(sizeof(MemBlockHeader) <= MEM_POOL_ALIGNMENT, "block header exceeds alignment");
+
+// 全局空闲链表
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static MemBlockHeader* g_free_lists[NUM_CLASSES];
+static MemBlockHeader* g_mapped_free;  // 释放的单独映射，按映射长度计入缓存
+static size_t g_cached_bytes = 0;
+static size_t g_cache_limit = MEM_POOL_DEFAULT_CACHE_LIMIT;
+
+static atomic_size_t g_allocated_bytes;
+static atomic_size_t g_hits;
+static atomic_size_t g_misses;
+static atomic_size_t g_mapped_bytes;
+static atomic_size_t g_hugetlb_bytes;
+static atomic_size_t g_thp_bytes;
+
+// 线程本地缓存（无锁）
+typedef struct {
+    MemBlockHeader* head[NUM_TLS_CLASSES];
+    uint32_t count[NUM_TLS_CLASSES];
+    int registered;
+} ThreadCache;
+
+static _Thread_local ThreadCache t_cache;
+
+// 线程退出时将本地缓存归还全局链表
+static pthread_key_t g_cache_key;
+static pthread_once_t g_cache_key_once = PTHREAD_ONCE_INIT;
+
+static size_t class_index(size_t size) {
+    if (size <= SMALL_CLASS_LIMIT) {
+        return size == 0 ? 0 : (size - 1) / SMALL_CLASS_STEP;
+    }
+    // size位于 (2^lg, 2^(lg+1)]，每级步长为 2^(lg-2)
+    size_t lg = (size_t)(63 - __builtin_clzll((unsigned long long)(size - 1)));
+    size_t sub = ((size - 1) - ((size_t)1 << lg)) >> (lg - SUBCLASSES_LOG2);
+    return NUM_SMALL_CLASSES + ((lg - SMALL_CLASS_LOG2) << SUBCLASSES_LOG2) + sub;
+}
+
+static size_t class_size(size_t idx) {
+    if (idx < NUM_SMALL_CLASSES) {
+        return (idx + 1) * SMALL_CLASS_STEP;
+    }
+    size_t lg = SMALL_CLASS_LOG2 + ((idx - NUM_SMALL_CLASSES) >> SUBCLASSES_LOG2);
+    size_t sub = (idx - NUM_SMALL_CLASSES) & ((1u << SUBCLASSES_LOG2) - 1);
+    return ((size_t)1 << lg) + (sub + 1) * ((size_t)1 << (lg - SUBCLASSES_LOG2));
+}
+
+static inline void* block_to_user(MemBlockHeader* hdr) {
+    return (char*)hdr + MEM_POOL_ALIGNMENT;
+}
+
+static inline MemBlockHeader* user_to_block(const void* ptr) {
+    return (MemBlockHeader*)((char*)ptr - MEM_POOL_ALIGNMENT);
+}
+
+static MemBlockHeader* system_alloc(size_t size, uint32_t class_idx) {
+    MemBlockHeader* hdr = (MemBlockHeader*)aligned_alloc(MEM_POOL_ALIGNMENT,
+                                                         MEM_POOL_ALIGNMENT + size);
+    if (!hdr) return NULL;
+    hdr->size = size;
+    hdr->class_idx = class_idx;
+    atomic_fetch_add_explicit(&g_misses, 1, memory_order_relaxed);
+    return hdr;
+}
+
+// 缓存中的块占用的字节数
+static size_t cached_size(const MemBlockHeader* hdr) {
+    return hdr->class_idx == MAPPED_CLASS ? hdr->mapping.length : hdr->size;
+}
+
+// 释放链表中的所有块（在锁外调用）
+static size_t release_list(MemBlockHeader* list) {
+    size_t released = 0;
+    while (list) {
+        MemBlockHeader* next = list->next;
+        released += cached_size(list);
+        if (list->class_idx == MAPPED_CLASS) {
+            PageMapping mapping = list->mapping;
+            page_unmap(&mapping);
+        } else {
+            free(list);
+        }
+        list = next;
+    }
+    return released;
+}
+
+// 将本地缓存放回全局链表，超出缓存上限的块归还系统
+static void flush_thread_cache(ThreadCache* cache) {
+    MemBlockHeader* release = NULL;
+
+    pthread_mutex_lock(&g_lock);
+    for (size_t idx = 0; idx < NUM_TLS_CLASSES; idx++) {
+        MemBlockHeader* hdr = cache->head[idx];
+        while (hdr) {
+            MemBlockHeader* next = hdr->next;
+            if (g_cached_bytes + hdr->size <= g_cache_limit) {
+                hdr->next = g_free_lists[idx];
+                g_free_lists[idx] = hdr;
+                g_cached_bytes += hdr->size;
+            } else {
+                hdr->next = release;
+                release = hdr;
+            }
+            hdr = next;
+        }
+        cache->head[idx] = NULL;
+        cache->count[idx] = 0;
+    }
+    pthread_mutex_unlock(&g_lock);
+
+    release_list(release);
+}
+
+static void thread_cache_destructor(void* arg) {
+    flush_thread_cache((ThreadCache*)arg);
+}
+
+static void create_cache_key(void) {
+    pthread_key_create(&g_cache_key, thread_cache_destructor);
+}
+
+void* mem_pool_alloc(size_t size) {
+    MemBlockHeader* hdr;
+
+    if (size > MEM_POOL_MAX_CLASS_SIZE) {
+        size = (size + MEM_POOL_ALIGNMENT - 1) & ~(size_t)(MEM_POOL_ALIGNMENT - 1);
+        hdr = system_alloc(size, LARGE_CLASS);
+        if (!hdr) return NULL;
+        atomic_fetch_add_explicit(&g_allocated_bytes, size, memory_order_relaxed);
+        return block_to_user(hdr);
+    }
+
+    size_t idx = class_index(size);
+    size_t csize = class_size(idx);
+
+    // 先查线程本地缓存，再查全局链表
+    if (idx < NUM_TLS_CLASSES && t_cache.head[idx]) {
+        hdr = t_cache.head[idx];
+        t_cache.head[idx] = hdr->next;
+        t_cache.count[idx]--;
+        atomic_fetch_add_explicit(&g_hits, 1, memory_order_relaxed);
+    } else {
+        pthread_mutex_lock(&g_lock);
+        hdr = g_free_lists[idx];
+        if (hdr) {
+            g_free_lists[idx] = hdr->next;
+            g_cached_bytes -= csize;
+        }
+        pthread_mutex_unlock(&g_lock);
+
+        if (hdr) {
+            atomic_fetch_add_explicit(&g_hits, 1, memory_order_relaxed);
+        } else {
+            hdr = system_alloc(csize, (uint32_t)idx);
+            if (!hdr) return NULL;
+        }
+    }
+
+    hdr->next = NULL;
+    atomic_fetch_add_explicit(&g_allocated_bytes, csize, memory_order_relaxed);
+    return block_to_user(hdr);
+}
+
+// 使用中的单独映射的统计
+static void account_mapping(const PageMapping* mapping, int add) {
+    atomic_size_t* backing = NULL;
+    if (mapping->backing == PAGE_MAP_HUGETLB) {
+        backing = &g_hugetlb_bytes;
+    } else if (mapping->backing == PAGE_MAP_THP) {
+        backing = &g_thp_bytes;
+    }
+    if (add) {
+        atomic_fetch_add_explicit(&g_mapped_bytes, mapping->length, memory_order_relaxed);
+        if (backing) atomic_fetch_add_explicit(backing, mapping->length, memory_order_relaxed);
+    } else {
+        atomic_fetch_sub_explicit(&g_mapped_bytes, mapping->length, memory_order_relaxed);
+        if (backing) atomic_fetch_sub_explicit(backing, mapping->length, memory_order_relaxed);
+    }
+}
+
+// 从缓存中取出选项相同、能容纳need字节且浪费不超过1/4的最小映射（调用者持有g_lock）
+static MemBlockHeader* take_cached_mapping(size_t need, int node_id, uint32_t page_flags) {
+    MemBlockHeader** best = NULL;
+    for (MemBlockHeader** p = &g_mapped_free; *p; p = &(*p)->next) {
+        const MemBlockHeader* hdr = *p;
+        if (hdr->node_id != node_id || hdr->page_flags != page_flags) continue;
+        if (hdr->mapping.length < need || hdr->mapping.length - need > need / 4) continue;
+        if (!best || hdr->mapping.length < (*best)->mapping.length) best = p;
+    }
+    if (!best) return NULL;
+    MemBlockHeader* hdr = *best;
+    *best = hdr->next;
+    g_cached_bytes -= hdr->mapping.length;
+    return hdr;
+}
+
+// 单独映射的块：头部位于映射起点，用户指针仍为64字节对齐
+// 释放的映射保留NUMA放置和大页支撑，按节点和选项缓存复用，避免每次分配都mmap+mbind
+void* mem_pool_alloc_mapped(size_t size, int node_id, uint32_t page_flags) {
+    if (size < MEM_POOL_MAPPED_MIN_SIZE) return mem_pool_alloc(size);
+
+    size = (size + MEM_POOL_ALIGNMENT - 1) & ~(size_t)(MEM_POOL_ALIGNMENT - 1);
+
+    pthread_mutex_lock(&g_lock);
+    MemBlockHeader* hdr = take_cached_mapping(MEM_POOL_ALIGNMENT + size, node_id, page_flags);
+    pthread_mutex_unlock(&g_lock);
+
+    if (hdr) {
+        atomic_fetch_add_explicit(&g_hits, 1, memory_order_relaxed);
+    } else {
+        PageMapping mapping;
+        if (page_map(MEM_POOL_ALIGNMENT + size, page_flags, &mapping) != 0) return NULL;
+
+        // 放置策略必须在写入头部（首次访问）之前设置
+        if (node_id != MEM_POOL_NODE_ANY) {
+            numa_bind_memory(mapping.ptr, mapping.length,
+                             node_id == MEM_POOL_NODE_INTERLEAVE ? -1 : node_id);
+        }
+
+        hdr = (MemBlockHeader*)mapping.ptr;
+        hdr->class_idx = MAPPED_CLASS;
+        hdr->page_flags = page_flags;
+        hdr->node_id = node_id;
+        hdr->mapping = mapping;
+        atomic_fetch_add_explicit(&g_misses, 1, memory_order_relaxed);
+    }
+
+    hdr->next = NULL;
+    hdr->size = size;
+    atomic_fetch_add_explicit(&g_allocated_bytes, size, memory_order_relaxed);
+    account_mapping(&hdr->mapping, 1);
+    return block_to_user(hdr);
+}
+
+size_t mem_pool_huge_bytes(const void* ptr) {
+    if (!ptr) return 0;
+    const MemBlockHeader* hdr = user_to_block(ptr);
+    if (hdr->class_idx != MAPPED_CLASS) return 0;
+    return page_map_huge_bytes(&hdr->mapping);
+}
+
+void mem_pool_free(void* ptr) {
+    if (!ptr) return;
+
+    MemBlockHeader* hdr = user_to_block(ptr);
+    atomic_fetch_sub_explicit(&g_allocated_bytes, hdr->size, memory_order_relaxed);
+
+    if (hdr->class_idx == LARGE_CLASS) {
+        free(hdr);
+        return;
+    }
+    if (hdr->class_idx == MAPPED_CLASS) {
+        PageMapping mapping = hdr->mapping;
+        account_mapping(&mapping, 0);
+
+        pthread_mutex_lock(&g_lock);
+        if (g_cached_bytes + mapping.length <= g_cache_limit) {
+            hdr->next = g_mapped_free;
+            g_mapped_free = hdr;
+            g_cached_bytes += mapping.length;
+            hdr = NULL;
+        }
+        pthread_mutex_unlock(&g_lock);
+
+        if (hdr) page_unmap(&mapping);
+        return;
+    }
+
+    size_t idx = hdr->class_idx;
+    if (idx < NUM_TLS_CLASSES && t_cache.count[idx] < TLS_CACHE_MAX_BLOCKS) {
+        if (!t_cache.registered) {
+            pthread_once(&g_cache_key_once, create_cache_key);
+            pthread_setspecific(g_cache_key, &t_cache);
+            t_cache.registered = 1;
+        }
+        hdr->next = t_cache.head[idx];
+        t_cache.head[idx] = hdr;
+        t_cache.count[idx]++;
+        return;
+    }
+
+    pthread_mutex_lock(&g_lock);
+    if (g_cached_bytes + hdr->size <= g_cache_limit) {
+        hdr->next = g_free_lists[idx];
+        g_free_lists[idx] = hdr;
+        g_cached_bytes += hdr->size;
+        hdr = NULL;
+    }
+    pthread_mutex_unlock(&g_lock);
+
+    free(hdr);
+}
+
+size_t mem_pool_usable_size(const void* ptr) {
+    return ptr ? user_to_block(ptr)->size : 0;
+}
+
+// 先释放单独映射，再从最大的尺寸级别开始释放，直到缓存不超过keep_bytes（调用者持有g_lock）
+static MemBlockHeader* detach_until(size_t keep_bytes) {
+    MemBlockHeader* release = NULL;
+    while (g_mapped_free && g_cached_bytes > keep_bytes) {
+        MemBlockHeader* hdr = g_mapped_free;
+        g_mapped_free = hdr->next;
+        g_cached_bytes -= hdr->mapping.length;
+        hdr->next = release;
+        release = hdr;
+    }
+    for (size_t idx = NUM_CLASSES; idx-- > 0 && g_cached_bytes > keep_bytes;) {
+        while (g_free_lists[idx] && g_cached_bytes > keep_bytes) {
+            MemBlockHeader* hdr = g_free_lists[idx];
+            g_free_lists[idx] = hdr->next;
+            g_cached_bytes -= hdr->size;
+            hdr->next = release;
+            release = hdr;
+        }
+    }
+    return release;
+}
+
+size_t mem_pool_trim(size_t keep_bytes) {
+    flush_thread_cache(&t_cache);
+
+    pthread_mutex_lock(&g_lock);
+    MemBlockHeader* release = detach_until(keep_bytes);
+    pthread_mutex_unlock(&g_lock);
+
+    return release_list(release);
+}
+
+void mem_pool_set_cache_limit(size_t bytes) {
+    pthread_mutex_lock(&g_lock);
+    g_cache_limit = bytes;
+    MemBlockHeader* release = detach_until(bytes);
+    pthread_mutex_unlock(&g_lock);
+
+    release_list(release);
+}
+
+void mem_pool_get_stats(MemPoolStats* stats) {
+    if (!stats) return;
+
+    pthread_mutex_lock(&g_lock);
+    stats->cached_bytes = g_cached_bytes;
+    stats->cache_limit = g_cache_limit;
+    pthread_mutex_unlock(&g_lock);
+
+    stats->allocated_bytes = atomic_load_explicit(&g_allocated_bytes, memory_order_relaxed);
+    stats->hits = atomic_load_explicit(&g_hits, memory_order_relaxed);
+    stats->misses = atomic_load_explicit(&g_misses, memory_order_relaxed);
+    stats->mapped_bytes = atomic_load_explicit(&g_mapped_bytes, memory_order_relaxed);
+    stats->hugetlb_bytes = atomic_load_explicit(&g_hugetlb_bytes, memory_order_relaxed);
+    stats->thp_bytes = atomic_load_explicit(&g_thp_bytes, memory_order_relaxed);
+}
@@ -0,0 +1,64 @@
+#ifndef MEM_POOL_H
+#define MEM_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 分配对齐（缓存行，满足AVX-512对齐加载）
+#define MEM_POOL_ALIGNMENT 64
+
+// 最大的尺寸级别，更大的分配直接走系统分配器
+#define MEM_POOL_MAX_CLASS_SIZE ((size_t)64 << 20)
+
+// 单独映射（NUMA放置/大页）的最小大小，更小的分配走普通尺寸级别
+#define MEM_POOL_MAPPED_MIN_SIZE ((size_t)256 << 10)
+
+// 单独映射的NUMA放置
+#define MEM_POOL_NODE_ANY (-1)          // 按首次访问放置
+#define MEM_POOL_NODE_INTERLEAVE (-2)   // 按页在所有节点之间交错
+
+// 全局缓存上限默认值
+#define MEM_POOL_DEFAULT_CACHE_LIMIT ((size_t)256 << 20)
+
+// 统计信息
+typedef struct {
+    size_t allocated_bytes;    // 当前已分配给调用者的字节数（按尺寸级别计）
+    size_t cached_bytes;       // 全局空闲链表和映射缓存中的字节数（不含线程本地缓存）
+    size_t cache_limit;        // 全局缓存上限
+    size_t hits;               // 从缓存复用的分配次数
+    size_t misses;             // 调用系统分配器的次数
+    size_t mapped_bytes;       // 使用中的单独映射的字节数（缓存中的映射计入cached_bytes）
+    size_t hugetlb_bytes;      // 其中由显式大页支撑的字节数
+    size_t thp_bytes;          // 其中已madvise为透明大页的字节数（实际支撑量见mem_pool_huge_bytes）
+} MemPoolStats;
+
+// 分配内存：按尺寸级别向上取整，返回64字节对齐的指针，size为0时返回最小块
+// 释放的块先进入线程本地缓存，再进入全局空闲链表，超过缓存上限时归还系统
+void* mem_pool_alloc(size_t size);
+
+// 单独映射的分配（权重、KV缓存等大缓冲区，以及绑定NUMA节点时的大块分配）
+// page_flags为PAGE_MAP_*（大页选项），node_id为节点编号或MEM_POOL_NODE_*
+// 释放的映射在缓存上限内保留，供节点和选项相同、大小相近（浪费不超过1/4）的分配复用
+// 小于MEM_POOL_MAPPED_MIN_SIZE时退化为mem_pool_alloc
+void* mem_pool_alloc_mapped(size_t size, int node_id, uint32_t page_flags);
+
+// ptr所在分配中实际由大页支撑的字节数（非单独映射的块返回0）
+size_t mem_pool_huge_bytes(const void* ptr);
+
+// 释放mem_pool_alloc*返回的内存，ptr可为NULL
+void mem_pool_free(void* ptr);
+
+// 块的实际可用大小
+size_t mem_pool_usable_size(const void* ptr);
+
+// 将缓存归还系统，直到全局缓存不超过keep_bytes；当前线程的本地缓存同时被清空
+// 返回归还的字节数
+size_t mem_pool_trim(size_t keep_bytes);
+
+// 设置全局缓存上限（超出部分立即归还系统）
+void mem_pool_set_cache_limit(size_t bytes);
+
+// 获取统计信息
+void mem_pool_get_stats(MemPoolStats* stats);
+
+#endif // MEM_POOL_H
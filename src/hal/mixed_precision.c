@@ -1,5 +1,7 @@
 #include "mixed_precision.h"
 #include "fp8.h"
+#include "fp16.h"
+#include "mem_pool.h"
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -415,10 +417,7 @@ static void convert_precision(void* output, const void* input, size_t size,
     
     switch (to_precision) {
         case PRECISION_FP16: {
-            uint16_t* out_f16 = (uint16_t*)output;
-            for (size_t i = 0; i < size; i++) {
-                out_f16[i] = float_to_fp16(in_f32[i]);
-            }
+            float_to_fp16_array((uint16_t*)output, in_f32, size);
             break;
         }
         case PRECISION_FP8: {
@@ -539,13 +538,13 @@ int mixed_precision_forward(MixedPrecisionState* state,
     }
     
     // 转换权重精度
-    void* temp_buffer = malloc(size * sizeof(float));
+    void* temp_buffer = mem_pool_alloc(size * sizeof(float));
     if (!temp_buffer) return -1;
     
     convert_precision(temp_buffer, data, size, PRECISION_FP32, config->weight_precision);
     memcpy(data, temp_buffer, size * sizeof(float));
     
-    free(temp_buffer);
+    mem_pool_free(temp_buffer);
     return 0;
 }
 
@@ -579,13 +578,13 @@ int mixed_precision_backward(MixedPrecisionState* state,
     }
     
     // 转换梯度精度
-    void* temp_buffer = malloc(size * sizeof(float));
+    void* temp_buffer = mem_pool_alloc(size * sizeof(float));
     if (!temp_buffer) return -1;
     
     convert_precision(temp_buffer, grad_data, size, PRECISION_FP32, config->grad_precision);
     memcpy(grad_data, temp_buffer, size * sizeof(float));
     
-    free(temp_buffer);
+    mem_pool_free(temp_buffer);
     return 0;
 }
 
@@ -626,13 +625,13 @@ int mixed_precision_post_update(MixedPrecisionState* state,
     }
     
     // 转换权重到目标精度
-    void* temp_buffer = malloc(size * sizeof(float));
+    void* temp_buffer = mem_pool_alloc(size * sizeof(float));
     if (!temp_buffer) return -1;
     
     convert_precision(temp_buffer, weight_data, size, PRECISION_FP32, config->weight_precision);
     memcpy(weight_data, temp_buffer, size * sizeof(float));
     
-    free(temp_buffer);
+    mem_pool_free(temp_buffer);
     return 0;
 }
 
@@ -0,0 +1,210 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE            // syscall
+#endif
+
+#include "numa_topology.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+
+// linux/mempolicy.h 中的策略编号
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+
+#define NODE_SYSFS_DIR "/sys/devices/system/node"
+#endif
+
+static NumaTopology g_topology;
+static pthread_once_t g_topology_once = PTHREAD_ONCE_INIT;
+
+static void mask_set(uint64_t* mask, int cpu) {
+    mask[cpu / 64] |= (uint64_t)1 << (cpu % 64);
+}
+
+static int mask_test(const uint64_t* mask, int cpu) {
+    return (int)((mask[cpu / 64] >> (cpu % 64)) & 1);
+}
+
+// 解析 "0-3,8-11" 格式的列表，对每个编号调用回调
+static void parse_list(const char* list, void (*fn)(void* ctx, int value), void* ctx) {
+    const char* p = list;
+    while (*p) {
+        char* end;
+        long lo = strtol(p, &end, 10);
+        if (end == p) break;
+        long hi = lo;
+        p = end;
+        if (*p == '-') {
+            hi = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long v = lo; v <= hi; v++) {
+            fn(ctx, (int)v);
+        }
+        if (*p != ',') break;
+        p++;
+    }
+}
+
+static void add_cpu(void* ctx, int cpu) {
+    NumaNode* node = (NumaNode*)ctx;
+    if (cpu < 0 || cpu >= NUMA_MAX_CPUS || mask_test(node->cpu_mask, cpu)) return;
+    mask_set(node->cpu_mask, cpu);
+    node->num_cpus++;
+}
+
+// 单节点回退：包含全部在线CPU
+static void fallback_topology(NumaTopology* topo) {
+    memset(topo, 0, sizeof(*topo));
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) cpus = 1;
+    if (cpus > NUMA_MAX_CPUS) cpus = NUMA_MAX_CPUS;
+
+    topo->num_nodes = 1;
+    for (int cpu = 0; cpu < cpus; cpu++) {
+        add_cpu(&topo->nodes[0], cpu);
+    }
+}
+
+#if defined(__linux__)
+static int read_line(const char* path, char* buf, size_t size) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) return -1;
+    int ok = fgets(buf, (int)size, fp) != NULL;
+    fclose(fp);
+    return ok ? 0 : -1;
+}
+
+static void add_node(void* ctx, int node_id) {
+    NumaTopology* topo = (NumaTopology*)ctx;
+    if (topo->num_nodes >= NUMA_MAX_NODES || node_id < 0 || node_id >= NUMA_MAX_NODES) return;
+
+    NumaNode* node = &topo->nodes[topo->num_nodes];
+    memset(node, 0, sizeof(*node));
+    node->id = node_id;
+
+    char path[128];
+    char buf[4096];
+    snprintf(path, sizeof(path), NODE_SYSFS_DIR "/node%d/cpulist", node_id);
+    if (read_line(path, buf, sizeof(buf)) == 0) {
+        parse_list(buf, add_cpu, node);
+    }
+
+    // "Node 0 MemTotal:       123456 kB"
+    snprintf(path, sizeof(path), NODE_SYSFS_DIR "/node%d/meminfo", node_id);
+    if (read_line(path, buf, sizeof(buf)) == 0) {
+        const char* p = strstr(buf, "MemTotal:");
+        if (p) node->memory_bytes = strtoull(p + 9, NULL, 10) * 1024;
+    }
+
+    topo->num_nodes++;
+}
+
+static void detect_topology(void) {
+    NumaTopology* topo = &g_topology;
+    memset(topo, 0, sizeof(*topo));
+
+    char buf[4096];
+    if (read_line(NODE_SYSFS_DIR "/online", buf, sizeof(buf)) == 0) {
+        parse_list(buf, add_node, topo);
+    }
+
+    if (topo->num_nodes == 0) {
+        fallback_topology(topo);
+        return;
+    }
+
+    // 内核未启用NUMA时get_mempolicy返回ENOSYS
+    topo->policy_supported = syscall(SYS_get_mempolicy, NULL, NULL, 0UL, NULL, 0UL) == 0;
+}
+#else
+static void detect_topology(void) {
+    fallback_topology(&g_topology);
+}
+#endif
+
+const NumaTopology* numa_topology_get(void) {
+    pthread_once(&g_topology_once, detect_topology);
+    return &g_topology;
+}
+
+const NumaNode* numa_topology_find_node(int node_id) {
+    const NumaTopology* topo = numa_topology_get();
+    for (size_t i = 0; i < topo->num_nodes; i++) {
+        if (topo->nodes[i].id == node_id) return &topo->nodes[i];
+    }
+    return NULL;
+}
+
+// 节点上第k个CPU的编号，不存在时返回-1
+static int nth_cpu(const NumaNode* node, size_t k) {
+    if (k >= node->num_cpus) return -1;
+    for (int cpu = 0; cpu < NUMA_MAX_CPUS; cpu++) {
+        if (mask_test(node->cpu_mask, cpu) && k-- == 0) return cpu;
+    }
+    return -1;
+}
+
+size_t numa_topology_cpu_order(int node_id, int* cpus, size_t max_cpus) {
+    const NumaTopology* topo = numa_topology_get();
+    size_t count = 0;
+
+    if (node_id >= 0) {
+        const NumaNode* node = numa_topology_find_node(node_id);
+        if (!node) return 0;
+        for (size_t k = 0; k < node->num_cpus && count < max_cpus; k++) {
+            cpus[count++] = nth_cpu(node, k);
+        }
+        return count;
+    }
+
+    // 各节点轮流取一个CPU
+    size_t max_per_node = 0;
+    for (size_t i = 0; i < topo->num_nodes; i++) {
+        if (topo->nodes[i].num_cpus > max_per_node) max_per_node = topo->nodes[i].num_cpus;
+    }
+    for (size_t k = 0; k < max_per_node; k++) {
+        for (size_t i = 0; i < topo->num_nodes && count < max_cpus; i++) {
+            int cpu = nth_cpu(&topo->nodes[i], k);
+            if (cpu >= 0) cpus[count++] = cpu;
+        }
+    }
+    return count;
+}
+
+#if defined(__linux__)
+int numa_bind_memory(void* ptr, size_t size, int node_id) {
+    const NumaTopology* topo = numa_topology_get();
+    if (!ptr || size == 0 || !topo->policy_supported || node_id >= NUMA_MAX_NODES) return -1;
+
+    unsigned long nodemask = 0;
+    unsigned long mode;
+    if (node_id >= 0) {
+        nodemask = 1UL << node_id;
+        mode = MPOL_PREFERRED;
+    } else {
+        for (size_t i = 0; i < topo->num_nodes; i++) {
+            nodemask |= 1UL << topo->nodes[i].id;
+        }
+        mode = MPOL_INTERLEAVE;
+    }
+    return syscall(SYS_mbind, ptr, size, mode, &nodemask,
+                   (unsigned long)NUMA_MAX_NODES + 1, 0UL) == 0 ? 0 : -1;
+}
+#else
+int numa_bind_memory(void* ptr, size_t size, int node_id) {
+    (void)ptr;
+    (void)size;
+    (void)node_id;
+    return -1;
+}
+#endif
@@ -0,0 +1,42 @@
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 支持的最大节点数和CPU数
+#define NUMA_MAX_NODES 64
+#define NUMA_MAX_CPUS 1024
+
+// NUMA节点
+typedef struct {
+    int id;                                  // 系统节点编号
+    size_t num_cpus;                         // 节点上的在线CPU数
+    uint64_t cpu_mask[NUMA_MAX_CPUS / 64];   // 节点上的CPU位图
+    uint64_t memory_bytes;                   // 节点内存总量（未知时为0）
+} NumaNode;
+
+// NUMA拓扑
+typedef struct {
+    size_t num_nodes;
+    NumaNode nodes[NUMA_MAX_NODES];
+    int policy_supported;      // 是否支持内存放置策略（mbind）
+} NumaTopology;
+
+// 探测拓扑（只在第一次调用时读取sysfs；无法探测时返回包含全部CPU的单节点）
+const NumaTopology* numa_topology_get(void);
+
+// 按系统节点编号查找节点，不存在时返回NULL
+const NumaNode* numa_topology_find_node(int node_id);
+
+// 按放置顺序列出CPU：node_id >= 0 时只列出该节点的CPU，
+// 否则在各节点之间轮转（线程数少于CPU数时均匀分布到各节点）
+// 返回写入cpus的个数
+size_t numa_topology_cpu_order(int node_id, int* cpus, size_t max_cpus);
+
+// 为页对齐的内存范围设置放置策略，需在首次访问之前调用（缺页时按策略分配物理页）
+// node_id >= 0：优先放在该节点上（节点内存不足时可回退到其他节点）；node_id < 0：按页在所有节点之间交错
+// 返回0成功，-1失败或不支持（内存仍可用，按首次访问放置）
+int numa_bind_memory(void* ptr, size_t size, int node_id);
+
+#endif // NUMA_TOPOLOGY_H
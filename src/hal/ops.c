@@ -0,0 +1,471 @@
+#include "ops.h"
+#include "cpu_features.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+// x86_64 内核（src/hal/x86_64/ops_avx2.c）
+extern void ops_rmsnorm_avx2(const float* x, const float* weight, const float* bias,
+                             float* out, size_t dim, float eps);
+extern void ops_layernorm_avx2(const float* x, const float* gamma, const float* beta,
+                               float* out, size_t dim, float eps);
+extern void ops_add_rmsnorm_avx2(float* residual, const float* delta, const float* weight,
+                                 const float* bias, float* out, size_t dim, float eps);
+extern void ops_add_layernorm_avx2(float* residual, const float* delta, const float* gamma,
+                                   const float* beta, float* out, size_t dim, float eps);
+extern void ops_softmax_avx2(const float* x, float* out, size_t dim);
+extern void ops_silu_mul_avx2(const float* gate, const float* up, float* out, size_t n);
+extern void ops_relu_avx2(const float* x, float* out, size_t n);
+extern void ops_silu_avx2(const float* x, float* out, size_t n);
+extern void ops_gelu_tanh_avx2(const float* x, float* out, size_t n);
+extern void ops_gelu_erf_avx2(const float* x, float* out, size_t n);
+extern void ops_tanh_avx2(const float* x, float* out, size_t n);
+extern void ops_relu_grad_avx2(const float* x, const float* grad_out, float* out, float* grad,
+                               size_t n);
+extern void ops_silu_grad_avx2(const float* x, const float* grad_out, float* out, float* grad,
+                               size_t n);
+extern void ops_gelu_tanh_grad_avx2(const float* x, const float* grad_out, float* out,
+                                    float* grad, size_t n);
+extern void ops_gelu_erf_grad_avx2(const float* x, const float* grad_out, float* out,
+                                   float* grad, size_t n);
+extern void ops_tanh_grad_avx2(const float* x, const float* grad_out, float* out, float* grad,
+                               size_t n);
+// src/hal/x86_64/ops_avx512.c
+extern void ops_softmax_avx512(const float* x, float* out, size_t dim);
+extern void ops_silu_mul_avx512(const float* gate, const float* up, float* out, size_t n);
+extern void ops_relu_avx512(const float* x, float* out, size_t n);
+extern void ops_silu_avx512(const float* x, float* out, size_t n);
+extern void ops_gelu_tanh_avx512(const float* x, float* out, size_t n);
+extern void ops_gelu_erf_avx512(const float* x, float* out, size_t n);
+extern void ops_tanh_avx512(const float* x, float* out, size_t n);
+extern void ops_relu_grad_avx512(const float* x, const float* grad_out, float* out, float* grad,
+                                 size_t n);
+extern void ops_silu_grad_avx512(const float* x, const float* grad_out, float* out, float* grad,
+                                 size_t n);
+extern void ops_gelu_tanh_grad_avx512(const float* x, const float* grad_out, float* out,
+                                      float* grad, size_t n);
+extern void ops_gelu_erf_grad_avx512(const float* x, const float* grad_out, float* out,
+                                     float* grad, size_t n);
+extern void ops_tanh_grad_avx512(const float* x, const float* grad_out, float* out, float* grad,
+                                 size_t n);
+#endif
+
+// 每个任务的最小元素数，低于该值不切分
+#define OPS_MIN_ELEMS_PER_TASK 16384
+
+// 按块切分时的对齐粒度（1024个float，避免伪共享）
+#define OPS_CHUNK_ALIGN 1024
+
+// softmax按块处理，块内数据留在L1中；块数有上限，块长随行长增大
+#define SOFTMAX_BLOCK 1024
+#define SOFTMAX_MAX_BLOCKS 64
+
+// 标量实现
+static void rmsnorm_scalar(const float* x, const float* weight, const float* bias,
+                           float* out, size_t dim, float eps) {
+    (void)bias;
+    float ss = 0.0f;
+    for (size_t i = 0; i < dim; i++) {
+        ss += x[i] * x[i];
+    }
+    float r = 1.0f / sqrtf(ss / (float)dim + eps);
+    for (size_t i = 0; i < dim; i++) {
+        out[i] = weight ? x[i] * r * weight[i] : x[i] * r;
+    }
+}
+
+// 按均值和偏差平方和m2归一化；两者由Welford算法在同一遍中求出，该行只再读取一次
+static void layernorm_apply(const float* x, const float* gamma, const float* beta,
+                            float* out, size_t dim, float eps, float mean, float m2) {
+    float r = 1.0f / sqrtf(m2 / (float)dim + eps);
+    for (size_t i = 0; i < dim; i++) {
+        float v = (x[i] - mean) * r;
+        if (gamma) v *= gamma[i];
+        if (beta) v += beta[i];
+        out[i] = v;
+    }
+}
+
+static void layernorm_scalar(const float* x, const float* gamma, const float* beta,
+                             float* out, size_t dim, float eps) {
+    float mean = 0.0f, m2 = 0.0f;
+    for (size_t i = 0; i < dim; i++) {
+        float d = x[i] - mean;
+        mean += d / (float)(i + 1);
+        m2 += d * (x[i] - mean);
+    }
+    layernorm_apply(x, gamma, beta, out, dim, eps, mean, m2);
+}
+
+static void add_rmsnorm_scalar(float* residual, const float* delta, const float* weight,
+                               const float* bias, float* out, size_t dim, float eps) {
+    for (size_t i = 0; i < dim; i++) {
+        residual[i] += delta[i];
+    }
+    rmsnorm_scalar(residual, weight, bias, out, dim, eps);
+}
+
+static void add_layernorm_scalar(float* residual, const float* delta, const float* gamma,
+                                 const float* beta, float* out, size_t dim, float eps) {
+    float mean = 0.0f, m2 = 0.0f;
+    for (size_t i = 0; i < dim; i++) {
+        float v = residual[i] + delta[i];
+        residual[i] = v;
+        float d = v - mean;
+        mean += d / (float)(i + 1);
+        m2 += d * (v - mean);
+    }
+    layernorm_apply(residual, gamma, beta, out, dim, eps, mean, m2);
+}
+
+static size_t softmax_block_len(size_t dim) {
+    size_t len = (dim + SOFTMAX_MAX_BLOCKS - 1) / SOFTMAX_MAX_BLOCKS;
+    len = (len + 15) & ~(size_t)15;
+    return len > SOFTMAX_BLOCK ? len : SOFTMAX_BLOCK;
+}
+
+// 在线softmax：每块写入 exp(x - 块内最大值) 并求和，同时合并为全行的最大值和总和；
+// 最后按块缩放out，x只读取一遍，每个元素只求一次exp
+static void softmax_scalar(const float* x, float* out, size_t dim) {
+    float block_max[SOFTMAX_MAX_BLOCKS];
+    size_t block = softmax_block_len(dim);
+    float max_val = -INFINITY, sum = 0.0f;
+    size_t b = 0;
+    for (size_t start = 0; start < dim; start += block, b++) {
+        size_t n = dim - start < block ? dim - start : block;
+        const float* xb = x + start;
+        float* ob = out + start;
+        float bm = xb[0];
+        for (size_t i = 1; i < n; i++) {
+            if (xb[i] > bm) bm = xb[i];
+        }
+        block_max[b] = bm;
+        // 整块为-inf时全为0，不参与合并
+        if (bm == -INFINITY) {
+            memset(ob, 0, n * sizeof(float));
+            continue;
+        }
+        float bs = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            ob[i] = expf(xb[i] - bm);
+            bs += ob[i];
+        }
+        if (bm > max_val) {
+            sum = sum * expf(max_val - bm) + bs;
+            max_val = bm;
+        } else {
+            sum += bs * expf(bm - max_val);
+        }
+    }
+    b = 0;
+    for (size_t start = 0; start < dim; start += block, b++) {
+        size_t n = dim - start < block ? dim - start : block;
+        float scale = expf(block_max[b] - max_val) / sum;
+        for (size_t i = 0; i < n; i++) {
+            out[start + i] *= scale;
+        }
+    }
+}
+
+static void silu_mul_scalar(const float* gate, const float* up, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = gate[i] / (1.0f + expf(-gate[i])) * up[i];
+    }
+}
+
+static void relu_scalar(const float* x, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = x[i] > 0.0f ? x[i] : 0.0f;
+    }
+}
+
+static void silu_scalar(const float* x, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = x[i] / (1.0f + expf(-x[i]));
+    }
+}
+
+// 0.5x(1 + tanh(u)) 写成 x * sigmoid(2u)，避免负半轴 1 + tanh 相消
+static void gelu_tanh_scalar(const float* x, float* out, size_t n) {
+    const float k = 0.7978845608f;     // sqrt(2 / pi)
+    for (size_t i = 0; i < n; i++) {
+        float v = x[i];
+        float u = k * (v + 0.044715f * v * v * v);
+        out[i] = v / (1.0f + expf(-2.0f * u));
+    }
+}
+
+// 0.5x(1 + erf(x / sqrt(2))) = 0.5x * erfc(-x / sqrt(2))
+static void gelu_erf_scalar(const float* x, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = 0.5f * x[i] * erfcf(-x[i] * 0.7071067812f);
+    }
+}
+
+static void tanh_scalar(const float* x, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = tanhf(x[i]);
+    }
+}
+
+// 逐元素返回 f'(x)，同时通过y返回 f(x)
+static inline float relu_grad1(float x, float* y) {
+    *y = x > 0.0f ? x : 0.0f;
+    return x > 0.0f ? 1.0f : 0.0f;
+}
+
+// s = sigmoid(x)，y = x * s，y' = s + y * (1 - s)
+static inline float silu_grad1(float x, float* y) {
+    float s = 1.0f / (1.0f + expf(-x));
+    *y = x * s;
+    return s + *y * (1.0f - s);
+}
+
+// s = sigmoid(2u)，y = x * s，y' = s + 2x * s(1 - s) * u'
+static inline float gelu_tanh_grad1(float x, float* y) {
+    const float k = 0.7978845608f;
+    float u = k * (x + 0.044715f * x * x * x);
+    float s = 1.0f / (1.0f + expf(-2.0f * u));
+    *y = x * s;
+    return s + 2.0f * x * s * (1.0f - s) * k * (1.0f + 3.0f * 0.044715f * x * x);
+}
+
+// y = x * Phi(x)，y' = Phi(x) + x * phi(x)
+static inline float gelu_erf_grad1(float x, float* y) {
+    float cdf = 0.5f * erfcf(-x * 0.7071067812f);
+    *y = x * cdf;
+    return cdf + x * expf(-0.5f * x * x) * 0.3989422804f;
+}
+
+// 1 - tanh^2(x)：大参数时由 t = 1 - |tanh(x)| = 2 / (exp(2|x|) + 1) 计算 t * (2 - t)，避免饱和区相消
+static inline float tanh_grad1(float x, float* y) {
+    *y = tanhf(x);
+    float ax = fabsf(x);
+    if (ax < 0.625f) return 1.0f - *y * *y;
+    float t = 2.0f / (expf(2.0f * ax) + 1.0f);
+    return t * (2.0f - t);
+}
+
+#define GRAD_SCALAR(name, fn)                                                        \
+    static void name(const float* x, const float* grad_out, float* out, float* grad, \
+                     size_t n) {                                                     \
+        for (size_t i = 0; i < n; i++) {                                             \
+            float y;                                                                 \
+            float d = fn(x[i], &y);                                                  \
+            if (grad_out) d *= grad_out[i];                                          \
+            if (out) out[i] = y;                                                     \
+            grad[i] = d;                                                             \
+        }                                                                            \
+    }
+
+GRAD_SCALAR(relu_grad_scalar, relu_grad1)
+GRAD_SCALAR(silu_grad_scalar, silu_grad1)
+GRAD_SCALAR(gelu_tanh_grad_scalar, gelu_tanh_grad1)
+GRAD_SCALAR(gelu_erf_grad_scalar, gelu_erf_grad1)
+GRAD_SCALAR(tanh_grad_scalar, tanh_grad1)
+
+// 各算子当前使用的内核
+typedef struct {
+    OpsNormKernel rmsnorm;
+    OpsNormKernel layernorm;
+    OpsAddNormKernel add_rmsnorm;
+    OpsAddNormKernel add_layernorm;
+    OpsRowKernel softmax;
+    OpsBinaryKernel silu_mul;
+    OpsUnaryKernel activation[ACTIVATION_COUNT];
+    OpsGradKernel activation_grad[ACTIVATION_COUNT];
+} OpsKernelTable;
+
+static OpsKernelTable g_ops = {
+    rmsnorm_scalar, layernorm_scalar, add_rmsnorm_scalar, add_layernorm_scalar,
+    softmax_scalar, silu_mul_scalar,
+    { relu_scalar, silu_scalar, gelu_tanh_scalar, gelu_erf_scalar, tanh_scalar },
+    { relu_grad_scalar, silu_grad_scalar, gelu_tanh_grad_scalar, gelu_erf_grad_scalar,
+      tanh_grad_scalar }
+};
+
+void ops_init(void) {
+#if defined(__x86_64__) || defined(_M_X64)
+    if (cpu_features_tier() >= CPU_TIER_AVX2) {
+        g_ops.rmsnorm = ops_rmsnorm_avx2;
+        g_ops.layernorm = ops_layernorm_avx2;
+        g_ops.add_rmsnorm = ops_add_rmsnorm_avx2;
+        g_ops.add_layernorm = ops_add_layernorm_avx2;
+        g_ops.softmax = ops_softmax_avx2;
+        g_ops.silu_mul = ops_silu_mul_avx2;
+        g_ops.activation[ACTIVATION_RELU] = ops_relu_avx2;
+        g_ops.activation[ACTIVATION_SILU] = ops_silu_avx2;
+        g_ops.activation[ACTIVATION_GELU_TANH] = ops_gelu_tanh_avx2;
+        g_ops.activation[ACTIVATION_GELU_ERF] = ops_gelu_erf_avx2;
+        g_ops.activation[ACTIVATION_TANH] = ops_tanh_avx2;
+        g_ops.activation_grad[ACTIVATION_RELU] = ops_relu_grad_avx2;
+        g_ops.activation_grad[ACTIVATION_SILU] = ops_silu_grad_avx2;
+        g_ops.activation_grad[ACTIVATION_GELU_TANH] = ops_gelu_tanh_grad_avx2;
+        g_ops.activation_grad[ACTIVATION_GELU_ERF] = ops_gelu_erf_grad_avx2;
+        g_ops.activation_grad[ACTIVATION_TANH] = ops_tanh_grad_avx2;
+    }
+    // 超越函数密集的算子换用16路内核（归一化受带宽限制，保留AVX2版本）
+    if (cpu_features_tier() >= CPU_TIER_AVX512) {
+        g_ops.softmax = ops_softmax_avx512;
+        g_ops.silu_mul = ops_silu_mul_avx512;
+        g_ops.activation[ACTIVATION_RELU] = ops_relu_avx512;
+        g_ops.activation[ACTIVATION_SILU] = ops_silu_avx512;
+        g_ops.activation[ACTIVATION_GELU_TANH] = ops_gelu_tanh_avx512;
+        g_ops.activation[ACTIVATION_GELU_ERF] = ops_gelu_erf_avx512;
+        g_ops.activation[ACTIVATION_TANH] = ops_tanh_avx512;
+        g_ops.activation_grad[ACTIVATION_RELU] = ops_relu_grad_avx512;
+        g_ops.activation_grad[ACTIVATION_SILU] = ops_silu_grad_avx512;
+        g_ops.activation_grad[ACTIVATION_GELU_TANH] = ops_gelu_tanh_grad_avx512;
+        g_ops.activation_grad[ACTIVATION_GELU_ERF] = ops_gelu_erf_grad_avx512;
+        g_ops.activation_grad[ACTIVATION_TANH] = ops_tanh_grad_avx512;
+    }
+#endif
+}
+
+static size_t div_round_up(size_t a, size_t b) {
+    return (a + b - 1) / b;
+}
+
+// 逐行算子的任务参数
+typedef struct {
+    NormType norm_type;
+    int add_residual;          // 非0时为残差相加+归一化
+    int softmax;               // 非0时为softmax
+    const float* x;
+    float* residual;
+    const float* delta;
+    const float* weight;
+    const float* bias;
+    float* out;
+    size_t rows;
+    size_t dim;
+    float eps;
+    size_t rows_per_task;
+} OpsRowArgs;
+
+static void ops_row_task(void* arg, size_t task_idx, size_t thread_idx) {
+    const OpsRowArgs* args = (const OpsRowArgs*)arg;
+    (void)thread_idx;
+    size_t r0 = task_idx * args->rows_per_task;
+    size_t r1 = r0 + args->rows_per_task;
+    if (r1 > args->rows) r1 = args->rows;
+
+    for (size_t r = r0; r < r1; r++) {
+        size_t off = r * args->dim;
+        if (args->softmax) {
+            g_ops.softmax(args->x + off, args->out + off, args->dim);
+        } else if (args->add_residual) {
+            OpsAddNormKernel kernel = (args->norm_type == NORM_LAYER) ?
+                                      g_ops.add_layernorm : g_ops.add_rmsnorm;
+            kernel(args->residual + off, args->delta + off, args->weight, args->bias,
+                   args->out + off, args->dim, args->eps);
+        } else {
+            OpsNormKernel kernel = (args->norm_type == NORM_LAYER) ?
+                                   g_ops.layernorm : g_ops.rmsnorm;
+            kernel(args->x + off, args->weight, args->bias, args->out + off,
+                   args->dim, args->eps);
+        }
+    }
+}
+
+static void ops_run_rows(ThreadPool* pool, OpsRowArgs* args) {
+    if (args->rows == 0 || args->dim == 0) return;
+
+    size_t num_threads = thread_pool_size(pool);
+    size_t total = args->rows * args->dim;
+    size_t max_tasks = div_round_up(total, OPS_MIN_ELEMS_PER_TASK);
+    if (num_threads > max_tasks) num_threads = max_tasks;
+    if (num_threads > args->rows) num_threads = args->rows;
+
+    args->rows_per_task = div_round_up(args->rows, num_threads);
+    thread_pool_parallel_for(pool, div_round_up(args->rows, args->rows_per_task),
+                             ops_row_task, args);
+}
+
+void ops_rmsnorm(ThreadPool* pool, const float* x, const float* weight, float* out,
+                 size_t rows, size_t dim, float eps) {
+    OpsRowArgs args = { NORM_RMS, 0, 0, x, NULL, NULL, weight, NULL, out, rows, dim, eps, 0 };
+    ops_run_rows(pool, &args);
+}
+
+void ops_layernorm(ThreadPool* pool, const float* x, const float* gamma, const float* beta,
+                   float* out, size_t rows, size_t dim, float eps) {
+    OpsRowArgs args = { NORM_LAYER, 0, 0, x, NULL, NULL, gamma, beta, out, rows, dim, eps, 0 };
+    ops_run_rows(pool, &args);
+}
+
+void ops_softmax(ThreadPool* pool, const float* x, float* out, size_t rows, size_t dim) {
+    OpsRowArgs args = { NORM_RMS, 0, 1, x, NULL, NULL, NULL, NULL, out, rows, dim, 0.0f, 0 };
+    ops_run_rows(pool, &args);
+}
+
+void ops_add_norm(ThreadPool* pool, NormType type, float* residual, const float* delta,
+                  const float* weight, const float* bias, float* out,
+                  size_t rows, size_t dim, float eps) {
+    OpsRowArgs args = { type, 1, 0, NULL, residual, delta, weight, bias, out, rows, dim, eps, 0 };
+    ops_run_rows(pool, &args);
+}
+
+// 逐元素算子的任务参数
+typedef struct {
+    OpsUnaryKernel unary;
+    OpsBinaryKernel binary;
+    OpsGradKernel grad_kernel;
+    const float* a;
+    const float* b;            // 导数内核的grad_out，可为NULL
+    float* out;                // 导数内核的f(x)输出，可为NULL
+    float* grad;
+    size_t size;
+    size_t chunk;
+} OpsElementwiseArgs;
+
+static void ops_elementwise_task(void* arg, size_t task_idx, size_t thread_idx) {
+    const OpsElementwiseArgs* args = (const OpsElementwiseArgs*)arg;
+    (void)thread_idx;
+    size_t start = task_idx * args->chunk;
+    size_t len = (args->size - start < args->chunk) ? args->size - start : args->chunk;
+    if (args->grad_kernel) {
+        args->grad_kernel(args->a + start, args->b ? args->b + start : NULL,
+                          args->out ? args->out + start : NULL, args->grad + start, len);
+    } else if (args->binary) {
+        args->binary(args->a + start, args->b + start, args->out + start, len);
+    } else {
+        args->unary(args->a + start, args->out + start, len);
+    }
+}
+
+static void ops_run_elementwise(ThreadPool* pool, OpsElementwiseArgs* args) {
+    if (args->size == 0) return;
+
+    size_t num_threads = thread_pool_size(pool);
+    size_t max_tasks = div_round_up(args->size, OPS_MIN_ELEMS_PER_TASK);
+    if (num_threads > max_tasks) num_threads = max_tasks;
+
+    args->chunk = div_round_up(args->size, num_threads);
+    args->chunk = div_round_up(args->chunk, OPS_CHUNK_ALIGN) * OPS_CHUNK_ALIGN;
+    thread_pool_parallel_for(pool, div_round_up(args->size, args->chunk),
+                             ops_elementwise_task, args);
+}
+
+void ops_silu_mul(ThreadPool* pool, const float* gate, const float* up, float* out, size_t size) {
+    OpsElementwiseArgs args = { NULL, g_ops.silu_mul, NULL, gate, up, out, NULL, size, 0 };
+    ops_run_elementwise(pool, &args);
+}
+
+int ops_activation(ThreadPool* pool, ActivationType type, const float* x, float* out, size_t size) {
+    if ((unsigned)type >= ACTIVATION_COUNT) return -1;
+
+    OpsElementwiseArgs args = { g_ops.activation[type], NULL, NULL, x, NULL, out, NULL, size, 0 };
+    ops_run_elementwise(pool, &args);
+    return 0;
+}
+
+int ops_activation_grad(ThreadPool* pool, ActivationType type, const float* x,
+                        const float* grad_out, float* out, float* grad, size_t size) {
+    if ((unsigned)type >= ACTIVATION_COUNT || !grad) return -1;
+
+    OpsElementwiseArgs args = { NULL, NULL, g_ops.activation_grad[type], x, grad_out, out, grad,
+                                size, 0 };
+    ops_run_elementwise(pool, &args);
+    return 0;
+}
@@ -0,0 +1,49 @@
+#ifndef OPS_H
+#define OPS_H
+
+#include <stddef.h>
+#include "hal.h"
+#include "thread_pool.h"
+
+// 单行归一化内核：out = norm(x) * weight (+ bias)，bias仅LayerNorm使用
+typedef void (*OpsNormKernel)(const float* x, const float* weight, const float* bias,
+                              float* out, size_t dim, float eps);
+
+// 残差相加+归一化内核：residual += delta，out = norm(residual)
+typedef void (*OpsAddNormKernel)(float* residual, const float* delta, const float* weight,
+                                 const float* bias, float* out, size_t dim, float eps);
+
+// 单行内核（softmax）
+typedef void (*OpsRowKernel)(const float* x, float* out, size_t dim);
+
+// 逐元素内核
+typedef void (*OpsUnaryKernel)(const float* x, float* out, size_t n);
+typedef void (*OpsBinaryKernel)(const float* a, const float* b, float* out, size_t n);
+
+// 激活导数内核：grad = f'(x)（grad_out非NULL时乘以grad_out），out非NULL时同时写出f(x)
+typedef void (*OpsGradKernel)(const float* x, const float* grad_out, float* out, float* grad,
+                              size_t n);
+
+// 初始化（按指令集层级选择内核）
+void ops_init(void);
+
+// 行主序 [rows x dim] 上的逐行算子
+void ops_rmsnorm(ThreadPool* pool, const float* x, const float* weight, float* out,
+                 size_t rows, size_t dim, float eps);
+void ops_layernorm(ThreadPool* pool, const float* x, const float* gamma, const float* beta,
+                   float* out, size_t rows, size_t dim, float eps);
+void ops_softmax(ThreadPool* pool, const float* x, float* out, size_t rows, size_t dim);
+void ops_add_norm(ThreadPool* pool, NormType type, float* residual, const float* delta,
+                  const float* weight, const float* bias, float* out,
+                  size_t rows, size_t dim, float eps);
+
+// 逐元素算子
+void ops_silu_mul(ThreadPool* pool, const float* gate, const float* up, float* out, size_t size);
+int ops_activation(ThreadPool* pool, ActivationType type, const float* x, float* out, size_t size);
+
+// 激活函数的前向与导数在同一遍内完成：grad = grad_out * f'(x)，grad_out为NULL时grad = f'(x)
+// out非NULL时同时写出f(x)；grad可与grad_out相同，out可与x相同
+int ops_activation_grad(ThreadPool* pool, ActivationType type, const float* x,
+                        const float* grad_out, float* out, float* grad, size_t size);
+
+#endif // OPS_H
@@ -0,0 +1,174 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE            // MAP_ANONYMOUS, MAP_HUGETLB, MADV_HUGEPAGE
+#endif
+
+#include "page_map.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#define BASE_PAGE_SIZE 4096
+#define DEFAULT_HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+static size_t round_up(size_t size, size_t align) {
+    return (size + align - 1) / align * align;
+}
+
+#if defined(__linux__)
+static size_t g_thp_size = 0;
+static size_t g_hugetlb_size = 0;
+
+size_t page_map_thp_size(void) {
+    if (g_thp_size) return g_thp_size;
+
+    size_t size = DEFAULT_HUGE_PAGE_SIZE;
+    FILE* fp = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+    if (fp) {
+        unsigned long long value;
+        if (fscanf(fp, "%llu", &value) == 1 && value >= BASE_PAGE_SIZE) size = (size_t)value;
+        fclose(fp);
+    }
+    g_thp_size = size;
+    return size;
+}
+
+size_t page_map_hugetlb_size(void) {
+    if (g_hugetlb_size) return g_hugetlb_size;
+
+    size_t size = DEFAULT_HUGE_PAGE_SIZE;
+    FILE* fp = fopen("/proc/meminfo", "r");
+    if (fp) {
+        char line[256];
+        unsigned long long kb;
+        while (fgets(line, sizeof(line), fp)) {
+            if (sscanf(line, "Hugepagesize: %llu kB", &kb) == 1) {
+                size = (size_t)kb * 1024;
+                break;
+            }
+        }
+        fclose(fp);
+    }
+    g_hugetlb_size = size;
+    return size;
+}
+
+// 多映射align字节后裁掉首尾，使起点按align对齐
+static void* map_aligned(size_t length, size_t align) {
+    size_t raw_length = length + align;
+    char* raw = (char*)mmap(NULL, raw_length, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+
+    char* aligned = (char*)round_up((size_t)raw, align);
+    if (aligned > raw) munmap(raw, (size_t)(aligned - raw));
+    size_t tail = (size_t)(raw + raw_length - (aligned + length));
+    if (tail > 0) munmap(aligned + length, tail);
+    return aligned;
+}
+
+int page_map(size_t size, uint32_t flags, PageMapping* mapping) {
+    if (!mapping || size == 0) return -1;
+    memset(mapping, 0, sizeof(*mapping));
+
+#ifdef MAP_HUGETLB
+    if (flags & PAGE_MAP_HUGETLB) {
+        size_t length = round_up(size, page_map_hugetlb_size());
+        void* ptr = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED) {
+            mapping->ptr = ptr;
+            mapping->length = length;
+            mapping->backing = PAGE_MAP_HUGETLB;
+            return 0;
+        }
+        // 预留页不足或未配置hugetlbfs
+        flags |= PAGE_MAP_THP;
+    }
+#endif
+
+    size_t length = round_up(size, BASE_PAGE_SIZE);
+    if (flags & PAGE_MAP_THP) {
+        void* ptr = map_aligned(length, page_map_thp_size());
+        if (ptr) {
+            mapping->ptr = ptr;
+            mapping->length = length;
+#ifdef MADV_HUGEPAGE
+            // THP被禁用（never）时madvise失败，映射仍可按普通页使用
+            if (madvise(ptr, length, MADV_HUGEPAGE) == 0) mapping->backing = PAGE_MAP_THP;
+#endif
+            return 0;
+        }
+    }
+
+    void* ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) return -1;
+    mapping->ptr = ptr;
+    mapping->length = length;
+    return 0;
+}
+
+void page_unmap(const PageMapping* mapping) {
+    if (mapping && mapping->ptr) munmap(mapping->ptr, mapping->length);
+}
+
+size_t page_map_huge_bytes(const PageMapping* mapping) {
+    if (!mapping || !mapping->ptr) return 0;
+    if (mapping->backing == PAGE_MAP_HUGETLB) return mapping->length;
+    if (mapping->backing != PAGE_MAP_THP) return 0;
+
+    FILE* fp = fopen("/proc/self/smaps", "r");
+    if (!fp) return 0;
+
+    uintptr_t lo = (uintptr_t)mapping->ptr;
+    uintptr_t hi = lo + mapping->length;
+    int in_range = 0;
+    size_t total = 0;
+    char line[512];
+
+    while (fgets(line, sizeof(line), fp)) {
+        unsigned long long start, end, kb;
+        if (sscanf(line, "%llx-%llx ", &start, &end) == 2) {
+            in_range = start < hi && end > lo;
+        } else if (in_range && sscanf(line, "AnonHugePages: %llu kB", &kb) == 1) {
+            total += (size_t)kb * 1024;
+        }
+    }
+    fclose(fp);
+
+    // 相邻VMA合并时统计可能超出本映射
+    return total < mapping->length ? total : mapping->length;
+}
+#else
+size_t page_map_thp_size(void) {
+    return DEFAULT_HUGE_PAGE_SIZE;
+}
+
+size_t page_map_hugetlb_size(void) {
+    return DEFAULT_HUGE_PAGE_SIZE;
+}
+
+int page_map(size_t size, uint32_t flags, PageMapping* mapping) {
+    (void)flags;
+    if (!mapping || size == 0) return -1;
+    memset(mapping, 0, sizeof(*mapping));
+
+    size_t length = round_up(size, BASE_PAGE_SIZE);
+    mapping->ptr = aligned_alloc(BASE_PAGE_SIZE, length);
+    if (!mapping->ptr) return -1;
+    mapping->length = length;
+    return 0;
+}
+
+void page_unmap(const PageMapping* mapping) {
+    if (mapping) free(mapping->ptr);
+}
+
+size_t page_map_huge_bytes(const PageMapping* mapping) {
+    (void)mapping;
+    return 0;
+}
+#endif
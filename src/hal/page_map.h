@@ -0,0 +1,31 @@
+#ifndef PAGE_MAP_H
+#define PAGE_MAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 映射选项
+#define PAGE_MAP_THP      (1u << 0)    // 透明大页：按大页大小对齐并madvise(MADV_HUGEPAGE)
+#define PAGE_MAP_HUGETLB  (1u << 1)    // 显式大页（MAP_HUGETLB，使用预留的hugetlbfs页），失败时回退到透明大页
+
+// 匿名内存映射
+typedef struct {
+    void* ptr;                 // 映射起点（页对齐）
+    size_t length;             // 映射长度
+    uint32_t backing;          // 实际生效的选项：PAGE_MAP_HUGETLB / PAGE_MAP_THP / 0（普通页）
+} PageMapping;
+
+// 映射至少size字节的匿名内存，大页不可用时依次回退，只有普通映射也失败时才返回-1
+int page_map(size_t size, uint32_t flags, PageMapping* mapping);
+
+// 解除映射
+void page_unmap(const PageMapping* mapping);
+
+// 映射范围内实际由大页支撑的字节数（读取/proc/self/smaps，按与范围重叠的VMA统计）
+size_t page_map_huge_bytes(const PageMapping* mapping);
+
+// 透明大页大小 / 默认显式大页大小（无法查询时为2MB）
+size_t page_map_thp_size(void);
+size_t page_map_hugetlb_size(void);
+
+#endif // PAGE_MAP_H
@@ -0,0 +1,406 @@
+#include "qgemm.h"
+#include "cpu_features.h"
+#include "thread_scratch.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+// x86_64 微内核（src/hal/x86_64/qgemm_*.c）
+extern void qgemm_kernel_avx2_4x8(size_t kg, const uint8_t* a_panel, const int8_t* b_panel,
+                                  int32_t* tile);
+extern void qgemm_kernel_avxvnni_6x16(size_t kg, const uint8_t* a_panel, const int8_t* b_panel,
+                                      int32_t* tile);
+extern void qgemm_kernel_avx512vnni_12x32(size_t kg, const uint8_t* a_panel, const int8_t* b_panel,
+                                          int32_t* tile);
+#endif
+
+// 通用微内核尺寸
+#define GENERIC_MR 4
+#define GENERIC_NR 8
+
+// 所有微内核中最大的tile
+#define QGEMM_MAX_MR 12
+#define QGEMM_MAX_NR 32
+
+// 打包缓冲区对齐
+#define PACK_ALIGN 64
+
+// 并行计算时单个任务的最小乘加量，低于该值直接单线程执行
+#define QGEMM_PARALLEL_MIN_OPS (1u << 20)
+
+// 通用C微内核（无SIMD的平台使用）
+static void qgemm_kernel_generic(size_t kg, const uint8_t* a_panel, const int8_t* b_panel,
+                                 int32_t* tile) {
+    int32_t acc[GENERIC_MR][GENERIC_NR] = {{0}};
+
+    for (size_t g = 0; g < kg; g++) {
+        const uint8_t* a = a_panel + g * GENERIC_MR * 4;
+        const int8_t* b = b_panel + g * GENERIC_NR * 4;
+        for (size_t i = 0; i < GENERIC_MR; i++) {
+            for (size_t j = 0; j < GENERIC_NR; j++) {
+                for (size_t u = 0; u < 4; u++) {
+                    acc[i][j] += (int32_t)a[i * 4 + u] * (int32_t)b[j * 4 + u];
+                }
+            }
+        }
+    }
+
+    memcpy(tile, acc, sizeof(acc));
+}
+
+static QGemmKernelInfo g_kernel = {
+    qgemm_kernel_generic, GENERIC_MR, GENERIC_NR, "generic_4x8"
+};
+static size_t g_l2_size = 0;
+static size_t g_l3_size = 0;
+
+void qgemm_init(void) {
+    g_kernel.kernel = qgemm_kernel_generic;
+    g_kernel.mr = GENERIC_MR;
+    g_kernel.nr = GENERIC_NR;
+    g_kernel.name = "generic_4x8";
+
+#if defined(__x86_64__) || defined(_M_X64)
+    CpuTier tier = cpu_features_tier();
+    if (tier >= CPU_TIER_AVX512_VNNI) {
+        g_kernel.kernel = qgemm_kernel_avx512vnni_12x32;
+        g_kernel.mr = 12;
+        g_kernel.nr = 32;
+        g_kernel.name = "avx512vnni_12x32";
+    } else if (tier >= CPU_TIER_AVX2 && cpu_has_feature(CPU_FEATURE_AVX_VNNI)) {
+        g_kernel.kernel = qgemm_kernel_avxvnni_6x16;
+        g_kernel.mr = 6;
+        g_kernel.nr = 16;
+        g_kernel.name = "avxvnni_6x16";
+    } else if (tier >= CPU_TIER_AVX2) {
+        g_kernel.kernel = qgemm_kernel_avx2_4x8;
+        g_kernel.mr = 4;
+        g_kernel.nr = 8;
+        g_kernel.name = "avx2_4x8";
+    }
+#endif
+
+    g_l2_size = cpu_cache_size(2);
+    g_l3_size = cpu_cache_size(3);
+}
+
+const QGemmKernelInfo* qgemm_get_kernel(void) {
+    return &g_kernel;
+}
+
+void qgemm_params_from_quant(QGemmParams* params,
+                             const QuantParams* a_params,
+                             const QuantParams* b_params) {
+    if (!params || !a_params || !b_params) return;
+
+    memset(params, 0, sizeof(*params));
+    params->output_type = QGEMM_OUTPUT_FP32;
+    params->a_scale = a_params->scale;
+    params->a_zero_point = a_params->zero_point;
+    params->b_scale = b_params->scale;
+    params->b_zero_point = b_params->zero_point;
+    params->out_scale = 1.0f;
+}
+
+static size_t div_round_up(size_t a, size_t b) {
+    return (a + b - 1) / b;
+}
+
+// 打包A块: [mb x k] -> 按MR行切分的微面板，每个面板布局为 [kp/4][MR][4]，尾部补零
+// 同时计算每行的和（零点校正项）
+static void pack_a(size_t mb, size_t k, size_t kp, const uint8_t* a, size_t lda,
+                   uint8_t* packed, int32_t* row_sums, size_t mr) {
+    for (size_t i = 0; i < mb; i += mr) {
+        size_t rows = (mb - i < mr) ? mb - i : mr;
+        uint8_t* panel = packed + i * kp;
+        if (rows < mr) {
+            memset(panel, 0, mr * kp);
+        }
+
+        for (size_t r = 0; r < rows; r++) {
+            const uint8_t* src = a + (i + r) * lda;
+            uint8_t* dst = panel + r * 4;
+            int32_t sum = 0;
+            size_t l = 0;
+            for (; l + 4 <= k; l += 4) {
+                memcpy(dst, src + l, 4);
+                dst += mr * 4;
+            }
+            if (l < k) {
+                uint8_t quad[4] = { 0, 0, 0, 0 };
+                memcpy(quad, src + l, k - l);
+                memcpy(dst, quad, 4);
+            }
+            for (l = 0; l < k; l++) {
+                sum += src[l];
+            }
+            row_sums[i + r] = sum;
+        }
+    }
+}
+
+// 打包B块中 [j0, j1) 列范围: [k x nb] -> 按NR列切分的微面板，每个面板布局为 [kp/4][NR][4]
+// 元素转换为 int8(b - 128) 以满足vpdpbusd的有符号操作数，尾部补零；同时计算每列的和
+// j0必须是NR的整数倍
+static void pack_b(size_t k, size_t kp, size_t nb, size_t j0, size_t j1,
+                   const uint8_t* b, size_t ldb, int8_t* packed, int32_t* col_sums,
+                   size_t nr) {
+    if (j1 > nb) j1 = nb;
+    for (size_t j = j0; j < j1; j += nr) {
+        size_t cols = (nb - j < nr) ? nb - j : nr;
+        int8_t* panel = packed + j * kp;
+        if (cols < nr || kp != k) {
+            memset(panel, 0, nr * kp);
+        }
+
+        for (size_t l = 0; l < k; l++) {
+            const uint8_t* src = b + l * ldb + j;
+            int8_t* dst = panel + (l / 4) * nr * 4 + (l % 4);
+            for (size_t c = 0; c < cols; c++) {
+                dst[c * 4] = (int8_t)(src[c] ^ 0x80);
+            }
+        }
+
+        memset(col_sums + j, 0, cols * sizeof(int32_t));
+        for (size_t l = 0; l < k; l++) {
+            const uint8_t* src = b + l * ldb + j;
+            for (size_t c = 0; c < cols; c++) {
+                col_sums[j + c] += src[c];
+            }
+        }
+    }
+}
+
+// 一次jc迭代中共享的计算参数
+typedef struct {
+    const QGemmKernelInfo* kernel;
+    const QGemmParams* params;
+    size_t m;                  // 总行数
+    size_t k;
+    size_t kp;                 // K补齐到4的整数倍
+    size_t nb;                 // 当前N分块
+    size_t jc;                 // 当前N分块在C中的起始列
+    const uint8_t* a;
+    size_t lda;
+    const uint8_t* b;          // B在当前N分块的起点
+    size_t ldb;
+    int8_t* b_packed;          // 共享的B打包缓冲区
+    int32_t* col_sums;         // 当前N分块每列的和
+    void* c;
+    size_t ldc;
+    size_t mc;                 // A块行数
+
+    // 任务划分：m_tasks x n_tasks 个二维任务
+    size_t rows_per_task;
+    size_t cols_per_task;
+    size_t n_tasks;
+    size_t pack_cols_per_task;
+} QGemmMacroArgs;
+
+// epilogue：零点校正并写出 tile 中 [rows x cols] 的有效部分
+// sum((a - za)(b - zb)) = acc + (128 - zb) * sum(a) - za * sum(b) + k * za * zb
+// 其中acc为 a 与 (b - 128) 的点积
+static void qgemm_store_tile(const QGemmMacroArgs* args, const int32_t* tile, size_t ld_tile,
+                             const int32_t* row_sums, size_t i, size_t j,
+                             size_t rows, size_t cols) {
+    const QGemmParams* p = args->params;
+    const int64_t za = p->a_zero_point;
+    const int64_t zb = p->b_zero_point;
+    const int64_t kzz = (int64_t)args->k * za * zb;
+    const float scale = p->a_scale * p->b_scale;
+    const size_t col0 = args->jc + j;
+
+    int64_t col_term[QGEMM_MAX_NR];
+    for (size_t c = 0; c < cols; c++) {
+        col_term[c] = -za * args->col_sums[j + c];
+    }
+
+    for (size_t r = 0; r < rows; r++) {
+        const int32_t* acc = tile + r * ld_tile;
+        int64_t row_term = (128 - zb) * row_sums[r] + kzz;
+        size_t offset = (i + r) * args->ldc + col0;
+
+        switch (p->output_type) {
+            case QGEMM_OUTPUT_INT32: {
+                int32_t* out = (int32_t*)args->c + offset;
+                for (size_t c = 0; c < cols; c++) {
+                    int64_t v = acc[c] + row_term + col_term[c];
+                    if (v > INT32_MAX) v = INT32_MAX;
+                    if (v < INT32_MIN) v = INT32_MIN;
+                    out[c] = (int32_t)v;
+                }
+                break;
+            }
+            case QGEMM_OUTPUT_FP32: {
+                float* out = (float*)args->c + offset;
+                for (size_t c = 0; c < cols; c++) {
+                    float v = (float)(acc[c] + row_term + col_term[c]) * scale;
+                    out[c] = p->bias ? v + p->bias[col0 + c] : v;
+                }
+                break;
+            }
+            case QGEMM_OUTPUT_UINT8: {
+                uint8_t* out = (uint8_t*)args->c + offset;
+                for (size_t c = 0; c < cols; c++) {
+                    float v = (float)(acc[c] + row_term + col_term[c]) * scale;
+                    if (p->bias) v += p->bias[col0 + c];
+                    float scaled = v / p->out_scale + p->out_zero_point;
+                    if (scaled > 255) scaled = 255;
+                    if (scaled < 0) scaled = 0;
+                    out[c] = (uint8_t)(scaled + 0.5f);
+                }
+                break;
+            }
+        }
+    }
+}
+
+// 宏内核：计算行 [i0, i1) 与列 [j0, j1) 的C块，A由当前线程打包
+static void qgemm_macro_kernel(const QGemmMacroArgs* args, size_t i0, size_t i1,
+                               size_t j0, size_t j1) {
+    const size_t mr = args->kernel->mr;
+    const size_t nr = args->kernel->nr;
+    const size_t kp = args->kp;
+    _Alignas(PACK_ALIGN) int32_t tile[QGEMM_MAX_MR * QGEMM_MAX_NR];
+
+    if (i1 > args->m) i1 = args->m;
+    if (j1 > args->nb) j1 = args->nb;
+    if (i0 >= i1 || j0 >= j1) return;
+
+    size_t mc_eff = args->mc;
+    if (i1 - i0 < mc_eff) mc_eff = div_round_up(i1 - i0, mr) * mr;
+    uint8_t* a_buf = (uint8_t*)thread_scratch(SCRATCH_QGEMM_PACK_A, mc_eff * kp);
+    int32_t* row_sums = (int32_t*)thread_scratch(SCRATCH_QGEMM_ROW_SUMS, mc_eff * sizeof(int32_t));
+    if (!a_buf || !row_sums) return;
+
+    for (size_t ic = i0; ic < i1; ic += args->mc) {
+        size_t mb = (i1 - ic < args->mc) ? i1 - ic : args->mc;
+
+        pack_a(mb, args->k, kp, args->a + ic * args->lda, args->lda, a_buf, row_sums, mr);
+
+        for (size_t jr = j0; jr < j1; jr += nr) {
+            size_t cols = (j1 - jr < nr) ? j1 - jr : nr;
+            const int8_t* b_panel = args->b_packed + jr * kp;
+
+            for (size_t ir = 0; ir < mb; ir += mr) {
+                size_t rows = (mb - ir < mr) ? mb - ir : mr;
+                args->kernel->kernel(kp / 4, a_buf + ir * kp, b_panel, tile);
+                qgemm_store_tile(args, tile, nr, row_sums + ir, ic + ir, jr, rows, cols);
+            }
+        }
+    }
+}
+
+static void qgemm_pack_b_task(void* arg, size_t task_idx, size_t thread_idx) {
+    const QGemmMacroArgs* args = (const QGemmMacroArgs*)arg;
+    (void)thread_idx;
+    size_t j0 = task_idx * args->pack_cols_per_task;
+    pack_b(args->k, args->kp, args->nb, j0, j0 + args->pack_cols_per_task,
+           args->b, args->ldb, args->b_packed, args->col_sums, args->kernel->nr);
+}
+
+static void qgemm_macro_task(void* arg, size_t task_idx, size_t thread_idx) {
+    const QGemmMacroArgs* args = (const QGemmMacroArgs*)arg;
+    (void)thread_idx;
+    size_t mi = task_idx / args->n_tasks;
+    size_t ni = task_idx % args->n_tasks;
+    size_t i0 = mi * args->rows_per_task;
+    size_t j0 = ni * args->cols_per_task;
+    qgemm_macro_kernel(args, i0, i0 + args->rows_per_task, j0, j0 + args->cols_per_task);
+}
+
+int qgemm_u8u8(ThreadPool* pool, size_t m, size_t n, size_t k,
+               const uint8_t* a, size_t lda,
+               const uint8_t* b, size_t ldb,
+               void* c, size_t ldc,
+               const QGemmParams* params) {
+    if (!a || !b || !c || !params) return -1;
+    if (k > QGEMM_MAX_K) return -1;
+    if (params->a_zero_point < 0 || params->a_zero_point > 255 ||
+        params->b_zero_point < 0 || params->b_zero_point > 255) {
+        return -1;
+    }
+    if (params->output_type == QGEMM_OUTPUT_UINT8 && !(params->out_scale > 0.0f)) {
+        return -1;
+    }
+    if (m == 0 || n == 0) return 0;
+
+    if (g_l2_size == 0) {
+        qgemm_init();
+    }
+
+    const QGemmKernelInfo* kernel = &g_kernel;
+    const size_t mr = kernel->mr;
+    const size_t nr = kernel->nr;
+    const size_t kp = (k + 3) & ~(size_t)3;
+
+    // K方向不分块：int32累加器在寄存器中完成整个K，epilogue直接作用于每个tile
+    // A块占用一半L2，B块占用一半L3
+    size_t kp_eff = kp ? kp : 4;
+    size_t mc = (g_l2_size / 2) / kp_eff;
+    mc -= mc % mr;
+    if (mc < mr) mc = mr;
+    if (mc > 960) mc = 960 - 960 % mr;
+
+    size_t nc = (g_l3_size / 2) / kp_eff;
+    nc -= nc % nr;
+    if (nc < nr) nc = nr;
+    if (nc > 8192) nc = 8192 - 8192 % nr;
+
+    // 线程数：按总计算量限制，避免小矩阵的调度开销
+    size_t num_threads = thread_pool_size(pool);
+    double ops = (double)m * (double)n * (double)k;
+    size_t max_useful = (size_t)(ops / QGEMM_PARALLEL_MIN_OPS) + 1;
+    if (num_threads > max_useful) num_threads = max_useful;
+
+    size_t nc_eff = (n < nc) ? div_round_up(n, nr) * nr : nc;
+    int8_t* b_buf = (int8_t*)thread_scratch(SCRATCH_QGEMM_PACK_B, kp * nc_eff);
+    int32_t* col_sums = (int32_t*)thread_scratch(SCRATCH_QGEMM_COL_SUMS, nc_eff * sizeof(int32_t));
+    if (!b_buf || !col_sums) return -1;
+
+    QGemmMacroArgs args;
+    args.kernel = kernel;
+    args.params = params;
+    args.m = m;
+    args.k = k;
+    args.kp = kp;
+    args.a = a;
+    args.lda = lda;
+    args.ldb = ldb;
+    args.b_packed = b_buf;
+    args.col_sums = col_sums;
+    args.c = c;
+    args.ldc = ldc;
+
+    for (size_t jc = 0; jc < n; jc += nc) {
+        size_t nb = (n - jc < nc) ? n - jc : nc;
+        size_t n_panels = div_round_up(nb, nr);
+        size_t m_panels = div_round_up(m, mr);
+
+        // 任务划分：优先按M切分（各线程打包各自的A块），M不足时再按N切分
+        size_t m_tasks = (m_panels < num_threads) ? m_panels : num_threads;
+        size_t n_tasks = div_round_up(num_threads, m_tasks);
+        if (n_tasks > n_panels) n_tasks = n_panels;
+
+        args.rows_per_task = div_round_up(m_panels, m_tasks) * mr;
+        args.cols_per_task = div_round_up(n_panels, n_tasks) * nr;
+        args.n_tasks = div_round_up(nb, args.cols_per_task);
+        m_tasks = div_round_up(m, args.rows_per_task);
+
+        args.mc = mc;
+        if (args.rows_per_task < args.mc) args.mc = args.rows_per_task;
+
+        size_t pack_tasks = (n_panels < num_threads) ? n_panels : num_threads;
+        args.pack_cols_per_task = div_round_up(n_panels, pack_tasks) * nr;
+        pack_tasks = div_round_up(nb, args.pack_cols_per_task);
+
+        args.nb = nb;
+        args.jc = jc;
+        args.b = b + jc;
+
+        thread_pool_parallel_for(pool, pack_tasks, qgemm_pack_b_task, &args);
+        thread_pool_parallel_for(pool, m_tasks * args.n_tasks, qgemm_macro_task, &args);
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#ifndef QGEMM_H
+#define QGEMM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "quantization.h"
+#include "thread_pool.h"
+
+// K的上限：保证 a * (b - 128) 的int32累加不溢出（65536 * 255 * 128 < 2^31）
+#define QGEMM_MAX_K 65536
+
+// INT8 GEMM 输出类型（融合在GEMM尾部的epilogue）
+typedef enum {
+    QGEMM_OUTPUT_INT32,        // 经过零点校正的int32累加结果
+    QGEMM_OUTPUT_FP32,         // 反量化为fp32
+    QGEMM_OUTPUT_UINT8         // 重新量化为uint8
+} QGemmOutputType;
+
+// INT8 GEMM 参数
+// A、B均为quant_quantize输出的uint8数据: real = (q - zero_point) * scale
+typedef struct QGemmParams {
+    QGemmOutputType output_type;
+    float a_scale;
+    int32_t a_zero_point;
+    float b_scale;
+    int32_t b_zero_point;
+    const float* bias;         // 可选，长度n，在反量化后相加
+    float out_scale;           // 重新量化参数（仅QGEMM_OUTPUT_UINT8）
+    int32_t out_zero_point;
+} QGemmParams;
+
+// 微内核：计算完整的 MR x NR int32 块，写入连续的tile（行距为NR）
+// a_panel: [kg][MR][4] uint8，b_panel: [kg][NR][4] int8（b-128），kg为K方向的4元组数
+// 尾部行列与零点校正由调用方在epilogue中处理
+typedef void (*QGemmMicroKernel)(size_t kg, const uint8_t* a_panel, const int8_t* b_panel,
+                                 int32_t* tile);
+
+// 微内核描述
+typedef struct {
+    QGemmMicroKernel kernel;
+    size_t mr;
+    size_t nr;
+    const char* name;
+} QGemmKernelInfo;
+
+// 初始化（按指令集层级选择微内核）
+void qgemm_init(void);
+
+// 获取当前使用的微内核
+const QGemmKernelInfo* qgemm_get_kernel(void);
+
+// 由quant_calibrate得到的量化参数填充GEMM参数（输出为fp32）
+void qgemm_params_from_quant(QGemmParams* params,
+                             const QuantParams* a_params,
+                             const QuantParams* b_params);
+
+// uint8 x uint8 GEMM: C[m x n] = epilogue(A[m x k] * B[k x n])
+// c的元素类型由params->output_type决定，ldc以元素为单位
+int qgemm_u8u8(ThreadPool* pool, size_t m, size_t n, size_t k,
+               const uint8_t* a, size_t lda,
+               const uint8_t* b, size_t ldb,
+               void* c, size_t ldc,
+               const QGemmParams* params);
+
+#endif // QGEMM_H
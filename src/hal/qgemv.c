@@ -0,0 +1,210 @@
+#include "qgemv.h"
+#include "cpu_features.h"
+#include "thread_scratch.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+// x86_64 内核（src/hal/x86_64/qgemv_*.c）
+extern void qgemv_q4_f32_avx2(const uint8_t* w, size_t row_bytes, const void* x,
+                              int32_t x_zero_point, const float* scales, size_t scale_stride,
+                              size_t group_size, size_t k, float* y, size_t rows);
+extern void qgemv_q4_u8_avx2(const uint8_t* w, size_t row_bytes, const void* x,
+                             int32_t x_zero_point, const float* scales, size_t scale_stride,
+                             size_t group_size, size_t k, float* y, size_t rows);
+extern void qgemv_q4_f32_avx512(const uint8_t* w, size_t row_bytes, const void* x,
+                                int32_t x_zero_point, const float* scales, size_t scale_stride,
+                                size_t group_size, size_t k, float* y, size_t rows);
+#endif
+
+// 每个任务的最小行数
+#define QGEMV_MIN_ROWS_PER_TASK 16
+
+static inline int nibble_at(const uint8_t* w, size_t l) {
+    uint8_t v = w[l >> 1];
+    return (l & 1) ? (v & 0x0F) : (v >> 4);
+}
+
+// 标量实现
+static void qgemv_q4_f32_scalar(const uint8_t* w, size_t row_bytes, const void* x_ptr,
+                                int32_t x_zero_point, const float* scales, size_t scale_stride,
+                                size_t group_size, size_t k, float* y, size_t rows) {
+    const float* x = (const float*)x_ptr;
+    (void)x_zero_point;
+
+    for (size_t r = 0; r < rows; r++) {
+        const uint8_t* wr = w + r * row_bytes;
+        const float* sr = scales + r * scale_stride;
+        float sum = 0.0f;
+        for (size_t g0 = 0, gi = 0; g0 < k; g0 += group_size, gi++) {
+            size_t end = (k - g0 < group_size) ? k : g0 + group_size;
+            float dot = 0.0f;
+            for (size_t l = g0; l < end; l++) {
+                dot += (float)nibble_at(wr, l) * x[l];
+            }
+            sum += sr[gi] * dot;
+        }
+        y[r] = sum;
+    }
+}
+
+static void qgemv_q4_u8_scalar(const uint8_t* w, size_t row_bytes, const void* x_ptr,
+                               int32_t x_zero_point, const float* scales, size_t scale_stride,
+                               size_t group_size, size_t k, float* y, size_t rows) {
+    const uint8_t* x = (const uint8_t*)x_ptr;
+
+    for (size_t r = 0; r < rows; r++) {
+        const uint8_t* wr = w + r * row_bytes;
+        const float* sr = scales + r * scale_stride;
+        float sum = 0.0f;
+        for (size_t g0 = 0, gi = 0; g0 < k; g0 += group_size, gi++) {
+            size_t end = (k - g0 < group_size) ? k : g0 + group_size;
+            int32_t dot = 0;
+            for (size_t l = g0; l < end; l++) {
+                dot += nibble_at(wr, l) * ((int32_t)x[l] - x_zero_point);
+            }
+            sum += sr[gi] * (float)dot;
+        }
+        y[r] = sum;
+    }
+}
+
+static Q4RowsKernel g_f32_kernel = qgemv_q4_f32_scalar;
+static Q4RowsKernel g_u8_kernel = qgemv_q4_u8_scalar;
+
+void qgemv_init(void) {
+    g_f32_kernel = qgemv_q4_f32_scalar;
+    g_u8_kernel = qgemv_q4_u8_scalar;
+
+#if defined(__x86_64__) || defined(_M_X64)
+    CpuTier tier = cpu_features_tier();
+    if (tier >= CPU_TIER_AVX512) {
+        g_f32_kernel = qgemv_q4_f32_avx512;
+        g_u8_kernel = qgemv_q4_u8_avx2;
+    } else if (tier >= CPU_TIER_AVX2) {
+        g_f32_kernel = qgemv_q4_f32_avx2;
+        g_u8_kernel = qgemv_q4_u8_avx2;
+    }
+#endif
+}
+
+static size_t div_round_up(size_t a, size_t b) {
+    return (a + b - 1) / b;
+}
+
+// 按行切分的任务参数
+typedef struct {
+    Q4RowsKernel kernel;
+    const Q4GemvParams* params;
+    size_t m;
+    size_t k;
+    size_t row_bytes;
+    size_t group_size;         // 实际分组大小（per-tensor时为k）
+    size_t scale_stride;       // 每行的scale/零点个数（per-tensor时为0）
+    size_t num_groups;
+    const uint8_t* w;
+    const void* x;
+    float* y;
+    const float* group_sums;
+    int has_zero_point;
+    size_t rows_per_task;
+} QGemvRowsArgs;
+
+static void qgemv_rows_task(void* arg, size_t task_idx, size_t thread_idx) {
+    const QGemvRowsArgs* args = (const QGemvRowsArgs*)arg;
+    const Q4GemvParams* p = args->params;
+    (void)thread_idx;
+
+    size_t i0 = task_idx * args->rows_per_task;
+    size_t rows = (args->m - i0 < args->rows_per_task) ? args->m - i0 : args->rows_per_task;
+    int32_t x_zero_point = (p->act_type == Q4_ACT_UINT8) ? p->act_zero_point : 0;
+
+    args->kernel(args->w + i0 * args->row_bytes, args->row_bytes, args->x, x_zero_point,
+                 p->scales + i0 * args->scale_stride, args->scale_stride,
+                 args->group_size, args->k, args->y + i0, rows);
+
+    // 权重零点校正: sum((w - zw) * x') = sum(w * x') - zw * sum(x')
+    for (size_t r = 0; r < rows; r++) {
+        size_t base = (i0 + r) * args->scale_stride;
+        float v = args->y[i0 + r];
+        if (args->has_zero_point) {
+            const float* sr = p->scales + base;
+            for (size_t g = 0; g < args->num_groups; g++) {
+                int32_t zw = p->zero_points ? p->zero_points[base + g] : p->zero_point;
+                v -= sr[g] * (float)zw * args->group_sums[g];
+            }
+        }
+        if (p->act_type == Q4_ACT_UINT8) {
+            v *= p->act_scale;
+        }
+        args->y[i0 + r] = v;
+    }
+}
+
+int qgemv_q4(ThreadPool* pool, size_t m, size_t k,
+             const uint8_t* w, const void* x, float* y,
+             const Q4GemvParams* params) {
+    if (!w || !x || !y || !params || !params->scales) return -1;
+    if (k % 2 != 0 || params->group_size % 2 != 0) return -1;
+    if (params->act_type == Q4_ACT_UINT8 &&
+        (params->act_zero_point < 0 || params->act_zero_point > 255)) {
+        return -1;
+    }
+    if (m == 0) return 0;
+    if (k == 0) {
+        memset(y, 0, m * sizeof(float));
+        return 0;
+    }
+
+    QGemvRowsArgs args;
+    args.params = params;
+    args.m = m;
+    args.k = k;
+    args.row_bytes = k / 2;
+    args.w = w;
+    args.x = x;
+    args.y = y;
+    args.kernel = (params->act_type == Q4_ACT_UINT8) ? g_u8_kernel : g_f32_kernel;
+
+    if (params->group_size == 0 || params->group_size >= k) {
+        args.group_size = k;
+        args.num_groups = 1;
+    } else {
+        args.group_size = params->group_size;
+        args.num_groups = div_round_up(k, params->group_size);
+    }
+    args.scale_stride = (params->group_size == 0) ? 0 : args.num_groups;
+    args.has_zero_point = params->zero_points != NULL || params->zero_point != 0;
+
+    // 预先计算每组的激活之和（uint8激活为减去零点后的和），所有行共享
+    float* sums = (float*)thread_scratch(SCRATCH_QGEMV_GROUP_SUMS, args.num_groups * sizeof(float));
+    if (!sums) return -1;
+    for (size_t g = 0; g < args.num_groups; g++) {
+        size_t g0 = g * args.group_size;
+        size_t end = (k - g0 < args.group_size) ? k : g0 + args.group_size;
+        if (params->act_type == Q4_ACT_UINT8) {
+            const uint8_t* xq = (const uint8_t*)x;
+            int32_t s = 0;
+            for (size_t l = g0; l < end; l++) {
+                s += (int32_t)xq[l] - params->act_zero_point;
+            }
+            sums[g] = (float)s;
+        } else {
+            const float* xf = (const float*)x;
+            float s = 0.0f;
+            for (size_t l = g0; l < end; l++) {
+                s += xf[l];
+            }
+            sums[g] = s;
+        }
+    }
+    args.group_sums = sums;
+
+    size_t num_threads = thread_pool_size(pool);
+    size_t max_tasks = div_round_up(m, QGEMV_MIN_ROWS_PER_TASK);
+    if (num_threads > max_tasks) num_threads = max_tasks;
+
+    args.rows_per_task = div_round_up(m, num_threads);
+    thread_pool_parallel_for(pool, div_round_up(m, args.rows_per_task), qgemv_rows_task, &args);
+    return 0;
+}
@@ -0,0 +1,44 @@
+#ifndef QGEMV_H
+#define QGEMV_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "thread_pool.h"
+
+// INT4 GEMV 激活类型
+typedef enum {
+    Q4_ACT_FP32,               // fp32激活向量
+    Q4_ACT_UINT8               // quant_quantize输出的uint8激活向量
+} Q4ActivationType;
+
+// INT4权重GEMV参数
+// 权重为quant_quantize的INT4输出：每字节两个元素，高半字节在前，real = (q - zp) * scale
+// 量化沿K方向按组进行，每行 m 有 ceil(k / group_size) 组
+typedef struct Q4GemvParams {
+    size_t group_size;             // 每组元素数（偶数），0表示整个张量共享 scales[0]
+    const float* scales;           // [m][num_groups]，group_size为0时只读取 scales[0]
+    const uint8_t* zero_points;    // 可选 [m][num_groups]（0-15），NULL时所有组使用zero_point
+    int32_t zero_point;
+
+    Q4ActivationType act_type;
+    float act_scale;               // 仅Q4_ACT_UINT8
+    int32_t act_zero_point;        // 仅Q4_ACT_UINT8
+} Q4GemvParams;
+
+// 按行的INT4点积内核：y[r] = sum_g scale[r][g] * sum_{l in g} w[r][l] * x'[l]
+// w为未减零点的半字节（0-15），x' = x（fp32）或 x - x_zero_point（uint8）
+// 零点项与激活scale由调用方在内核之后统一处理
+typedef void (*Q4RowsKernel)(const uint8_t* w, size_t row_bytes, const void* x,
+                             int32_t x_zero_point, const float* scales, size_t scale_stride,
+                             size_t group_size, size_t k, float* y, size_t rows);
+
+// 初始化（按指令集层级选择内核）
+void qgemv_init(void);
+
+// y[m] = dequant(W[m x k]) * x[k]，W为INT4打包数据，每行 k / 2 字节（k必须为偶数）
+// x的类型由params->act_type决定，按输出行切分到线程池
+int qgemv_q4(ThreadPool* pool, size_t m, size_t k,
+             const uint8_t* w, const void* x, float* y,
+             const Q4GemvParams* params);
+
+#endif // QGEMV_H
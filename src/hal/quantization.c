@@ -1,32 +1,11 @@
 #include "quantization.h"
 #include "fp8.h"
+#include "fp16.h"
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <float.h>
 
-// FP16相关的辅助函数
-static uint16_t float_to_fp16(float value) {
-    uint32_t x = *(uint32_t*)&value;
-    uint32_t sign = (x >> 31) & 0x1;
-    uint32_t exp = ((x >> 23) & 0xFF) - 127 + 15;
-    uint32_t frac = (x >> 13) & 0x3FF;
-    
-    if (exp > 31) exp = 31;
-    else if (exp < 0) exp = 0;
-    
-    return (sign << 15) | (exp << 10) | frac;
-}
-
-static float fp16_to_float(uint16_t value) {
-    uint32_t sign = (value >> 15) & 0x1;
-    uint32_t exp = ((value >> 10) & 0x1F) - 15 + 127;
-    uint32_t frac = (value & 0x3FF) << 13;
-    
-    uint32_t x = (sign << 31) | (exp << 23) | frac;
-    return *(float*)&x;
-}
-
 // 查找数据范围
 static void find_data_range(const float* data, size_t size, float* min_val, float* max_val) {
     *min_val = FLT_MAX;
@@ -131,10 +110,7 @@ int quant_quantize(void* output, const float* input, size_t size,
             break;
         }
         case QUANT_TYPE_FP16: {
-            uint16_t* out = (uint16_t*)output;
-            for (size_t i = 0; i < size; i++) {
-                out[i] = float_to_fp16(input[i]);
-            }
+            float_to_fp16_array((uint16_t*)output, input, size);
             break;
         }
         case QUANT_TYPE_FP8: {
@@ -198,10 +174,7 @@ int quant_dequantize(float* output, const void* input, size_t size,
             break;
         }
         case QUANT_TYPE_FP16: {
-            const uint16_t* in = (const uint16_t*)input;
-            for (size_t i = 0; i < size; i++) {
-                output[i] = fp16_to_float(in[i]);
-            }
+            fp16_to_float_array(output, (const uint16_t*)input, size);
             break;
         }
         case QUANT_TYPE_FP8: {
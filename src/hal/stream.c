@@ -0,0 +1,313 @@
+#include "stream.h"
+#include "thread_scratch.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+    STREAM_CMD_FUNC,           // 执行函数
+    STREAM_CMD_MEMCPY,         // 内存复制
+    STREAM_CMD_RECORD,         // 完成事件
+    STREAM_CMD_WAIT            // 等待事件
+} StreamCommandType;
+
+typedef struct StreamCommand {
+    struct StreamCommand* next;
+    StreamCommandType type;
+    StreamFunc func;
+    void* arg;
+    void* dst;
+    const void* src;
+    size_t size;
+    StreamEvent* event;
+    uint64_t event_value;      // RECORD/WAIT对应的记录序号
+    max_align_t arg_data[];    // stream_launch复制的参数块
+} StreamCommand;
+
+struct Stream {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;  // 新命令到达
+    pthread_cond_t done_cond;  // 命令完成
+    StreamCommand* head;
+    StreamCommand* tail;
+    uint64_t submitted;        // 已提交命令数
+    uint64_t completed;        // 已完成命令数
+    int shutdown;
+};
+
+struct StreamEvent {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint64_t recorded;         // 最近一次记录的序号
+    uint64_t completed;        // 已完成的最大序号
+};
+
+static void event_complete(StreamEvent* event, uint64_t value) {
+    pthread_mutex_lock(&event->lock);
+    if (event->completed < value) event->completed = value;
+    pthread_cond_broadcast(&event->cond);
+    pthread_mutex_unlock(&event->lock);
+}
+
+static void event_wait_value(StreamEvent* event, uint64_t value) {
+    pthread_mutex_lock(&event->lock);
+    while (event->completed < value) {
+        pthread_cond_wait(&event->cond, &event->lock);
+    }
+    pthread_mutex_unlock(&event->lock);
+}
+
+static void execute_command(StreamCommand* cmd) {
+    switch (cmd->type) {
+        case STREAM_CMD_FUNC:
+            cmd->func(cmd->arg);
+            break;
+        case STREAM_CMD_MEMCPY:
+            memcpy(cmd->dst, cmd->src, cmd->size);
+            break;
+        case STREAM_CMD_RECORD:
+            event_complete(cmd->event, cmd->event_value);
+            break;
+        case STREAM_CMD_WAIT:
+            event_wait_value(cmd->event, cmd->event_value);
+            break;
+    }
+}
+
+static void* stream_worker_main(void* param) {
+    Stream* stream = (Stream*)param;
+
+    pthread_mutex_lock(&stream->lock);
+    for (;;) {
+        while (!stream->head && !stream->shutdown) {
+            pthread_cond_wait(&stream->work_cond, &stream->lock);
+        }
+        if (!stream->head) break;  // 已关闭且队列为空
+
+        StreamCommand* cmd = stream->head;
+        pthread_mutex_unlock(&stream->lock);
+
+        execute_command(cmd);
+
+        pthread_mutex_lock(&stream->lock);
+        stream->head = cmd->next;
+        if (!stream->head) stream->tail = NULL;
+        stream->completed++;
+        pthread_cond_broadcast(&stream->done_cond);
+        free(cmd);
+    }
+    pthread_mutex_unlock(&stream->lock);
+
+    // 流线程随stream_destroy退出，命令中内核使用的暂存区在此释放
+    thread_scratch_release();
+    return NULL;
+}
+
+int stream_create(Stream** stream) {
+    if (!stream) return -1;
+
+    Stream* s = (Stream*)calloc(1, sizeof(Stream));
+    if (!s) return -1;
+
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->work_cond, NULL);
+    pthread_cond_init(&s->done_cond, NULL);
+
+    if (pthread_create(&s->thread, NULL, stream_worker_main, s) != 0) {
+        pthread_cond_destroy(&s->done_cond);
+        pthread_cond_destroy(&s->work_cond);
+        pthread_mutex_destroy(&s->lock);
+        free(s);
+        return -1;
+    }
+
+    *stream = s;
+    return 0;
+}
+
+void stream_destroy(Stream* stream) {
+    if (!stream) return;
+
+    pthread_mutex_lock(&stream->lock);
+    stream->shutdown = 1;
+    pthread_cond_signal(&stream->work_cond);
+    pthread_mutex_unlock(&stream->lock);
+    pthread_join(stream->thread, NULL);
+
+    pthread_cond_destroy(&stream->done_cond);
+    pthread_cond_destroy(&stream->work_cond);
+    pthread_mutex_destroy(&stream->lock);
+    free(stream);
+}
+
+static StreamCommand* command_alloc(StreamCommandType type, size_t arg_size) {
+    StreamCommand* cmd = (StreamCommand*)calloc(1, sizeof(StreamCommand) + arg_size);
+    if (cmd) cmd->type = type;
+    return cmd;
+}
+
+static int submit(Stream* stream, StreamCommand* cmd) {
+    pthread_mutex_lock(&stream->lock);
+    if (stream->shutdown) {
+        pthread_mutex_unlock(&stream->lock);
+        free(cmd);
+        return -1;
+    }
+    if (stream->tail) {
+        stream->tail->next = cmd;
+    } else {
+        stream->head = cmd;
+    }
+    stream->tail = cmd;
+    stream->submitted++;
+    pthread_cond_signal(&stream->work_cond);
+    pthread_mutex_unlock(&stream->lock);
+    return 0;
+}
+
+int stream_launch(Stream* stream, StreamFunc func, const void* arg, size_t arg_size) {
+    if (!func || (arg_size > 0 && !arg)) return -1;
+
+    if (!stream) {
+        func((void*)arg);
+        return 0;
+    }
+
+    StreamCommand* cmd = command_alloc(STREAM_CMD_FUNC, arg_size);
+    if (!cmd) return -1;
+    cmd->func = func;
+    if (arg_size > 0) {
+        memcpy(cmd->arg_data, arg, arg_size);
+        cmd->arg = cmd->arg_data;
+    } else {
+        cmd->arg = (void*)arg;
+    }
+    return submit(stream, cmd);
+}
+
+int stream_memcpy_async(Stream* stream, void* dst, const void* src, size_t size) {
+    if ((!dst || !src) && size > 0) return -1;
+
+    if (!stream) {
+        memcpy(dst, src, size);
+        return 0;
+    }
+
+    StreamCommand* cmd = command_alloc(STREAM_CMD_MEMCPY, 0);
+    if (!cmd) return -1;
+    cmd->dst = dst;
+    cmd->src = src;
+    cmd->size = size;
+    return submit(stream, cmd);
+}
+
+int stream_synchronize(Stream* stream) {
+    if (!stream) return 0;
+
+    pthread_mutex_lock(&stream->lock);
+    uint64_t target = stream->submitted;
+    while (stream->completed < target) {
+        pthread_cond_wait(&stream->done_cond, &stream->lock);
+    }
+    pthread_mutex_unlock(&stream->lock);
+    return 0;
+}
+
+int stream_query(Stream* stream) {
+    if (!stream) return 1;
+
+    pthread_mutex_lock(&stream->lock);
+    int idle = stream->completed == stream->submitted;
+    pthread_mutex_unlock(&stream->lock);
+    return idle;
+}
+
+int stream_event_create(StreamEvent** event) {
+    if (!event) return -1;
+
+    StreamEvent* e = (StreamEvent*)calloc(1, sizeof(StreamEvent));
+    if (!e) return -1;
+
+    pthread_mutex_init(&e->lock, NULL);
+    pthread_cond_init(&e->cond, NULL);
+    *event = e;
+    return 0;
+}
+
+void stream_event_destroy(StreamEvent* event) {
+    if (!event) return;
+
+    // 等待仍在队列中的记录命令，避免工作线程访问已释放的事件
+    stream_event_synchronize(event);
+    pthread_cond_destroy(&event->cond);
+    pthread_mutex_destroy(&event->lock);
+    free(event);
+}
+
+int stream_event_record(StreamEvent* event, Stream* stream) {
+    if (!event) return -1;
+
+    if (!stream) {
+        pthread_mutex_lock(&event->lock);
+        uint64_t value = ++event->recorded;
+        pthread_mutex_unlock(&event->lock);
+        event_complete(event, value);
+        return 0;
+    }
+
+    StreamCommand* cmd = command_alloc(STREAM_CMD_RECORD, 0);
+    if (!cmd) return -1;
+    cmd->event = event;
+
+    // 持有事件锁提交，序号与入队顺序一致；提交成功后才更新recorded，失败时事件保持上一次记录
+    // （工作线程执行命令时不持有流的锁，先事件锁后流锁不会死锁）
+    pthread_mutex_lock(&event->lock);
+    cmd->event_value = event->recorded + 1;
+    int ret = submit(stream, cmd);
+    if (ret == 0) event->recorded++;
+    pthread_mutex_unlock(&event->lock);
+    return ret;
+}
+
+int stream_wait_event(Stream* stream, StreamEvent* event) {
+    if (!event) return -1;
+
+    pthread_mutex_lock(&event->lock);
+    uint64_t value = event->recorded;
+    int done = event->completed >= value;
+    pthread_mutex_unlock(&event->lock);
+    if (done) return 0;
+
+    if (!stream) {
+        event_wait_value(event, value);
+        return 0;
+    }
+
+    StreamCommand* cmd = command_alloc(STREAM_CMD_WAIT, 0);
+    if (!cmd) return -1;
+    cmd->event = event;
+    cmd->event_value = value;
+    return submit(stream, cmd);
+}
+
+int stream_event_synchronize(StreamEvent* event) {
+    if (!event) return -1;
+
+    pthread_mutex_lock(&event->lock);
+    uint64_t value = event->recorded;
+    pthread_mutex_unlock(&event->lock);
+
+    event_wait_value(event, value);
+    return 0;
+}
+
+int stream_event_query(StreamEvent* event) {
+    if (!event) return -1;
+
+    pthread_mutex_lock(&event->lock);
+    int done = event->completed >= event->recorded;
+    pthread_mutex_unlock(&event->lock);
+    return done;
+}
@@ -0,0 +1,50 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stddef.h>
+
+// 异步命令流：每个流有一个专用工作线程，按提交顺序依次执行命令
+// 不同流之间并发执行，通过事件建立跨流依赖
+typedef struct Stream Stream;
+
+// 事件：记录到流中的某个位置，流执行到该位置时完成
+typedef struct StreamEvent StreamEvent;
+
+// 流上执行的命令函数
+typedef void (*StreamFunc)(void* arg);
+
+// 创建/销毁流（销毁前等待已提交的命令全部完成）
+int stream_create(Stream** stream);
+void stream_destroy(Stream* stream);
+
+// 提交命令：arg_size > 0 时复制arg指向的参数块，命令执行期间有效；
+// arg_size为0时直接传递arg指针，调用者需保证其在命令完成前有效
+// stream为NULL时在调用线程上同步执行
+int stream_launch(Stream* stream, StreamFunc func, const void* arg, size_t arg_size);
+
+// 异步内存复制，src/dst在命令完成前不得释放或修改
+int stream_memcpy_async(Stream* stream, void* dst, const void* src, size_t size);
+
+// 阻塞直到流中已提交的命令全部完成
+int stream_synchronize(Stream* stream);
+
+// 流是否空闲：1为已全部完成，0为仍有命令在执行
+int stream_query(Stream* stream);
+
+// 创建/销毁事件
+int stream_event_create(StreamEvent** event);
+void stream_event_destroy(StreamEvent* event);
+
+// 在流的当前位置记录事件（覆盖之前的记录）；失败时事件保持之前的记录
+int stream_event_record(StreamEvent* event, Stream* stream);
+
+// 流中后续命令等待事件完成后才执行（不阻塞调用线程）
+int stream_wait_event(Stream* stream, StreamEvent* event);
+
+// 阻塞直到事件最近一次记录的位置执行完成；从未记录的事件视为已完成
+int stream_event_synchronize(StreamEvent* event);
+
+// 事件是否已完成：1为完成，0为未完成
+int stream_event_query(StreamEvent* event);
+
+#endif // STREAM_H
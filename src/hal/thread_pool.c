@@ -0,0 +1,236 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE            // pthread_setaffinity_np
+#endif
+
+#include "thread_pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define CPU_RELAX() _mm_pause()
+#elif defined(__aarch64__)
+#define CPU_RELAX() __asm__ volatile("yield")
+#else
+#define CPU_RELAX() ((void)0)
+#endif
+
+// 进入休眠前的自旋次数（解码阶段每层都会派发，避免频繁的条件变量唤醒延迟）
+#define SPIN_ITERATIONS 4000
+
+struct ThreadPool {
+    pthread_t* threads;            // 工作线程
+    size_t num_workers;            // 工作线程数（不含调用线程）
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;      // 新任务到达
+    pthread_cond_t done_cond;      // 工作线程全部完成
+    pthread_mutex_t submit_lock;   // 同一时刻只允许一个提交者
+
+    ThreadPoolTask task;           // 当前任务
+    void* arg;
+    size_t num_tasks;
+    atomic_size_t next_task;       // 下一个待领取的任务
+    atomic_size_t active_workers;  // 尚未完成当前批次的工作线程数
+    atomic_uint_fast64_t generation; // 批次编号
+    int shutdown;
+};
+
+// 工作线程参数
+typedef struct {
+    ThreadPool* pool;
+    size_t thread_idx;
+} WorkerArg;
+
+// 当前线程是否为线程池工作线程（用于检测嵌套调用）
+static _Thread_local int t_is_worker = 0;
+
+static void run_tasks(ThreadPool* pool, ThreadPoolTask task, void* arg,
+                      size_t num_tasks, size_t thread_idx) {
+    size_t idx;
+    while ((idx = atomic_fetch_add_explicit(&pool->next_task, 1,
+                                            memory_order_relaxed)) < num_tasks) {
+        task(arg, idx, thread_idx);
+    }
+}
+
+static void* worker_main(void* param) {
+    WorkerArg* worker = (WorkerArg*)param;
+    ThreadPool* pool = worker->pool;
+    size_t thread_idx = worker->thread_idx;
+    free(worker);
+
+    t_is_worker = 1;
+    uint64_t seen = 0;
+
+    for (;;) {
+        // 先自旋等待新批次，超时后再进入条件变量休眠
+        int spins = 0;
+        while (atomic_load_explicit(&pool->generation, memory_order_acquire) == seen &&
+               spins < SPIN_ITERATIONS) {
+            CPU_RELAX();
+            spins++;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->shutdown &&
+               atomic_load_explicit(&pool->generation, memory_order_acquire) == seen) {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        seen = atomic_load_explicit(&pool->generation, memory_order_acquire);
+        ThreadPoolTask task = pool->task;
+        void* arg = pool->arg;
+        size_t num_tasks = pool->num_tasks;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_tasks(pool, task, arg, num_tasks, thread_idx);
+
+        if (atomic_fetch_sub_explicit(&pool->active_workers, 1,
+                                      memory_order_acq_rel) == 1) {
+            pthread_mutex_lock(&pool->lock);
+            pthread_cond_signal(&pool->done_cond);
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+
+    return NULL;
+}
+
+int thread_pool_create(ThreadPool** pool, size_t num_threads) {
+    if (!pool || num_threads == 0) return -1;
+    if (num_threads > THREAD_POOL_MAX_THREADS) num_threads = THREAD_POOL_MAX_THREADS;
+
+    ThreadPool* p = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if (!p) return -1;
+
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_mutex_init(&p->submit_lock, NULL);
+    pthread_cond_init(&p->work_cond, NULL);
+    pthread_cond_init(&p->done_cond, NULL);
+    atomic_init(&p->next_task, 0);
+    atomic_init(&p->active_workers, 0);
+    atomic_init(&p->generation, 0);
+
+    size_t wanted = num_threads - 1;
+    if (wanted > 0) {
+        p->threads = (pthread_t*)calloc(wanted, sizeof(pthread_t));
+        if (!p->threads) {
+            thread_pool_destroy(p);
+            return -1;
+        }
+    }
+
+    // 部分线程创建失败时按实际创建的数量工作
+    for (size_t i = 0; i < wanted; i++) {
+        WorkerArg* worker = (WorkerArg*)malloc(sizeof(WorkerArg));
+        if (!worker) break;
+        worker->pool = p;
+        worker->thread_idx = i + 1;
+        if (pthread_create(&p->threads[i], NULL, worker_main, worker) != 0) {
+            free(worker);
+            break;
+        }
+        p->num_workers = i + 1;
+    }
+
+    *pool = p;
+    return 0;
+}
+
+void thread_pool_destroy(ThreadPool* pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    if (pool->threads) {
+        for (size_t i = 0; i < pool->num_workers; i++) {
+            pthread_join(pool->threads[i], NULL);
+        }
+        free(pool->threads);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->submit_lock);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    free(pool);
+}
+
+int thread_pool_set_affinity(ThreadPool* pool, const int* cpus, size_t num_cpus) {
+    if (!pool || !cpus || num_cpus == 0) return -1;
+
+#if defined(__linux__)
+    int ret = 0;
+    for (size_t i = 0; i < pool->num_workers; i++) {
+        int cpu = cpus[(i + 1) % num_cpus];
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            ret = -1;
+            continue;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(pool->threads[i], sizeof(set), &set) != 0) ret = -1;
+    }
+    return ret;
+#else
+    return -1;
+#endif
+}
+
+size_t thread_pool_size(const ThreadPool* pool) {
+    return pool ? pool->num_workers + 1 : 1;
+}
+
+void thread_pool_parallel_for(ThreadPool* pool, size_t num_tasks,
+                              ThreadPoolTask task, void* arg) {
+    if (!task || num_tasks == 0) return;
+
+    // 串行路径：无线程池、单任务、嵌套调用或线程池忙
+    if (!pool || pool->num_workers == 0 || num_tasks == 1 || t_is_worker ||
+        pthread_mutex_trylock(&pool->submit_lock) != 0) {
+        for (size_t i = 0; i < num_tasks; i++) {
+            task(arg, i, 0);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->arg = arg;
+    pool->num_tasks = num_tasks;
+    atomic_store_explicit(&pool->next_task, 0, memory_order_relaxed);
+    atomic_store_explicit(&pool->active_workers, pool->num_workers, memory_order_relaxed);
+    atomic_fetch_add_explicit(&pool->generation, 1, memory_order_release);
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    // 调用线程同样参与执行
+    t_is_worker = 1;
+    run_tasks(pool, task, arg, num_tasks, 0);
+    t_is_worker = 0;
+
+    // 等待所有工作线程完成当前批次
+    int spins = 0;
+    while (atomic_load_explicit(&pool->active_workers, memory_order_acquire) > 0 &&
+           spins < SPIN_ITERATIONS) {
+        CPU_RELAX();
+        spins++;
+    }
+    pthread_mutex_lock(&pool->lock);
+    while (atomic_load_explicit(&pool->active_workers, memory_order_acquire) > 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    pthread_mutex_unlock(&pool->submit_lock);
+}
@@ -0,0 +1,34 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+
+// 线程池最大线程数
+#define THREAD_POOL_MAX_THREADS 256
+
+// 任务函数：task_idx为任务序号，thread_idx为执行线程序号（调用线程为0）
+// 串行回退路径上thread_idx恒为0，线程私有的暂存区应使用thread_scratch而不是按thread_idx索引
+typedef void (*ThreadPoolTask)(void* arg, size_t task_idx, size_t thread_idx);
+
+// 持久化工作线程池
+typedef struct ThreadPool ThreadPool;
+
+// 创建线程池，num_threads包含调用线程本身（创建num_threads-1个工作线程）
+int thread_pool_create(ThreadPool** pool, size_t num_threads);
+
+// 销毁线程池
+void thread_pool_destroy(ThreadPool* pool);
+
+// 绑定工作线程：第i个工作线程（thread_idx = i）绑定到 cpus[i % num_cpus]，调用线程不绑定
+// 返回0成功，-1失败或平台不支持
+int thread_pool_set_affinity(ThreadPool* pool, const int* cpus, size_t num_cpus);
+
+// 线程总数（包含调用线程），pool为NULL时返回1
+size_t thread_pool_size(const ThreadPool* pool);
+
+// 并行执行num_tasks个任务，阻塞直到全部完成
+// pool为NULL、在工作线程内嵌套调用或线程池正被其他线程使用时，在调用线程上串行执行
+void thread_pool_parallel_for(ThreadPool* pool, size_t num_tasks,
+                              ThreadPoolTask task, void* arg);
+
+#endif // THREAD_POOL_H
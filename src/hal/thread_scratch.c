@@ -0,0 +1,56 @@
+#include "thread_scratch.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+typedef struct {
+    void* buf[SCRATCH_NUM_SLOTS];
+    size_t size[SCRATCH_NUM_SLOTS];
+    int registered;
+} ThreadScratch;
+
+static _Thread_local ThreadScratch t_scratch;
+
+// 线程退出时释放暂存区
+static pthread_key_t g_scratch_key;
+static pthread_once_t g_scratch_key_once = PTHREAD_ONCE_INIT;
+
+static void free_scratch(ThreadScratch* scratch) {
+    for (size_t i = 0; i < SCRATCH_NUM_SLOTS; i++) {
+        free(scratch->buf[i]);
+        scratch->buf[i] = NULL;
+        scratch->size[i] = 0;
+    }
+}
+
+static void scratch_destructor(void* arg) {
+    free_scratch((ThreadScratch*)arg);
+}
+
+static void create_scratch_key(void) {
+    pthread_key_create(&g_scratch_key, scratch_destructor);
+}
+
+void* thread_scratch(ThreadScratchSlot slot, size_t bytes) {
+    ThreadScratch* scratch = &t_scratch;
+    if (scratch->buf[slot] && scratch->size[slot] >= bytes) return scratch->buf[slot];
+
+    if (!scratch->registered) {
+        pthread_once(&g_scratch_key_once, create_scratch_key);
+        pthread_setspecific(g_scratch_key, scratch);
+        scratch->registered = 1;
+    }
+
+    size_t aligned = (bytes + THREAD_SCRATCH_ALIGN - 1) & ~(size_t)(THREAD_SCRATCH_ALIGN - 1);
+    if (aligned == 0) aligned = THREAD_SCRATCH_ALIGN;
+    void* buf = aligned_alloc(THREAD_SCRATCH_ALIGN, aligned);
+    if (!buf) return NULL;
+
+    free(scratch->buf[slot]);
+    scratch->buf[slot] = buf;
+    scratch->size[slot] = bytes;
+    return buf;
+}
+
+void thread_scratch_release(void) {
+    free_scratch(&t_scratch);
+}
@@ -0,0 +1,35 @@
+#ifndef THREAD_SCRATCH_H
+#define THREAD_SCRATCH_H
+
+#include <stddef.h>
+
+// 线程私有的暂存区：每个线程每个槽位一块缓冲区，只增不减，避免内核每次调用都分配内存
+// 线程退出时（线程池工作线程、命令流线程）由pthread键的析构函数释放，
+// 调用线程自己的暂存区由thread_scratch_release释放（hal_cleanup中调用）
+
+// 暂存区对齐（缓存行，满足AVX-512对齐加载）
+#define THREAD_SCRATCH_ALIGN 64
+
+// 暂存区槽位，同一线程上同时使用的缓冲区须占用不同的槽位
+typedef enum {
+    SCRATCH_GEMM_PACK_A,        // GEMM打包的A块
+    SCRATCH_GEMM_PACK_B,        // GEMM打包的B块
+    SCRATCH_QGEMM_PACK_A,       // INT8 GEMM打包的A块
+    SCRATCH_QGEMM_ROW_SUMS,     // INT8 GEMM的A行和
+    SCRATCH_QGEMM_PACK_B,       // INT8 GEMM打包的B块
+    SCRATCH_QGEMM_COL_SUMS,     // INT8 GEMM的B列和
+    SCRATCH_QGEMV_GROUP_SUMS,   // INT4 GEMV每组的激活之和
+    SCRATCH_KV_ROW,             // 量化KV缓存一行的码字和scale
+    SCRATCH_ATTENTION_SPANS,    // 批量注意力收集的各序列K/V段
+    SCRATCH_ATTENTION_ARGS,     // 批量注意力各组的任务参数
+    SCRATCH_NUM_SLOTS
+} ThreadScratchSlot;
+
+// 调用线程slot槽位上至少bytes字节的缓冲区（THREAD_SCRATCH_ALIGN对齐），
+// 扩容时不保留原内容，内存不足时返回NULL
+void* thread_scratch(ThreadScratchSlot slot, size_t bytes);
+
+// 释放调用线程的全部暂存区
+void thread_scratch_release(void);
+
+#endif // THREAD_SCRATCH_H
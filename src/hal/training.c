@@ -17,6 +17,12 @@ typedef struct {
     float beta2_t;     // beta2^t
 } AdamState;
 
+// 默认激活函数：调用设备的融合算子
+static void device_forward_activation(void* output, const void* input,
+                                      size_t size, ActivationType type) {
+    g_device->activation(input, output, size, type);
+}
+
 // 初始化训练扩展
 int training_init(HAL_Device* device, TrainingExtension* extension) {
     if (!device || !extension) return -1;
@@ -24,6 +30,10 @@ int training_init(HAL_Device* device, TrainingExtension* extension) {
     g_device = device;
     g_extension = extension;
     
+    if (!extension->forward_activation && device->activation) {
+        extension->forward_activation = device_forward_activation;
+    }
+    
     return 0;
 }
 
@@ -133,7 +143,7 @@ static int forward_pass(void* model, void* inputs, void* predictions,
     // 应用激活函数
     g_extension->forward_activation(output_data, layer_output,
                                   batch_size * g_config->hidden_size,
-                                  "relu");
+                                  ACTIVATION_RELU);
     
     // 释放中间缓冲区
     g_device->free_memory(layer_output);
@@ -60,11 +60,11 @@ typedef struct {
     void (*backward_vector_add)(const void* grad_output, void* grad_input,
                               void* grad_bias, size_t size);
     
-    // 激活函数及其导数
+    // 激活函数及其导数（未设置forward_activation时使用设备的融合算子）
     void (*forward_activation)(void* output, const void* input,
-                             size_t size, const char* type);
+                             size_t size, ActivationType type);
     void (*backward_activation)(void* grad_input, const void* grad_output,
-                              const void* output, size_t size, const char* type);
+                              const void* output, size_t size, ActivationType type);
     
     // 损失函数及其导数
     float (*compute_loss)(const void* predictions, const void* targets,
@@ -0,0 +1,357 @@
+// x86_64 AVX2/FMA 注意力块内核
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include "vmath_avx2.h"
+
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+
+static const int32_t mask_table[16] = {
+    -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+
+AVX2_TARGET
+static inline __m256i tail_mask(size_t n) {
+    return _mm256_loadu_si256((const __m256i*)(mask_table + 8 - n));
+}
+
+AVX2_TARGET
+static inline float hsum(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_movehdup_ps(lo));
+    return _mm_cvtss_f32(lo);
+}
+
+// 从第d列开始的8列中有效列的掩码（超出head_dim的部分为0）
+AVX2_TARGET
+static inline __m256i col_mask(size_t d, size_t head_dim) {
+    return tail_mask(d >= head_dim ? 0 : (head_dim - d < 8 ? head_dim - d : 8));
+}
+
+// K预取的提前量（行）。同一个头的相邻行相隔 num_heads * head_dim 个float，
+// 通常跨越4KB页，硬件预取器跟不上，需要软件预取
+#define PREFETCH_ROWS 16
+
+// 预取一行（head_dim个float）
+static inline void prefetch_row(const float* p, size_t head_dim) {
+    for (size_t d = 0; d < head_dim; d += 16) {
+        _mm_prefetch((const char*)(p + d), _MM_HINT_T0);
+    }
+}
+
+// scores[j] = scale * dot(q, k_j)：每次4行，共享q的加载
+// 同时预取后面的K行（越过块尾即下一块）和本块稍后累加要用的V行
+AVX2_TARGET
+static void row_scores(const float* q, const float* k, const float* v, size_t ld, size_t count,
+                       size_t head_dim, float scale, float* scores) {
+    size_t j = 0;
+    for (; j + 4 <= count; j += 4) {
+        const float* k0 = k + j * ld;
+        const float* k1 = k0 + ld;
+        const float* k2 = k1 + ld;
+        const float* k3 = k2 + ld;
+        for (size_t r = 0; r < 4; r++) {
+            prefetch_row(k + (j + PREFETCH_ROWS + r) * ld, head_dim);
+            if (v) prefetch_row(v + (j + r) * ld, head_dim);
+        }
+        __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+        __m256 s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+        size_t d = 0;
+        for (; d + 8 <= head_dim; d += 8) {
+            __m256 qv = _mm256_loadu_ps(q + d);
+            s0 = _mm256_fmadd_ps(_mm256_loadu_ps(k0 + d), qv, s0);
+            s1 = _mm256_fmadd_ps(_mm256_loadu_ps(k1 + d), qv, s1);
+            s2 = _mm256_fmadd_ps(_mm256_loadu_ps(k2 + d), qv, s2);
+            s3 = _mm256_fmadd_ps(_mm256_loadu_ps(k3 + d), qv, s3);
+        }
+        if (d < head_dim) {
+            __m256i m = tail_mask(head_dim - d);
+            __m256 qv = _mm256_maskload_ps(q + d, m);
+            s0 = _mm256_fmadd_ps(_mm256_maskload_ps(k0 + d, m), qv, s0);
+            s1 = _mm256_fmadd_ps(_mm256_maskload_ps(k1 + d, m), qv, s1);
+            s2 = _mm256_fmadd_ps(_mm256_maskload_ps(k2 + d, m), qv, s2);
+            s3 = _mm256_fmadd_ps(_mm256_maskload_ps(k3 + d, m), qv, s3);
+        }
+        scores[j] = hsum(s0) * scale;
+        scores[j + 1] = hsum(s1) * scale;
+        scores[j + 2] = hsum(s2) * scale;
+        scores[j + 3] = hsum(s3) * scale;
+    }
+    for (; j < count; j++) {
+        const float* k0 = k + j * ld;
+        __m256 s0 = _mm256_setzero_ps();
+        size_t d = 0;
+        for (; d + 8 <= head_dim; d += 8) {
+            s0 = _mm256_fmadd_ps(_mm256_loadu_ps(k0 + d), _mm256_loadu_ps(q + d), s0);
+        }
+        if (d < head_dim) {
+            __m256i m = tail_mask(head_dim - d);
+            s0 = _mm256_fmadd_ps(_mm256_maskload_ps(k0 + d, m), _mm256_maskload_ps(q + d, m), s0);
+        }
+        scores[j] = hsum(s0) * scale;
+    }
+}
+
+// 4个查询行的分数：每次2个键，K的每次加载由4行共享
+AVX2_TARGET
+static void block_scores(const float* q, size_t q_ld, const float* k, size_t ld, size_t count,
+                         size_t head_dim, float scale, float* scores) {
+    const float* q0 = q;
+    const float* q1 = q0 + q_ld;
+    const float* q2 = q1 + q_ld;
+    const float* q3 = q2 + q_ld;
+    size_t j = 0;
+    for (; j + 2 <= count; j += 2) {
+        const float* k0 = k + j * ld;
+        const float* k1 = k0 + ld;
+        __m256 s00 = _mm256_setzero_ps(), s01 = _mm256_setzero_ps();
+        __m256 s10 = _mm256_setzero_ps(), s11 = _mm256_setzero_ps();
+        __m256 s20 = _mm256_setzero_ps(), s21 = _mm256_setzero_ps();
+        __m256 s30 = _mm256_setzero_ps(), s31 = _mm256_setzero_ps();
+        for (size_t d = 0; d < head_dim; d += 8) {
+            __m256i m = col_mask(d, head_dim);
+            __m256 kv0 = _mm256_maskload_ps(k0 + d, m);
+            __m256 kv1 = _mm256_maskload_ps(k1 + d, m);
+            __m256 qv = _mm256_maskload_ps(q0 + d, m);
+            s00 = _mm256_fmadd_ps(qv, kv0, s00);
+            s01 = _mm256_fmadd_ps(qv, kv1, s01);
+            qv = _mm256_maskload_ps(q1 + d, m);
+            s10 = _mm256_fmadd_ps(qv, kv0, s10);
+            s11 = _mm256_fmadd_ps(qv, kv1, s11);
+            qv = _mm256_maskload_ps(q2 + d, m);
+            s20 = _mm256_fmadd_ps(qv, kv0, s20);
+            s21 = _mm256_fmadd_ps(qv, kv1, s21);
+            qv = _mm256_maskload_ps(q3 + d, m);
+            s30 = _mm256_fmadd_ps(qv, kv0, s30);
+            s31 = _mm256_fmadd_ps(qv, kv1, s31);
+        }
+        scores[j] = hsum(s00) * scale;
+        scores[j + 1] = hsum(s01) * scale;
+        scores[count + j] = hsum(s10) * scale;
+        scores[count + j + 1] = hsum(s11) * scale;
+        scores[2 * count + j] = hsum(s20) * scale;
+        scores[2 * count + j + 1] = hsum(s21) * scale;
+        scores[3 * count + j] = hsum(s30) * scale;
+        scores[3 * count + j + 1] = hsum(s31) * scale;
+    }
+    if (j < count) {
+        for (size_t r = 0; r < 4; r++) {
+            row_scores(q + r * q_ld, k + j * ld, NULL, ld, 1, head_dim, scale, scores + r * count + j);
+        }
+    }
+}
+
+// 在线softmax：scores就地替换为权重 p_j = exp(s_j - 新最大值)，被屏蔽的行权重为0
+// 更新max/sum并返回已有累加结果的缩放系数 exp(旧最大值 - 新最大值)
+AVX2_TARGET
+static float row_weights(float* scores, const unsigned char* valid, size_t count,
+                         float* max, float* sum) {
+    float tile_max = -INFINITY;
+    for (size_t j = 0; j < count; j++) {
+        if (valid && !valid[j]) scores[j] = -INFINITY;
+        if (scores[j] > tile_max) tile_max = scores[j];
+    }
+    if (tile_max == -INFINITY) {
+        // 该行整块被屏蔽
+        memset(scores, 0, count * sizeof(float));
+        return 1.0f;
+    }
+
+    float new_max = tile_max > *max ? tile_max : *max;
+    float alpha = expf(*max - new_max);
+
+    const __m256 neg_inf = _mm256_set1_ps(-INFINITY);
+    const __m256 max_v = _mm256_set1_ps(new_max);
+    __m256 s0 = _mm256_setzero_ps();
+    size_t j = 0;
+    for (; j + 8 <= count; j += 8) {
+        __m256 s = _mm256_loadu_ps(scores + j);
+        __m256 e = exp256(_mm256_sub_ps(s, max_v));
+        e = _mm256_and_ps(e, _mm256_cmp_ps(s, neg_inf, _CMP_NEQ_OQ));
+        _mm256_storeu_ps(scores + j, e);
+        s0 = _mm256_add_ps(s0, e);
+    }
+    if (j < count) {
+        __m256i m = tail_mask(count - j);
+        __m256 s = _mm256_blendv_ps(neg_inf, _mm256_maskload_ps(scores + j, m),
+                                    _mm256_castsi256_ps(m));
+        __m256 e = exp256(_mm256_sub_ps(s, max_v));
+        e = _mm256_and_ps(e, _mm256_cmp_ps(s, neg_inf, _CMP_NEQ_OQ));
+        _mm256_maskstore_ps(scores + j, m, e);
+        s0 = _mm256_add_ps(s0, e);
+    }
+    *sum = *sum * alpha + hsum(s0);
+    *max = new_max;
+    return alpha;
+}
+
+// acc = acc * alpha + sum_j p_j * v_j：每次32列，4条独立的FMA依赖链覆盖延迟
+AVX2_TARGET
+static void row_accumulate(const float* p, const float* v, size_t ld, size_t count,
+                           size_t head_dim, float alpha, float* acc) {
+    const __m256 alpha_v = _mm256_set1_ps(alpha);
+    size_t d = 0;
+    for (; d + 32 <= head_dim; d += 32) {
+        __m256 a0 = _mm256_mul_ps(_mm256_loadu_ps(acc + d), alpha_v);
+        __m256 a1 = _mm256_mul_ps(_mm256_loadu_ps(acc + d + 8), alpha_v);
+        __m256 a2 = _mm256_mul_ps(_mm256_loadu_ps(acc + d + 16), alpha_v);
+        __m256 a3 = _mm256_mul_ps(_mm256_loadu_ps(acc + d + 24), alpha_v);
+        for (size_t j = 0; j < count; j++) {
+            if (p[j] == 0.0f) continue;
+            const float* v_row = v + j * ld + d;
+            __m256 pv = _mm256_set1_ps(p[j]);
+            a0 = _mm256_fmadd_ps(pv, _mm256_loadu_ps(v_row), a0);
+            a1 = _mm256_fmadd_ps(pv, _mm256_loadu_ps(v_row + 8), a1);
+            a2 = _mm256_fmadd_ps(pv, _mm256_loadu_ps(v_row + 16), a2);
+            a3 = _mm256_fmadd_ps(pv, _mm256_loadu_ps(v_row + 24), a3);
+        }
+        _mm256_storeu_ps(acc + d, a0);
+        _mm256_storeu_ps(acc + d + 8, a1);
+        _mm256_storeu_ps(acc + d + 16, a2);
+        _mm256_storeu_ps(acc + d + 24, a3);
+    }
+    for (; d < head_dim; d += 8) {
+        __m256i m = col_mask(d, head_dim);
+        __m256 a = _mm256_mul_ps(_mm256_maskload_ps(acc + d, m), alpha_v);
+        for (size_t j = 0; j < count; j++) {
+            if (p[j] == 0.0f) continue;
+            a = _mm256_fmadd_ps(_mm256_set1_ps(p[j]), _mm256_maskload_ps(v + j * ld + d, m), a);
+        }
+        _mm256_maskstore_ps(acc + d, m, a);
+    }
+}
+
+// 4行同时累加：每次16列，V的每次加载由4行共享
+AVX2_TARGET
+static void block_accumulate(const float* p, const float* v, size_t ld, size_t count,
+                             size_t head_dim, const float* alpha, float* acc) {
+    float* acc0 = acc;
+    float* acc1 = acc0 + head_dim;
+    float* acc2 = acc1 + head_dim;
+    float* acc3 = acc2 + head_dim;
+    const float* p0 = p;
+    const float* p1 = p0 + count;
+    const float* p2 = p1 + count;
+    const float* p3 = p2 + count;
+    for (size_t d = 0; d < head_dim; d += 16) {
+        __m256i m0 = col_mask(d, head_dim);
+        __m256i m1 = col_mask(d + 8, head_dim);
+        __m256 al = _mm256_set1_ps(alpha[0]);
+        __m256 a00 = _mm256_mul_ps(_mm256_maskload_ps(acc0 + d, m0), al);
+        __m256 a01 = _mm256_mul_ps(_mm256_maskload_ps(acc0 + d + 8, m1), al);
+        al = _mm256_set1_ps(alpha[1]);
+        __m256 a10 = _mm256_mul_ps(_mm256_maskload_ps(acc1 + d, m0), al);
+        __m256 a11 = _mm256_mul_ps(_mm256_maskload_ps(acc1 + d + 8, m1), al);
+        al = _mm256_set1_ps(alpha[2]);
+        __m256 a20 = _mm256_mul_ps(_mm256_maskload_ps(acc2 + d, m0), al);
+        __m256 a21 = _mm256_mul_ps(_mm256_maskload_ps(acc2 + d + 8, m1), al);
+        al = _mm256_set1_ps(alpha[3]);
+        __m256 a30 = _mm256_mul_ps(_mm256_maskload_ps(acc3 + d, m0), al);
+        __m256 a31 = _mm256_mul_ps(_mm256_maskload_ps(acc3 + d + 8, m1), al);
+        for (size_t j = 0; j < count; j++) {
+            const float* v_row = v + j * ld + d;
+            __m256 v0 = _mm256_maskload_ps(v_row, m0);
+            __m256 v1 = _mm256_maskload_ps(v_row + 8, m1);
+            __m256 pv = _mm256_set1_ps(p0[j]);
+            a00 = _mm256_fmadd_ps(pv, v0, a00);
+            a01 = _mm256_fmadd_ps(pv, v1, a01);
+            pv = _mm256_set1_ps(p1[j]);
+            a10 = _mm256_fmadd_ps(pv, v0, a10);
+            a11 = _mm256_fmadd_ps(pv, v1, a11);
+            pv = _mm256_set1_ps(p2[j]);
+            a20 = _mm256_fmadd_ps(pv, v0, a20);
+            a21 = _mm256_fmadd_ps(pv, v1, a21);
+            pv = _mm256_set1_ps(p3[j]);
+            a30 = _mm256_fmadd_ps(pv, v0, a30);
+            a31 = _mm256_fmadd_ps(pv, v1, a31);
+        }
+        _mm256_maskstore_ps(acc0 + d, m0, a00);
+        _mm256_maskstore_ps(acc0 + d + 8, m1, a01);
+        _mm256_maskstore_ps(acc1 + d, m0, a10);
+        _mm256_maskstore_ps(acc1 + d + 8, m1, a11);
+        _mm256_maskstore_ps(acc2 + d, m0, a20);
+        _mm256_maskstore_ps(acc2 + d + 8, m1, a21);
+        _mm256_maskstore_ps(acc3 + d, m0, a30);
+        _mm256_maskstore_ps(acc3 + d + 8, m1, a31);
+    }
+}
+
+// 在线softmax的一块：rows为4时K/V的加载由4行共享，否则逐行计算
+AVX2_TARGET
+void attention_tile_avx2(const float* q, size_t q_ld, size_t rows,
+                         const float* k, const float* v, size_t ld,
+                         size_t count, size_t head_dim, float scale,
+                         const unsigned char* valid, float* scores,
+                         float* acc, float* max, float* sum) {
+    if (rows == 4) {
+        float alpha[4];
+        block_scores(q, q_ld, k, ld, count, head_dim, scale, scores);
+        for (size_t r = 0; r < 4; r++) {
+            alpha[r] = row_weights(scores + r * count, valid ? valid + r * count : NULL, count,
+                                   max + r, sum + r);
+        }
+        block_accumulate(scores, v, ld, count, head_dim, alpha, acc);
+        return;
+    }
+
+    for (size_t r = 0; r < rows; r++) {
+        float* p = scores + r * count;
+        row_scores(q + r * q_ld, k, v, ld, count, head_dim, scale, p);
+        float alpha = row_weights(p, valid ? valid + r * count : NULL, count, max + r, sum + r);
+        row_accumulate(p, v, ld, count, head_dim, alpha, acc + r * head_dim);
+    }
+}
+
+// 量化KV的反量化，每次8个码字（不足8个时先复制到临时区）
+AVX2_TARGET
+static inline __m256i load_codes8(const uint8_t* codes, size_t n) {
+    if (n >= 8) return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)codes));
+    uint8_t tmp[8] = { 0 };
+    memcpy(tmp, codes, n);
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)tmp));
+}
+
+AVX2_TARGET
+static inline void store_tail8(float* out, __m256 y, size_t n) {
+    if (n >= 8) {
+        _mm256_storeu_ps(out, y);
+    } else {
+        _mm256_maskstore_ps(out, tail_mask(n), y);
+    }
+}
+
+// 对称INT8，零点128
+AVX2_TARGET
+void attention_dequant_int8_avx2(const uint8_t* codes, float scale, size_t n, float* out) {
+    __m256 s = _mm256_set1_ps(scale);
+    __m256i zero_point = _mm256_set1_epi32(128);
+    for (size_t i = 0; i < n; i += 8) {
+        __m256i c = load_codes8(codes + i, n - i);
+        __m256 y = _mm256_cvtepi32_ps(_mm256_sub_epi32(c, zero_point));
+        store_tail8(out + i, _mm256_mul_ps(y, s), n - i);
+    }
+}
+
+// FP8 E4M3，推导见attention_avx512.c
+AVX2_TARGET
+void attention_dequant_fp8_avx2(const uint8_t* codes, float scale, size_t n, float* out) {
+    __m256 s = _mm256_set1_ps(scale);
+    for (size_t i = 0; i < n; i += 8) {
+        __m256i c = load_codes8(codes + i, n - i);
+        __m256i em = _mm256_and_si256(c, _mm256_set1_epi32(0x7F));
+        __m256 normal = _mm256_castsi256_ps(_mm256_add_epi32(_mm256_slli_epi32(em, 20),
+                                                             _mm256_set1_epi32(120 << 23)));
+        __m256 subnormal = _mm256_mul_ps(_mm256_cvtepi32_ps(em), _mm256_set1_ps(1.0f / 512.0f));
+        __m256i is_sub = _mm256_cmpgt_epi32(_mm256_set1_epi32(8), em);
+        __m256 y = _mm256_blendv_ps(normal, subnormal, _mm256_castsi256_ps(is_sub));
+        __m256i sign = _mm256_slli_epi32(_mm256_and_si256(c, _mm256_set1_epi32(0x80)), 24);
+        y = _mm256_castsi256_ps(_mm256_or_si256(_mm256_castps_si256(y), sign));
+        store_tail8(out + i, _mm256_mul_ps(y, s), n - i);
+    }
+}
@@ -0,0 +1,299 @@
+// x86_64 AVX-512 注意力块内核
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include "vmath_avx512.h"
+
+#define AVX512_TARGET __attribute__((target("avx512f,avx512bw,avx512vl,fma")))
+
+AVX512_TARGET
+static inline __mmask16 tail_mask16(size_t n) {
+    return (n >= 16) ? (__mmask16)0xFFFF : (__mmask16)((1u << n) - 1);
+}
+
+// 从第d列开始的16列中有效列的掩码（超出head_dim的部分为0）
+AVX512_TARGET
+static inline __mmask16 col_mask16(size_t d, size_t head_dim) {
+    return d < head_dim ? tail_mask16(head_dim - d) : (__mmask16)0;
+}
+
+// K预取的提前量（行）。同一个头的相邻行相隔 num_heads * head_dim 个float，
+// 通常跨越4KB页，硬件预取器跟不上，需要软件预取
+#define PREFETCH_ROWS 16
+
+// 预取一行（head_dim个float）
+static inline void prefetch_row(const float* p, size_t head_dim) {
+    for (size_t d = 0; d < head_dim; d += 16) {
+        _mm_prefetch((const char*)(p + d), _MM_HINT_T0);
+    }
+}
+
+// scores[j] = scale * dot(q, k_j)：每次4行，共享q的加载
+// 同时预取后面的K行（越过块尾即下一块）和本块稍后累加要用的V行
+AVX512_TARGET
+static void row_scores(const float* q, const float* k, const float* v, size_t ld, size_t count,
+                       size_t head_dim, float scale, float* scores) {
+    size_t j = 0;
+    for (; j + 4 <= count; j += 4) {
+        const float* k0 = k + j * ld;
+        const float* k1 = k0 + ld;
+        const float* k2 = k1 + ld;
+        const float* k3 = k2 + ld;
+        for (size_t r = 0; r < 4; r++) {
+            prefetch_row(k + (j + PREFETCH_ROWS + r) * ld, head_dim);
+            if (v) prefetch_row(v + (j + r) * ld, head_dim);
+        }
+        __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+        __m512 s2 = _mm512_setzero_ps(), s3 = _mm512_setzero_ps();
+        for (size_t d = 0; d < head_dim; d += 16) {
+            __mmask16 m = tail_mask16(head_dim - d);
+            __m512 qv = _mm512_maskz_loadu_ps(m, q + d);
+            s0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, k0 + d), qv, s0);
+            s1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, k1 + d), qv, s1);
+            s2 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, k2 + d), qv, s2);
+            s3 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, k3 + d), qv, s3);
+        }
+        scores[j] = _mm512_reduce_add_ps(s0) * scale;
+        scores[j + 1] = _mm512_reduce_add_ps(s1) * scale;
+        scores[j + 2] = _mm512_reduce_add_ps(s2) * scale;
+        scores[j + 3] = _mm512_reduce_add_ps(s3) * scale;
+    }
+    for (; j < count; j++) {
+        const float* k0 = k + j * ld;
+        __m512 s0 = _mm512_setzero_ps();
+        for (size_t d = 0; d < head_dim; d += 16) {
+            __mmask16 m = tail_mask16(head_dim - d);
+            s0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, k0 + d), _mm512_maskz_loadu_ps(m, q + d), s0);
+        }
+        scores[j] = _mm512_reduce_add_ps(s0) * scale;
+    }
+}
+
+// 4个查询行的分数：每次2个键，K的每次加载由4行共享
+AVX512_TARGET
+static void block_scores(const float* q, size_t q_ld, const float* k, size_t ld, size_t count,
+                         size_t head_dim, float scale, float* scores) {
+    const float* q0 = q;
+    const float* q1 = q0 + q_ld;
+    const float* q2 = q1 + q_ld;
+    const float* q3 = q2 + q_ld;
+    size_t j = 0;
+    for (; j + 2 <= count; j += 2) {
+        const float* k0 = k + j * ld;
+        const float* k1 = k0 + ld;
+        __m512 s00 = _mm512_setzero_ps(), s01 = _mm512_setzero_ps();
+        __m512 s10 = _mm512_setzero_ps(), s11 = _mm512_setzero_ps();
+        __m512 s20 = _mm512_setzero_ps(), s21 = _mm512_setzero_ps();
+        __m512 s30 = _mm512_setzero_ps(), s31 = _mm512_setzero_ps();
+        for (size_t d = 0; d < head_dim; d += 16) {
+            __mmask16 m = tail_mask16(head_dim - d);
+            __m512 kv0 = _mm512_maskz_loadu_ps(m, k0 + d);
+            __m512 kv1 = _mm512_maskz_loadu_ps(m, k1 + d);
+            __m512 qv = _mm512_maskz_loadu_ps(m, q0 + d);
+            s00 = _mm512_fmadd_ps(qv, kv0, s00);
+            s01 = _mm512_fmadd_ps(qv, kv1, s01);
+            qv = _mm512_maskz_loadu_ps(m, q1 + d);
+            s10 = _mm512_fmadd_ps(qv, kv0, s10);
+            s11 = _mm512_fmadd_ps(qv, kv1, s11);
+            qv = _mm512_maskz_loadu_ps(m, q2 + d);
+            s20 = _mm512_fmadd_ps(qv, kv0, s20);
+            s21 = _mm512_fmadd_ps(qv, kv1, s21);
+            qv = _mm512_maskz_loadu_ps(m, q3 + d);
+            s30 = _mm512_fmadd_ps(qv, kv0, s30);
+            s31 = _mm512_fmadd_ps(qv, kv1, s31);
+        }
+        scores[j] = _mm512_reduce_add_ps(s00) * scale;
+        scores[j + 1] = _mm512_reduce_add_ps(s01) * scale;
+        scores[count + j] = _mm512_reduce_add_ps(s10) * scale;
+        scores[count + j + 1] = _mm512_reduce_add_ps(s11) * scale;
+        scores[2 * count + j] = _mm512_reduce_add_ps(s20) * scale;
+        scores[2 * count + j + 1] = _mm512_reduce_add_ps(s21) * scale;
+        scores[3 * count + j] = _mm512_reduce_add_ps(s30) * scale;
+        scores[3 * count + j + 1] = _mm512_reduce_add_ps(s31) * scale;
+    }
+    if (j < count) {
+        for (size_t r = 0; r < 4; r++) {
+            row_scores(q + r * q_ld, k + j * ld, NULL, ld, 1, head_dim, scale, scores + r * count + j);
+        }
+    }
+}
+
+// 在线softmax：scores就地替换为权重 p_j = exp(s_j - 新最大值)，被屏蔽的行权重为0
+// 更新max/sum并返回已有累加结果的缩放系数 exp(旧最大值 - 新最大值)
+AVX512_TARGET
+static float row_weights(float* scores, const unsigned char* valid, size_t count,
+                         float* max, float* sum) {
+    float tile_max = -INFINITY;
+    for (size_t j = 0; j < count; j++) {
+        if (valid && !valid[j]) scores[j] = -INFINITY;
+        if (scores[j] > tile_max) tile_max = scores[j];
+    }
+    if (tile_max == -INFINITY) {
+        // 该行整块被屏蔽
+        memset(scores, 0, count * sizeof(float));
+        return 1.0f;
+    }
+
+    float new_max = tile_max > *max ? tile_max : *max;
+    float alpha = expf(*max - new_max);
+
+    const __m512 neg_inf = _mm512_set1_ps(-INFINITY);
+    const __m512 max_v = _mm512_set1_ps(new_max);
+    __m512 s0 = _mm512_setzero_ps();
+    for (size_t j = 0; j < count; j += 16) {
+        __mmask16 m = tail_mask16(count - j);
+        __m512 s = _mm512_mask_loadu_ps(neg_inf, m, scores + j);
+        __mmask16 live = _mm512_cmp_ps_mask(s, neg_inf, _CMP_NEQ_OQ);
+        __m512 e = _mm512_maskz_mov_ps(live, exp512(_mm512_sub_ps(s, max_v)));
+        _mm512_mask_storeu_ps(scores + j, m, e);
+        s0 = _mm512_add_ps(s0, e);
+    }
+    *sum = *sum * alpha + _mm512_reduce_add_ps(s0);
+    *max = new_max;
+    return alpha;
+}
+
+// acc = acc * alpha + sum_j p_j * v_j：每次64列，4条独立的FMA依赖链覆盖延迟
+AVX512_TARGET
+static void row_accumulate(const float* p, const float* v, size_t ld, size_t count,
+                           size_t head_dim, float alpha, float* acc) {
+    const __m512 alpha_v = _mm512_set1_ps(alpha);
+    for (size_t d = 0; d < head_dim; d += 64) {
+        __mmask16 m0 = col_mask16(d, head_dim);
+        __mmask16 m1 = col_mask16(d + 16, head_dim);
+        __mmask16 m2 = col_mask16(d + 32, head_dim);
+        __mmask16 m3 = col_mask16(d + 48, head_dim);
+        __m512 a0 = _mm512_mul_ps(_mm512_maskz_loadu_ps(m0, acc + d), alpha_v);
+        __m512 a1 = _mm512_mul_ps(_mm512_maskz_loadu_ps(m1, acc + d + 16), alpha_v);
+        __m512 a2 = _mm512_mul_ps(_mm512_maskz_loadu_ps(m2, acc + d + 32), alpha_v);
+        __m512 a3 = _mm512_mul_ps(_mm512_maskz_loadu_ps(m3, acc + d + 48), alpha_v);
+        for (size_t j = 0; j < count; j++) {
+            if (p[j] == 0.0f) continue;
+            const float* v_row = v + j * ld + d;
+            __m512 pv = _mm512_set1_ps(p[j]);
+            a0 = _mm512_fmadd_ps(pv, _mm512_maskz_loadu_ps(m0, v_row), a0);
+            a1 = _mm512_fmadd_ps(pv, _mm512_maskz_loadu_ps(m1, v_row + 16), a1);
+            a2 = _mm512_fmadd_ps(pv, _mm512_maskz_loadu_ps(m2, v_row + 32), a2);
+            a3 = _mm512_fmadd_ps(pv, _mm512_maskz_loadu_ps(m3, v_row + 48), a3);
+        }
+        _mm512_mask_storeu_ps(acc + d, m0, a0);
+        _mm512_mask_storeu_ps(acc + d + 16, m1, a1);
+        _mm512_mask_storeu_ps(acc + d + 32, m2, a2);
+        _mm512_mask_storeu_ps(acc + d + 48, m3, a3);
+    }
+}
+
+// 4行同时累加：每次32列，V的每次加载由4行共享
+AVX512_TARGET
+static void block_accumulate(const float* p, const float* v, size_t ld, size_t count,
+                             size_t head_dim, const float* alpha, float* acc) {
+    float* acc0 = acc;
+    float* acc1 = acc0 + head_dim;
+    float* acc2 = acc1 + head_dim;
+    float* acc3 = acc2 + head_dim;
+    const float* p0 = p;
+    const float* p1 = p0 + count;
+    const float* p2 = p1 + count;
+    const float* p3 = p2 + count;
+    for (size_t d = 0; d < head_dim; d += 32) {
+        __mmask16 m0 = col_mask16(d, head_dim);
+        __mmask16 m1 = col_mask16(d + 16, head_dim);
+        __m512 al = _mm512_set1_ps(alpha[0]);
+        __m512 a00 = _mm512_mul_ps(_mm512_maskz_loadu_ps(m0, acc0 + d), al);
+        __m512 a01 = _mm512_mul_ps(_mm512_maskz_loadu_ps(m1, acc0 + d + 16), al);
+        al = _mm512_set1_ps(alpha[1]);
+        __m512 a10 = _mm512_mul_ps(_mm512_maskz_loadu_ps(m0, acc1 + d), al);
+        __m512 a11 = _mm512_mul_ps(_mm512_maskz_loadu_ps(m1, acc1 + d + 16), al);
+        al = _mm512_set1_ps(alpha[2]);
+        __m512 a20 = _mm512_mul_ps(_mm512_maskz_loadu_ps(m0, acc2 + d), al);
+        __m512 a21 = _mm512_mul_ps(_mm512_maskz_loadu_ps(m1, acc2 + d + 16), al);
+        al = _mm512_set1_ps(alpha[3]);
+        __m512 a30 = _mm512_mul_ps(_mm512_maskz_loadu_ps(m0, acc3 + d), al);
+        __m512 a31 = _mm512_mul_ps(_mm512_maskz_loadu_ps(m1, acc3 + d + 16), al);
+        for (size_t j = 0; j < count; j++) {
+            const float* v_row = v + j * ld + d;
+            __m512 v0 = _mm512_maskz_loadu_ps(m0, v_row);
+            __m512 v1 = _mm512_maskz_loadu_ps(m1, v_row + 16);
+            __m512 pv = _mm512_set1_ps(p0[j]);
+            a00 = _mm512_fmadd_ps(pv, v0, a00);
+            a01 = _mm512_fmadd_ps(pv, v1, a01);
+            pv = _mm512_set1_ps(p1[j]);
+            a10 = _mm512_fmadd_ps(pv, v0, a10);
+            a11 = _mm512_fmadd_ps(pv, v1, a11);
+            pv = _mm512_set1_ps(p2[j]);
+            a20 = _mm512_fmadd_ps(pv, v0, a20);
+            a21 = _mm512_fmadd_ps(pv, v1, a21);
+            pv = _mm512_set1_ps(p3[j]);
+            a30 = _mm512_fmadd_ps(pv, v0, a30);
+            a31 = _mm512_fmadd_ps(pv, v1, a31);
+        }
+        _mm512_mask_storeu_ps(acc0 + d, m0, a00);
+        _mm512_mask_storeu_ps(acc0 + d + 16, m1, a01);
+        _mm512_mask_storeu_ps(acc1 + d, m0, a10);
+        _mm512_mask_storeu_ps(acc1 + d + 16, m1, a11);
+        _mm512_mask_storeu_ps(acc2 + d, m0, a20);
+        _mm512_mask_storeu_ps(acc2 + d + 16, m1, a21);
+        _mm512_mask_storeu_ps(acc3 + d, m0, a30);
+        _mm512_mask_storeu_ps(acc3 + d + 16, m1, a31);
+    }
+}
+
+// 在线softmax的一块：rows为4时K/V的加载由4行共享，否则逐行计算
+AVX512_TARGET
+void attention_tile_avx512(const float* q, size_t q_ld, size_t rows,
+                           const float* k, const float* v, size_t ld,
+                           size_t count, size_t head_dim, float scale,
+                           const unsigned char* valid, float* scores,
+                           float* acc, float* max, float* sum) {
+    if (rows == 4) {
+        float alpha[4];
+        block_scores(q, q_ld, k, ld, count, head_dim, scale, scores);
+        for (size_t r = 0; r < 4; r++) {
+            alpha[r] = row_weights(scores + r * count, valid ? valid + r * count : NULL, count,
+                                   max + r, sum + r);
+        }
+        block_accumulate(scores, v, ld, count, head_dim, alpha, acc);
+        return;
+    }
+
+    for (size_t r = 0; r < rows; r++) {
+        float* p = scores + r * count;
+        row_scores(q + r * q_ld, k, v, ld, count, head_dim, scale, p);
+        float alpha = row_weights(p, valid ? valid + r * count : NULL, count, max + r, sum + r);
+        row_accumulate(p, v, ld, count, head_dim, alpha, acc + r * head_dim);
+    }
+}
+
+// 量化KV的反量化：对称INT8，零点128
+AVX512_TARGET
+void attention_dequant_int8_avx512(const uint8_t* codes, float scale, size_t n, float* out) {
+    __m512 s = _mm512_set1_ps(scale);
+    __m512i zero_point = _mm512_set1_epi32(128);
+    for (size_t i = 0; i < n; i += 16) {
+        __mmask16 m = tail_mask16(n - i);
+        __m512i c = _mm512_cvtepu8_epi32(_mm_maskz_loadu_epi8(m, codes + i));
+        __m512 y = _mm512_cvtepi32_ps(_mm512_sub_epi32(c, zero_point));
+        _mm512_mask_storeu_ps(out + i, m, _mm512_mul_ps(y, s));
+    }
+}
+
+// FP8 E4M3：规格化数把指数和尾数移到float的对应位置并把指数偏置从7调整为127，
+// 非规格化数（指数为0）为 尾数 * 2^-9
+AVX512_TARGET
+void attention_dequant_fp8_avx512(const uint8_t* codes, float scale, size_t n, float* out) {
+    __m512 s = _mm512_set1_ps(scale);
+    for (size_t i = 0; i < n; i += 16) {
+        __mmask16 m = tail_mask16(n - i);
+        __m512i c = _mm512_cvtepu8_epi32(_mm_maskz_loadu_epi8(m, codes + i));
+        __m512i em = _mm512_and_si512(c, _mm512_set1_epi32(0x7F));
+        __m512 y = _mm512_castsi512_ps(_mm512_add_epi32(_mm512_slli_epi32(em, 20),
+                                                        _mm512_set1_epi32(120 << 23)));
+        __mmask16 subnormal = _mm512_cmplt_epi32_mask(em, _mm512_set1_epi32(8));
+        y = _mm512_mask_mul_ps(y, subnormal, _mm512_cvtepi32_ps(em), _mm512_set1_ps(1.0f / 512.0f));
+        __m512i sign = _mm512_slli_epi32(_mm512_and_si512(c, _mm512_set1_epi32(0x80)), 24);
+        y = _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(y), sign));
+        _mm512_mask_storeu_ps(out + i, m, _mm512_mul_ps(y, s));
+    }
+}
@@ -0,0 +1,40 @@
+// x86_64 F16C半精度批量转换
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define F16C_TARGET __attribute__((target("avx,f16c")))
+
+F16C_TARGET
+void fp16_to_float_f16c(float* dst, const uint16_t* src, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+    if (i < count) {
+        uint16_t tmp_h[8] = { 0 };
+        float tmp_f[8];
+        memcpy(tmp_h, src + i, (count - i) * sizeof(uint16_t));
+        _mm256_storeu_ps(tmp_f, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)tmp_h)));
+        memcpy(dst + i, tmp_f, (count - i) * sizeof(float));
+    }
+}
+
+F16C_TARGET
+void float_to_fp16_f16c(uint16_t* dst, const float* src, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(dst + i), h);
+    }
+    if (i < count) {
+        float tmp_f[8] = { 0 };
+        uint16_t tmp_h[8];
+        memcpy(tmp_f, src + i, (count - i) * sizeof(float));
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(tmp_f), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)tmp_h, h);
+        memcpy(dst + i, tmp_h, (count - i) * sizeof(uint16_t));
+    }
+}
@@ -0,0 +1,88 @@
+// x86_64 AVX2/FMA GEMM微内核
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// 尾部掩码表：从 mask_table + 8 - n 处加载得到前n个通道有效的掩码
+static const int32_t mask_table[16] = {
+    -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+
+__attribute__((target("avx2,fma")))
+static inline __m256i tail_mask(size_t n) {
+    return _mm256_loadu_si256((const __m256i*)(mask_table + 8 - n));
+}
+
+#define KERNEL_ROW_FMA(row)                                              \
+    do {                                                                 \
+        __m256 a##row = _mm256_broadcast_ss(a_panel + (row));            \
+        c##row##0 = _mm256_fmadd_ps(a##row, b0, c##row##0);              \
+        c##row##1 = _mm256_fmadd_ps(a##row, b1, c##row##1);              \
+    } while (0)
+
+// 6x16 微内核：12个累加寄存器 + 2个B寄存器 + 1个A广播寄存器
+// a_panel: [kc][6]，b_panel: [kc][16]
+// 尾部行列通过行数判断和maskstore处理，不会越界写C
+__attribute__((target("avx2,fma")))
+void gemm_kernel_avx2_6x16(size_t kc, const float* a_panel, const float* b_panel,
+                           float* c, size_t ldc, size_t mr, size_t nr,
+                           int accumulate) {
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+    for (size_t p = 0; p < kc; p++) {
+        _mm_prefetch((const char*)(b_panel + 128), _MM_HINT_T0);
+        __m256 b0 = _mm256_load_ps(b_panel);
+        __m256 b1 = _mm256_load_ps(b_panel + 8);
+
+        KERNEL_ROW_FMA(0);
+        KERNEL_ROW_FMA(1);
+        KERNEL_ROW_FMA(2);
+        KERNEL_ROW_FMA(3);
+        KERNEL_ROW_FMA(4);
+        KERNEL_ROW_FMA(5);
+
+        a_panel += 6;
+        b_panel += 16;
+    }
+
+    __m256 acc[6][2] = {
+        { c00, c01 }, { c10, c11 }, { c20, c21 },
+        { c30, c31 }, { c40, c41 }, { c50, c51 }
+    };
+
+    if (nr == 16) {
+        for (size_t i = 0; i < mr; i++) {
+            float* c_row = c + i * ldc;
+            __m256 r0 = acc[i][0];
+            __m256 r1 = acc[i][1];
+            if (accumulate) {
+                r0 = _mm256_add_ps(r0, _mm256_loadu_ps(c_row));
+                r1 = _mm256_add_ps(r1, _mm256_loadu_ps(c_row + 8));
+            }
+            _mm256_storeu_ps(c_row, r0);
+            _mm256_storeu_ps(c_row + 8, r1);
+        }
+        return;
+    }
+
+    // 列尾部：掩码存储
+    __m256i m0 = (nr >= 8) ? tail_mask(8) : tail_mask(nr);
+    __m256i m1 = (nr > 8) ? tail_mask(nr - 8) : tail_mask(0);
+    for (size_t i = 0; i < mr; i++) {
+        float* c_row = c + i * ldc;
+        __m256 r0 = acc[i][0];
+        __m256 r1 = acc[i][1];
+        if (accumulate) {
+            r0 = _mm256_add_ps(r0, _mm256_maskload_ps(c_row, m0));
+            r1 = _mm256_add_ps(r1, _mm256_maskload_ps(c_row + 8, m1));
+        }
+        _mm256_maskstore_ps(c_row, m0, r0);
+        _mm256_maskstore_ps(c_row + 8, m1, r1);
+    }
+}
@@ -0,0 +1,78 @@
+// x86_64 AVX-512 GEMM微内核
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AVX512_TARGET __attribute__((target("avx512f,avx512bw,avx512vl,fma")))
+
+#define KERNEL_ROW_FMA(row)                                              \
+    do {                                                                 \
+        __m512 a##row = _mm512_set1_ps(a_panel[row]);                    \
+        c##row##0 = _mm512_fmadd_ps(a##row, b0, c##row##0);              \
+        c##row##1 = _mm512_fmadd_ps(a##row, b1, c##row##1);              \
+    } while (0)
+
+// 12x32 微内核：24个累加寄存器 + 2个B寄存器 + 1个A广播寄存器
+// a_panel: [kc][12]，b_panel: [kc][32]
+// 尾部列通过k掩码存储处理
+AVX512_TARGET
+void gemm_kernel_avx512_12x32(size_t kc, const float* a_panel, const float* b_panel,
+                              float* c, size_t ldc, size_t mr, size_t nr,
+                              int accumulate) {
+    __m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps();
+    __m512 c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+    __m512 c20 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps();
+    __m512 c30 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+    __m512 c40 = _mm512_setzero_ps(), c41 = _mm512_setzero_ps();
+    __m512 c50 = _mm512_setzero_ps(), c51 = _mm512_setzero_ps();
+    __m512 c60 = _mm512_setzero_ps(), c61 = _mm512_setzero_ps();
+    __m512 c70 = _mm512_setzero_ps(), c71 = _mm512_setzero_ps();
+    __m512 c80 = _mm512_setzero_ps(), c81 = _mm512_setzero_ps();
+    __m512 c90 = _mm512_setzero_ps(), c91 = _mm512_setzero_ps();
+    __m512 c100 = _mm512_setzero_ps(), c101 = _mm512_setzero_ps();
+    __m512 c110 = _mm512_setzero_ps(), c111 = _mm512_setzero_ps();
+
+    for (size_t p = 0; p < kc; p++) {
+        _mm_prefetch((const char*)(b_panel + 256), _MM_HINT_T0);
+        __m512 b0 = _mm512_load_ps(b_panel);
+        __m512 b1 = _mm512_load_ps(b_panel + 16);
+
+        KERNEL_ROW_FMA(0);
+        KERNEL_ROW_FMA(1);
+        KERNEL_ROW_FMA(2);
+        KERNEL_ROW_FMA(3);
+        KERNEL_ROW_FMA(4);
+        KERNEL_ROW_FMA(5);
+        KERNEL_ROW_FMA(6);
+        KERNEL_ROW_FMA(7);
+        KERNEL_ROW_FMA(8);
+        KERNEL_ROW_FMA(9);
+        KERNEL_ROW_FMA(10);
+        KERNEL_ROW_FMA(11);
+
+        a_panel += 12;
+        b_panel += 32;
+    }
+
+    __m512 acc[12][2] = {
+        { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 },
+        { c40, c41 }, { c50, c51 }, { c60, c61 }, { c70, c71 },
+        { c80, c81 }, { c90, c91 }, { c100, c101 }, { c110, c111 }
+    };
+
+    __mmask16 m0 = (nr >= 16) ? (__mmask16)0xFFFF : (__mmask16)((1u << nr) - 1);
+    __mmask16 m1 = (nr >= 32) ? (__mmask16)0xFFFF :
+                   (nr > 16) ? (__mmask16)((1u << (nr - 16)) - 1) : (__mmask16)0;
+
+    for (size_t i = 0; i < mr; i++) {
+        float* c_row = c + i * ldc;
+        __m512 r0 = acc[i][0];
+        __m512 r1 = acc[i][1];
+        if (accumulate) {
+            r0 = _mm512_add_ps(r0, _mm512_maskz_loadu_ps(m0, c_row));
+            r1 = _mm512_add_ps(r1, _mm512_maskz_loadu_ps(m1, c_row + 16));
+        }
+        _mm512_mask_storeu_ps(c_row, m0, r0);
+        _mm512_mask_storeu_ps(c_row + 16, m1, r1);
+    }
+}
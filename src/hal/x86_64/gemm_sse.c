@@ -0,0 +1,66 @@
+// x86_64 SSE4.2 GEMM微内核
+#include <immintrin.h>
+#include <stddef.h>
+
+#define KERNEL_ROW_MUL_ADD(row)                                          \
+    do {                                                                 \
+        __m128 a##row = _mm_set1_ps(a_panel[row]);                       \
+        c##row##0 = _mm_add_ps(c##row##0, _mm_mul_ps(a##row, b0));       \
+        c##row##1 = _mm_add_ps(c##row##1, _mm_mul_ps(a##row, b1));       \
+    } while (0)
+
+// 6x8 微内核：12个累加寄存器 + 2个B寄存器 + 1个A广播寄存器
+// a_panel: [kc][6]，b_panel: [kc][8]
+__attribute__((target("sse4.2")))
+void gemm_kernel_sse_6x8(size_t kc, const float* a_panel, const float* b_panel,
+                         float* c, size_t ldc, size_t mr, size_t nr,
+                         int accumulate) {
+    __m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps();
+    __m128 c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps();
+    __m128 c20 = _mm_setzero_ps(), c21 = _mm_setzero_ps();
+    __m128 c30 = _mm_setzero_ps(), c31 = _mm_setzero_ps();
+    __m128 c40 = _mm_setzero_ps(), c41 = _mm_setzero_ps();
+    __m128 c50 = _mm_setzero_ps(), c51 = _mm_setzero_ps();
+
+    for (size_t p = 0; p < kc; p++) {
+        __m128 b0 = _mm_load_ps(b_panel);
+        __m128 b1 = _mm_load_ps(b_panel + 4);
+
+        KERNEL_ROW_MUL_ADD(0);
+        KERNEL_ROW_MUL_ADD(1);
+        KERNEL_ROW_MUL_ADD(2);
+        KERNEL_ROW_MUL_ADD(3);
+        KERNEL_ROW_MUL_ADD(4);
+        KERNEL_ROW_MUL_ADD(5);
+
+        a_panel += 6;
+        b_panel += 8;
+    }
+
+    __m128 acc[6][2] = {
+        { c00, c01 }, { c10, c11 }, { c20, c21 },
+        { c30, c31 }, { c40, c41 }, { c50, c51 }
+    };
+
+    for (size_t i = 0; i < mr; i++) {
+        float* c_row = c + i * ldc;
+        if (nr == 8) {
+            __m128 r0 = acc[i][0];
+            __m128 r1 = acc[i][1];
+            if (accumulate) {
+                r0 = _mm_add_ps(r0, _mm_loadu_ps(c_row));
+                r1 = _mm_add_ps(r1, _mm_loadu_ps(c_row + 4));
+            }
+            _mm_storeu_ps(c_row, r0);
+            _mm_storeu_ps(c_row + 4, r1);
+        } else {
+            // 列尾部：先落到临时行再逐个写回
+            float tmp[8];
+            _mm_storeu_ps(tmp, acc[i][0]);
+            _mm_storeu_ps(tmp + 4, acc[i][1]);
+            for (size_t j = 0; j < nr; j++) {
+                c_row[j] = accumulate ? c_row[j] + tmp[j] : tmp[j];
+            }
+        }
+    }
+}
@@ -0,0 +1,175 @@
+// x86_64 AVX2/FMA GEMV内核
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+#define F16C_TARGET __attribute__((target("avx2,fma,f16c")))
+
+static const int32_t mask_table[16] = {
+    -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+
+AVX2_TARGET
+static inline __m256i tail_mask(size_t n) {
+    return _mm256_loadu_si256((const __m256i*)(mask_table + 8 - n));
+}
+
+AVX2_TARGET
+static inline float hsum(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_movehdup_ps(lo));
+    return _mm_cvtss_f32(lo);
+}
+
+// y[i] = dot(A[i], x)：每次处理4行，共享x的加载
+AVX2_TARGET
+void gemv_rows_avx2(const float* a, size_t lda, const float* x,
+                    float* y, size_t rows, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= rows; i += 4) {
+        const float* r0 = a + i * lda;
+        const float* r1 = r0 + lda;
+        const float* r2 = r1 + lda;
+        const float* r3 = r2 + lda;
+        __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+        __m256 s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+
+        size_t j = 0;
+        for (; j + 8 <= n; j += 8) {
+            __m256 xv = _mm256_loadu_ps(x + j);
+            s0 = _mm256_fmadd_ps(_mm256_loadu_ps(r0 + j), xv, s0);
+            s1 = _mm256_fmadd_ps(_mm256_loadu_ps(r1 + j), xv, s1);
+            s2 = _mm256_fmadd_ps(_mm256_loadu_ps(r2 + j), xv, s2);
+            s3 = _mm256_fmadd_ps(_mm256_loadu_ps(r3 + j), xv, s3);
+        }
+        if (j < n) {
+            __m256i m = tail_mask(n - j);
+            __m256 xv = _mm256_maskload_ps(x + j, m);
+            s0 = _mm256_fmadd_ps(_mm256_maskload_ps(r0 + j, m), xv, s0);
+            s1 = _mm256_fmadd_ps(_mm256_maskload_ps(r1 + j, m), xv, s1);
+            s2 = _mm256_fmadd_ps(_mm256_maskload_ps(r2 + j, m), xv, s2);
+            s3 = _mm256_fmadd_ps(_mm256_maskload_ps(r3 + j, m), xv, s3);
+        }
+
+        y[i] = hsum(s0);
+        y[i + 1] = hsum(s1);
+        y[i + 2] = hsum(s2);
+        y[i + 3] = hsum(s3);
+    }
+
+    for (; i < rows; i++) {
+        const float* r0 = a + i * lda;
+        __m256 s0 = _mm256_setzero_ps();
+        __m256 s1 = _mm256_setzero_ps();
+        size_t j = 0;
+        for (; j + 16 <= n; j += 16) {
+            s0 = _mm256_fmadd_ps(_mm256_loadu_ps(r0 + j), _mm256_loadu_ps(x + j), s0);
+            s1 = _mm256_fmadd_ps(_mm256_loadu_ps(r0 + j + 8), _mm256_loadu_ps(x + j + 8), s1);
+        }
+        for (; j < n; j += 8) {
+            size_t rem = (n - j < 8) ? n - j : 8;
+            __m256i m = tail_mask(rem);
+            s0 = _mm256_fmadd_ps(_mm256_maskload_ps(r0 + j, m), _mm256_maskload_ps(x + j, m), s0);
+        }
+        y[i] = hsum(_mm256_add_ps(s0, s1));
+    }
+}
+
+// 加载B的8个元素（n为剩余元素数，不足8个时补零）
+#define LOAD_F32(p, n, mk) _mm256_maskload_ps((p), (mk))
+#define LOAD_F16(p, n, mk) load_half8((p), (n))
+
+F16C_TARGET
+static inline __m256 load_half8(const uint16_t* p, size_t n) {
+    if (n >= 8) return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)p));
+    uint16_t tmp[8] = { 0 };
+    memcpy(tmp, p, n * sizeof(uint16_t));
+    return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)tmp));
+}
+
+// 每次处理的列块宽度：M行的C块（最多 4 x 2KB）常驻L1
+#define CHUNK_COLS 512
+
+// 小M流式内核主体：外层按K每次推进4行，B的4行各读取一段连续的列块，
+// 保证硬件预取器看到的是顺序流；C块在L1中累加
+#define SMALL_M_BODY(M, BT, LOAD_B)                                              \
+    do {                                                                         \
+        for (size_t j0 = 0; j0 < ncols; j0 += CHUNK_COLS) {                      \
+            size_t cw = (ncols - j0 < CHUNK_COLS) ? ncols - j0 : CHUNK_COLS;     \
+            size_t cw8 = cw & ~(size_t)7;                                        \
+            __m256i mt = tail_mask(cw - cw8);                                    \
+            for (size_t i = 0; i < (M); i++) {                                   \
+                memset(c + i * ldc + j0, 0, cw * sizeof(float));                 \
+            }                                                                    \
+            size_t l = 0;                                                        \
+            for (; l + 4 <= k; l += 4) {                                         \
+                const BT* b0p = b + l * ldb + j0;                                \
+                const BT* b1p = b0p + ldb;                                       \
+                const BT* b2p = b1p + ldb;                                       \
+                const BT* b3p = b2p + ldb;                                       \
+                for (size_t j = 0; j < cw; j += 8) {                             \
+                    __m256i mk = (j < cw8) ? tail_mask(8) : mt;                  \
+                    __m256 b0 = LOAD_B(b0p + j, cw - j, mk);                     \
+                    __m256 b1 = LOAD_B(b1p + j, cw - j, mk);                     \
+                    __m256 b2 = LOAD_B(b2p + j, cw - j, mk);                     \
+                    __m256 b3 = LOAD_B(b3p + j, cw - j, mk);                     \
+                    for (size_t i = 0; i < (M); i++) {                           \
+                        const float* ap = a + i * lda + l;                       \
+                        float* cp = c + i * ldc + j0 + j;                        \
+                        __m256 acc = _mm256_maskload_ps(cp, mk);                 \
+                        acc = _mm256_fmadd_ps(_mm256_broadcast_ss(ap), b0, acc);     \
+                        acc = _mm256_fmadd_ps(_mm256_broadcast_ss(ap + 1), b1, acc); \
+                        acc = _mm256_fmadd_ps(_mm256_broadcast_ss(ap + 2), b2, acc); \
+                        acc = _mm256_fmadd_ps(_mm256_broadcast_ss(ap + 3), b3, acc); \
+                        _mm256_maskstore_ps(cp, mk, acc);                        \
+                    }                                                            \
+                }                                                                \
+            }                                                                    \
+            for (; l < k; l++) {                                                 \
+                const BT* bp = b + l * ldb + j0;                                 \
+                for (size_t i = 0; i < (M); i++) {                               \
+                    __m256 av = _mm256_broadcast_ss(a + i * lda + l);            \
+                    float* cp = c + i * ldc + j0;                                \
+                    for (size_t j = 0; j < cw; j += 8) {                         \
+                        __m256i mk = (j < cw8) ? tail_mask(8) : mt;              \
+                        __m256 acc = _mm256_maskload_ps(cp + j, mk);             \
+                        acc = _mm256_fmadd_ps(av, LOAD_B(bp + j, cw - j, mk), acc);  \
+                        _mm256_maskstore_ps(cp + j, mk, acc);                    \
+                    }                                                            \
+                }                                                                \
+            }                                                                    \
+        }                                                                        \
+    } while (0)
+
+AVX2_TARGET
+void gemv_small_m_avx2(size_t m, size_t k, const float* a, size_t lda,
+                       const float* b, size_t ldb,
+                       float* c, size_t ldc, size_t ncols) {
+    switch (m) {
+        case 1: SMALL_M_BODY(1, float, LOAD_F32); break;
+        case 2: SMALL_M_BODY(2, float, LOAD_F32); break;
+        case 3: SMALL_M_BODY(3, float, LOAD_F32); break;
+        case 4: SMALL_M_BODY(4, float, LOAD_F32); break;
+        default: break;
+    }
+}
+
+// B为fp16：vcvtph2ps每次转换8个元素后按fp32累加
+F16C_TARGET
+void gemv_small_m_f16_f16c(size_t m, size_t k, const float* a, size_t lda,
+                           const uint16_t* b, size_t ldb,
+                           float* c, size_t ldc, size_t ncols) {
+    switch (m) {
+        case 1: SMALL_M_BODY(1, uint16_t, LOAD_F16); break;
+        case 2: SMALL_M_BODY(2, uint16_t, LOAD_F16); break;
+        case 3: SMALL_M_BODY(3, uint16_t, LOAD_F16); break;
+        case 4: SMALL_M_BODY(4, uint16_t, LOAD_F16); break;
+        default: break;
+    }
+}
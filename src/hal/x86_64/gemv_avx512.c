@@ -0,0 +1,125 @@
+// x86_64 AVX-512 GEMV内核
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AVX512_TARGET __attribute__((target("avx512f,avx512bw,avx512vl,fma")))
+
+AVX512_TARGET
+static inline __mmask16 tail_mask16(size_t n) {
+    return (n >= 16) ? (__mmask16)0xFFFF : (__mmask16)((1u << n) - 1);
+}
+
+// y[i] = dot(A[i], x)：每次处理4行，共享x的加载
+AVX512_TARGET
+void gemv_rows_avx512(const float* a, size_t lda, const float* x,
+                      float* y, size_t rows, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= rows; i += 4) {
+        const float* r0 = a + i * lda;
+        const float* r1 = r0 + lda;
+        const float* r2 = r1 + lda;
+        const float* r3 = r2 + lda;
+        __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+        __m512 s2 = _mm512_setzero_ps(), s3 = _mm512_setzero_ps();
+
+        for (size_t j = 0; j < n; j += 16) {
+            __mmask16 m = tail_mask16(n - j);
+            __m512 xv = _mm512_maskz_loadu_ps(m, x + j);
+            s0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, r0 + j), xv, s0);
+            s1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, r1 + j), xv, s1);
+            s2 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, r2 + j), xv, s2);
+            s3 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, r3 + j), xv, s3);
+        }
+
+        y[i] = _mm512_reduce_add_ps(s0);
+        y[i + 1] = _mm512_reduce_add_ps(s1);
+        y[i + 2] = _mm512_reduce_add_ps(s2);
+        y[i + 3] = _mm512_reduce_add_ps(s3);
+    }
+
+    for (; i < rows; i++) {
+        const float* r0 = a + i * lda;
+        __m512 s0 = _mm512_setzero_ps();
+        for (size_t j = 0; j < n; j += 16) {
+            __mmask16 m = tail_mask16(n - j);
+            s0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, r0 + j),
+                                 _mm512_maskz_loadu_ps(m, x + j), s0);
+        }
+        y[i] = _mm512_reduce_add_ps(s0);
+    }
+}
+
+// 每次处理的列块宽度：M行的C块（最多 4 x 2KB）常驻L1
+#define CHUNK_COLS 512
+
+// 小M流式内核主体：外层按K每次推进4行，B的4行各读取一段连续的列块，
+// 保证硬件预取器看到的是顺序流；C块在L1中累加
+#define SMALL_M_BODY(M)                                                          \
+    do {                                                                         \
+        for (size_t j0 = 0; j0 < ncols; j0 += CHUNK_COLS) {                      \
+            size_t cw = (ncols - j0 < CHUNK_COLS) ? ncols - j0 : CHUNK_COLS;     \
+            for (size_t i = 0; i < (M); i++) {                                   \
+                for (size_t j = 0; j < cw; j += 16) {                            \
+                    _mm512_mask_storeu_ps(c + i * ldc + j0 + j,                  \
+                                          tail_mask16(cw - j), _mm512_setzero_ps()); \
+                }                                                                \
+            }                                                                    \
+            size_t l = 0;                                                        \
+            for (; l + 4 <= k; l += 4) {                                         \
+                const float* b0p = b + l * ldb + j0;                             \
+                const float* b1p = b0p + ldb;                                    \
+                const float* b2p = b1p + ldb;                                    \
+                const float* b3p = b2p + ldb;                                    \
+                __m512 av[M][4];                                                 \
+                for (size_t i = 0; i < (M); i++) {                               \
+                    av[i][0] = _mm512_set1_ps(a[i * lda + l]);                   \
+                    av[i][1] = _mm512_set1_ps(a[i * lda + l + 1]);               \
+                    av[i][2] = _mm512_set1_ps(a[i * lda + l + 2]);               \
+                    av[i][3] = _mm512_set1_ps(a[i * lda + l + 3]);               \
+                }                                                                \
+                for (size_t j = 0; j < cw; j += 16) {                            \
+                    __mmask16 mk = tail_mask16(cw - j);                          \
+                    __m512 b0 = _mm512_maskz_loadu_ps(mk, b0p + j);              \
+                    __m512 b1 = _mm512_maskz_loadu_ps(mk, b1p + j);              \
+                    __m512 b2 = _mm512_maskz_loadu_ps(mk, b2p + j);              \
+                    __m512 b3 = _mm512_maskz_loadu_ps(mk, b3p + j);              \
+                    for (size_t i = 0; i < (M); i++) {                           \
+                        float* cp = c + i * ldc + j0 + j;                        \
+                        __m512 acc = _mm512_maskz_loadu_ps(mk, cp);              \
+                        acc = _mm512_fmadd_ps(av[i][0], b0, acc);                \
+                        acc = _mm512_fmadd_ps(av[i][1], b1, acc);                \
+                        acc = _mm512_fmadd_ps(av[i][2], b2, acc);                \
+                        acc = _mm512_fmadd_ps(av[i][3], b3, acc);                \
+                        _mm512_mask_storeu_ps(cp, mk, acc);                      \
+                    }                                                            \
+                }                                                                \
+            }                                                                    \
+            for (; l < k; l++) {                                                 \
+                const float* bp = b + l * ldb + j0;                              \
+                for (size_t i = 0; i < (M); i++) {                               \
+                    __m512 av = _mm512_set1_ps(a[i * lda + l]);                  \
+                    float* cp = c + i * ldc + j0;                                \
+                    for (size_t j = 0; j < cw; j += 16) {                        \
+                        __mmask16 mk = tail_mask16(cw - j);                      \
+                        __m512 acc = _mm512_maskz_loadu_ps(mk, cp + j);          \
+                        acc = _mm512_fmadd_ps(av, _mm512_maskz_loadu_ps(mk, bp + j), acc); \
+                        _mm512_mask_storeu_ps(cp + j, mk, acc);                  \
+                    }                                                            \
+                }                                                                \
+            }                                                                    \
+        }                                                                        \
+    } while (0)
+
+AVX512_TARGET
+void gemv_small_m_avx512(size_t m, size_t k, const float* a, size_t lda,
+                         const float* b, size_t ldb,
+                         float* c, size_t ldc, size_t ncols) {
+    switch (m) {
+        case 1: SMALL_M_BODY(1); break;
+        case 2: SMALL_M_BODY(2); break;
+        case 3: SMALL_M_BODY(3); break;
+        case 4: SMALL_M_BODY(4); break;
+        default: break;
+    }
+}
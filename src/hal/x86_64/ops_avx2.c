@@ -0,0 +1,469 @@
+// x86_64 AVX2/FMA 融合逐元素算子
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include "vmath_avx2.h"
+
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+
+// softmax按块处理，块内数据留在L1中；块数有上限，块长随行长增大
+#define SOFTMAX_BLOCK 1024
+#define SOFTMAX_MAX_BLOCKS 64
+
+static const int32_t mask_table[16] = {
+    -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  0,  0,  0,  0,  0,  0,  0
+};
+
+AVX2_TARGET
+static inline __m256i tail_mask(size_t n) {
+    return _mm256_loadu_si256((const __m256i*)(mask_table + 8 - n));
+}
+
+AVX2_TARGET
+static inline float hsum(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_movehdup_ps(lo));
+    return _mm_cvtss_f32(lo);
+}
+
+AVX2_TARGET
+static inline float hmax(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_max_ps(lo, hi);
+    lo = _mm_max_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_max_ss(lo, _mm_movehdup_ps(lo));
+    return _mm_cvtss_f32(lo);
+}
+
+// x * sigmoid(x)
+AVX2_TARGET
+static inline __m256 silu256(__m256 x) {
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 e = exp256(_mm256_sub_ps(_mm256_setzero_ps(), x));
+    return _mm256_div_ps(x, _mm256_add_ps(one, e));
+}
+
+// u = sqrt(2/pi) * (x + 0.044715x^3)
+AVX2_TARGET
+static inline __m256 gelu_tanh_arg256(__m256 x) {
+    __m256 x2 = _mm256_mul_ps(x, x);
+    return _mm256_mul_ps(x, _mm256_fmadd_ps(x2, _mm256_set1_ps(0.044715f * 0.7978845608f),
+                                            _mm256_set1_ps(0.7978845608f)));
+}
+
+// 0.5x(1 + tanh(u)) = x * sigmoid(2u)
+AVX2_TARGET
+static inline __m256 gelu_tanh256(__m256 x) {
+    __m256 u = gelu_tanh_arg256(x);
+    __m256 e = exp256(_mm256_mul_ps(u, _mm256_set1_ps(-2.0f)));
+    return _mm256_div_ps(x, _mm256_add_ps(_mm256_set1_ps(1.0f), e));
+}
+
+// Phi(x) = 0.5 * erfc(-x / sqrt(2))，负半轴尾部不会因 1 + erf 相消而丢失精度
+AVX2_TARGET
+static inline __m256 normal_cdf256(__m256 x) {
+    __m256 z = _mm256_mul_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), x),
+                             _mm256_set1_ps(0.7071067812f));
+    __m256 half_erfc = _mm256_mul_ps(_mm256_set1_ps(0.5f), erfc256(z));
+    // x >= 0 时 Phi = 1 - erfc(z) / 2，否则 Phi = erfc(z) / 2
+    return _mm256_blendv_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), half_erfc), half_erfc, x);
+}
+
+// 0.5x(1 + erf(x / sqrt(2))) = x * Phi(x)
+AVX2_TARGET
+static inline __m256 gelu_erf256(__m256 x) {
+    return _mm256_mul_ps(x, normal_cdf256(x));
+}
+
+// out = x * r * weight（weight为NULL时省略）
+AVX2_TARGET
+static void scale_row(const float* x, const float* weight, float* out, size_t dim, float r) {
+    __m256 rv = _mm256_set1_ps(r);
+    size_t i = 0;
+    for (; i + 8 <= dim; i += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(x + i), rv);
+        if (weight) v = _mm256_mul_ps(v, _mm256_loadu_ps(weight + i));
+        _mm256_storeu_ps(out + i, v);
+    }
+    if (i < dim) {
+        __m256i m = tail_mask(dim - i);
+        __m256 v = _mm256_mul_ps(_mm256_maskload_ps(x + i, m), rv);
+        if (weight) v = _mm256_mul_ps(v, _mm256_maskload_ps(weight + i, m));
+        _mm256_maskstore_ps(out + i, m, v);
+    }
+}
+
+// out = (x - mean) * r * gamma + beta
+AVX2_TARGET
+static void normalize_row(const float* x, const float* gamma, const float* beta, float* out,
+                          size_t dim, float mean, float r) {
+    __m256 mv = _mm256_set1_ps(mean);
+    __m256 rv = _mm256_set1_ps(r);
+    size_t i = 0;
+    for (; i + 8 <= dim; i += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), mv), rv);
+        if (gamma) v = _mm256_mul_ps(v, _mm256_loadu_ps(gamma + i));
+        if (beta) v = _mm256_add_ps(v, _mm256_loadu_ps(beta + i));
+        _mm256_storeu_ps(out + i, v);
+    }
+    if (i < dim) {
+        __m256i m = tail_mask(dim - i);
+        __m256 v = _mm256_mul_ps(_mm256_sub_ps(_mm256_maskload_ps(x + i, m), mv), rv);
+        if (gamma) v = _mm256_mul_ps(v, _mm256_maskload_ps(gamma + i, m));
+        if (beta) v = _mm256_add_ps(v, _mm256_maskload_ps(beta + i, m));
+        _mm256_maskstore_ps(out + i, m, v);
+    }
+}
+
+// Welford单步：所有通道计数相同，rc为计数的倒数
+AVX2_TARGET
+static inline void welford_step(__m256 v, __m256 rc, __m256* mean, __m256* m2) {
+    __m256 d = _mm256_sub_ps(v, *mean);
+    *mean = _mm256_fmadd_ps(d, rc, *mean);
+    *m2 = _mm256_fmadd_ps(d, _mm256_sub_ps(v, *mean), *m2);
+}
+
+// 一遍求出该行的均值和偏差平方和：每个通道独立做Welford更新，最后按Chan公式合并各通道
+// delta非NULL时该行为 x + delta，并写回sum_out（残差相加）
+AVX2_TARGET
+static void row_moments(const float* x, const float* delta, float* sum_out, size_t dim,
+                        float* mean_out, float* m2_out) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 cnt = _mm256_setzero_ps();
+    __m256 mean0 = _mm256_setzero_ps(), m20 = _mm256_setzero_ps();
+    __m256 mean1 = _mm256_setzero_ps(), m21 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= dim; i += 16) {
+        __m256 v0 = _mm256_loadu_ps(x + i);
+        __m256 v1 = _mm256_loadu_ps(x + i + 8);
+        if (delta) {
+            v0 = _mm256_add_ps(v0, _mm256_loadu_ps(delta + i));
+            v1 = _mm256_add_ps(v1, _mm256_loadu_ps(delta + i + 8));
+            _mm256_storeu_ps(sum_out + i, v0);
+            _mm256_storeu_ps(sum_out + i + 8, v1);
+        }
+        cnt = _mm256_add_ps(cnt, one);
+        __m256 rc = _mm256_div_ps(one, cnt);
+        welford_step(v0, rc, &mean0, &m20);
+        welford_step(v1, rc, &mean1, &m21);
+    }
+    // 两组累加器计数相同：均值取平均，偏差平方和加上 (mean1 - mean0)^2 * cnt / 2
+    __m256 dm = _mm256_sub_ps(mean1, mean0);
+    __m256 half_cnt = _mm256_mul_ps(cnt, _mm256_set1_ps(0.5f));
+    mean0 = _mm256_mul_ps(_mm256_add_ps(mean0, mean1), _mm256_set1_ps(0.5f));
+    m20 = _mm256_fmadd_ps(_mm256_mul_ps(dm, dm), half_cnt, _mm256_add_ps(m20, m21));
+    cnt = _mm256_add_ps(cnt, cnt);
+    // 剩余不足16个元素：未加载的通道计数和统计量不变
+    for (; i < dim; i += 8) {
+        size_t rem = (dim - i < 8) ? dim - i : 8;
+        __m256i m = tail_mask(rem);
+        __m256 mf = _mm256_castsi256_ps(m);
+        __m256 v = _mm256_maskload_ps(x + i, m);
+        if (delta) {
+            v = _mm256_add_ps(v, _mm256_maskload_ps(delta + i, m));
+            _mm256_maskstore_ps(sum_out + i, m, v);
+        }
+        cnt = _mm256_add_ps(cnt, _mm256_and_ps(one, mf));
+        __m256 d = _mm256_and_ps(_mm256_sub_ps(v, mean0), mf);
+        mean0 = _mm256_fmadd_ps(d, _mm256_div_ps(one, _mm256_max_ps(cnt, one)), mean0);
+        m20 = _mm256_fmadd_ps(d, _mm256_sub_ps(v, mean0), m20);
+    }
+
+    float c[8], mu[8], q[8];
+    _mm256_storeu_ps(c, cnt);
+    _mm256_storeu_ps(mu, mean0);
+    _mm256_storeu_ps(q, m20);
+    float n = 0.0f, mean = 0.0f, m2 = 0.0f;
+    for (int l = 0; l < 8; l++) {
+        if (c[l] == 0.0f) continue;
+        float total = n + c[l];
+        float d = mu[l] - mean;
+        mean += d * c[l] / total;
+        m2 += q[l] + d * d * n * c[l] / total;
+        n = total;
+    }
+    *mean_out = mean;
+    *m2_out = m2;
+}
+
+AVX2_TARGET
+void ops_rmsnorm_avx2(const float* x, const float* weight, const float* bias,
+                      float* out, size_t dim, float eps) {
+    (void)bias;
+    __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= dim; i += 16) {
+        __m256 v0 = _mm256_loadu_ps(x + i);
+        __m256 v1 = _mm256_loadu_ps(x + i + 8);
+        s0 = _mm256_fmadd_ps(v0, v0, s0);
+        s1 = _mm256_fmadd_ps(v1, v1, s1);
+    }
+    for (; i < dim; i += 8) {
+        size_t rem = (dim - i < 8) ? dim - i : 8;
+        __m256 v = _mm256_maskload_ps(x + i, tail_mask(rem));
+        s0 = _mm256_fmadd_ps(v, v, s0);
+    }
+    float ss = hsum(_mm256_add_ps(s0, s1));
+    scale_row(x, weight, out, dim, 1.0f / sqrtf(ss / (float)dim + eps));
+}
+
+AVX2_TARGET
+void ops_layernorm_avx2(const float* x, const float* gamma, const float* beta,
+                        float* out, size_t dim, float eps) {
+    float mean, m2;
+    row_moments(x, NULL, NULL, dim, &mean, &m2);
+    normalize_row(x, gamma, beta, out, dim, mean, 1.0f / sqrtf(m2 / (float)dim + eps));
+}
+
+// 残差相加时同时累加平方和，归一化阶段从缓存中重新读取该行
+AVX2_TARGET
+void ops_add_rmsnorm_avx2(float* residual, const float* delta, const float* weight,
+                          const float* bias, float* out, size_t dim, float eps) {
+    (void)bias;
+    __m256 s0 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= dim; i += 8) {
+        __m256 v = _mm256_add_ps(_mm256_loadu_ps(residual + i), _mm256_loadu_ps(delta + i));
+        _mm256_storeu_ps(residual + i, v);
+        s0 = _mm256_fmadd_ps(v, v, s0);
+    }
+    if (i < dim) {
+        __m256i m = tail_mask(dim - i);
+        __m256 v = _mm256_add_ps(_mm256_maskload_ps(residual + i, m),
+                                 _mm256_maskload_ps(delta + i, m));
+        _mm256_maskstore_ps(residual + i, m, v);
+        s0 = _mm256_fmadd_ps(v, v, s0);
+    }
+    float ss = hsum(s0);
+    scale_row(residual, weight, out, dim, 1.0f / sqrtf(ss / (float)dim + eps));
+}
+
+AVX2_TARGET
+void ops_add_layernorm_avx2(float* residual, const float* delta, const float* gamma,
+                            const float* beta, float* out, size_t dim, float eps) {
+    float mean, m2;
+    row_moments(residual, delta, residual, dim, &mean, &m2);
+    normalize_row(residual, gamma, beta, out, dim, mean, 1.0f / sqrtf(m2 / (float)dim + eps));
+}
+
+static size_t softmax_block_len(size_t dim) {
+    size_t len = (dim + SOFTMAX_MAX_BLOCKS - 1) / SOFTMAX_MAX_BLOCKS;
+    len = (len + 15) & ~(size_t)15;
+    return len > SOFTMAX_BLOCK ? len : SOFTMAX_BLOCK;
+}
+
+// 一块：写入 exp(x - 块内最大值)，返回块内的和；整块为-inf时写入0
+AVX2_TARGET
+static float softmax_block(const float* x, float* out, size_t dim, float* block_max) {
+    const __m256 neg_inf = _mm256_set1_ps(-INFINITY);
+    __m256 mx = neg_inf;
+    size_t i = 0;
+    for (; i + 8 <= dim; i += 8) {
+        mx = _mm256_max_ps(mx, _mm256_loadu_ps(x + i));
+    }
+    if (i < dim) {
+        __m256i m = tail_mask(dim - i);
+        __m256 v = _mm256_blendv_ps(neg_inf, _mm256_maskload_ps(x + i, m), _mm256_castsi256_ps(m));
+        mx = _mm256_max_ps(mx, v);
+    }
+    *block_max = hmax(mx);
+    if (*block_max == -INFINITY) {
+        memset(out, 0, dim * sizeof(float));
+        return 0.0f;
+    }
+    __m256 max_v = _mm256_set1_ps(*block_max);
+
+    __m256 s0 = _mm256_setzero_ps();
+    for (i = 0; i + 8 <= dim; i += 8) {
+        __m256 e = exp256(_mm256_sub_ps(_mm256_loadu_ps(x + i), max_v));
+        _mm256_storeu_ps(out + i, e);
+        s0 = _mm256_add_ps(s0, e);
+    }
+    if (i < dim) {
+        __m256i m = tail_mask(dim - i);
+        __m256 e = exp256(_mm256_sub_ps(_mm256_maskload_ps(x + i, m), max_v));
+        e = _mm256_and_ps(e, _mm256_castsi256_ps(m));
+        _mm256_maskstore_ps(out + i, m, e);
+        s0 = _mm256_add_ps(s0, e);
+    }
+    return hsum(s0);
+}
+
+// 在线softmax：逐块求exp并把块的最大值和和合并为全行的最大值和总和，最后按块缩放，
+// x只读取一遍，每个元素只求一次exp
+AVX2_TARGET
+void ops_softmax_avx2(const float* x, float* out, size_t dim) {
+    float block_max[SOFTMAX_MAX_BLOCKS];
+    size_t block = softmax_block_len(dim);
+    float max_val = -INFINITY, sum = 0.0f;
+    size_t b = 0;
+    for (size_t start = 0; start < dim; start += block, b++) {
+        size_t n = dim - start < block ? dim - start : block;
+        float bs = softmax_block(x + start, out + start, n, &block_max[b]);
+        float bm = block_max[b];
+        if (bm == -INFINITY) continue;
+        if (bm > max_val) {
+            sum = sum * expf(max_val - bm) + bs;
+            max_val = bm;
+        } else {
+            sum += bs * expf(bm - max_val);
+        }
+    }
+    b = 0;
+    for (size_t start = 0; start < dim; start += block, b++) {
+        size_t n = dim - start < block ? dim - start : block;
+        scale_row(out + start, NULL, out + start, n, expf(block_max[b] - max_val) / sum);
+    }
+}
+
+// 逐元素内核主体：OP为 __m256 -> __m256 的向量函数
+#define UNARY_BODY(OP)                                                       \
+    do {                                                                     \
+        size_t i = 0;                                                        \
+        for (; i + 8 <= n; i += 8) {                                         \
+            _mm256_storeu_ps(out + i, OP(_mm256_loadu_ps(x + i)));           \
+        }                                                                    \
+        if (i < n) {                                                         \
+            __m256i m = tail_mask(n - i);                                    \
+            _mm256_maskstore_ps(out + i, m, OP(_mm256_maskload_ps(x + i, m))); \
+        }                                                                    \
+    } while (0)
+
+AVX2_TARGET
+static inline __m256 relu256(__m256 x) {
+    return _mm256_max_ps(x, _mm256_setzero_ps());
+}
+
+AVX2_TARGET
+void ops_relu_avx2(const float* x, float* out, size_t n) {
+    UNARY_BODY(relu256);
+}
+
+AVX2_TARGET
+void ops_silu_avx2(const float* x, float* out, size_t n) {
+    UNARY_BODY(silu256);
+}
+
+AVX2_TARGET
+void ops_gelu_tanh_avx2(const float* x, float* out, size_t n) {
+    UNARY_BODY(gelu_tanh256);
+}
+
+AVX2_TARGET
+void ops_gelu_erf_avx2(const float* x, float* out, size_t n) {
+    UNARY_BODY(gelu_erf256);
+}
+
+AVX2_TARGET
+void ops_tanh_avx2(const float* x, float* out, size_t n) {
+    UNARY_BODY(tanh256);
+}
+
+AVX2_TARGET
+void ops_silu_mul_avx2(const float* gate, const float* up, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_mul_ps(silu256(_mm256_loadu_ps(gate + i)), _mm256_loadu_ps(up + i));
+        _mm256_storeu_ps(out + i, v);
+    }
+    if (i < n) {
+        __m256i m = tail_mask(n - i);
+        __m256 v = _mm256_mul_ps(silu256(_mm256_maskload_ps(gate + i, m)),
+                                 _mm256_maskload_ps(up + i, m));
+        _mm256_maskstore_ps(out + i, m, v);
+    }
+}
+
+// 导数内核：返回 f'(x)，同时通过y返回 f(x)（前向值与导数共享exp/erfc等中间结果）
+
+AVX2_TARGET
+static inline __m256 relu_grad256(__m256 x, __m256* y) {
+    *y = _mm256_max_ps(x, _mm256_setzero_ps());
+    return _mm256_and_ps(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GT_OQ), _mm256_set1_ps(1.0f));
+}
+
+// s = sigmoid(x)，y = x * s，y' = s + y * (1 - s)
+AVX2_TARGET
+static inline __m256 silu_grad256(__m256 x, __m256* y) {
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 s = sigmoid256(x);
+    *y = _mm256_mul_ps(x, s);
+    return _mm256_fmadd_ps(*y, _mm256_sub_ps(one, s), s);
+}
+
+// s = sigmoid(2u)，y = x * s，y' = s + 2x * s(1 - s) * u'，u' = sqrt(2/pi) * (1 + 3 * 0.044715x^2)
+AVX2_TARGET
+static inline __m256 gelu_tanh_grad256(__m256 x, __m256* y) {
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 s = sigmoid256(_mm256_mul_ps(gelu_tanh_arg256(x), _mm256_set1_ps(2.0f)));
+    *y = _mm256_mul_ps(x, s);
+    __m256 du = _mm256_fmadd_ps(_mm256_mul_ps(x, x), _mm256_set1_ps(3.0f * 0.044715f * 0.7978845608f),
+                                _mm256_set1_ps(0.7978845608f));
+    __m256 ds = _mm256_mul_ps(_mm256_mul_ps(s, _mm256_sub_ps(one, s)), _mm256_add_ps(x, x));
+    return _mm256_fmadd_ps(ds, du, s);
+}
+
+// y = x * Phi(x)，y' = Phi(x) + x * exp(-x^2 / 2) / sqrt(2pi)
+AVX2_TARGET
+static inline __m256 gelu_erf_grad256(__m256 x, __m256* y) {
+    __m256 cdf = normal_cdf256(x);
+    *y = _mm256_mul_ps(x, cdf);
+    __m256 pdf = _mm256_mul_ps(exp256(_mm256_mul_ps(_mm256_mul_ps(x, x), _mm256_set1_ps(-0.5f))),
+                               _mm256_set1_ps(0.3989422804f));
+    return _mm256_fmadd_ps(x, pdf, cdf);
+}
+
+// 导数内核主体：grad = f'(x)（grad_out非NULL时乘以grad_out），out非NULL时写出f(x)
+#define GRAD_BODY(OP)                                                        \
+    do {                                                                     \
+        size_t i = 0;                                                        \
+        for (; i + 8 <= n; i += 8) {                                         \
+            __m256 y;                                                        \
+            __m256 d = OP(_mm256_loadu_ps(x + i), &y);                       \
+            if (grad_out) d = _mm256_mul_ps(d, _mm256_loadu_ps(grad_out + i)); \
+            if (out) _mm256_storeu_ps(out + i, y);                           \
+            _mm256_storeu_ps(grad + i, d);                                   \
+        }                                                                    \
+        if (i < n) {                                                         \
+            __m256i m = tail_mask(n - i);                                    \
+            __m256 y;                                                        \
+            __m256 d = OP(_mm256_maskload_ps(x + i, m), &y);                 \
+            if (grad_out) d = _mm256_mul_ps(d, _mm256_maskload_ps(grad_out + i, m)); \
+            if (out) _mm256_maskstore_ps(out + i, m, y);                     \
+            _mm256_maskstore_ps(grad + i, m, d);                             \
+        }                                                                    \
+    } while (0)
+
+AVX2_TARGET
+void ops_relu_grad_avx2(const float* x, const float* grad_out, float* out, float* grad, size_t n) {
+    GRAD_BODY(relu_grad256);
+}
+
+AVX2_TARGET
+void ops_silu_grad_avx2(const float* x, const float* grad_out, float* out, float* grad, size_t n) {
+    GRAD_BODY(silu_grad256);
+}
+
+AVX2_TARGET
+void ops_gelu_tanh_grad_avx2(const float* x, const float* grad_out, float* out, float* grad,
+                             size_t n) {
+    GRAD_BODY(gelu_tanh_grad256);
+}
+
+AVX2_TARGET
+void ops_gelu_erf_grad_avx2(const float* x, const float* grad_out, float* out, float* grad,
+                            size_t n) {
+    GRAD_BODY(gelu_erf_grad256);
+}
+
+AVX2_TARGET
+void ops_tanh_grad_avx2(const float* x, const float* grad_out, float* out, float* grad, size_t n) {
+    GRAD_BODY(tanh_deriv256);
+}
@@ -0,0 +1,267 @@
+// x86_64 AVX-512 逐元素算子（激活函数、SwiGLU门控和softmax；归一化受带宽限制，沿用AVX2版本）
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include "vmath_avx512.h"
+
+#define AVX512_TARGET __attribute__((target("avx512f,avx512bw,avx512vl,fma")))
+
+// softmax按块处理，块内数据留在L1中；块数有上限，块长随行长增大
+#define SOFTMAX_BLOCK 1024
+#define SOFTMAX_MAX_BLOCKS 64
+
+AVX512_TARGET
+static inline __mmask16 tail_mask16(size_t n) {
+    return (n >= 16) ? (__mmask16)0xFFFF : (__mmask16)((1u << n) - 1);
+}
+
+// x * sigmoid(x)
+AVX512_TARGET
+static inline __m512 silu512(__m512 x) {
+    __m512 one = _mm512_set1_ps(1.0f);
+    __m512 e = exp512(_mm512_sub_ps(_mm512_setzero_ps(), x));
+    return _mm512_div_ps(x, _mm512_add_ps(one, e));
+}
+
+// u = sqrt(2/pi) * (x + 0.044715x^3)
+AVX512_TARGET
+static inline __m512 gelu_tanh_arg512(__m512 x) {
+    __m512 x2 = _mm512_mul_ps(x, x);
+    return _mm512_mul_ps(x, _mm512_fmadd_ps(x2, _mm512_set1_ps(0.044715f * 0.7978845608f),
+                                            _mm512_set1_ps(0.7978845608f)));
+}
+
+// 0.5x(1 + tanh(u)) = x * sigmoid(2u)
+AVX512_TARGET
+static inline __m512 gelu_tanh512(__m512 x) {
+    __m512 u = gelu_tanh_arg512(x);
+    __m512 e = exp512(_mm512_mul_ps(u, _mm512_set1_ps(-2.0f)));
+    return _mm512_div_ps(x, _mm512_add_ps(_mm512_set1_ps(1.0f), e));
+}
+
+// Phi(x) = 0.5 * erfc(-x / sqrt(2))
+AVX512_TARGET
+static inline __m512 normal_cdf512(__m512 x) {
+    __m512 z = _mm512_mul_ps(_mm512_abs_ps(x), _mm512_set1_ps(0.7071067812f));
+    __m512 half_erfc = _mm512_mul_ps(_mm512_set1_ps(0.5f), erfc512(z));
+    // x >= 0 时 Phi = 1 - erfc(z) / 2，否则 Phi = erfc(z) / 2
+    __mmask16 pos = _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_GE_OQ);
+    return _mm512_mask_sub_ps(half_erfc, pos, _mm512_set1_ps(1.0f), half_erfc);
+}
+
+// x * Phi(x)
+AVX512_TARGET
+static inline __m512 gelu_erf512(__m512 x) {
+    return _mm512_mul_ps(x, normal_cdf512(x));
+}
+
+AVX512_TARGET
+static inline __m512 relu512(__m512 x) {
+    return _mm512_max_ps(x, _mm512_setzero_ps());
+}
+
+static size_t softmax_block_len(size_t dim) {
+    size_t len = (dim + SOFTMAX_MAX_BLOCKS - 1) / SOFTMAX_MAX_BLOCKS;
+    len = (len + 15) & ~(size_t)15;
+    return len > SOFTMAX_BLOCK ? len : SOFTMAX_BLOCK;
+}
+
+// 一块：写入 exp(x - 块内最大值)，返回块内的和；整块为-inf时写入0
+AVX512_TARGET
+static float softmax_block(const float* x, float* out, size_t dim, float* block_max) {
+    __m512 mx = _mm512_set1_ps(-INFINITY);
+    for (size_t i = 0; i < dim; i += 16) {
+        __mmask16 m = tail_mask16(dim - i);
+        mx = _mm512_mask_max_ps(mx, m, mx, _mm512_maskz_loadu_ps(m, x + i));
+    }
+    *block_max = _mm512_reduce_max_ps(mx);
+    if (*block_max == -INFINITY) {
+        memset(out, 0, dim * sizeof(float));
+        return 0.0f;
+    }
+    __m512 max_v = _mm512_set1_ps(*block_max);
+
+    __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= dim; i += 32) {
+        __m512 e0 = exp512(_mm512_sub_ps(_mm512_loadu_ps(x + i), max_v));
+        __m512 e1 = exp512(_mm512_sub_ps(_mm512_loadu_ps(x + i + 16), max_v));
+        _mm512_storeu_ps(out + i, e0);
+        _mm512_storeu_ps(out + i + 16, e1);
+        s0 = _mm512_add_ps(s0, e0);
+        s1 = _mm512_add_ps(s1, e1);
+    }
+    for (; i < dim; i += 16) {
+        __mmask16 m = tail_mask16(dim - i);
+        __m512 e = exp512(_mm512_sub_ps(_mm512_maskz_loadu_ps(m, x + i), max_v));
+        _mm512_mask_storeu_ps(out + i, m, e);
+        s0 = _mm512_mask_add_ps(s0, m, s0, e);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(s0, s1));
+}
+
+// 在线softmax：逐块求exp并把块的最大值和和合并为全行的最大值和总和，最后按块缩放，
+// x只读取一遍，每个元素只求一次exp
+AVX512_TARGET
+void ops_softmax_avx512(const float* x, float* out, size_t dim) {
+    float block_max[SOFTMAX_MAX_BLOCKS];
+    size_t block = softmax_block_len(dim);
+    float max_val = -INFINITY, sum = 0.0f;
+    size_t b = 0;
+    for (size_t start = 0; start < dim; start += block, b++) {
+        size_t n = dim - start < block ? dim - start : block;
+        float bs = softmax_block(x + start, out + start, n, &block_max[b]);
+        float bm = block_max[b];
+        if (bm == -INFINITY) continue;
+        if (bm > max_val) {
+            sum = sum * expf(max_val - bm) + bs;
+            max_val = bm;
+        } else {
+            sum += bs * expf(bm - max_val);
+        }
+    }
+    b = 0;
+    for (size_t start = 0; start < dim; start += block, b++) {
+        size_t n = dim - start < block ? dim - start : block;
+        __m512 scale = _mm512_set1_ps(expf(block_max[b] - max_val) / sum);
+        for (size_t i = 0; i < n; i += 16) {
+            __mmask16 m = tail_mask16(n - i);
+            _mm512_mask_storeu_ps(out + start + i, m,
+                                  _mm512_mul_ps(_mm512_maskz_loadu_ps(m, out + start + i), scale));
+        }
+    }
+}
+
+// 逐元素内核主体：OP为 __m512 -> __m512 的向量函数
+#define UNARY_BODY(OP)                                                       \
+    do {                                                                     \
+        size_t i = 0;                                                        \
+        for (; i + 16 <= n; i += 16) {                                       \
+            _mm512_storeu_ps(out + i, OP(_mm512_loadu_ps(x + i)));           \
+        }                                                                    \
+        if (i < n) {                                                         \
+            __mmask16 m = tail_mask16(n - i);                                \
+            _mm512_mask_storeu_ps(out + i, m, OP(_mm512_maskz_loadu_ps(m, x + i))); \
+        }                                                                    \
+    } while (0)
+
+AVX512_TARGET
+void ops_relu_avx512(const float* x, float* out, size_t n) {
+    UNARY_BODY(relu512);
+}
+
+AVX512_TARGET
+void ops_silu_avx512(const float* x, float* out, size_t n) {
+    UNARY_BODY(silu512);
+}
+
+AVX512_TARGET
+void ops_gelu_tanh_avx512(const float* x, float* out, size_t n) {
+    UNARY_BODY(gelu_tanh512);
+}
+
+AVX512_TARGET
+void ops_gelu_erf_avx512(const float* x, float* out, size_t n) {
+    UNARY_BODY(gelu_erf512);
+}
+
+AVX512_TARGET
+void ops_tanh_avx512(const float* x, float* out, size_t n) {
+    UNARY_BODY(tanh512);
+}
+
+AVX512_TARGET
+void ops_silu_mul_avx512(const float* gate, const float* up, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = _mm512_mul_ps(silu512(_mm512_loadu_ps(gate + i)), _mm512_loadu_ps(up + i));
+        _mm512_storeu_ps(out + i, v);
+    }
+    if (i < n) {
+        __mmask16 m = tail_mask16(n - i);
+        __m512 v = _mm512_mul_ps(silu512(_mm512_maskz_loadu_ps(m, gate + i)),
+                                 _mm512_maskz_loadu_ps(m, up + i));
+        _mm512_mask_storeu_ps(out + i, m, v);
+    }
+}
+
+// 导数内核：返回 f'(x)，同时通过y返回 f(x)，推导见ops_avx2.c
+AVX512_TARGET
+static inline __m512 relu_grad512(__m512 x, __m512* y) {
+    *y = _mm512_max_ps(x, _mm512_setzero_ps());
+    __mmask16 pos = _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_GT_OQ);
+    return _mm512_maskz_mov_ps(pos, _mm512_set1_ps(1.0f));
+}
+
+AVX512_TARGET
+static inline __m512 silu_grad512(__m512 x, __m512* y) {
+    __m512 one = _mm512_set1_ps(1.0f);
+    __m512 s = sigmoid512(x);
+    *y = _mm512_mul_ps(x, s);
+    return _mm512_fmadd_ps(*y, _mm512_sub_ps(one, s), s);
+}
+
+AVX512_TARGET
+static inline __m512 gelu_tanh_grad512(__m512 x, __m512* y) {
+    __m512 one = _mm512_set1_ps(1.0f);
+    __m512 s = sigmoid512(_mm512_mul_ps(gelu_tanh_arg512(x), _mm512_set1_ps(2.0f)));
+    *y = _mm512_mul_ps(x, s);
+    __m512 du = _mm512_fmadd_ps(_mm512_mul_ps(x, x), _mm512_set1_ps(3.0f * 0.044715f * 0.7978845608f),
+                                _mm512_set1_ps(0.7978845608f));
+    __m512 ds = _mm512_mul_ps(_mm512_mul_ps(s, _mm512_sub_ps(one, s)), _mm512_add_ps(x, x));
+    return _mm512_fmadd_ps(ds, du, s);
+}
+
+AVX512_TARGET
+static inline __m512 gelu_erf_grad512(__m512 x, __m512* y) {
+    __m512 cdf = normal_cdf512(x);
+    *y = _mm512_mul_ps(x, cdf);
+    __m512 pdf = _mm512_mul_ps(exp512(_mm512_mul_ps(_mm512_mul_ps(x, x), _mm512_set1_ps(-0.5f))),
+                               _mm512_set1_ps(0.3989422804f));
+    return _mm512_fmadd_ps(x, pdf, cdf);
+}
+
+// 导数内核主体：grad = f'(x)（grad_out非NULL时乘以grad_out），out非NULL时写出f(x)
+#define GRAD_BODY(OP)                                                        \
+    do {                                                                     \
+        for (size_t i = 0; i < n; i += 16) {                                 \
+            __mmask16 m = tail_mask16(n - i);                                \
+            __m512 y;                                                        \
+            __m512 d = OP(_mm512_maskz_loadu_ps(m, x + i), &y);              \
+            if (grad_out) d = _mm512_mul_ps(d, _mm512_maskz_loadu_ps(m, grad_out + i)); \
+            if (out) _mm512_mask_storeu_ps(out + i, m, y);                   \
+            _mm512_mask_storeu_ps(grad + i, m, d);                           \
+        }                                                                    \
+    } while (0)
+
+AVX512_TARGET
+void ops_relu_grad_avx512(const float* x, const float* grad_out, float* out, float* grad,
+                          size_t n) {
+    GRAD_BODY(relu_grad512);
+}
+
+AVX512_TARGET
+void ops_silu_grad_avx512(const float* x, const float* grad_out, float* out, float* grad,
+                          size_t n) {
+    GRAD_BODY(silu_grad512);
+}
+
+AVX512_TARGET
+void ops_gelu_tanh_grad_avx512(const float* x, const float* grad_out, float* out, float* grad,
+                               size_t n) {
+    GRAD_BODY(gelu_tanh_grad512);
+}
+
+AVX512_TARGET
+void ops_gelu_erf_grad_avx512(const float* x, const float* grad_out, float* out, float* grad,
+                              size_t n) {
+    GRAD_BODY(gelu_erf_grad512);
+}
+
+AVX512_TARGET
+void ops_tanh_grad_avx512(const float* x, const float* grad_out, float* out, float* grad,
+                          size_t n) {
+    GRAD_BODY(tanh_deriv512);
+}
@@ -0,0 +1,109 @@
+// x86_64 AVX2 / AVX-VNNI INT8 GEMM微内核
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+#define AVXVNNI_TARGET __attribute__((target("avx2,fma,avxvnni")))
+
+// 读取A面板中一行的4个uint8（K方向相邻）
+static inline int32_t load_quad(const uint8_t* p) {
+    int32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 无VNNI时的路径：uint8/int8扩展为int16后用vpmaddwd累加
+// vpmaddubsw的int16饱和在uint8满量程（255 * -128 * 2）下会截断结果，这里不使用
+#define MADD_ROW(row)                                                        \
+    do {                                                                     \
+        __m256i a##row = _mm256_cvtepu8_epi16(                               \
+            _mm_set1_epi32(load_quad(a_panel + (row) * 4)));                 \
+        lo##row = _mm256_add_epi32(lo##row, _mm256_madd_epi16(a##row, blo)); \
+        hi##row = _mm256_add_epi32(hi##row, _mm256_madd_epi16(a##row, bhi)); \
+    } while (0)
+
+// 两个部分和相邻的列合并：lo为列0-3，hi为列4-7，每列两个int32部分和
+#define MADD_STORE(row)                                                      \
+    do {                                                                     \
+        __m256i s = _mm256_hadd_epi32(lo##row, hi##row);                     \
+        s = _mm256_permute4x64_epi64(s, 0xD8);                               \
+        _mm256_storeu_si256((__m256i*)(tile + (row) * 8), s);                \
+    } while (0)
+
+// 4x8 微内核（AVX2）：a_panel: [kg][4][4]，b_panel: [kg][8][4]
+AVX2_TARGET
+void qgemm_kernel_avx2_4x8(size_t kg, const uint8_t* a_panel, const int8_t* b_panel,
+                           int32_t* tile) {
+    __m256i lo0 = _mm256_setzero_si256(), hi0 = _mm256_setzero_si256();
+    __m256i lo1 = _mm256_setzero_si256(), hi1 = _mm256_setzero_si256();
+    __m256i lo2 = _mm256_setzero_si256(), hi2 = _mm256_setzero_si256();
+    __m256i lo3 = _mm256_setzero_si256(), hi3 = _mm256_setzero_si256();
+
+    for (size_t g = 0; g < kg; g++) {
+        __m256i braw = _mm256_load_si256((const __m256i*)b_panel);
+        __m256i blo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(braw));
+        __m256i bhi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(braw, 1));
+
+        MADD_ROW(0);
+        MADD_ROW(1);
+        MADD_ROW(2);
+        MADD_ROW(3);
+
+        a_panel += 16;
+        b_panel += 32;
+    }
+
+    MADD_STORE(0);
+    MADD_STORE(1);
+    MADD_STORE(2);
+    MADD_STORE(3);
+}
+
+#define VNNI_ROW(row)                                                        \
+    do {                                                                     \
+        __m256i a##row = _mm256_set1_epi32(load_quad(a_panel + (row) * 4));  \
+        c##row##0 = _mm256_dpbusd_avx_epi32(c##row##0, a##row, b0);          \
+        c##row##1 = _mm256_dpbusd_avx_epi32(c##row##1, a##row, b1);          \
+    } while (0)
+
+#define VNNI_STORE(row)                                                      \
+    do {                                                                     \
+        _mm256_storeu_si256((__m256i*)(tile + (row) * 16), c##row##0);       \
+        _mm256_storeu_si256((__m256i*)(tile + (row) * 16 + 8), c##row##1);   \
+    } while (0)
+
+// 6x16 微内核（AVX-VNNI）：12个累加寄存器，a_panel: [kg][6][4]，b_panel: [kg][16][4]
+AVXVNNI_TARGET
+void qgemm_kernel_avxvnni_6x16(size_t kg, const uint8_t* a_panel, const int8_t* b_panel,
+                               int32_t* tile) {
+    __m256i c00 = _mm256_setzero_si256(), c01 = _mm256_setzero_si256();
+    __m256i c10 = _mm256_setzero_si256(), c11 = _mm256_setzero_si256();
+    __m256i c20 = _mm256_setzero_si256(), c21 = _mm256_setzero_si256();
+    __m256i c30 = _mm256_setzero_si256(), c31 = _mm256_setzero_si256();
+    __m256i c40 = _mm256_setzero_si256(), c41 = _mm256_setzero_si256();
+    __m256i c50 = _mm256_setzero_si256(), c51 = _mm256_setzero_si256();
+
+    for (size_t g = 0; g < kg; g++) {
+        __m256i b0 = _mm256_load_si256((const __m256i*)b_panel);
+        __m256i b1 = _mm256_load_si256((const __m256i*)(b_panel + 32));
+
+        VNNI_ROW(0);
+        VNNI_ROW(1);
+        VNNI_ROW(2);
+        VNNI_ROW(3);
+        VNNI_ROW(4);
+        VNNI_ROW(5);
+
+        a_panel += 24;
+        b_panel += 64;
+    }
+
+    VNNI_STORE(0);
+    VNNI_STORE(1);
+    VNNI_STORE(2);
+    VNNI_STORE(3);
+    VNNI_STORE(4);
+    VNNI_STORE(5);
+}
@@ -0,0 +1,76 @@
+// x86_64 AVX-512 VNNI INT8 GEMM微内核
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define AVX512VNNI_TARGET __attribute__((target("avx512f,avx512bw,avx512vl,avx512vnni")))
+
+#define VNNI_ROW(row)                                                        \
+    do {                                                                     \
+        int32_t q##row;                                                      \
+        memcpy(&q##row, a_panel + (row) * 4, sizeof(int32_t));               \
+        __m512i a##row = _mm512_set1_epi32(q##row);                          \
+        c##row##0 = _mm512_dpbusd_epi32(c##row##0, a##row, b0);              \
+        c##row##1 = _mm512_dpbusd_epi32(c##row##1, a##row, b1);              \
+    } while (0)
+
+#define VNNI_STORE(row)                                                      \
+    do {                                                                     \
+        _mm512_storeu_si512(tile + (row) * 32, c##row##0);                   \
+        _mm512_storeu_si512(tile + (row) * 32 + 16, c##row##1);              \
+    } while (0)
+
+// 12x32 微内核：24个累加寄存器 + 2个B寄存器 + 1个A广播寄存器
+// a_panel: [kg][12][4] uint8，b_panel: [kg][32][4] int8，每条vpdpbusd完成4个K的乘加
+AVX512VNNI_TARGET
+void qgemm_kernel_avx512vnni_12x32(size_t kg, const uint8_t* a_panel, const int8_t* b_panel,
+                                   int32_t* tile) {
+    __m512i c00 = _mm512_setzero_si512(), c01 = _mm512_setzero_si512();
+    __m512i c10 = _mm512_setzero_si512(), c11 = _mm512_setzero_si512();
+    __m512i c20 = _mm512_setzero_si512(), c21 = _mm512_setzero_si512();
+    __m512i c30 = _mm512_setzero_si512(), c31 = _mm512_setzero_si512();
+    __m512i c40 = _mm512_setzero_si512(), c41 = _mm512_setzero_si512();
+    __m512i c50 = _mm512_setzero_si512(), c51 = _mm512_setzero_si512();
+    __m512i c60 = _mm512_setzero_si512(), c61 = _mm512_setzero_si512();
+    __m512i c70 = _mm512_setzero_si512(), c71 = _mm512_setzero_si512();
+    __m512i c80 = _mm512_setzero_si512(), c81 = _mm512_setzero_si512();
+    __m512i c90 = _mm512_setzero_si512(), c91 = _mm512_setzero_si512();
+    __m512i c100 = _mm512_setzero_si512(), c101 = _mm512_setzero_si512();
+    __m512i c110 = _mm512_setzero_si512(), c111 = _mm512_setzero_si512();
+
+    for (size_t g = 0; g < kg; g++) {
+        _mm_prefetch((const char*)(b_panel + 512), _MM_HINT_T0);
+        __m512i b0 = _mm512_load_si512(b_panel);
+        __m512i b1 = _mm512_load_si512(b_panel + 64);
+
+        VNNI_ROW(0);
+        VNNI_ROW(1);
+        VNNI_ROW(2);
+        VNNI_ROW(3);
+        VNNI_ROW(4);
+        VNNI_ROW(5);
+        VNNI_ROW(6);
+        VNNI_ROW(7);
+        VNNI_ROW(8);
+        VNNI_ROW(9);
+        VNNI_ROW(10);
+        VNNI_ROW(11);
+
+        a_panel += 48;
+        b_panel += 128;
+    }
+
+    VNNI_STORE(0);
+    VNNI_STORE(1);
+    VNNI_STORE(2);
+    VNNI_STORE(3);
+    VNNI_STORE(4);
+    VNNI_STORE(5);
+    VNNI_STORE(6);
+    VNNI_STORE(7);
+    VNNI_STORE(8);
+    VNNI_STORE(9);
+    VNNI_STORE(10);
+    VNNI_STORE(11);
+}
@@ -0,0 +1,53 @@
+// x86_64 AVX-512 INT4 GEMV内核
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AVX512_TARGET __attribute__((target("avx512f,avx512bw,avx512vl,fma")))
+
+static inline int nibble_at(const uint8_t* w, size_t l) {
+    uint8_t v = w[l >> 1];
+    return (l & 1) ? (v & 0x0F) : (v >> 4);
+}
+
+// fp32激活：每次处理32个元素（16字节权重），组内累加后乘以该组scale
+AVX512_TARGET
+void qgemv_q4_f32_avx512(const uint8_t* w, size_t row_bytes, const void* x_ptr,
+                         int32_t x_zero_point, const float* scales, size_t scale_stride,
+                         size_t group_size, size_t k, float* y, size_t rows) {
+    const float* x = (const float*)x_ptr;
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    (void)x_zero_point;
+
+    for (size_t r = 0; r < rows; r++) {
+        const uint8_t* wr = w + r * row_bytes;
+        const float* sr = scales + r * scale_stride;
+        __m512 acc = _mm512_setzero_ps();
+        float tail = 0.0f;
+
+        for (size_t g0 = 0, gi = 0; g0 < k; g0 += group_size, gi++) {
+            size_t end = (k - g0 < group_size) ? k : g0 + group_size;
+            __m512 d0 = _mm512_setzero_ps(), d1 = _mm512_setzero_ps();
+            size_t l = g0;
+            for (; l + 32 <= end; l += 32) {
+                __m128i raw = _mm_loadu_si128((const __m128i*)(wr + (l >> 1)));
+                __m128i hi = _mm_and_si128(_mm_srli_epi16(raw, 4), mask);
+                __m128i lo = _mm_and_si128(raw, mask);
+                __m512 f0 = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_unpacklo_epi8(hi, lo)));
+                __m512 f1 = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_unpackhi_epi8(hi, lo)));
+                d0 = _mm512_fmadd_ps(f0, _mm512_loadu_ps(x + l), d0);
+                d1 = _mm512_fmadd_ps(f1, _mm512_loadu_ps(x + l + 16), d1);
+            }
+            float s = sr[gi];
+            acc = _mm512_fmadd_ps(_mm512_add_ps(d0, d1), _mm512_set1_ps(s), acc);
+
+            float t = 0.0f;
+            for (; l < end; l++) {
+                t += (float)nibble_at(wr, l) * x[l];
+            }
+            tail += s * t;
+        }
+
+        y[r] = _mm512_reduce_add_ps(acc) + tail;
+    }
+}
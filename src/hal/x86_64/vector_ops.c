@@ -0,0 +1,50 @@
+// x86_64 向量运算（SSE4.2 / AVX2 / AVX-512 版本）
+#include <immintrin.h>
+#include <stddef.h>
+
+__attribute__((target("sse4.2")))
+void vector_add_sse42(const float* a, const float* b, float* c, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m128 r0 = _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        __m128 r1 = _mm_add_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+        _mm_storeu_ps(c + i, r0);
+        _mm_storeu_ps(c + i + 4, r1);
+    }
+    for (; i < size; i++) {
+        c[i] = a[i] + b[i];
+    }
+}
+
+__attribute__((target("avx2")))
+void vector_add_avx2(const float* a, const float* b, float* c, size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m256 r0 = _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        __m256 r1 = _mm256_add_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        _mm256_storeu_ps(c + i, r0);
+        _mm256_storeu_ps(c + i + 8, r1);
+    }
+    for (; i < size; i++) {
+        c[i] = a[i] + b[i];
+    }
+}
+
+__attribute__((target("avx512f")))
+void vector_add_avx512(const float* a, const float* b, float* c, size_t size) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m512 r0 = _mm512_add_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+        __m512 r1 = _mm512_add_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16));
+        _mm512_storeu_ps(c + i, r0);
+        _mm512_storeu_ps(c + i + 16, r1);
+    }
+    // 尾部使用掩码加载/存储
+    while (i < size) {
+        size_t rem = size - i;
+        __mmask16 m = (rem >= 16) ? (__mmask16)0xFFFF : (__mmask16)((1u << rem) - 1);
+        __m512 r = _mm512_add_ps(_mm512_maskz_loadu_ps(m, a + i), _mm512_maskz_loadu_ps(m, b + i));
+        _mm512_mask_storeu_ps(c + i, m, r);
+        i += (rem >= 16) ? 16 : rem;
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef VMATH_AVX2_H
+#define VMATH_AVX2_H
+
+// x86_64 AVX2/FMA 向量超越函数（static inline，供各内核文件内联）
+// 误差为对区间内全部float逐一与双精度libm比较测得的最大ULP（AVX2与AVX-512结果相同）：
+//   exp256      [-87.33, 88.72]    1.3
+//   sigmoid256  [-87.33, 88.72]    3.2
+//   tanh256     [-20, 20]          1.4（区间外为±1）
+//   erf256      [-10, 10]          2.5
+//   erfc256     [0, 4]             18.3，[0, 10] 67（exp参数约为-x^2，其舍入误差随x^2放大）
+#include <immintrin.h>
+
+#define VMATH_AVX2_TARGET __attribute__((target("avx2,fma")))
+
+// exp(x)：n = round(x / ln2)，r = x - n * ln2（ln2拆为高低两部分），exp(r) 用Cephes多项式
+// x < ln(FLT_MIN) 时返回0（不产生非规格化数），x > ln(FLT_MAX) 时返回FLT_MAX附近的值
+VMATH_AVX2_TARGET
+static inline __m256 exp256(__m256 x) {
+    const __m256 lo = _mm256_set1_ps(-87.33654475f);
+    __m256 underflow = _mm256_cmp_ps(x, lo, _CMP_LT_OQ);
+    x = _mm256_max_ps(x, lo);
+    x = _mm256_min_ps(x, _mm256_set1_ps(88.72283905f));
+
+    __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                               _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+    r = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), r);
+
+    __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+    p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+
+    // n可能为128（x接近上界），拆成两次乘法避免指数溢出
+    __m256i e = _mm256_cvtps_epi32(n);
+    __m256i e1 = _mm256_srai_epi32(e, 1);
+    __m256 s1 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(e1, _mm256_set1_epi32(127)), 23));
+    __m256 s2 = _mm256_castsi256_ps(_mm256_slli_epi32(
+        _mm256_add_epi32(_mm256_sub_epi32(e, e1), _mm256_set1_epi32(127)), 23));
+    return _mm256_andnot_ps(underflow, _mm256_mul_ps(_mm256_mul_ps(p, s1), s2));
+}
+
+// 1 / (1 + exp(-x))
+VMATH_AVX2_TARGET
+static inline __m256 sigmoid256(__m256 x) {
+    __m256 one = _mm256_set1_ps(1.0f);
+    return _mm256_div_ps(one, _mm256_add_ps(one, exp256(_mm256_sub_ps(_mm256_setzero_ps(), x))));
+}
+
+// tanh(x)：|x| < 0.625 用奇次多项式（Cephes tanhf），否则 1 - t，t = 2 / (exp(2|x|) + 1)，再恢复符号
+// 返回导数 1 - tanh^2(x)（大参数时为 t * (2 - t)，饱和区不会相消），tanh(x) 写入y
+VMATH_AVX2_TARGET
+static inline __m256 tanh_deriv256(__m256 x, __m256* y) {
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    __m256 ax = _mm256_andnot_ps(sign_mask, x);
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 two = _mm256_set1_ps(2.0f);
+
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_set1_ps(-5.70498872745e-3f);
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(2.06390887954e-2f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(-5.37397155531e-2f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(1.33314422036e-1f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(-3.33332819422e-1f));
+    __m256 small = _mm256_fmadd_ps(_mm256_mul_ps(p, x2), x, x);
+
+    __m256 t = _mm256_div_ps(two, _mm256_add_ps(exp256(_mm256_add_ps(ax, ax)), one));
+    __m256 big = _mm256_or_ps(_mm256_sub_ps(one, t), _mm256_and_ps(x, sign_mask));
+
+    __m256 is_small = _mm256_cmp_ps(ax, _mm256_set1_ps(0.625f), _CMP_LT_OQ);
+    *y = _mm256_blendv_ps(big, small, is_small);
+    return _mm256_blendv_ps(_mm256_mul_ps(t, _mm256_sub_ps(two, t)),
+                            _mm256_fnmadd_ps(small, small, one), is_small);
+}
+
+VMATH_AVX2_TARGET
+static inline __m256 tanh256(__m256 x) {
+    __m256 y;
+    tanh_deriv256(x, &y);
+    return y;
+}
+
+// erfc(x)，x >= 0：Chebyshev拟合 erfc(x) = t * exp(-x^2 + P(t))，t = 1 / (1 + x / 2)
+VMATH_AVX2_TARGET
+static inline __m256 erfc256(__m256 x) {
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 t = _mm256_div_ps(one, _mm256_fmadd_ps(x, _mm256_set1_ps(0.5f), one));
+
+    __m256 p = _mm256_set1_ps(0.17087277f);
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(-0.82215223f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(1.48851587f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(-1.13520398f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(0.27886807f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(-0.18628806f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(0.09678418f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(0.37409196f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(1.00002368f));
+    p = _mm256_fmadd_ps(p, t, _mm256_set1_ps(-1.26551223f));
+    return _mm256_mul_ps(t, exp256(_mm256_fnmadd_ps(x, x, p)));
+}
+
+// erf(x)：|x| < 1 用奇次多项式（Cephes erff），否则 1 - erfc(|x|)，再恢复符号
+VMATH_AVX2_TARGET
+static inline __m256 erf256(__m256 x) {
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    __m256 ax = _mm256_andnot_ps(sign_mask, x);
+
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_set1_ps(7.853861353153693e-5f);
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(-8.010193625184903e-4f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(5.188327685732524e-3f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(-2.685381193529856e-2f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(1.128358514861418e-1f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(-3.761262582423300e-1f));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(1.128379165726710e+0f));
+    __m256 small = _mm256_mul_ps(p, x);
+
+    __m256 big = _mm256_sub_ps(_mm256_set1_ps(1.0f), erfc256(ax));
+    big = _mm256_or_ps(big, _mm256_and_ps(x, sign_mask));
+
+    return _mm256_blendv_ps(big, small, _mm256_cmp_ps(ax, _mm256_set1_ps(1.0f), _CMP_LT_OQ));
+}
+
+#endif // VMATH_AVX2_H
@@ -0,0 +1,119 @@
+#ifndef VMATH_AVX512_H
+#define VMATH_AVX512_H
+
+// x86_64 AVX-512 向量超越函数（static inline，供各内核文件内联），算法与vmath_avx2.h相同
+// 误差为对区间内全部float逐一与双精度libm比较测得的最大ULP（AVX2与AVX-512结果相同）：
+//   exp512      [-87.33, 88.72]    1.3
+//   sigmoid512  [-87.33, 88.72]    3.2
+//   tanh512     [-20, 20]          1.4（区间外为±1）
+//   erf512      [-10, 10]          2.5
+//   erfc512     [0, 4]             18.3，[0, 10] 67（exp参数约为-x^2，其舍入误差随x^2放大）
+#include <immintrin.h>
+
+#define VMATH_AVX512_TARGET __attribute__((target("avx512f,fma")))
+
+// exp(x)：n = round(x / ln2)，r = x - n * ln2（ln2拆为高低两部分），exp(r) 用Cephes多项式
+// 2^n 由scalef完成，溢出/下溢时自动得到inf/非规格化数/0
+VMATH_AVX512_TARGET
+static inline __m512 exp512(__m512 x) {
+    x = _mm512_max_ps(x, _mm512_set1_ps(-104.0f));
+    x = _mm512_min_ps(x, _mm512_set1_ps(88.72283905f));
+
+    __m512 n = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(1.44269504088896341f)),
+                                    _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(0.693359375f), x);
+    r = _mm512_fnmadd_ps(n, _mm512_set1_ps(-2.12194440e-4f), r);
+
+    __m512 p = _mm512_set1_ps(1.9875691500e-4f);
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.3981999507e-3f));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(8.3334519073e-3f));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(4.1665795894e-2f));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.6666665459e-1f));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(5.0000001201e-1f));
+    p = _mm512_fmadd_ps(p, _mm512_mul_ps(r, r), _mm512_add_ps(r, _mm512_set1_ps(1.0f)));
+    return _mm512_scalef_ps(p, n);
+}
+
+// 1 / (1 + exp(-x))
+VMATH_AVX512_TARGET
+static inline __m512 sigmoid512(__m512 x) {
+    __m512 one = _mm512_set1_ps(1.0f);
+    return _mm512_div_ps(one, _mm512_add_ps(one, exp512(_mm512_sub_ps(_mm512_setzero_ps(), x))));
+}
+
+// tanh(x)：|x| < 0.625 用奇次多项式（Cephes tanhf），否则 1 - t，t = 2 / (exp(2|x|) + 1)，再恢复符号
+// 返回导数 1 - tanh^2(x)（大参数时为 t * (2 - t)，饱和区不会相消），tanh(x) 写入y
+VMATH_AVX512_TARGET
+static inline __m512 tanh_deriv512(__m512 x, __m512* y) {
+    __m512 ax = _mm512_abs_ps(x);
+    __m512i sign = _mm512_and_si512(_mm512_castps_si512(x), _mm512_set1_epi32((int)0x80000000));
+    __m512 one = _mm512_set1_ps(1.0f);
+    __m512 two = _mm512_set1_ps(2.0f);
+
+    __m512 x2 = _mm512_mul_ps(x, x);
+    __m512 p = _mm512_set1_ps(-5.70498872745e-3f);
+    p = _mm512_fmadd_ps(p, x2, _mm512_set1_ps(2.06390887954e-2f));
+    p = _mm512_fmadd_ps(p, x2, _mm512_set1_ps(-5.37397155531e-2f));
+    p = _mm512_fmadd_ps(p, x2, _mm512_set1_ps(1.33314422036e-1f));
+    p = _mm512_fmadd_ps(p, x2, _mm512_set1_ps(-3.33332819422e-1f));
+    __m512 small = _mm512_fmadd_ps(_mm512_mul_ps(p, x2), x, x);
+
+    __m512 t = _mm512_div_ps(two, _mm512_add_ps(exp512(_mm512_add_ps(ax, ax)), one));
+    __m512 big = _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(_mm512_sub_ps(one, t)), sign));
+
+    __mmask16 is_small = _mm512_cmp_ps_mask(ax, _mm512_set1_ps(0.625f), _CMP_LT_OQ);
+    *y = _mm512_mask_mov_ps(big, is_small, small);
+    return _mm512_mask_mov_ps(_mm512_mul_ps(t, _mm512_sub_ps(two, t)), is_small,
+                              _mm512_fnmadd_ps(small, small, one));
+}
+
+VMATH_AVX512_TARGET
+static inline __m512 tanh512(__m512 x) {
+    __m512 y;
+    tanh_deriv512(x, &y);
+    return y;
+}
+
+// erfc(x)，x >= 0：Chebyshev拟合 erfc(x) = t * exp(-x^2 + P(t))，t = 1 / (1 + x / 2)
+VMATH_AVX512_TARGET
+static inline __m512 erfc512(__m512 x) {
+    __m512 one = _mm512_set1_ps(1.0f);
+    __m512 t = _mm512_div_ps(one, _mm512_fmadd_ps(x, _mm512_set1_ps(0.5f), one));
+
+    __m512 p = _mm512_set1_ps(0.17087277f);
+    p = _mm512_fmadd_ps(p, t, _mm512_set1_ps(-0.82215223f));
+    p = _mm512_fmadd_ps(p, t, _mm512_set1_ps(1.48851587f));
+    p = _mm512_fmadd_ps(p, t, _mm512_set1_ps(-1.13520398f));
+    p = _mm512_fmadd_ps(p, t, _mm512_set1_ps(0.27886807f));
+    p = _mm512_fmadd_ps(p, t, _mm512_set1_ps(-0.18628806f));
+    p = _mm512_fmadd_ps(p, t, _mm512_set1_ps(0.09678418f));
+    p = _mm512_fmadd_ps(p, t, _mm512_set1_ps(0.37409196f));
+    p = _mm512_fmadd_ps(p, t, _mm512_set1_ps(1.00002368f));
+    p = _mm512_fmadd_ps(p, t, _mm512_set1_ps(-1.26551223f));
+    return _mm512_mul_ps(t, exp512(_mm512_fnmadd_ps(x, x, p)));
+}
+
+// erf(x)：|x| < 1 用奇次多项式（Cephes erff），否则 1 - erfc(|x|)，再恢复符号
+VMATH_AVX512_TARGET
+static inline __m512 erf512(__m512 x) {
+    __m512 ax = _mm512_abs_ps(x);
+    __m512i sign = _mm512_and_si512(_mm512_castps_si512(x), _mm512_set1_epi32((int)0x80000000));
+
+    __m512 x2 = _mm512_mul_ps(x, x);
+    __m512 p = _mm512_set1_ps(7.853861353153693e-5f);
+    p = _mm512_fmadd_ps(p, x2, _mm512_set1_ps(-8.010193625184903e-4f));
+    p = _mm512_fmadd_ps(p, x2, _mm512_set1_ps(5.188327685732524e-3f));
+    p = _mm512_fmadd_ps(p, x2, _mm512_set1_ps(-2.685381193529856e-2f));
+    p = _mm512_fmadd_ps(p, x2, _mm512_set1_ps(1.128358514861418e-1f));
+    p = _mm512_fmadd_ps(p, x2, _mm512_set1_ps(-3.761262582423300e-1f));
+    p = _mm512_fmadd_ps(p, x2, _mm512_set1_ps(1.128379165726710e+0f));
+    __m512 small = _mm512_mul_ps(p, x);
+
+    __m512 big = _mm512_sub_ps(_mm512_set1_ps(1.0f), erfc512(ax));
+    big = _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(big), sign));
+
+    __mmask16 is_small = _mm512_cmp_ps_mask(ax, _mm512_set1_ps(1.0f), _CMP_LT_OQ);
+    return _mm512_mask_mov_ps(big, is_small, small);
+}
+
+#endif // VMATH_AVX512_H
@@ -412,8 +412,11 @@ int hf_model_load_local(HFModel** model, const char* path, void* device) {
         
         fclose(fp);
         
-        // 分配设备内存并上传权重
-        void* device_mem = ((HAL_Device*)device)->allocate_memory(fsize);
+        // 分配设备内存并上传权重（权重常驻，优先使用大页）
+        HAL_Device* hal_device = (HAL_Device*)device;
+        void* device_mem = hal_device->allocate_memory_flags
+            ? hal_device->allocate_memory_flags(fsize, HAL_ALLOC_HUGEPAGE)
+            : hal_device->allocate_memory(fsize);
         if (!device_mem) {
             free(temp);
             hf_model_free(*model);
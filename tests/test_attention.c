@@ -0,0 +1,180 @@
+// 融合注意力对照显式的分数矩阵+softmax：因果/非因果屏蔽、无效位置、
+// 分段K/V以及直接读取KV缓存的kv_cache_attention
+
+#include "test_common.h"
+#include "attention.h"
+#include "kv_cache.h"
+#include <string.h>
+
+// q/out: [nq][heads][dim]，k/v: [kv_len][heads][dim]
+static void ref_attention(const float* q, const float* k, const float* v,
+                          const size_t* kv_pos, size_t kv_len,
+                          const size_t* q_pos, size_t nq,
+                          size_t heads, size_t dim, int causal, float scale, float* out) {
+    if (scale == 0.0f) scale = 1.0f / sqrtf((float)dim);
+    size_t row = heads * dim;
+    double* scores = malloc((kv_len ? kv_len : 1) * sizeof(double));
+    for (size_t i = 0; i < nq; i++) {
+        size_t qp = q_pos ? q_pos[i] : kv_len - nq + i;
+        for (size_t h = 0; h < heads; h++) {
+            const float* qi = q + i * row + h * dim;
+            float* oi = out + i * row + h * dim;
+            double max = -INFINITY;
+            for (size_t j = 0; j < kv_len; j++) {
+                size_t kp = kv_pos ? kv_pos[j] : j;
+                if (kp == ATTENTION_INVALID_POSITION || (causal && kp > qp)) {
+                    scores[j] = -INFINITY;
+                    continue;
+                }
+                double s = 0.0;
+                for (size_t d = 0; d < dim; d++) s += (double)qi[d] * k[j * row + h * dim + d];
+                scores[j] = s * scale;
+                if (scores[j] > max) max = scores[j];
+            }
+            memset(oi, 0, dim * sizeof(float));
+            if (max == -INFINITY) continue;
+            double sum = 0.0;
+            for (size_t j = 0; j < kv_len; j++) {
+                scores[j] = scores[j] == -INFINITY ? 0.0 : exp(scores[j] - max);
+                sum += scores[j];
+            }
+            for (size_t d = 0; d < dim; d++) {
+                double acc = 0.0;
+                for (size_t j = 0; j < kv_len; j++) acc += scores[j] * v[j * row + h * dim + d];
+                oi[d] = (float)(acc / sum);
+            }
+        }
+    }
+    free(scores);
+}
+
+static void test_forward(HAL_Device* dev, size_t heads, size_t dim, size_t kv_len, size_t nq,
+                         int causal, int with_positions) {
+    size_t row = heads * dim;
+    float* q = malloc(nq * row * sizeof(float));
+    float* k = malloc(kv_len * row * sizeof(float));
+    float* v = malloc(kv_len * row * sizeof(float));
+    float* out = malloc(nq * row * sizeof(float));
+    float* ref = malloc(nq * row * sizeof(float));
+    size_t* kv_pos = malloc(kv_len * sizeof(size_t));
+    size_t* q_pos = malloc(nq * sizeof(size_t));
+    test_fill(q, nq * row);
+    test_fill(k, kv_len * row);
+    test_fill(v, kv_len * row);
+    // 位置不连续，每7行有一行被压缩掉；查询位置分散在KV范围内（部分查询看不到任何键）
+    for (size_t j = 0; j < kv_len; j++) kv_pos[j] = (j % 7 == 3) ? ATTENTION_INVALID_POSITION : 2 * j + 1;
+    for (size_t i = 0; i < nq; i++) q_pos[i] = (i * 2 * kv_len) / nq;
+
+    AttentionParams params = {
+        .num_heads = heads,
+        .head_dim = dim,
+        .causal = causal,
+        .kv_precision = KV_CACHE_FP32
+    };
+    const size_t* kp = with_positions ? kv_pos : NULL;
+    const size_t* qp = with_positions ? q_pos : NULL;
+    CHECK(dev->attention(&params, q, k, v, kp, kv_len, qp, nq, out) == 0);
+    ref_attention(q, k, v, kp, kv_len, qp, nq, heads, dim, causal, 0.0f, ref);
+    char what[96];
+    snprintf(what, sizeof(what), "attention heads=%zu dim=%zu kv=%zu q=%zu causal=%d pos=%d",
+             heads, dim, kv_len, nq, causal, with_positions);
+    test_compare(what, out, ref, nq * row, 1e-5f, 1e-4f);
+
+    // 同样的K/V切成长度不等的若干段
+    AttentionKVSpan spans[4];
+    size_t cuts[5] = {0, kv_len / 5, kv_len / 2, kv_len / 2 + 1, kv_len};
+    for (size_t s = 0; s < 4; s++) {
+        spans[s].k = k + cuts[s] * row;
+        spans[s].v = v + cuts[s] * row;
+        spans[s].positions = kp ? kp + cuts[s] : NULL;
+        spans[s].len = cuts[s + 1] - cuts[s];
+    }
+    memset(out, 0, nq * row * sizeof(float));
+    CHECK(dev->attention_spans(&params, q, spans, 4, qp, nq, out) == 0);
+    snprintf(what, sizeof(what), "attention_spans heads=%zu dim=%zu kv=%zu causal=%d pos=%d",
+             heads, dim, kv_len, causal, with_positions);
+    test_compare(what, out, ref, nq * row, 1e-5f, 1e-4f);
+
+    free(q);
+    free(k);
+    free(v);
+    free(out);
+    free(ref);
+    free(kv_pos);
+    free(q_pos);
+}
+
+// 在KV缓存上逐个追加令牌，kv_cache_attention对照缓存内容（量化模式为反量化后的K/V）的参考结果
+static void test_kv_cache_attention(HAL_Device* dev, KVCachePrecision precision, size_t block_size) {
+    const size_t heads = 4, dim = 32, len = 150, nq = 3;
+    size_t row = heads * dim;
+    KVCacheConfig config = {
+        .max_seq_length = 256,
+        .num_layers = 2,
+        .num_heads = heads,
+        .head_dim = dim,
+        .block_size = block_size,
+        .precision = precision
+    };
+    KVCacheManager* cache = NULL;
+    CHECK(kv_cache_init(&cache, &config, dev) == 0);
+    if (!cache) return;
+
+    float* k = malloc(len * row * sizeof(float));
+    float* v = malloc(len * row * sizeof(float));
+    float* q = malloc(nq * row * sizeof(float));
+    float* out = malloc(nq * row * sizeof(float));
+    float* ref = malloc(nq * row * sizeof(float));
+    test_fill(k, len * row);
+    test_fill(v, len * row);
+    test_fill(q, nq * row);
+    for (size_t j = 0; j < len; j++) {
+        CHECK(kv_cache_append(cache, 1, k + j * row, v + j * row, j) == 0);
+    }
+    // 注意力内核逐块反量化，参考结果使用缓存中实际存储的值
+    size_t* rows = malloc(len * sizeof(size_t));
+    for (size_t j = 0; j < len; j++) rows[j] = j;
+    CHECK(kv_cache_lookup(cache, 1, k, v, rows, len) == 0);
+    free(rows);
+    char what[64];
+
+    // 最后nq个令牌的查询（解码/分块预填充）
+    CHECK(kv_cache_attention(cache, 1, q, NULL, nq, 1, 0.0f, out) == 0);
+    ref_attention(q, k, v, NULL, len, NULL, nq, heads, dim, 1, 0.0f, ref);
+    snprintf(what, sizeof(what), "kv_cache_attention precision=%d block=%zu", (int)precision, block_size);
+    test_compare(what, out, ref, nq * row, 1e-5f, 1e-4f);
+
+    // 显式的查询位置和缩放
+    size_t q_pos[3] = {0, 77, 149};
+    CHECK(kv_cache_attention(cache, 1, q, q_pos, nq, 1, 0.25f, out) == 0);
+    ref_attention(q, k, v, NULL, len, q_pos, nq, heads, dim, 1, 0.25f, ref);
+    snprintf(what, sizeof(what), "kv_cache_attention q_positions precision=%d", (int)precision);
+    test_compare(what, out, ref, nq * row, 1e-5f, 1e-4f);
+
+    free(k);
+    free(v);
+    free(q);
+    free(out);
+    free(ref);
+    kv_cache_cleanup(cache);
+}
+
+int main(void) {
+    HAL_Device* dev = test_init_device();
+    if (!dev) return 1;
+
+    // head_dim覆盖向量宽度的尾部，kv_len跨越多个ATTENTION_TILE
+    test_forward(dev, 1, 8, 1, 1, 1, 0);
+    test_forward(dev, 2, 64, 100, 1, 1, 0);
+    test_forward(dev, 3, 40, 200, 9, 1, 0);
+    test_forward(dev, 4, 128, 130, 130, 1, 0);
+    test_forward(dev, 2, 17, 150, 6, 0, 0);
+    test_forward(dev, 2, 64, 190, 11, 1, 1);
+    test_forward(dev, 3, 33, 90, 5, 0, 1);
+    test_kv_cache_attention(dev, KV_CACHE_FP32, 0);
+    test_kv_cache_attention(dev, KV_CACHE_FP32, 16);
+    test_kv_cache_attention(dev, KV_CACHE_INT8, 0);
+    test_kv_cache_attention(dev, KV_CACHE_FP8, 16);
+
+    return test_finish("test_attention");
+}
@@ -0,0 +1,82 @@
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+// 测试公用工具：每个测试程序对照朴素的参考实现检查HAL内核，失败时返回非0
+// 由ctest在各指令集层级（LOWMEM_CPU_TIER）下分别运行
+
+#include "hal.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int g_test_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: 检查失败: %s\n", __FILE__, __LINE__, #cond); \
+        g_test_failures++; \
+    } \
+} while (0)
+
+// 可复现的伪随机数（xorshift32），不依赖rand的实现
+static uint32_t g_test_rng = 0x9e3779b9u;
+
+static inline uint32_t test_rand_u32(void) {
+    uint32_t x = g_test_rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    g_test_rng = x;
+    return x;
+}
+
+// [-1, 1) 的均匀分布
+static inline float test_rand_float(void) {
+    return (float)(test_rand_u32() >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+static inline void test_fill(float* data, size_t count) {
+    for (size_t i = 0; i < count; i++) data[i] = test_rand_float();
+}
+
+// 逐元素比较，|got - want| <= atol + rtol * |want|，只报告第一个不一致的元素
+static inline int test_compare(const char* what, const float* got, const float* want,
+                               size_t count, float atol, float rtol) {
+    for (size_t i = 0; i < count; i++) {
+        float diff = fabsf(got[i] - want[i]);
+        if (!(diff <= atol + rtol * fabsf(want[i]))) {
+            fprintf(stderr, "%s: 第%zu个元素 %g，期望 %g\n", what, i, got[i], want[i]);
+            g_test_failures++;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 初始化HAL并返回CPU设备，失败时返回NULL
+static inline HAL_Device* test_init_device(void) {
+    if (hal_init() != 0) {
+        fprintf(stderr, "HAL初始化失败\n");
+        return NULL;
+    }
+    HAL_Device* dev = hal_select_optimal_device();
+    if (!dev || dev->device_type != DEVICE_TYPE_CPU) {
+        fprintf(stderr, "没有可用的CPU设备\n");
+        hal_cleanup();
+        return NULL;
+    }
+    return dev;
+}
+
+static inline int test_finish(const char* name) {
+    hal_cleanup();
+    if (g_test_failures) {
+        fprintf(stderr, "%s: %d项检查失败\n", name, g_test_failures);
+        return 1;
+    }
+    printf("%s: 通过\n", name);
+    return 0;
+}
+
+#endif // TEST_COMMON_H
@@ -0,0 +1,226 @@
+// 设备管理器的代价模型：从校准缓存载入已知的设备能力，predict_time对照roofline公式，
+// 非统一内存时计入搬运开销、设备内存不足时拒绝，按预测耗时选择设备，实测校准写回缓存，
+// 以及未设置校准文件时不读写缓存。HOME和校准文件指向临时目录，不读写用户的 ~/.cache
+
+#include "test_common.h"
+#include "device_manager.h"
+#include "cpu_features.h"
+#include <string.h>
+#include <unistd.h>
+
+static char g_dir[] = "/tmp/lowmem_devices_XXXXXX";
+static char g_cal_path[256];
+
+// 与device_manager相同的CPU缓存键：类型、型号、指令集层级和核心数，空白替换为下划线
+static void cpu_key(const HAL_Device* dev, char* buf, size_t size) {
+    const CpuInfo* info = cpu_features_get();
+    snprintf(buf, size, "cpu:%s:%s:%u", info->brand, cpu_tier_name(info->tier),
+             dev->capabilities.compute_units);
+    for (char* p = buf; *p; p++) {
+        if (*p == ' ' || *p == '\t') *p = '_';
+    }
+}
+
+static void write_calibration(const HAL_Device* dev, const DeviceCalibration* cal) {
+    char key[128];
+    cpu_key(dev, key, sizeof(key));
+    FILE* fp = fopen(g_cal_path, "w");
+    CHECK(fp != NULL);
+    if (!fp) return;
+    fprintf(fp, "# LowMemoryLLM device calibration v1\n");
+    fprintf(fp, "other:1:2 1 1 1 1 1 1\n");
+    fprintf(fp, "%s %.3f %.3f %.3f %.3f %.3f %d\n", key, cal->gemm_gflops, cal->memory_gbps,
+            cal->transfer_gbps, cal->transfer_latency_us, cal->launch_latency_us,
+            cal->unified_memory);
+    fclose(fp);
+}
+
+static int close_to(double got, double want) {
+    return fabs(got - want) <= 1e-9 * fabs(want) + 1e-15;
+}
+
+static double ref_predict(const DeviceCalibration* cal, const DeviceTask* task) {
+    double compute = task->flops / (cal->gemm_gflops * 1e9);
+    double memory = task->device_bytes / (cal->memory_gbps * 1e9);
+    double t = cal->launch_latency_us * 1e-6 + (compute > memory ? compute : memory);
+    if (!cal->unified_memory) {
+        t += cal->transfer_latency_us * 1e-6 + task->transfer_bytes / (cal->transfer_gbps * 1e9);
+    }
+    return t;
+}
+
+static void test_task_costs(void) {
+    DeviceTask t = device_task_matmul(10, 20, 30);
+    CHECK(t.flops == 2.0 * 10 * 20 * 30);
+    CHECK(t.device_bytes == 4.0 * (10 * 30 + 30 * 20 + 10 * 20));
+    CHECK(t.transfer_bytes == t.device_bytes);
+    CHECK(t.memory_requirement == (size_t)t.device_bytes);
+
+    t = device_task_vector_add(1000);
+    CHECK(t.flops == 1000.0);
+    CHECK(t.device_bytes == 12000.0);
+    CHECK(t.memory_requirement == 12000);
+}
+
+// 载入缓存中的能力值后，预测耗时与公式一致：小任务受调用开销和带宽限制，大GEMM受计算限制
+static void test_predict(const DeviceCalibration* cal) {
+    HAL_Device* dev = device_manager_get_current_device();
+    CHECK(dev != NULL && dev->device_type == DEVICE_TYPE_CPU);
+    if (!dev) return;
+
+    const DeviceCalibration* got = device_manager_get_calibration(dev);
+    CHECK(got != NULL);
+    if (!got) return;
+    CHECK(close_to(got->gemm_gflops, cal->gemm_gflops));
+    CHECK(close_to(got->memory_gbps, cal->memory_gbps));
+    CHECK(close_to(got->launch_latency_us, cal->launch_latency_us));
+    CHECK(got->unified_memory == cal->unified_memory);
+
+    const DeviceTask tasks[4] = {
+        device_task_matmul(4096, 4096, 4096),
+        device_task_matmul(1, 4096, 4096),
+        device_task_vector_add(16),
+        device_task_vector_add((size_t)1 << 24),
+    };
+    for (int i = 0; i < 4; i++) {
+        double t = device_manager_predict_time(dev, &tasks[i]);
+        double want = ref_predict(cal, &tasks[i]);
+        if (!close_to(t, want)) {
+            fprintf(stderr, "predict_time 任务%d: %g，期望 %g\n", i, t, want);
+            g_test_failures++;
+        }
+    }
+    // 大GEMM受计算限制，GEMV受带宽限制
+    CHECK(tasks[0].flops / (cal->gemm_gflops * 1e9) > tasks[0].device_bytes / (cal->memory_gbps * 1e9));
+    CHECK(tasks[1].flops / (cal->gemm_gflops * 1e9) < tasks[1].device_bytes / (cal->memory_gbps * 1e9));
+
+    CHECK(device_manager_predict_time(NULL, &tasks[0]) < 0);
+    CHECK(device_manager_predict_time(dev, NULL) < 0);
+
+    // 不在列表中的设备没有校准结果
+    HAL_Device other = *dev;
+    CHECK(device_manager_get_calibration(&other) == NULL);
+    CHECK(device_manager_predict_time(&other, &tasks[0]) < 0);
+}
+
+static void test_select(const DeviceCalibration* cal) {
+    HAL_Device* dev = device_manager_get_current_device();
+    if (!dev) return;
+
+    DeviceTask task = device_task_matmul(512, 512, 512);
+    double predicted = 0;
+    CHECK(device_manager_select_for_task(&task, &predicted) == dev);
+    CHECK(close_to(predicted, ref_predict(cal, &task)));
+    CHECK(device_manager_select_for_task(NULL, &predicted) == NULL);
+    CHECK(device_manager_select_device("matrix_multiply", (size_t)12 << 20) == dev);
+    CHECK(device_manager_select_device("vector_add", 1200) == dev);
+    CHECK(device_manager_select_device("unknown", 4096) == dev);
+    CHECK(device_manager_select_device(NULL, 4096) == NULL);
+
+    // 设备内存不足时不可选
+    size_t memory_size = dev->capabilities.memory_size;
+    dev->capabilities.memory_size = task.memory_requirement - 1;
+    CHECK(device_manager_predict_time(dev, &task) < 0);
+    CHECK(device_manager_select_for_task(&task, &predicted) == NULL);
+    CHECK(predicted < 0);
+    dev->capabilities.memory_size = memory_size;
+
+    CHECK(device_manager_switch_device(dev) == 0);
+    HAL_Device other = *dev;
+    CHECK(device_manager_switch_device(&other) == -1);
+    CHECK(device_manager_get_current_device() == dev);
+}
+
+// 非统一内存的设备：数据搬运计入预测耗时
+static void test_transfer_cost(void) {
+    HAL_Device* dev = device_manager_get_current_device();
+    if (!dev) return;
+    DeviceCalibration cal = {
+        .gemm_gflops = 500.0,
+        .memory_gbps = 400.0,
+        .transfer_gbps = 10.0,
+        .transfer_latency_us = 8.0,
+        .launch_latency_us = 5.0,
+        .unified_memory = 0
+    };
+    write_calibration(dev, &cal);
+    CHECK(device_manager_calibrate(0) == 0);
+
+    DeviceTask task = device_task_vector_add((size_t)1 << 20);
+    double t = device_manager_predict_time(dev, &task);
+    CHECK(close_to(t, ref_predict(&cal, &task)));
+    // 搬运占主要部分
+    CHECK(t > task.transfer_bytes / (cal.transfer_gbps * 1e9));
+}
+
+// 强制实测：结果为正并按本机的键写回缓存，其他设备的条目保留
+static void test_measure(void) {
+    HAL_Device* dev = device_manager_get_current_device();
+    if (!dev) return;
+    CHECK(device_manager_calibrate(1) == 0);
+    const DeviceCalibration* cal = device_manager_get_calibration(dev);
+    CHECK(cal && cal->gemm_gflops > 0 && cal->memory_gbps > 0 && cal->transfer_gbps > 0);
+    CHECK(cal && cal->unified_memory == 1);
+
+    char key[128];
+    cpu_key(dev, key, sizeof(key));
+    FILE* fp = fopen(g_cal_path, "r");
+    CHECK(fp != NULL);
+    if (!fp) return;
+    char line[512];
+    int found_key = 0, found_other = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, key, strlen(key)) == 0 && line[strlen(key)] == ' ') found_key = 1;
+        if (strncmp(line, "other:1:2 ", 10) == 0) found_other = 1;
+    }
+    fclose(fp);
+    CHECK(found_key);
+    CHECK(found_other);
+
+    // 缓存需显式开启：未设置时实测但不写默认路径
+    char default_path[512];
+    snprintf(default_path, sizeof(default_path), "%s/.cache/lowmemory_llm/devices.cal", g_dir);
+    unsetenv(DEVICE_CALIBRATION_ENV);
+    CHECK(device_manager_calibrate(0) == 0);
+    CHECK(device_manager_get_calibration(dev) != NULL);
+    CHECK(access(default_path, F_OK) != 0);
+    setenv(DEVICE_CALIBRATION_ENV, g_cal_path, 1);
+}
+
+int main(void) {
+    if (!mkdtemp(g_dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    setenv("HOME", g_dir, 1);
+    unsetenv("XDG_CACHE_HOME");
+    snprintf(g_cal_path, sizeof(g_cal_path), "%s/devices.cal", g_dir);
+    setenv(DEVICE_CALIBRATION_ENV, g_cal_path, 1);
+
+    // 先初始化HAL取得缓存键用到的核心数，再写入已知的能力值
+    HAL_Device* dev = test_init_device();
+    if (!dev) return 1;
+    const DeviceCalibration cal = {
+        .gemm_gflops = 100.0,
+        .memory_gbps = 20.0,
+        .transfer_gbps = 20.0,
+        .transfer_latency_us = 0.0,
+        .launch_latency_us = 2.5,
+        .unified_memory = 1
+    };
+    write_calibration(dev, &cal);
+
+    CHECK(device_manager_init() == 0);
+    test_task_costs();
+    test_predict(&cal);
+    test_select(&cal);
+    test_transfer_cost();
+    // 标量层级下校准用的1024阶GEMM耗时过长，只在向量层级实测
+    if (cpu_features_tier() != CPU_TIER_SCALAR) test_measure();
+    device_manager_cleanup();
+
+    int ret = test_finish("test_device_manager");
+    unlink(g_cal_path);
+    rmdir(g_dir);
+    return ret;
+}
@@ -0,0 +1,183 @@
+// fp16转换对照独立的参考实现：全部65536个半精度值的float_to_fp16/fp16_to_float往返，
+// 相邻半精度值之间的舍入中点（就近舍入到偶数）、溢出和次正规数，
+// 以及批量转换（F16C）与标量转换逐位一致
+
+#include "test_common.h"
+#include "fp16.h"
+#include <float.h>
+#include <string.h>
+
+#define FP16_POS_INF 0x7C00
+
+static uint32_t float_bits(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static float bits_float(uint32_t bits) {
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static int half_is_nan(uint16_t h) {
+    return (h & 0x7C00) == 0x7C00 && (h & 0x3FF) != 0;
+}
+
+// 有限半精度值的精确值；正无穷按2^16参与舍入（即65504之后的下一个步长）
+static double ref_half_value(uint16_t h) {
+    uint32_t exp = (h >> 10) & 0x1F;
+    uint32_t mant = h & 0x3FF;
+    double v = exp ? ldexp((double)(mant | 0x400), (int)exp - 25) : ldexp((double)mant, -24);
+    return (h & 0x8000) ? -v : v;
+}
+
+// 非NaN的float就近舍入到偶数：在单调的正半精度值 [0, 0x7C00] 上二分查找
+static uint16_t ref_float_to_half(float f) {
+    uint16_t sign = (float_bits(f) >> 16) & 0x8000;
+    double a = fabs((double)f);
+    if (a >= 65536.0) return sign | FP16_POS_INF;
+    uint16_t lo = 0, hi = FP16_POS_INF;
+    while (hi - lo > 1) {
+        uint16_t mid = (uint16_t)((lo + hi) / 2);
+        if (ref_half_value(mid) <= a) lo = mid;
+        else hi = mid;
+    }
+    double d_lo = a - ref_half_value(lo);
+    double d_hi = ref_half_value(hi) - a;
+    uint16_t h = (d_lo < d_hi || (d_lo == d_hi && !(lo & 1))) ? lo : hi;
+    return sign | h;
+}
+
+static void check_to_half(float f) {
+    uint16_t got = float_to_fp16(f);
+    uint16_t want = ref_float_to_half(f);
+    if (got != want) {
+        fprintf(stderr, "float_to_fp16(%a): 0x%04x，期望 0x%04x\n", f, got, want);
+        g_test_failures++;
+    }
+}
+
+// 全部半精度值：转为float的值精确，非NaN的值往返不变
+static void test_every_half(void) {
+    const size_t count = 65536;
+    uint16_t* h = malloc(count * sizeof(uint16_t));
+    float* f = malloc(count * sizeof(float));
+    for (size_t i = 0; i < count; i++) h[i] = (uint16_t)i;
+
+    int failures = g_test_failures;
+    for (size_t i = 0; i < count && g_test_failures - failures < 8; i++) {
+        float v = fp16_to_float(h[i]);
+        if (half_is_nan(h[i])) {
+            // 静默NaN，保留符号和尾数
+            uint32_t bits = float_bits(v);
+            uint32_t want = ((uint32_t)(h[i] & 0x8000) << 16) | 0x7FC00000 | ((uint32_t)(h[i] & 0x3FF) << 13);
+            if (bits != want) {
+                fprintf(stderr, "fp16_to_float(0x%04zx): 0x%08x，期望 0x%08x\n", i, bits, want);
+                g_test_failures++;
+            }
+            continue;
+        }
+        double want = (h[i] & 0x7FFF) == FP16_POS_INF ? ((h[i] & 0x8000) ? -INFINITY : INFINITY)
+                                                        : ref_half_value(h[i]);
+        if ((double)v != want || !signbit(v) != !signbit(want)) {
+            fprintf(stderr, "fp16_to_float(0x%04zx): %a，期望 %a\n", i, v, want);
+            g_test_failures++;
+        }
+        uint16_t back = float_to_fp16(v);
+        if (back != h[i]) {
+            fprintf(stderr, "float_to_fp16(fp16_to_float(0x%04zx)): 0x%04x\n", i, back);
+            g_test_failures++;
+        }
+    }
+
+    // 批量转换（F16C可用时为vcvtph2ps）与标量逐位一致，包括NaN
+    fp16_to_float_array(f, h, count);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t got = float_bits(f[i]);
+        uint32_t want = float_bits(fp16_to_float(h[i]));
+        if (got != want) {
+            fprintf(stderr, "fp16_to_float_array(0x%04zx): 0x%08x，期望 0x%08x\n", i, got, want);
+            g_test_failures++;
+            break;
+        }
+    }
+
+    free(h);
+    free(f);
+}
+
+// 相邻半精度值的中点及其两侧最近的float：覆盖就近舍入到偶数、次正规数边界和溢出
+static void test_rounding_boundaries(void) {
+    int failures = g_test_failures;
+    for (uint32_t h = 0; h < FP16_POS_INF && g_test_failures - failures < 8; h++) {
+        // 两个半精度值的中点只需12位有效数字，在float中精确
+        float mid = (float)((ref_half_value((uint16_t)h) + ref_half_value((uint16_t)(h + 1))) / 2.0);
+        float probes[3] = { mid, nextafterf(mid, 0.0f), nextafterf(mid, INFINITY) };
+        for (int p = 0; p < 3; p++) {
+            check_to_half(probes[p]);
+            check_to_half(-probes[p]);
+        }
+    }
+    // 次正规数以下：2^-25 恰为0与最小次正规数的中点
+    check_to_half(ldexpf(1.0f, -25));
+    check_to_half(ldexpf(1.0f, -26));
+    check_to_half(nextafterf(ldexpf(1.0f, -25), 1.0f));
+    check_to_half(FLT_MIN);
+    check_to_half(INFINITY);
+    check_to_half(-INFINITY);
+    check_to_half(FLT_MAX);
+}
+
+// 随机的float位模式（包括NaN），标量对照参考实现，批量（F16C可用时为vcvtps2ph）对照标量
+static void test_random_floats(void) {
+    const size_t count = 1 << 20;
+    float* f = malloc(count * sizeof(float));
+    uint16_t* h = malloc(count * sizeof(uint16_t));
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bits = test_rand_u32();
+        // 一半样本集中在半精度的指数范围内
+        if (i & 1) bits = (bits & 0x807FFFFF) | ((uint32_t)(100 + test_rand_u32() % 45) << 23);
+        f[i] = bits_float(bits);
+    }
+
+    int failures = g_test_failures;
+    for (size_t i = 0; i < count && g_test_failures - failures < 8; i++) {
+        if (isnan(f[i])) {
+            uint16_t got = float_to_fp16(f[i]);
+            if (!half_is_nan(got) || (got & 0x8000) != ((float_bits(f[i]) >> 16) & 0x8000)) {
+                fprintf(stderr, "float_to_fp16(NaN 0x%08x): 0x%04x\n", float_bits(f[i]), got);
+                g_test_failures++;
+            }
+            continue;
+        }
+        check_to_half(f[i]);
+    }
+
+    float_to_fp16_array(h, f, count);
+    for (size_t i = 0; i < count; i++) {
+        uint16_t want = float_to_fp16(f[i]);
+        if (h[i] != want) {
+            fprintf(stderr, "float_to_fp16_array(0x%08x): 0x%04x，期望 0x%04x\n",
+                    float_bits(f[i]), h[i], want);
+            g_test_failures++;
+            break;
+        }
+    }
+
+    free(f);
+    free(h);
+}
+
+int main(void) {
+    // 批量转换按HAL选择的层级使用F16C
+    HAL_Device* dev = test_init_device();
+    if (!dev) return 1;
+
+    test_every_half();
+    test_rounding_boundaries();
+    test_random_floats();
+
+    return test_finish("test_fp16");
+}
@@ -0,0 +1,239 @@
+// fp32 GEMM族对照朴素三重循环：matrix_multiply（含小M的GEMV路径）、gemv、
+// 带转置的单个/批量矩阵乘、fp16权重矩阵乘和线性层反向
+
+#include "test_common.h"
+#include "fp16.h"
+#include <string.h>
+
+// op(A)[i][l]，trans时A按 [k x m] 存储
+static float elem_a(const float* a, size_t lda, int trans, size_t i, size_t l) {
+    return trans ? a[l * lda + i] : a[i * lda + l];
+}
+
+// op(B)[l][j]，trans时B按 [n x k] 存储
+static float elem_b(const float* b, size_t ldb, int trans, size_t l, size_t j) {
+    return trans ? b[j * ldb + l] : b[l * ldb + j];
+}
+
+static void ref_gemm(const float* a, size_t lda, int trans_a,
+                     const float* b, size_t ldb, int trans_b,
+                     float* c, size_t ldc, size_t m, size_t n, size_t k, int accumulate) {
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            double sum = accumulate ? c[i * ldc + j] : 0.0;
+            for (size_t l = 0; l < k; l++) {
+                sum += (double)elem_a(a, lda, trans_a, i, l) * elem_b(b, ldb, trans_b, l, j);
+            }
+            c[i * ldc + j] = (float)sum;
+        }
+    }
+}
+
+// 误差随k增长
+static float gemm_atol(size_t k) {
+    return 1e-5f * (float)k + 1e-5f;
+}
+
+static void test_matrix_multiply(HAL_Device* dev) {
+    // 覆盖GEMV（m=1）、小M流式路径、微内核尾部和多个K分块
+    static const size_t shapes[][3] = {
+        {1, 1, 1}, {1, 257, 129}, {3, 100, 77}, {7, 33, 300},
+        {16, 16, 16}, {37, 53, 131}, {65, 129, 257}, {128, 96, 520}
+    };
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        size_t m = shapes[s][0], n = shapes[s][1], k = shapes[s][2];
+        float* a = malloc(m * k * sizeof(float));
+        float* b = malloc(k * n * sizeof(float));
+        float* c = malloc(m * n * sizeof(float));
+        float* ref = malloc(m * n * sizeof(float));
+        test_fill(a, m * k);
+        test_fill(b, k * n);
+        memset(c, 0xff, m * n * sizeof(float));
+
+        dev->matrix_multiply(a, b, c, m, n, k);
+        ref_gemm(a, k, 0, b, n, 0, ref, n, m, n, k, 0);
+        char what[64];
+        snprintf(what, sizeof(what), "matrix_multiply %zux%zux%zu", m, n, k);
+        test_compare(what, c, ref, m * n, gemm_atol(k), 1e-5f);
+
+        free(a);
+        free(b);
+        free(c);
+        free(ref);
+    }
+}
+
+static void test_gemv(HAL_Device* dev) {
+    const size_t m = 131, n = 389;
+    float* a = malloc(m * n * sizeof(float));
+    float* x = malloc(n * sizeof(float));
+    float* y = malloc(m * sizeof(float));
+    float* ref = malloc(m * sizeof(float));
+    test_fill(a, m * n);
+    test_fill(x, n);
+
+    dev->gemv(a, x, y, m, n);
+    // y = A * x 即 [m x n] 乘 [n x 1]
+    ref_gemm(a, n, 0, x, 1, 0, ref, 1, m, 1, n, 0);
+    test_compare("gemv", y, ref, m, gemm_atol(n), 1e-5f);
+
+    free(a);
+    free(x);
+    free(y);
+    free(ref);
+}
+
+static void test_matrix_multiply_trans(HAL_Device* dev) {
+    const size_t m = 29, n = 45, k = 67;
+    // 行跨度大于行宽，检查跨步访问
+    const size_t pad = 3;
+    size_t lda_n = k + pad, lda_t = m + pad;
+    size_t ldb_n = n + pad, ldb_t = k + pad;
+    size_t ldc = n + pad;
+    float* a = malloc(k * (m + pad) * sizeof(float) + m * (k + pad) * sizeof(float));
+    float* b = malloc(k * (n + pad) * sizeof(float) + n * (k + pad) * sizeof(float));
+    float* c = malloc(m * ldc * sizeof(float));
+    float* ref = malloc(m * ldc * sizeof(float));
+    test_fill(a, k * (m + pad) + m * (k + pad));
+    test_fill(b, k * (n + pad) + n * (k + pad));
+
+    for (int trans_a = 0; trans_a <= 1; trans_a++) {
+        for (int trans_b = 0; trans_b <= 1; trans_b++) {
+            for (int accumulate = 0; accumulate <= 1; accumulate++) {
+                size_t lda = trans_a ? lda_t : lda_n;
+                size_t ldb = trans_b ? ldb_t : ldb_n;
+                test_fill(c, m * ldc);
+                memcpy(ref, c, m * ldc * sizeof(float));
+
+                dev->matrix_multiply_trans(a, lda, trans_a, b, ldb, trans_b, c, ldc,
+                                           m, n, k, accumulate);
+                ref_gemm(a, lda, trans_a, b, ldb, trans_b, ref, ldc, m, n, k, accumulate);
+                char what[64];
+                snprintf(what, sizeof(what), "matrix_multiply_trans %c%c acc=%d",
+                         trans_a ? 'T' : 'N', trans_b ? 'T' : 'N', accumulate);
+                // 包括行尾的填充（不得被写入）
+                test_compare(what, c, ref, m * ldc, gemm_atol(k), 1e-5f);
+            }
+        }
+    }
+
+    free(a);
+    free(b);
+    free(c);
+    free(ref);
+}
+
+static void test_matrix_multiply_batched(HAL_Device* dev) {
+    // 多头注意力的 Q * K^T：Q/K为 [seq][heads][head_dim]，每个头的行跨度为 heads * head_dim
+    const size_t heads = 5, seq = 23, head_dim = 24;
+    size_t ld = heads * head_dim;
+    float* q = malloc(seq * ld * sizeof(float));
+    float* kmat = malloc(seq * ld * sizeof(float));
+    float* scores = malloc(heads * seq * seq * sizeof(float));
+    float* ref = malloc(heads * seq * seq * sizeof(float));
+    test_fill(q, seq * ld);
+    test_fill(kmat, seq * ld);
+
+    dev->matrix_multiply_batched(q, ld, head_dim, 0, kmat, ld, head_dim, 1,
+                                 scores, seq, seq * seq, seq, seq, head_dim, heads);
+    for (size_t h = 0; h < heads; h++) {
+        ref_gemm(q + h * head_dim, ld, 0, kmat + h * head_dim, ld, 1,
+                 ref + h * seq * seq, seq, seq, seq, head_dim, 0);
+    }
+    test_compare("matrix_multiply_batched NT", scores, ref, heads * seq * seq,
+                 gemm_atol(head_dim), 1e-5f);
+
+    // scores * V：V同样按头交错存储，输出写回交错布局
+    float* out = malloc(seq * ld * sizeof(float));
+    float* out_ref = malloc(seq * ld * sizeof(float));
+    dev->matrix_multiply_batched(scores, seq, seq * seq, 0, kmat, ld, head_dim, 0,
+                                 out, ld, head_dim, seq, head_dim, seq, heads);
+    for (size_t h = 0; h < heads; h++) {
+        ref_gemm(scores + h * seq * seq, seq, 0, kmat + h * head_dim, ld, 0,
+                 out_ref + h * head_dim, ld, seq, head_dim, seq, 0);
+    }
+    test_compare("matrix_multiply_batched NN", out, out_ref, seq * ld, 1e-3f, 1e-4f);
+
+    free(q);
+    free(kmat);
+    free(scores);
+    free(ref);
+    free(out);
+    free(out_ref);
+}
+
+static void test_matrix_multiply_f16(HAL_Device* dev) {
+    static const size_t shapes[][3] = {{1, 300, 129}, {4, 77, 65}, {33, 70, 190}};
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        size_t m = shapes[s][0], n = shapes[s][1], k = shapes[s][2];
+        float* a = malloc(m * k * sizeof(float));
+        float* b = malloc(k * n * sizeof(float));
+        uint16_t* b16 = malloc(k * n * sizeof(uint16_t));
+        float* c = malloc(m * n * sizeof(float));
+        float* ref = malloc(m * n * sizeof(float));
+        test_fill(a, m * k);
+        test_fill(b, k * n);
+        // 参考实现使用fp16往返后的权重，只比较累加误差
+        for (size_t i = 0; i < k * n; i++) {
+            b16[i] = float_to_fp16(b[i]);
+            b[i] = fp16_to_float(b16[i]);
+        }
+
+        dev->matrix_multiply_f16(a, b16, c, m, n, k);
+        ref_gemm(a, k, 0, b, n, 0, ref, n, m, n, k, 0);
+        char what[64];
+        snprintf(what, sizeof(what), "matrix_multiply_f16 %zux%zux%zu", m, n, k);
+        test_compare(what, c, ref, m * n, gemm_atol(k), 1e-5f);
+
+        free(a);
+        free(b);
+        free(b16);
+        free(c);
+        free(ref);
+    }
+}
+
+static void test_matrix_multiply_backward(HAL_Device* dev) {
+    const size_t m = 19, n = 41, k = 27;
+    float* x = malloc(m * k * sizeof(float));
+    float* w = malloc(k * n * sizeof(float));
+    float* gy = malloc(m * n * sizeof(float));
+    float* gx = malloc(m * k * sizeof(float));
+    float* gw = malloc(k * n * sizeof(float));
+    float* gx_ref = malloc(m * k * sizeof(float));
+    float* gw_ref = malloc(k * n * sizeof(float));
+    test_fill(x, m * k);
+    test_fill(w, k * n);
+    test_fill(gy, m * n);
+    test_fill(gw, k * n);
+    memcpy(gw_ref, gw, k * n * sizeof(float));
+
+    // 梯度累积：grad_weight += X^T * grad_output
+    dev->matrix_multiply_backward(gy, x, w, gx, gw, m, n, k, 1);
+    ref_gemm(gy, n, 0, w, n, 1, gx_ref, k, m, k, n, 0);
+    ref_gemm(x, k, 1, gy, n, 0, gw_ref, n, k, n, m, 1);
+    test_compare("matrix_multiply_backward grad_input", gx, gx_ref, m * k, gemm_atol(n), 1e-5f);
+    test_compare("matrix_multiply_backward grad_weight", gw, gw_ref, k * n, gemm_atol(m), 1e-5f);
+
+    free(x);
+    free(w);
+    free(gy);
+    free(gx);
+    free(gw);
+    free(gx_ref);
+    free(gw_ref);
+}
+
+int main(void) {
+    HAL_Device* dev = test_init_device();
+    if (!dev) return 1;
+
+    test_matrix_multiply(dev);
+    test_gemv(dev);
+    test_matrix_multiply_trans(dev);
+    test_matrix_multiply_batched(dev);
+    test_matrix_multiply_f16(dev);
+    test_matrix_multiply_backward(dev);
+
+    return test_finish("test_gemm");
+}
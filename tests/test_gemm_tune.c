@@ -0,0 +1,283 @@
+// GEMM调优表与调优文件：默认路径（CPU型号和指令集层级作为文件名）、保存/载入往返、
+// CPU型号或层级不一致时拒绝载入，autotune_matmul写出的文件在下次hal_init时生效，
+// 以及LOWMEM_AUTOTUNE=1时未调优的形状交给后台调优
+// HOME指向临时目录，不读写用户的 ~/.cache
+
+#include "test_common.h"
+#include "gemm.h"
+#include "gemm_tune.h"
+#include "cpu_features.h"
+#include <string.h>
+#include <unistd.h>
+
+static char g_dir[] = "/tmp/lowmem_tune_XXXXXX";
+
+static int configs_equal(const GemmConfig* a, const GemmConfig* b) {
+    return a->kernel_tier == b->kernel_tier && a->threads == b->threads &&
+           a->blocking.mc == b->blocking.mc && a->blocking.kc == b->blocking.kc &&
+           a->blocking.nc == b->blocking.nc;
+}
+
+static int ends_with(const char* s, const char* suffix) {
+    size_t ls = strlen(s), lx = strlen(suffix);
+    return ls >= lx && strcmp(s + ls - lx, suffix) == 0;
+}
+
+// 把文件中以prefix开头的行替换为line
+static void rewrite_line(const char* path, const char* prefix, const char* line) {
+    char buf[8192];
+    FILE* fp = fopen(path, "r");
+    if (!fp) return;
+    size_t len = fread(buf, 1, sizeof(buf) - 1, fp);
+    buf[len] = '\0';
+    fclose(fp);
+
+    fp = fopen(path, "w");
+    if (!fp) return;
+    for (char* p = buf; *p;) {
+        char* end = strchr(p, '\n');
+        size_t n = end ? (size_t)(end - p + 1) : strlen(p);
+        if (strncmp(p, prefix, strlen(prefix)) == 0) {
+            fprintf(fp, "%s\n", line);
+        } else {
+            fwrite(p, 1, n, fp);
+        }
+        p += n;
+    }
+    fclose(fp);
+}
+
+static void test_default_path(void) {
+    const CpuInfo* info = cpu_features_get();
+    char path[512];
+    char want[512];
+
+    // $HOME/.cache/lowmemory_llm/gemm_<型号>_<层级>.tune，型号只保留字母数字
+    CHECK(gemm_tuning_default_path(path, sizeof(path)) == 0);
+    snprintf(want, sizeof(want), "%s/.cache/lowmemory_llm/gemm_", g_dir);
+    CHECK(strncmp(path, want, strlen(want)) == 0);
+    snprintf(want, sizeof(want), "_%s.tune", cpu_tier_name(info->tier));
+    CHECK(ends_with(path, want));
+    const char* model = path + strlen(g_dir) + strlen("/.cache/lowmemory_llm/gemm_");
+    for (const char* p = model; p < path + strlen(path) - strlen(want); p++) {
+        int alnum = (*p >= '0' && *p <= '9') || (*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z');
+        CHECK(alnum || *p == '_');
+    }
+
+    // XDG_CACHE_HOME优先于HOME
+    char xdg[256];
+    snprintf(xdg, sizeof(xdg), "%s/xdg", g_dir);
+    setenv("XDG_CACHE_HOME", xdg, 1);
+    CHECK(gemm_tuning_default_path(path, sizeof(path)) == 0);
+    snprintf(want, sizeof(want), "%s/lowmemory_llm/gemm_", xdg);
+    CHECK(strncmp(path, want, strlen(want)) == 0);
+    unsetenv("XDG_CACHE_HOME");
+
+    // 环境变量直接指定文件
+    setenv(GEMM_TUNING_FILE_ENV, "/nonexistent/custom.tune", 1);
+    CHECK(gemm_tuning_default_path(path, sizeof(path)) == 0);
+    CHECK(strcmp(path, "/nonexistent/custom.tune") == 0);
+    unsetenv(GEMM_TUNING_FILE_ENV);
+
+    CHECK(gemm_tuning_default_path(path, 8) == -1);
+    CHECK(gemm_tuning_default_path(NULL, sizeof(path)) == -1);
+}
+
+static void test_round_trip(void) {
+    int tier = (int)cpu_features_tier();
+    const GemmConfig configs[3] = {
+        { .kernel_tier = tier, .blocking = { 96, 256, 1024 }, .threads = 2 },
+        { .kernel_tier = CPU_TIER_SCALAR, .blocking = { 0, 128, 0 }, .threads = 0 },
+        { .kernel_tier = tier, .blocking = { 0, 0, 0 }, .threads = 1 },
+    };
+    const size_t shapes[3][3] = { { 64, 256, 512 }, { 100, 33, 7 }, { 4096, 4096, 4096 } };
+
+    gemm_tuning_clear();
+    for (int i = 0; i < 3; i++) {
+        CHECK(gemm_tuning_set(shapes[i][0], shapes[i][1], shapes[i][2], &configs[i]) == 0);
+    }
+    // 已有形状原地更新
+    CHECK(gemm_tuning_set(shapes[0][0], shapes[0][1], shapes[0][2], &configs[0]) == 0);
+    CHECK(gemm_tuning_count() == 3);
+
+    // 按需创建目录
+    char path[512];
+    snprintf(path, sizeof(path), "%s/a/b/round_trip.tune", g_dir);
+    CHECK(gemm_tuning_save(path) == 0);
+    CHECK(access(path, R_OK) == 0);
+
+    gemm_tuning_clear();
+    CHECK(gemm_tuning_count() == 0);
+    CHECK(gemm_tuning_find(shapes[0][0], shapes[0][1], shapes[0][2], NULL) == -1);
+    CHECK(gemm_tuning_load(path) == 3);
+    CHECK(gemm_tuning_count() == 3);
+    for (int i = 0; i < 3; i++) {
+        GemmConfig got;
+        CHECK(gemm_tuning_find(shapes[i][0], shapes[i][1], shapes[i][2], &got) == 0);
+        CHECK(configs_equal(&got, &configs[i]));
+    }
+    // 精确匹配
+    CHECK(gemm_tuning_find(shapes[0][0], shapes[0][1], shapes[0][2] + 1, NULL) == -1);
+
+    // 格式错误或本机不可用的微内核层级的行被跳过
+    FILE* fp = fopen(path, "a");
+    if (fp) {
+        fprintf(fp, "1 2 garbage\n");
+        fprintf(fp, "8 8 8 %d 0 0 0 0\n", CPU_TIER_COUNT);
+        fclose(fp);
+    }
+    gemm_tuning_clear();
+    CHECK(gemm_tuning_load(path) == 3);
+
+    // 另一个指令集层级的调优结果
+    const char* other = cpu_tier_name(tier == CPU_TIER_SCALAR ? CPU_TIER_AVX2 : CPU_TIER_SCALAR);
+    char line[128];
+    snprintf(line, sizeof(line), "tier %s", other);
+    rewrite_line(path, "tier ", line);
+    gemm_tuning_clear();
+    CHECK(gemm_tuning_load(path) == -1);
+    CHECK(gemm_tuning_count() == 0);
+
+    // 另一台机器（CPU型号不同）
+    snprintf(line, sizeof(line), "tier %s", cpu_tier_name((CpuTier)tier));
+    rewrite_line(path, "tier ", line);
+    CHECK(gemm_tuning_load(path) == 3);
+    gemm_tuning_clear();
+    rewrite_line(path, "cpu ", "cpu Some Other CPU @ 1.00GHz");
+    CHECK(gemm_tuning_load(path) == -1);
+    CHECK(gemm_tuning_count() == 0);
+
+    snprintf(path, sizeof(path), "%s/missing.tune", g_dir);
+    CHECK(gemm_tuning_load(path) == -1);
+    CHECK(gemm_tuning_load(NULL) == -1);
+}
+
+// autotune_matmul的结果立即生效并写入调优文件，重新初始化后从文件载入
+static void test_autotune(HAL_Device* dev) {
+    const size_t m = 40, n = 72, k = 56;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/auto.tune", g_dir);
+    setenv(GEMM_TUNING_FILE_ENV, path, 1);
+
+    gemm_tuning_clear();
+    CHECK(dev->autotune_matmul(m, n, k) == 0);
+    CHECK(dev->autotune_matmul(0, n, k) == -1);
+    GemmConfig tuned;
+    CHECK(gemm_tuning_find(m, n, k, &tuned) == 0);
+    CHECK(access(path, R_OK) == 0);
+
+    // 调优后的配置结果不变
+    float* a = malloc(m * k * sizeof(float));
+    float* b = malloc(k * n * sizeof(float));
+    float* c = malloc(m * n * sizeof(float));
+    float* ref = malloc(m * n * sizeof(float));
+    test_fill(a, m * k);
+    test_fill(b, k * n);
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            double sum = 0.0;
+            for (size_t l = 0; l < k; l++) sum += (double)a[i * k + l] * b[l * n + j];
+            ref[i * n + j] = (float)sum;
+        }
+    }
+    dev->matrix_multiply(a, b, c, m, n, k);
+    test_compare("matrix_multiply tuned", c, ref, m * n, 1e-4f, 1e-4f);
+
+    // hal_cleanup清空调优表，hal_init按当前层级载入
+    hal_cleanup();
+    CHECK(gemm_tuning_count() == 0);
+    dev = test_init_device();
+    CHECK(dev != NULL);
+    GemmConfig loaded;
+    CHECK(gemm_tuning_find(m, n, k, &loaded) == 0);
+    CHECK(configs_equal(&loaded, &tuned));
+    if (dev) {
+        dev->matrix_multiply(a, b, c, m, n, k);
+        test_compare("matrix_multiply loaded", c, ref, m * n, 1e-4f, 1e-4f);
+    }
+
+    unsetenv(GEMM_TUNING_FILE_ENV);
+    unlink(path);
+    free(a);
+    free(b);
+    free(c);
+    free(ref);
+}
+
+// 后台调优：matrix_multiply不等待搜索，结果正确；搜索完成后写入调优表和调优文件
+static void test_background_autotune(void) {
+    const size_t m = 64, n = 256, k = 520;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/background.tune", g_dir);
+    setenv(GEMM_TUNING_FILE_ENV, path, 1);
+    setenv(HAL_AUTOTUNE_ENV, "1", 1);
+    hal_cleanup();
+    HAL_Device* dev = test_init_device();
+    CHECK(dev != NULL);
+    if (!dev) return;
+    CHECK(gemm_tuning_find(m, n, k, NULL) == -1);
+
+    float* a = malloc(m * k * sizeof(float));
+    float* b = malloc(k * n * sizeof(float));
+    float* c = malloc(m * n * sizeof(float));
+    float* ref = malloc(m * n * sizeof(float));
+    test_fill(a, m * k);
+    test_fill(b, k * n);
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            double sum = 0.0;
+            for (size_t l = 0; l < k; l++) sum += (double)a[i * k + l] * b[l * n + j];
+            ref[i * n + j] = (float)sum;
+        }
+    }
+    dev->matrix_multiply(a, b, c, m, n, k);
+    test_compare("matrix_multiply background", c, ref, m * n, 1e-4f, 1e-4f);
+
+    // 等待后台搜索完成（最多60秒）
+    int done = 0;
+    for (int i = 0; i < 6000 && !done; i++) {
+        done = gemm_tuning_find(m, n, k, NULL) == 0 && access(path, R_OK) == 0;
+        if (!done) usleep(10000);
+    }
+    CHECK(done);
+    dev->matrix_multiply(a, b, c, m, n, k);
+    test_compare("matrix_multiply background tuned", c, ref, m * n, 1e-4f, 1e-4f);
+
+    hal_cleanup();
+    unsetenv(HAL_AUTOTUNE_ENV);
+    unsetenv(GEMM_TUNING_FILE_ENV);
+    unlink(path);
+    free(a);
+    free(b);
+    free(c);
+    free(ref);
+}
+
+static void remove_tree(const char* dir) {
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", dir);
+    if (system(cmd) != 0) fprintf(stderr, "无法删除 %s\n", dir);
+}
+
+int main(void) {
+    if (!mkdtemp(g_dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    setenv("HOME", g_dir, 1);
+    unsetenv("XDG_CACHE_HOME");
+    unsetenv(GEMM_TUNING_FILE_ENV);
+    unsetenv(HAL_AUTOTUNE_ENV);
+
+    HAL_Device* dev = test_init_device();
+    if (!dev) return 1;
+
+    test_default_path();
+    test_round_trip();
+    test_autotune(dev);
+    test_background_autotune();
+
+    int ret = test_finish("test_gemm_tune");
+    remove_tree(g_dir);
+    return ret;
+}
@@ -0,0 +1,572 @@
+// KV缓存往返测试：在各存储模式下执行追加/查找/分段遍历/旋转/压缩/卸载/加载，
+// 单序列、多序列和前缀共享各一遍，每一步之后对照影子副本（按逻辑行保存的K/V和位置）检查缓存内容
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "test_common.h"
+#include "kv_cache.h"
+#include "attention.h"
+#include <dirent.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_LAYERS 2
+#define TEST_HEADS 2
+#define TEST_HEAD_DIM 16
+#define TEST_ROW (TEST_HEADS * TEST_HEAD_DIM)
+#define TEST_MAX_SEQ 64
+#define TEST_SEQS 3
+
+// 被压缩掉的行
+#define TEST_INVALID ((size_t)-1)
+
+// 存储模式
+typedef struct {
+    const char* name;
+    size_t block_size;
+    size_t max_blocks;
+    KVCachePrecision precision;
+    size_t quant_group_size;
+    int ring_buffer;
+} KVTestMode;
+
+static const KVTestMode g_modes[] = {
+    {"contiguous", 0, 0, KV_CACHE_FP32, 0, 0},
+    {"paged16", 16, 0, KV_CACHE_FP32, 0, 0},
+    // 块大小不整除max_seq_length，块池上限（按序列数放大）只够恰好装满
+    {"paged7", 7, TEST_LAYERS * 10, KV_CACHE_FP32, 0, 0},
+    // 量化：按头、按令牌和更细的分组
+    {"int8", 0, 0, KV_CACHE_INT8, 0, 0},
+    {"int8_token", 0, 0, KV_CACHE_INT8, TEST_ROW, 0},
+    {"fp8_group8", 0, 0, KV_CACHE_FP8, 8, 0},
+    {"paged7_int8", 7, 0, KV_CACHE_INT8, 8, 0},
+    {"paged16_fp8", 16, 0, KV_CACHE_FP8, 0, 0},
+    // 环形模式：旋转后追加到写满时回绕
+    {"ring", 0, 0, KV_CACHE_FP32, 0, 1},
+    {"ring_paged16", 16, 0, KV_CACHE_FP32, 0, 1},
+    {"ring_paged7_int8", 7, TEST_LAYERS * 10, KV_CACHE_INT8, 0, 1},
+};
+
+// 影子副本：一个序列一层的逻辑行
+typedef struct {
+    float k[TEST_MAX_SEQ * TEST_ROW];
+    float v[TEST_MAX_SEQ * TEST_ROW];
+    size_t pos[TEST_MAX_SEQ];
+    size_t len;
+} Shadow;
+
+static const char* g_mode_name = "";
+
+static void report(const char* what, size_t seq, size_t layer, const char* detail) {
+    fprintf(stderr, "[%s] %s 序列%zu 第%zu层: %s\n", g_mode_name, what, seq, layer, detail);
+    g_test_failures++;
+}
+
+// 对照影子副本检查一个序列一层的长度、查找结果和分段遍历
+static void check_layer(KVCacheManager* cache, size_t seq, size_t layer, const Shadow* sh,
+                        const char* what) {
+    if (kv_cache_seq_length(cache, seq, layer) != sh->len) {
+        report(what, seq, layer, "长度不一致");
+        return;
+    }
+    if (sh->len == 0) return;
+
+    size_t rows[TEST_MAX_SEQ];
+    float k[TEST_MAX_SEQ * TEST_ROW], v[TEST_MAX_SEQ * TEST_ROW];
+    for (size_t i = 0; i < sh->len; i++) rows[i] = i;
+    if (kv_cache_lookup_seq(cache, seq, layer, k, v, rows, sh->len) != 0) {
+        report(what, seq, layer, "查找失败");
+        return;
+    }
+    // 重排只复制存储的行（量化模式为码字），反量化结果逐位不变
+    if (memcmp(k, sh->k, sh->len * TEST_ROW * sizeof(float)) != 0 ||
+        memcmp(v, sh->v, sh->len * TEST_ROW * sizeof(float)) != 0) {
+        report(what, seq, layer, "K/V内容不一致");
+        return;
+    }
+
+    // 分段遍历覆盖全部行且位置一致
+    size_t start = 0;
+    while (start < sh->len) {
+        const void* ks;
+        const void* vs;
+        const size_t* ps;
+        size_t n = kv_cache_span_seq(cache, seq, layer, start, &ks, &vs, &ps);
+        if (n == 0 || start + n > sh->len) {
+            report(what, seq, layer, "分段长度错误");
+            return;
+        }
+        if (memcmp(ps, sh->pos + start, n * sizeof(size_t)) != 0) {
+            report(what, seq, layer, "位置映射不一致");
+            return;
+        }
+        if (cache->config.precision == KV_CACHE_FP32 &&
+            (memcmp(ks, sh->k + start * TEST_ROW, n * TEST_ROW * sizeof(float)) != 0 ||
+             memcmp(vs, sh->v + start * TEST_ROW, n * TEST_ROW * sizeof(float)) != 0)) {
+            report(what, seq, layer, "分段内容不一致");
+            return;
+        }
+        start += n;
+    }
+}
+
+// 反量化误差上限（输入在 [-1, 1) 内）
+static float precision_tolerance(KVCachePrecision precision) {
+    switch (precision) {
+        case KV_CACHE_INT8: return 1.0f / 127.0f;
+        case KV_CACHE_FP8: return 1.0f / 16.0f;
+        default: return 0.0f;
+    }
+}
+
+// 刚追加的一行对照输入检查后记入影子副本
+static void record_row(KVCacheManager* cache, size_t seq, size_t layer, Shadow* sh,
+                       const float* k, const float* v, size_t pos) {
+    size_t row = sh->len;
+    float* ko = sh->k + row * TEST_ROW;
+    float* vo = sh->v + row * TEST_ROW;
+    if (kv_cache_lookup_seq(cache, seq, layer, ko, vo, &row, 1) != 0) {
+        report("append", seq, layer, "查找新行失败");
+        return;
+    }
+    float tol = precision_tolerance(cache->config.precision);
+    if (test_compare(g_mode_name, ko, k, TEST_ROW, tol, 0.0f) != 0 ||
+        test_compare(g_mode_name, vo, v, TEST_ROW, tol, 0.0f) != 0) {
+        return;
+    }
+    sh->pos[row] = pos;
+    sh->len++;
+}
+
+// 每5行中有一行位置无效
+static size_t take_position(size_t* next_pos) {
+    size_t pos = (*next_pos % 5 == 2) ? TEST_INVALID : *next_pos;
+    (*next_pos)++;
+    return pos;
+}
+
+// 追加count行并记入影子副本
+static void append_rows(KVCacheManager* cache, size_t seq, size_t layer, Shadow* sh,
+                        size_t count, size_t* next_pos) {
+    float k[TEST_ROW], v[TEST_ROW];
+    for (size_t i = 0; i < count; i++) {
+        test_fill(k, TEST_ROW);
+        test_fill(v, TEST_ROW);
+        size_t pos = take_position(next_pos);
+        if (kv_cache_append_seq(cache, seq, layer, k, v, pos) != 0) {
+            report("append", seq, layer, "追加失败");
+            return;
+        }
+        record_row(cache, seq, layer, sh, k, v, pos);
+    }
+}
+
+static void shadow_drop_front(Shadow* sh, size_t n) {
+    memmove(sh->k, sh->k + n * TEST_ROW, (sh->len - n) * TEST_ROW * sizeof(float));
+    memmove(sh->v, sh->v + n * TEST_ROW, (sh->len - n) * TEST_ROW * sizeof(float));
+    memmove(sh->pos, sh->pos + n, (sh->len - n) * sizeof(size_t));
+    sh->len -= n;
+}
+
+static void shadow_compact(Shadow* sh) {
+    size_t out = 0;
+    for (size_t i = 0; i < sh->len; i++) {
+        if (sh->pos[i] == TEST_INVALID) continue;
+        memmove(sh->k + out * TEST_ROW, sh->k + i * TEST_ROW, TEST_ROW * sizeof(float));
+        memmove(sh->v + out * TEST_ROW, sh->v + i * TEST_ROW, TEST_ROW * sizeof(float));
+        sh->pos[out++] = sh->pos[i];
+    }
+    sh->len = out;
+}
+
+static size_t used_blocks(KVCacheManager* cache) {
+    KVBlockPoolStats stats;
+    if (kv_cache_get_pool_stats(cache, &stats) != 0) return 0;
+    return stats.used_blocks;
+}
+
+static void check_all(KVCacheManager* cache, Shadow* sh, const char* what) {
+    for (size_t l = 0; l < TEST_LAYERS; l++) check_layer(cache, 0, l, &sh[l], what);
+}
+
+// 删除卸载目录及其中的文件
+static void remove_dir(const char* dir) {
+    DIR* d = opendir(dir);
+    if (d) {
+        struct dirent* e;
+        while ((e = readdir(d)) != NULL) {
+            if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+            char path[512];
+            snprintf(path, sizeof(path), "%s/%s", dir, e->d_name);
+            unlink(path);
+        }
+        closedir(d);
+    }
+    rmdir(dir);
+}
+
+static KVCacheManager* create_cache(HAL_Device* dev, const KVTestMode* mode, size_t batch_size,
+                                    int prefix_cache) {
+    KVCacheConfig config = {
+        .max_seq_length = TEST_MAX_SEQ,
+        .num_layers = TEST_LAYERS,
+        .num_heads = TEST_HEADS,
+        .head_dim = TEST_HEAD_DIM,
+        .batch_size = batch_size,
+        .block_size = mode->block_size,
+        .max_blocks = mode->max_blocks * batch_size,
+        .precision = mode->precision,
+        .quant_group_size = mode->quant_group_size,
+        .ring_buffer = mode->ring_buffer,
+        .prefix_cache = prefix_cache
+    };
+    KVCacheManager* cache = NULL;
+    if (kv_cache_init(&cache, &config, dev) != 0) {
+        fprintf(stderr, "[%s] kv_cache_init失败\n", mode->name);
+        g_test_failures++;
+        return NULL;
+    }
+    return cache;
+}
+
+static void test_round_trip(HAL_Device* dev, const KVTestMode* mode, const char* dir) {
+    g_mode_name = mode->name;
+    KVCacheManager* cache = create_cache(dev, mode, 1, 0);
+    if (!cache) return;
+
+    static Shadow sh[TEST_LAYERS];
+    size_t next_pos[TEST_LAYERS] = {0};
+    memset(sh, 0, sizeof(sh));
+
+    for (size_t l = 0; l < TEST_LAYERS; l++) append_rows(cache, 0, l, &sh[l], 50, &next_pos[l]);
+    check_all(cache, sh, "append");
+
+    // 旋转：第0层不是整块，第1层恰好两整块（分页模式归还这两块）
+    size_t before_rotate = used_blocks(cache);
+    CHECK(kv_cache_rotate(cache, 0, 37) == 0);
+    shadow_drop_front(&sh[0], 37);
+    CHECK(kv_cache_rotate(cache, 1, 32) == 0);
+    shadow_drop_front(&sh[1], 32);
+    CHECK(kv_cache_rotate(cache, 1, sh[1].len) != 0);
+    if (cache->block_pool) CHECK(used_blocks(cache) + 2 <= before_rotate);
+    check_all(cache, sh, "rotate");
+
+    // 旋转后继续追加直到写满
+    for (size_t l = 0; l < TEST_LAYERS; l++) {
+        append_rows(cache, 0, l, &sh[l], TEST_MAX_SEQ - sh[l].len, &next_pos[l]);
+        float row[TEST_ROW] = {0};
+        CHECK(kv_cache_append(cache, l, row, row, 0) != 0);
+    }
+    check_all(cache, sh, "append after rotate");
+
+    for (size_t l = 0; l < TEST_LAYERS; l++) {
+        CHECK(kv_cache_compact(cache, l) == 0);
+        shadow_compact(&sh[l]);
+    }
+    check_all(cache, sh, "compact");
+
+    // 卸载第1层：数据不可访问，分页模式归还其块；加载后内容不变
+    size_t blocks = used_blocks(cache);
+    CHECK(kv_cache_offload(cache, 1, dir) == 0);
+    float k[TEST_ROW], v[TEST_ROW];
+    size_t row0 = 0;
+    const void* ks;
+    const void* vs;
+    CHECK(kv_cache_lookup(cache, 1, k, v, &row0, 1) != 0);
+    CHECK(kv_cache_span(cache, 1, 0, &ks, &vs, NULL) == 0);
+    CHECK(kv_cache_append(cache, 1, k, v, 0) != 0);
+    if (cache->block_pool) CHECK(used_blocks(cache) < blocks);
+    check_layer(cache, 0, 0, &sh[0], "offload other layer");
+    CHECK(kv_cache_load(cache, 1, dir) == 0);
+    CHECK(used_blocks(cache) == blocks);
+    check_all(cache, sh, "load");
+
+    // 在命令流上异步卸载并加载第0层
+    struct Stream* stream = dev->stream_create();
+    int offload_status = -1, load_status = -1;
+    CHECK(kv_cache_offload_async(cache, 0, dir, stream, &offload_status) == 0);
+    CHECK(kv_cache_load_async(cache, 0, dir, stream, &load_status) == 0);
+    CHECK(dev->stream_synchronize(stream) == 0);
+    dev->stream_destroy(stream);
+    CHECK(offload_status == 0 && load_status == 0);
+    check_all(cache, sh, "async offload/load");
+
+    // 压缩后追加的行接在末尾
+    for (size_t l = 0; l < TEST_LAYERS; l++) append_rows(cache, 0, l, &sh[l], 3, &next_pos[l]);
+    check_all(cache, sh, "append after compact");
+
+    kv_cache_reset(cache);
+    for (size_t l = 0; l < TEST_LAYERS; l++) sh[l].len = 0;
+    check_all(cache, sh, "reset");
+    CHECK(used_blocks(cache) == 0);
+
+    kv_cache_cleanup(cache);
+}
+
+// 多序列：槽位分配与归还、批量追加的全有或全无语义、按序列旋转/压缩互不影响、
+// 卸载/加载所有使用中的序列，以及批量解码注意力与逐序列计算一致
+static void test_sequences(HAL_Device* dev, const KVTestMode* mode, const char* dir) {
+    g_mode_name = mode->name;
+    KVCacheManager* cache = create_cache(dev, mode, TEST_SEQS, 0);
+    if (!cache) return;
+
+    static Shadow sh[TEST_SEQS][TEST_LAYERS];
+    size_t next_pos[TEST_SEQS] = {0};
+    memset(sh, 0, sizeof(sh));
+
+    size_t s1, s2, s3;
+    CHECK(kv_cache_add_sequence(cache, &s1) == 0 && s1 == 1);
+    CHECK(kv_cache_add_sequence(cache, &s2) == 0 && s2 == 2);
+    CHECK(kv_cache_add_sequence(cache, &s3) != 0);
+
+    // 各序列长度不同：序列2先单独追加几行
+    for (size_t l = 0; l < TEST_LAYERS; l++) {
+        size_t pos = 0;
+        append_rows(cache, 2, l, &sh[2][l], 5, &pos);
+    }
+    next_pos[2] = 5;
+
+    // 批量解码步：序列顺序与槽位顺序不同
+    const size_t order[TEST_SEQS] = {2, 0, 1};
+    float k[TEST_SEQS * TEST_ROW], v[TEST_SEQS * TEST_ROW];
+    size_t pos[TEST_SEQS];
+    for (size_t step = 0; step < 30; step++) {
+        for (size_t l = 0; l < TEST_LAYERS; l++) {
+            test_fill(k, TEST_SEQS * TEST_ROW);
+            test_fill(v, TEST_SEQS * TEST_ROW);
+            for (size_t i = 0; i < TEST_SEQS; i++) pos[i] = next_pos[order[i]] + l * 1000;
+            if (kv_cache_append_batch(cache, l, order, TEST_SEQS, k, v, pos) != 0) {
+                report("append_batch", 0, l, "批量追加失败");
+                continue;
+            }
+            for (size_t i = 0; i < TEST_SEQS; i++) {
+                record_row(cache, order[i], l, &sh[order[i]][l], k + i * TEST_ROW,
+                           v + i * TEST_ROW, pos[i]);
+            }
+        }
+        for (size_t i = 0; i < TEST_SEQS; i++) next_pos[i]++;
+    }
+    for (size_t s = 0; s < TEST_SEQS; s++) {
+        for (size_t l = 0; l < TEST_LAYERS; l++) check_layer(cache, s, l, &sh[s][l], "append_batch");
+    }
+
+    // 重复的序列号、槽位越界：整批拒绝，不写入任何一行
+    const size_t dup[2] = {1, 1};
+    const size_t bad[2] = {0, TEST_SEQS};
+    CHECK(kv_cache_append_batch(cache, 0, dup, 2, k, v, pos) != 0);
+    CHECK(kv_cache_append_batch(cache, 0, bad, 2, k, v, pos) != 0);
+    for (size_t s = 0; s < TEST_SEQS; s++) check_layer(cache, s, 0, &sh[s][0], "rejected batch");
+
+    // 靠后的序列失败时归还前面序列已预留的块（逐行推进序列0，覆盖需要新块的情形）
+    for (size_t i = 0; i < 16; i++) {
+        size_t before = used_blocks(cache);
+        CHECK(kv_cache_append_batch(cache, 0, bad, 2, k, v, pos) != 0);
+        CHECK(used_blocks(cache) == before);
+        append_rows(cache, 0, 0, &sh[0][0], 1, &next_pos[0]);
+    }
+    check_layer(cache, 0, 0, &sh[0][0], "rolled back batch");
+
+    // 批量解码注意力与逐序列计算一致
+    float q[TEST_SEQS * TEST_ROW], out[TEST_SEQS * TEST_ROW], ref[TEST_SEQS * TEST_ROW];
+    test_fill(q, TEST_SEQS * TEST_ROW);
+    CHECK(kv_cache_attention_batch(cache, 1, order, TEST_SEQS, q, 0, 0.0f, out) == 0);
+    for (size_t i = 0; i < TEST_SEQS; i++) {
+        CHECK(kv_cache_attention_seq(cache, order[i], 1, q + i * TEST_ROW, NULL, 1, 0, 0.0f,
+                                     ref + i * TEST_ROW) == 0);
+    }
+    test_compare("kv_cache_attention_batch", out, ref, TEST_SEQS * TEST_ROW, 0.0f, 0.0f);
+
+    // 旋转/压缩只作用于指定的序列
+    CHECK(kv_cache_rotate_seq(cache, 2, 0, 9) == 0);
+    shadow_drop_front(&sh[2][0], 9);
+    CHECK(kv_cache_compact_seq(cache, 1, 1) == 0);
+    shadow_compact(&sh[1][1]);
+    for (size_t s = 0; s < TEST_SEQS; s++) {
+        for (size_t l = 0; l < TEST_LAYERS; l++) check_layer(cache, s, l, &sh[s][l], "rotate/compact seq");
+    }
+
+    // 卸载/加载一层时包括所有使用中的序列
+    CHECK(kv_cache_offload(cache, 1, dir) == 0);
+    for (size_t s = 0; s < TEST_SEQS; s++) {
+        float row[TEST_ROW];
+        size_t r0 = 0;
+        CHECK(kv_cache_lookup_seq(cache, s, 1, row, row, &r0, 1) != 0);
+    }
+    CHECK(kv_cache_load(cache, 1, dir) == 0);
+    for (size_t s = 0; s < TEST_SEQS; s++) check_layer(cache, s, 1, &sh[s][1], "offload/load seqs");
+
+    // 归还的槽位清空并且不能再追加，重新分配时从空序列开始
+    CHECK(kv_cache_release_sequence(cache, 1) == 0);
+    CHECK(kv_cache_seq_length(cache, 1, 0) == 0);
+    CHECK(kv_cache_append_batch(cache, 0, order, TEST_SEQS, k, v, pos) != 0);
+    for (size_t s = 0; s < TEST_SEQS; s += 2) check_layer(cache, s, 0, &sh[s][0], "inactive seq");
+    CHECK(kv_cache_add_sequence(cache, &s3) == 0 && s3 == 1);
+    CHECK(kv_cache_seq_length(cache, 1, 0) == 0 && kv_cache_seq_length(cache, 1, 1) == 0);
+
+    // 在卸载状态下归还的槽位重新分配后可直接追加，加载不影响它
+    CHECK(kv_cache_offload(cache, 1, dir) == 0);
+    CHECK(kv_cache_release_sequence(cache, 2) == 0);
+    CHECK(kv_cache_add_sequence(cache, &s3) == 0 && s3 == 2);
+    CHECK(kv_cache_append_seq(cache, 2, 1, k, v, 0) == 0);
+    CHECK(kv_cache_load(cache, 1, dir) == 0);
+    check_layer(cache, 0, 1, &sh[0][1], "reuse offloaded slot");
+    CHECK(kv_cache_seq_length(cache, 2, 1) == 1);
+
+    CHECK(kv_cache_release_sequence(cache, 1) == 0);
+    CHECK(kv_cache_release_sequence(cache, 2) == 0);
+    kv_cache_reset(cache);
+    CHECK(used_blocks(cache) == 0);
+    kv_cache_cleanup(cache);
+}
+
+// 按位置0..count-1追加令牌，作为可登记到前缀树的序列
+static void append_prefix_rows(KVCacheManager* cache, size_t seq, Shadow* sh, size_t count) {
+    float k[TEST_ROW], v[TEST_ROW];
+    for (size_t l = 0; l < TEST_LAYERS; l++) {
+        for (size_t i = sh[l].len; i < count; i++) {
+            test_fill(k, TEST_ROW);
+            test_fill(v, TEST_ROW);
+            if (kv_cache_append_seq(cache, seq, l, k, v, i) != 0) {
+                report("append", seq, l, "追加失败");
+                return;
+            }
+            record_row(cache, seq, l, &sh[l], k, v, i);
+        }
+    }
+}
+
+static void check_seq(KVCacheManager* cache, size_t seq, const Shadow* sh, const char* what) {
+    for (size_t l = 0; l < TEST_LAYERS; l++) check_layer(cache, seq, l, &sh[l], what);
+}
+
+// 前缀共享：挂上的前缀与原序列内容一致，任一方写入、旋转、压缩或卸载共享块后
+// 另一方不受影响（写时复制），淘汰和块池耗尽时的LRU淘汰只回收前缀树独占的块
+static void test_prefix(HAL_Device* dev, const KVTestMode* mode, const char* dir) {
+    g_mode_name = mode->name;
+    KVCacheManager* cache = create_cache(dev, mode, TEST_SEQS, 1);
+    if (!cache) return;
+
+    static Shadow sh[TEST_SEQS][TEST_LAYERS];
+    memset(sh, 0, sizeof(sh));
+    int32_t tokens[TEST_MAX_SEQ];
+    for (size_t i = 0; i < TEST_MAX_SEQ; i++) tokens[i] = (int32_t)(1000 + i);
+
+    // 序列0计算40个令牌并登记
+    append_prefix_rows(cache, 0, sh[0], 40);
+    CHECK(kv_cache_prefix_insert(cache, 0, tokens, 40) == 0);
+    KVPrefixStats stats;
+    CHECK(kv_cache_get_prefix_stats(cache, &stats) == 0);
+    CHECK(stats.cached_nodes == (40 + mode->block_size - 1) / mode->block_size);
+
+    // 序列1挂上39个令牌（最后一块部分匹配）
+    size_t s1, matched = 0;
+    CHECK(kv_cache_add_sequence(cache, &s1) == 0);
+    CHECK(kv_cache_prefix_attach(cache, s1, tokens, 39, &matched) == 0);
+    CHECK(matched == 39);
+    for (size_t l = 0; l < TEST_LAYERS; l++) {
+        sh[s1][l] = sh[0][l];
+        sh[s1][l].len = matched;
+    }
+    check_seq(cache, s1, sh[s1], "attach");
+    KVBlockPoolStats pool;
+    CHECK(kv_cache_get_pool_stats(cache, &pool) == 0);
+    CHECK(pool.shared_blocks > 0);
+
+    // 与已缓存前缀在第20个令牌处分叉的序列只匹配前20个
+    size_t s2;
+    int32_t forked[TEST_MAX_SEQ];
+    memcpy(forked, tokens, sizeof(forked));
+    forked[20] = -1;
+    CHECK(kv_cache_add_sequence(cache, &s2) == 0);
+    CHECK(kv_cache_prefix_attach(cache, s2, forked, 30, &matched) == 0);
+    CHECK(matched == 20);
+    for (size_t l = 0; l < TEST_LAYERS; l++) {
+        sh[s2][l] = sh[0][l];
+        sh[s2][l].len = matched;
+    }
+
+    // 在共享的块中写入不同的令牌：复制后写入，其他引用者不变
+    append_prefix_rows(cache, s1, sh[s1], 50);
+    append_prefix_rows(cache, s2, sh[s2], 45);
+    append_prefix_rows(cache, 0, sh[0], 44);
+    check_seq(cache, 0, sh[0], "cow append");
+    check_seq(cache, s1, sh[s1], "cow append");
+    check_seq(cache, s2, sh[s2], "cow append");
+    CHECK(kv_cache_get_prefix_stats(cache, &stats) == 0);
+    CHECK(stats.cow_copies > 0);
+    CHECK(stats.hit_tokens == 59 && stats.lookups == 2);
+
+    // 不整块的旋转和压缩改写共享的块
+    CHECK(kv_cache_rotate_seq(cache, s2, 0, 5) == 0);
+    shadow_drop_front(&sh[s2][0], 5);
+    float k[TEST_ROW], v[TEST_ROW];
+    test_fill(k, TEST_ROW);
+    test_fill(v, TEST_ROW);
+    CHECK(kv_cache_append_seq(cache, s1, 1, k, v, TEST_INVALID) == 0);
+    record_row(cache, s1, 1, &sh[s1][1], k, v, TEST_INVALID);
+    CHECK(kv_cache_compact_seq(cache, s1, 1) == 0);
+    shadow_compact(&sh[s1][1]);
+    // 旋转或压缩之后的序列不能再登记
+    CHECK(kv_cache_prefix_insert(cache, s2, tokens, 10) != 0);
+    for (size_t s = 0; s < TEST_SEQS; s++) check_seq(cache, s, sh[s], "cow rotate/compact");
+
+    // 卸载归还共享块的引用，加载后各序列使用私有的块
+    CHECK(kv_cache_offload(cache, 1, dir) == 0);
+    CHECK(kv_cache_load(cache, 1, dir) == 0);
+    for (size_t s = 0; s < TEST_SEQS; s++) check_seq(cache, s, sh[s], "cow offload/load");
+
+    // 序列仍在引用的节点不会被淘汰；全部归还后前缀树独占的块被回收
+    CHECK(kv_cache_release_sequence(cache, s1) == 0);
+    CHECK(kv_cache_release_sequence(cache, s2) == 0);
+    kv_cache_reset(cache);
+    CHECK(used_blocks(cache) == TEST_LAYERS * stats.cached_nodes);
+    CHECK(kv_cache_prefix_evict(cache, (size_t)-1) == stats.cached_nodes);
+    CHECK(used_blocks(cache) == 0);
+    CHECK(kv_cache_get_prefix_stats(cache, &stats) == 0);
+    CHECK(stats.cached_nodes == 0);
+    kv_cache_cleanup(cache);
+
+    // 块池只够一个写满的序列：登记的前缀在分配新块时按LRU淘汰
+    size_t per_seq = TEST_LAYERS * ((TEST_MAX_SEQ + mode->block_size - 1) / mode->block_size);
+    KVTestMode small_pool = *mode;
+    small_pool.max_blocks = per_seq;
+    cache = create_cache(dev, &small_pool, 1, 1);
+    if (!cache) return;
+    memset(sh, 0, sizeof(sh));
+    append_prefix_rows(cache, 0, sh[0], 40);
+    CHECK(kv_cache_prefix_insert(cache, 0, tokens, 40) == 0);
+    kv_cache_reset(cache);
+    memset(sh, 0, sizeof(sh));
+    forked[0] = -1;
+    CHECK(kv_cache_prefix_attach(cache, 0, forked, TEST_MAX_SEQ, &matched) == 0);
+    CHECK(matched == 0);
+    append_prefix_rows(cache, 0, sh[0], TEST_MAX_SEQ);
+    check_seq(cache, 0, sh[0], "evict on alloc");
+    CHECK(kv_cache_get_prefix_stats(cache, &stats) == 0);
+    CHECK(stats.evictions > 0 && stats.cached_nodes == 0);
+    kv_cache_cleanup(cache);
+}
+
+int main(void) {
+    HAL_Device* dev = test_init_device();
+    if (!dev) return 1;
+
+    const char* tmp = getenv("TMPDIR");
+    char dir[256];
+    snprintf(dir, sizeof(dir), "%s/lowmem_kv_XXXXXX", tmp && *tmp ? tmp : "/tmp");
+    if (!mkdtemp(dir)) {
+        fprintf(stderr, "无法创建临时目录\n");
+        hal_cleanup();
+        return 1;
+    }
+
+    for (size_t i = 0; i < sizeof(g_modes) / sizeof(g_modes[0]); i++) {
+        test_round_trip(dev, &g_modes[i], dir);
+        test_sequences(dev, &g_modes[i], dir);
+        // 前缀共享只支持分页模式
+        if (g_modes[i].block_size) test_prefix(dev, &g_modes[i], dir);
+    }
+
+    remove_dir(dir);
+    return test_finish("test_kv_cache");
+}
@@ -0,0 +1,226 @@
+// 尺寸级别内存池：级别取整对照独立的参考计算、线程本地缓存与全局链表的复用路径、
+// 线程退出时本地缓存归还全局、缓存上限与trim，以及多线程下的分配统计
+
+#include "test_common.h"
+#include "mem_pool.h"
+#include <pthread.h>
+#include <string.h>
+
+#define TEST_NUM_THREADS 4
+
+// 1KB以内按64字节取整，之后每个2的幂区间 (2^lg, 2^(lg+1)] 分4级
+static size_t ref_class_size(size_t size) {
+    if (size > MEM_POOL_MAX_CLASS_SIZE) {
+        return (size + MEM_POOL_ALIGNMENT - 1) & ~(size_t)(MEM_POOL_ALIGNMENT - 1);
+    }
+    if (size <= 1024) return size == 0 ? 64 : (size + 63) & ~(size_t)63;
+    size_t lg = 0;
+    while (((size_t)1 << (lg + 1)) < size) lg++;
+    size_t step = (size_t)1 << (lg - 2);
+    return (size + step - 1) / step * step;
+}
+
+static MemPoolStats get_stats(void) {
+    MemPoolStats stats;
+    mem_pool_get_stats(&stats);
+    return stats;
+}
+
+static void check_block(void* p, size_t size) {
+    CHECK(p != NULL);
+    if (!p) return;
+    CHECK(((uintptr_t)p & (MEM_POOL_ALIGNMENT - 1)) == 0);
+    size_t usable = mem_pool_usable_size(p);
+    if (usable != ref_class_size(size)) {
+        fprintf(stderr, "mem_pool_usable_size(%zu): %zu，期望 %zu\n", size, usable, ref_class_size(size));
+        g_test_failures++;
+    }
+    // 整块可写（ASan下越界会被发现）
+    memset(p, 0xa5, usable);
+}
+
+static void test_size_classes(void) {
+    for (size_t size = 0; size <= 5000; size++) {
+        void* p = mem_pool_alloc(size);
+        check_block(p, size);
+        mem_pool_free(p);
+    }
+    // 每个2的幂及其两侧，直到超过最大级别
+    for (size_t lg = 11; lg <= 26; lg++) {
+        size_t base = (size_t)1 << lg;
+        size_t sizes[4] = { base - 1, base, base + 1, base + base / 4 + 1 };
+        for (int i = 0; i < 4; i++) {
+            void* p = mem_pool_alloc(sizes[i]);
+            check_block(p, sizes[i]);
+            mem_pool_free(p);
+        }
+    }
+    void* p = mem_pool_alloc(MEM_POOL_MAX_CLASS_SIZE + 1);
+    check_block(p, MEM_POOL_MAX_CLASS_SIZE + 1);
+    mem_pool_free(p);
+    mem_pool_free(NULL);
+    CHECK(mem_pool_usable_size(NULL) == 0);
+    mem_pool_trim(0);
+}
+
+// 小块经线程本地缓存复用：不计入全局缓存，也不调用系统分配器
+static void test_thread_cache(void) {
+    mem_pool_trim(0);
+    MemPoolStats before = get_stats();
+    void* p = mem_pool_alloc(100);
+    mem_pool_free(p);
+    MemPoolStats freed = get_stats();
+    CHECK(freed.cached_bytes == before.cached_bytes);
+    CHECK(freed.allocated_bytes == before.allocated_bytes);
+
+    void* q = mem_pool_alloc(100);
+    MemPoolStats after = get_stats();
+    CHECK(q == p);
+    CHECK(after.hits == freed.hits + 1);
+    CHECK(after.misses == freed.misses);
+    CHECK(after.allocated_bytes == before.allocated_bytes + 128);
+    mem_pool_free(q);
+
+    // 本地缓存满后溢出到全局链表，再分配时全部命中
+    enum { COUNT = 40 };
+    void* blocks[COUNT];
+    for (int i = 0; i < COUNT; i++) blocks[i] = mem_pool_alloc(256);
+    MemPoolStats allocated = get_stats();
+    for (int i = 0; i < COUNT; i++) mem_pool_free(blocks[i]);
+    MemPoolStats spilled = get_stats();
+    CHECK(spilled.cached_bytes > allocated.cached_bytes);
+    CHECK(spilled.cached_bytes - allocated.cached_bytes < COUNT * 256);
+    for (int i = 0; i < COUNT; i++) blocks[i] = mem_pool_alloc(256);
+    MemPoolStats reused = get_stats();
+    CHECK(reused.hits == spilled.hits + COUNT);
+    CHECK(reused.misses == spilled.misses);
+    CHECK(reused.cached_bytes == allocated.cached_bytes);
+    for (int i = 0; i < COUNT; i++) mem_pool_free(blocks[i]);
+    mem_pool_trim(0);
+}
+
+static void* alloc_free_thread(void* arg) {
+    void** out = (void**)arg;
+    *out = mem_pool_alloc(200);
+    mem_pool_free(*out);
+    return NULL;
+}
+
+// 线程退出时本地缓存归还全局链表，其他线程可以复用
+static void test_thread_exit(void) {
+    mem_pool_trim(0);
+    CHECK(get_stats().cached_bytes == 0);
+
+    void* p = NULL;
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, alloc_free_thread, &p) == 0);
+    pthread_join(thread, NULL);
+    MemPoolStats exited = get_stats();
+    CHECK(exited.cached_bytes == 256);
+
+    void* q = mem_pool_alloc(200);
+    CHECK(q == p);
+    CHECK(get_stats().hits == exited.hits + 1);
+    CHECK(get_stats().cached_bytes == 0);
+    mem_pool_free(q);
+    mem_pool_trim(0);
+}
+
+// 大块（超过本地缓存的级别）直接进入全局链表
+static void test_global_cache_and_trim(void) {
+    mem_pool_trim(0);
+    const size_t sizes[3] = { 100 << 10, 1 << 20, 5 << 20 };
+    void* blocks[3];
+    size_t total = 0;
+    for (int i = 0; i < 3; i++) {
+        blocks[i] = mem_pool_alloc(sizes[i]);
+        total += ref_class_size(sizes[i]);
+    }
+    for (int i = 0; i < 3; i++) mem_pool_free(blocks[i]);
+    CHECK(get_stats().cached_bytes == total);
+
+    // 同一级别的请求复用缓存块
+    void* again = mem_pool_alloc(sizes[1] - 100);
+    CHECK(again == blocks[1]);
+    mem_pool_free(again);
+
+    // trim从最大的级别开始归还
+    size_t released = mem_pool_trim(total - 1);
+    CHECK(released == ref_class_size(sizes[2]));
+    CHECK(get_stats().cached_bytes == total - released);
+    released = mem_pool_trim(0);
+    CHECK(released == ref_class_size(sizes[0]) + ref_class_size(sizes[1]));
+    CHECK(get_stats().cached_bytes == 0);
+    CHECK(mem_pool_trim(0) == 0);
+
+    // 缓存上限：超出上限的块直接归还系统，降低上限立即释放
+    mem_pool_set_cache_limit(2 << 20);
+    void* big = mem_pool_alloc(3 << 20);
+    void* small = mem_pool_alloc(1 << 20);
+    mem_pool_free(big);
+    mem_pool_free(small);
+    MemPoolStats limited = get_stats();
+    CHECK(limited.cache_limit == (size_t)2 << 20);
+    CHECK(limited.cached_bytes == ref_class_size(1 << 20));
+    mem_pool_set_cache_limit(0);
+    CHECK(get_stats().cached_bytes == 0);
+    mem_pool_set_cache_limit(MEM_POOL_DEFAULT_CACHE_LIMIT);
+}
+
+static void* stress_thread(void* arg) {
+    uint32_t seed = (uint32_t)(uintptr_t)arg;
+    enum { SLOTS = 64 };
+    unsigned char* slots[SLOTS] = { NULL };
+    size_t sizes[SLOTS] = { 0 };
+    int* failures = calloc(1, sizeof(int));
+    for (int iter = 0; iter < 20000; iter++) {
+        seed = seed * 1664525u + 1013904223u;
+        size_t s = (seed >> 8) % SLOTS;
+        if (slots[s]) {
+            // 内容未被其他线程改写
+            for (size_t i = 0; i < sizes[s]; i += 61) {
+                if (slots[s][i] != (unsigned char)(s + sizes[s])) (*failures)++;
+            }
+            mem_pool_free(slots[s]);
+            slots[s] = NULL;
+        } else {
+            sizes[s] = (seed >> 12) % ((seed & 1) ? 512 : 70000);
+            slots[s] = mem_pool_alloc(sizes[s]);
+            if (!slots[s]) {
+                (*failures)++;
+                continue;
+            }
+            memset(slots[s], (unsigned char)(s + sizes[s]), sizes[s]);
+        }
+    }
+    for (int s = 0; s < SLOTS; s++) mem_pool_free(slots[s]);
+    return failures;
+}
+
+// 多线程交叉分配释放：内容不串，结束后已分配字节数回到初始值
+static void test_threads(void) {
+    size_t allocated = get_stats().allocated_bytes;
+    pthread_t threads[TEST_NUM_THREADS];
+    for (uintptr_t t = 0; t < TEST_NUM_THREADS; t++) {
+        CHECK(pthread_create(&threads[t], NULL, stress_thread, (void*)(t + 1)) == 0);
+    }
+    for (int t = 0; t < TEST_NUM_THREADS; t++) {
+        void* result = NULL;
+        pthread_join(threads[t], &result);
+        int* failures = (int*)result;
+        CHECK(failures && *failures == 0);
+        free(failures);
+    }
+    CHECK(get_stats().allocated_bytes == allocated);
+    mem_pool_trim(0);
+}
+
+int main(void) {
+    test_size_classes();
+    test_thread_cache();
+    test_thread_exit();
+    test_global_cache_and_trim();
+    test_threads();
+
+    return test_finish("test_mem_pool");
+}
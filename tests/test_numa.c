@@ -0,0 +1,231 @@
+// NUMA拓扑对照独立解析的sysfs（不可读时对照单节点回退）、CPU放置顺序，
+// 以及放置策略和按节点/交错放置的内存池分配（策略设置失败时仍返回可用内存）
+
+#include "test_common.h"
+#include "numa_topology.h"
+#include "mem_pool.h"
+#include "page_map.h"
+#include <string.h>
+#include <unistd.h>
+
+#define SYSFS_NODE_DIR "/sys/devices/system/node"
+
+static int read_sysfs(const char* path, char* buf, size_t size) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) return -1;
+    int ok = fgets(buf, (int)size, fp) != NULL;
+    fclose(fp);
+    return ok ? 0 : -1;
+}
+
+// "0-3,8,10-11" 展开为位图，返回个数
+static size_t ref_parse_list(const char* list, unsigned char* set, size_t max) {
+    size_t count = 0;
+    const char* p = list;
+    while (*p >= '0' && *p <= '9') {
+        long lo = strtol(p, (char**)&p, 10);
+        long hi = lo;
+        if (*p == '-') hi = strtol(p + 1, (char**)&p, 10);
+        for (long v = lo; v <= hi && v < (long)max; v++) {
+            if (!set[v]) count++;
+            set[v] = 1;
+        }
+        if (*p == ',') p++;
+    }
+    return count;
+}
+
+static int cpu_in_node(const NumaNode* node, int cpu) {
+    return (int)((node->cpu_mask[cpu / 64] >> (cpu % 64)) & 1);
+}
+
+static void test_topology(void) {
+    const NumaTopology* topo = numa_topology_get();
+    CHECK(topo == numa_topology_get());
+    CHECK(topo->num_nodes >= 1 && topo->num_nodes <= NUMA_MAX_NODES);
+
+    char buf[4096];
+    unsigned char nodes[NUMA_MAX_NODES] = { 0 };
+    size_t want_nodes = 0;
+    if (read_sysfs(SYSFS_NODE_DIR "/online", buf, sizeof(buf)) == 0) {
+        want_nodes = ref_parse_list(buf, nodes, NUMA_MAX_NODES);
+    }
+
+    if (want_nodes == 0) {
+        // 回退：单节点包含全部在线CPU
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        if (online < 1) online = 1;
+        CHECK(topo->num_nodes == 1);
+        CHECK(topo->nodes[0].id == 0);
+        CHECK(topo->nodes[0].num_cpus == (size_t)online);
+        for (int cpu = 0; cpu < online && cpu < NUMA_MAX_CPUS; cpu++) {
+            CHECK(cpu_in_node(&topo->nodes[0], cpu));
+        }
+        CHECK(!topo->policy_supported);
+        return;
+    }
+
+    CHECK(topo->num_nodes == want_nodes);
+    unsigned char seen[NUMA_MAX_CPUS] = { 0 };
+    for (size_t i = 0; i < topo->num_nodes; i++) {
+        const NumaNode* node = &topo->nodes[i];
+        CHECK(node->id >= 0 && node->id < NUMA_MAX_NODES && nodes[node->id]);
+        CHECK(numa_topology_find_node(node->id) == node);
+
+        unsigned char cpus[NUMA_MAX_CPUS] = { 0 };
+        size_t want_cpus = 0;
+        char path[128];
+        snprintf(path, sizeof(path), SYSFS_NODE_DIR "/node%d/cpulist", node->id);
+        if (read_sysfs(path, buf, sizeof(buf)) == 0) {
+            want_cpus = ref_parse_list(buf, cpus, NUMA_MAX_CPUS);
+        }
+        CHECK(node->num_cpus == want_cpus);
+        for (int cpu = 0; cpu < NUMA_MAX_CPUS; cpu++) {
+            CHECK(cpu_in_node(node, cpu) == cpus[cpu]);
+            // 每个CPU只属于一个节点
+            if (cpus[cpu]) {
+                CHECK(!seen[cpu]);
+                seen[cpu] = 1;
+            }
+        }
+    }
+    CHECK(numa_topology_find_node(-1) == NULL);
+    CHECK(numa_topology_find_node(NUMA_MAX_NODES) == NULL);
+}
+
+// 各节点轮转时每个CPU恰好出现一次，前num_nodes个CPU来自不同节点
+static void test_cpu_order(void) {
+    const NumaTopology* topo = numa_topology_get();
+    size_t total = 0;
+    for (size_t i = 0; i < topo->num_nodes; i++) total += topo->nodes[i].num_cpus;
+
+    static int cpus[NUMA_MAX_CPUS];
+    size_t count = numa_topology_cpu_order(-1, cpus, NUMA_MAX_CPUS);
+    CHECK(count == total);
+    unsigned char seen[NUMA_MAX_CPUS] = { 0 };
+    for (size_t k = 0; k < count; k++) {
+        CHECK(cpus[k] >= 0 && cpus[k] < NUMA_MAX_CPUS);
+        if (cpus[k] < 0 || cpus[k] >= NUMA_MAX_CPUS) continue;
+        CHECK(!seen[cpus[k]]);
+        seen[cpus[k]] = 1;
+    }
+    size_t populated = 0;
+    for (size_t i = 0; i < topo->num_nodes; i++) populated += topo->nodes[i].num_cpus > 0;
+    for (size_t k = 0; k < populated && k < count; k++) {
+        size_t node_k = topo->num_nodes;
+        for (size_t i = 0; i < topo->num_nodes; i++) {
+            if (cpu_in_node(&topo->nodes[i], cpus[k])) node_k = i;
+        }
+        for (size_t j = 0; j < k; j++) CHECK(!cpu_in_node(&topo->nodes[node_k], cpus[j]));
+    }
+
+    // 截断到max_cpus
+    if (count > 1) CHECK(numa_topology_cpu_order(-1, cpus, 1) == 1);
+
+    // 指定节点：按编号升序列出该节点的CPU
+    for (size_t i = 0; i < topo->num_nodes; i++) {
+        const NumaNode* node = &topo->nodes[i];
+        count = numa_topology_cpu_order(node->id, cpus, NUMA_MAX_CPUS);
+        CHECK(count == node->num_cpus);
+        for (size_t k = 0; k < count; k++) {
+            CHECK(cpu_in_node(node, cpus[k]));
+            if (k > 0) CHECK(cpus[k] > cpus[k - 1]);
+        }
+    }
+    if (!numa_topology_find_node(NUMA_MAX_NODES - 1)) {
+        CHECK(numa_topology_cpu_order(NUMA_MAX_NODES - 1, cpus, NUMA_MAX_CPUS) == 0);
+    }
+}
+
+static void check_writable(unsigned char* p, size_t size, unsigned char value) {
+    memset(p, value, size);
+    CHECK(p[0] == value && p[size / 2] == value && p[size - 1] == value);
+}
+
+// 放置策略只在支持mbind时生效；失败（不支持、节点不存在）时内存仍按首次访问放置
+static void test_bind_memory(void) {
+    const NumaTopology* topo = numa_topology_get();
+    PageMapping mapping;
+    CHECK(page_map(3 * 4096 + 100, 0, &mapping) == 0);
+    if (!mapping.ptr) return;
+
+    for (size_t i = 0; i < topo->num_nodes; i++) {
+        int rc = numa_bind_memory(mapping.ptr, mapping.length, topo->nodes[i].id);
+        CHECK(rc == (topo->policy_supported ? 0 : -1));
+    }
+    CHECK(numa_bind_memory(mapping.ptr, mapping.length, -1) == (topo->policy_supported ? 0 : -1));
+    if (!numa_topology_find_node(NUMA_MAX_NODES - 1)) {
+        CHECK(numa_bind_memory(mapping.ptr, mapping.length, NUMA_MAX_NODES - 1) == -1);
+    }
+    CHECK(numa_bind_memory(mapping.ptr, mapping.length, NUMA_MAX_NODES) == -1);
+    CHECK(numa_bind_memory(NULL, mapping.length, 0) == -1);
+    CHECK(numa_bind_memory(mapping.ptr, 0, 0) == -1);
+    check_writable(mapping.ptr, mapping.length, 0x5a);
+    page_unmap(&mapping);
+}
+
+// 小块走普通尺寸级别，大块单独映射；都由mem_pool_free释放，释放的映射按节点缓存
+static void test_pool_placement(HAL_Device* dev) {
+    mem_pool_trim(0);
+    MemPoolStats before;
+    mem_pool_get_stats(&before);
+    int node = numa_topology_get()->nodes[0].id;
+
+    const size_t sizes[4] = { 1000, MEM_POOL_MAPPED_MIN_SIZE - 1, MEM_POOL_MAPPED_MIN_SIZE, (5 << 20) + 3 };
+    for (int i = 0; i < 4; i++) {
+        void* blocks[4] = {
+            mem_pool_alloc_mapped(sizes[i], node, 0),
+            mem_pool_alloc_mapped(sizes[i], MEM_POOL_NODE_INTERLEAVE, 0),
+            mem_pool_alloc_mapped(sizes[i], NUMA_MAX_NODES - 1, 0),
+            dev->allocate_memory_on_node(sizes[i], node)
+        };
+        for (int b = 0; b < 4; b++) {
+            CHECK(blocks[b] && ((uintptr_t)blocks[b] & (MEM_POOL_ALIGNMENT - 1)) == 0);
+            if (!blocks[b]) continue;
+            CHECK(mem_pool_usable_size(blocks[b]) >= sizes[i]);
+            check_writable(blocks[b], sizes[i], (unsigned char)(i + b));
+        }
+        void* inter = dev->allocate_interleaved(sizes[i]);
+        CHECK(inter != NULL);
+        if (inter) check_writable(inter, sizes[i], 0x77);
+        dev->free_memory(inter);
+        for (int b = 0; b < 4; b++) mem_pool_free(blocks[b]);
+    }
+
+    // 释放的映射按放置方式缓存：同一节点的分配复用，交错放置的分配不复用
+    void* a = mem_pool_alloc_mapped(MEM_POOL_MAPPED_MIN_SIZE, node, 0);
+    CHECK(a != NULL);
+    mem_pool_free(a);
+    void* inter = mem_pool_alloc_mapped(MEM_POOL_MAPPED_MIN_SIZE, MEM_POOL_NODE_INTERLEAVE, 0);
+    void* again = mem_pool_alloc_mapped(MEM_POOL_MAPPED_MIN_SIZE, node, 0);
+    CHECK(inter && inter != a);
+    CHECK(again == a);
+    mem_pool_free(inter);
+    mem_pool_free(again);
+
+    MemPoolStats after;
+    mem_pool_get_stats(&after);
+    CHECK(after.allocated_bytes == before.allocated_bytes);
+    CHECK(after.mapped_bytes == before.mapped_bytes);
+    mem_pool_trim(0);
+}
+
+static void test_device_capabilities(HAL_Device* dev) {
+    CHECK(dev->capabilities.numa_nodes == numa_topology_get()->num_nodes);
+    // 未设置LOWMEM_NUMA_NODE时不绑定节点
+    const char* env = getenv(HAL_NUMA_NODE_ENV);
+    if (!env || !*env) CHECK(dev->capabilities.numa_node == -1);
+}
+
+int main(void) {
+    HAL_Device* dev = test_init_device();
+    if (!dev) return 1;
+
+    test_topology();
+    test_cpu_order();
+    test_bind_memory();
+    test_pool_placement(dev);
+    test_device_capabilities(dev);
+
+    return test_finish("test_numa");
+}
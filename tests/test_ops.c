@@ -0,0 +1,222 @@
+// 融合逐元素算子对照双精度参考：RMSNorm、LayerNorm、softmax、SwiGLU、残差相加+归一化，
+// 以及各激活函数的前向与导数（覆盖饱和区和多项式近似的区间端点）
+
+#include "test_common.h"
+#include <string.h>
+
+#define SQRT1_2 0.70710678118654752440
+#define SQRT2_PI 0.79788456080286535588
+
+static double ref_activation(ActivationType type, double x) {
+    switch (type) {
+        case ACTIVATION_RELU: return x > 0.0 ? x : 0.0;
+        case ACTIVATION_SILU: return x / (1.0 + exp(-x));
+        case ACTIVATION_GELU_TANH: return 0.5 * x * (1.0 + tanh(SQRT2_PI * (x + 0.044715 * x * x * x)));
+        case ACTIVATION_GELU_ERF: return 0.5 * x * erfc(-x * SQRT1_2);
+        case ACTIVATION_TANH: return tanh(x);
+        default: return 0.0;
+    }
+}
+
+static double ref_activation_grad(ActivationType type, double x) {
+    switch (type) {
+        case ACTIVATION_RELU: return x > 0.0 ? 1.0 : 0.0;
+        case ACTIVATION_SILU: {
+            double s = 1.0 / (1.0 + exp(-x));
+            return s * (1.0 + x * (1.0 - s));
+        }
+        case ACTIVATION_GELU_TANH: {
+            double u = SQRT2_PI * (x + 0.044715 * x * x * x);
+            double t = tanh(u);
+            return 0.5 * (1.0 + t) +
+                   0.5 * x * (1.0 - t * t) * SQRT2_PI * (1.0 + 3.0 * 0.044715 * x * x);
+        }
+        case ACTIVATION_GELU_ERF:
+            return 0.5 * erfc(-x * SQRT1_2) + x * exp(-0.5 * x * x) * 0.39894228040143267794;
+        case ACTIVATION_TANH: {
+            double t = tanh(x);
+            return 1.0 - t * t;
+        }
+        default: return 0.0;
+    }
+}
+
+static void ref_norm(NormType type, const float* x, const float* weight, const float* bias,
+                     float* out, size_t rows, size_t dim, float eps) {
+    for (size_t r = 0; r < rows; r++) {
+        const float* xr = x + r * dim;
+        double mean = 0.0;
+        if (type == NORM_LAYER) {
+            for (size_t i = 0; i < dim; i++) mean += xr[i];
+            mean /= (double)dim;
+        }
+        double var = 0.0;
+        for (size_t i = 0; i < dim; i++) var += (xr[i] - mean) * (xr[i] - mean);
+        double inv = 1.0 / sqrt(var / (double)dim + eps);
+        for (size_t i = 0; i < dim; i++) {
+            double v = (xr[i] - mean) * inv * (weight ? weight[i] : 1.0f);
+            if (bias) v += bias[i];
+            out[r * dim + i] = (float)v;
+        }
+    }
+}
+
+static void test_norms(HAL_Device* dev) {
+    // dim覆盖向量宽度的尾部
+    static const size_t dims[] = {1, 7, 64, 333, 4096};
+    const size_t rows = 5;
+    const float eps = 1e-5f;
+    for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); d++) {
+        size_t dim = dims[d];
+        float* x = malloc(rows * dim * sizeof(float));
+        float* delta = malloc(rows * dim * sizeof(float));
+        float* w = malloc(dim * sizeof(float));
+        float* b = malloc(dim * sizeof(float));
+        float* out = malloc(rows * dim * sizeof(float));
+        float* ref = malloc(rows * dim * sizeof(float));
+        float* residual = malloc(rows * dim * sizeof(float));
+        test_fill(x, rows * dim);
+        test_fill(delta, rows * dim);
+        test_fill(w, dim);
+        test_fill(b, dim);
+        char what[64];
+
+        dev->rmsnorm(x, w, out, rows, dim, eps);
+        ref_norm(NORM_RMS, x, w, NULL, ref, rows, dim, eps);
+        snprintf(what, sizeof(what), "rmsnorm dim=%zu", dim);
+        test_compare(what, out, ref, rows * dim, 1e-5f, 1e-5f);
+
+        dev->rmsnorm(x, NULL, out, rows, dim, eps);
+        ref_norm(NORM_RMS, x, NULL, NULL, ref, rows, dim, eps);
+        snprintf(what, sizeof(what), "rmsnorm weight=NULL dim=%zu", dim);
+        test_compare(what, out, ref, rows * dim, 1e-5f, 1e-5f);
+
+        dev->layernorm(x, w, b, out, rows, dim, eps);
+        ref_norm(NORM_LAYER, x, w, b, ref, rows, dim, eps);
+        snprintf(what, sizeof(what), "layernorm dim=%zu", dim);
+        // dim=1时方差为0，输出为bias
+        test_compare(what, out, ref, rows * dim, 1e-4f, 1e-4f);
+
+        for (int t = 0; t < 2; t++) {
+            NormType type = t ? NORM_LAYER : NORM_RMS;
+            const float* bias = t ? b : NULL;
+            memcpy(residual, x, rows * dim * sizeof(float));
+            dev->add_norm(residual, delta, w, bias, out, rows, dim, eps, type);
+            float* sum = malloc(rows * dim * sizeof(float));
+            for (size_t i = 0; i < rows * dim; i++) sum[i] = x[i] + delta[i];
+            snprintf(what, sizeof(what), "add_norm residual type=%d dim=%zu", t, dim);
+            test_compare(what, residual, sum, rows * dim, 0.0f, 0.0f);
+            ref_norm(type, sum, w, bias, ref, rows, dim, eps);
+            snprintf(what, sizeof(what), "add_norm type=%d dim=%zu", t, dim);
+            test_compare(what, out, ref, rows * dim, 1e-4f, 1e-4f);
+            free(sum);
+        }
+
+        free(x);
+        free(delta);
+        free(w);
+        free(b);
+        free(out);
+        free(ref);
+        free(residual);
+    }
+}
+
+static void test_softmax(HAL_Device* dev) {
+    // 单块、多个整块加尾块、块长超过最小块长的长行
+    static const size_t dims[] = {1001, 5000, 70001};
+    const size_t rows = 6;
+    for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); d++) {
+        size_t dim = dims[d];
+        float* x = malloc(rows * dim * sizeof(float));
+        float* out = malloc(rows * dim * sizeof(float));
+        float* ref = malloc(rows * dim * sizeof(float));
+        test_fill(x, rows * dim);
+        // 大的logit检查减去最大值后的数值稳定性
+        for (size_t i = 0; i < rows * dim; i++) x[i] *= (i / dim == 0) ? 80.0f : 8.0f;
+        // 最后一行的前半部分被屏蔽（整块为-inf），最大值出现在后面的块中
+        for (size_t i = 0; i < dim / 2; i++) x[(rows - 1) * dim + i] = -INFINITY;
+
+        dev->softmax(x, out, rows, dim);
+        for (size_t r = 0; r < rows; r++) {
+            double max = x[r * dim];
+            for (size_t i = 1; i < dim; i++) max = fmax(max, x[r * dim + i]);
+            double sum = 0.0;
+            for (size_t i = 0; i < dim; i++) sum += exp(x[r * dim + i] - max);
+            for (size_t i = 0; i < dim; i++) ref[r * dim + i] = (float)(exp(x[r * dim + i] - max) / sum);
+        }
+        char what[64];
+        snprintf(what, sizeof(what), "softmax dim=%zu", dim);
+        test_compare(what, out, ref, rows * dim, 1e-7f, 1e-5f);
+
+        // 原地计算
+        dev->softmax(x, x, rows, dim);
+        snprintf(what, sizeof(what), "softmax in-place dim=%zu", dim);
+        test_compare(what, x, ref, rows * dim, 1e-7f, 1e-5f);
+
+        free(x);
+        free(out);
+        free(ref);
+    }
+}
+
+static void test_activations(HAL_Device* dev) {
+    // [-12, 12] 的均匀网格加上随机点，大小不是向量宽度的倍数
+    const size_t n = 4003;
+    float* x = malloc(n * sizeof(float));
+    float* gy = malloc(n * sizeof(float));
+    float* out = malloc(n * sizeof(float));
+    float* fwd = malloc(n * sizeof(float));
+    float* grad = malloc(n * sizeof(float));
+    float* ref = malloc(n * sizeof(float));
+    float* ref_grad = malloc(n * sizeof(float));
+    for (size_t i = 0; i < n; i++) {
+        x[i] = (i % 2) ? -12.0f + 24.0f * (float)i / (float)n : 4.0f * test_rand_float();
+    }
+    test_fill(gy, n);
+
+    static const char* names[ACTIVATION_COUNT] = {"relu", "silu", "gelu_tanh", "gelu_erf", "tanh"};
+    for (int t = 0; t < ACTIVATION_COUNT; t++) {
+        ActivationType type = (ActivationType)t;
+        for (size_t i = 0; i < n; i++) {
+            ref[i] = (float)ref_activation(type, x[i]);
+            ref_grad[i] = (float)(gy[i] * ref_activation_grad(type, x[i]));
+        }
+
+        dev->activation(x, out, n, type);
+        char what[64];
+        snprintf(what, sizeof(what), "activation %s", names[t]);
+        test_compare(what, out, ref, n, 1e-6f, 1e-5f);
+
+        // 导数与前向在同一遍内完成，前向输出须与activation一致
+        dev->activation_backward(x, gy, fwd, grad, n, type);
+        snprintf(what, sizeof(what), "activation_backward %s output", names[t]);
+        test_compare(what, fwd, ref, n, 1e-6f, 1e-5f);
+        snprintf(what, sizeof(what), "activation_backward %s", names[t]);
+        test_compare(what, grad, ref_grad, n, 1e-5f, 1e-4f);
+    }
+
+    // silu_mul: out = silu(gate) * up
+    dev->silu_mul(x, gy, out, n);
+    for (size_t i = 0; i < n; i++) ref[i] = (float)(ref_activation(ACTIVATION_SILU, x[i]) * gy[i]);
+    test_compare("silu_mul", out, ref, n, 1e-6f, 1e-5f);
+
+    free(x);
+    free(gy);
+    free(out);
+    free(fwd);
+    free(grad);
+    free(ref);
+    free(ref_grad);
+}
+
+int main(void) {
+    HAL_Device* dev = test_init_device();
+    if (!dev) return 1;
+
+    test_norms(dev);
+    test_softmax(dev);
+    test_activations(dev);
+
+    return test_finish("test_ops");
+}
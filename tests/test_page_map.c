@@ -0,0 +1,193 @@
+// 大页映射的回退链：显式大页不可用时回退到透明大页，madvise失败时按普通页使用；
+// 映射的对齐与长度、大页统计、内存池对释放的映射的缓存，以及HAL按选项分配的长期缓冲区
+
+#include "test_common.h"
+#include "page_map.h"
+#include "mem_pool.h"
+#include <string.h>
+
+#define BASE_PAGE 4096
+
+static int is_pow2(size_t x) {
+    return x && (x & (x - 1)) == 0;
+}
+
+static void check_mapping(const PageMapping* m, size_t size, uint32_t flags) {
+    CHECK(m->ptr != NULL);
+    if (!m->ptr) return;
+    CHECK(m->length >= size);
+
+    uintptr_t addr = (uintptr_t)m->ptr;
+    if (m->backing == PAGE_MAP_HUGETLB) {
+        CHECK(flags & PAGE_MAP_HUGETLB);
+        CHECK(m->length % page_map_hugetlb_size() == 0);
+        CHECK(addr % page_map_hugetlb_size() == 0);
+        CHECK(page_map_huge_bytes(m) == m->length);
+    } else {
+        // 普通页或透明大页：长度按基本页取整
+        CHECK(m->backing == 0 || m->backing == PAGE_MAP_THP);
+        CHECK(m->length == (size + BASE_PAGE - 1) / BASE_PAGE * BASE_PAGE);
+        CHECK(addr % BASE_PAGE == 0);
+        if (m->backing == PAGE_MAP_THP) CHECK(flags & (PAGE_MAP_THP | PAGE_MAP_HUGETLB));
+        if (flags & (PAGE_MAP_THP | PAGE_MAP_HUGETLB)) {
+            // 请求了大页时起点按透明大页大小对齐，即使madvise失败
+            CHECK(addr % page_map_thp_size() == 0);
+        } else {
+            CHECK(m->backing == 0);
+        }
+    }
+
+    memset(m->ptr, 0xc3, m->length);
+    size_t huge = page_map_huge_bytes(m);
+    CHECK(huge <= m->length);
+    if (m->backing == 0) CHECK(huge == 0);
+    if (huge != 0 && m->backing != PAGE_MAP_HUGETLB) CHECK(huge % page_map_thp_size() == 0);
+}
+
+static void test_page_map(void) {
+    CHECK(is_pow2(page_map_thp_size()) && page_map_thp_size() >= BASE_PAGE);
+    CHECK(is_pow2(page_map_hugetlb_size()) && page_map_hugetlb_size() >= BASE_PAGE);
+
+    PageMapping m;
+    CHECK(page_map(0, 0, &m) == -1);
+    CHECK(page_map(100, 0, NULL) == -1);
+
+    const size_t sizes[3] = { 100, (3 << 20) + 5, 8 << 20 };
+    const uint32_t flags[4] = { 0, PAGE_MAP_THP, PAGE_MAP_HUGETLB, PAGE_MAP_HUGETLB | PAGE_MAP_THP };
+    for (int s = 0; s < 3; s++) {
+        for (int f = 0; f < 4; f++) {
+            CHECK(page_map(sizes[s], flags[f], &m) == 0);
+            check_mapping(&m, sizes[s], flags[f]);
+            page_unmap(&m);
+        }
+    }
+
+    // 未映射的描述符
+    memset(&m, 0, sizeof(m));
+    CHECK(page_map_huge_bytes(&m) == 0);
+    CHECK(page_map_huge_bytes(NULL) == 0);
+    page_unmap(&m);
+}
+
+// 单独映射的统计：映射字节按实际生效的支撑方式计入，释放后回到初始值
+static void test_pool_mapped(void) {
+    mem_pool_trim(0);
+    MemPoolStats before;
+    mem_pool_get_stats(&before);
+
+    // 小于阈值时退化为普通尺寸级别
+    void* small = mem_pool_alloc_mapped(MEM_POOL_MAPPED_MIN_SIZE - 1, MEM_POOL_NODE_ANY, PAGE_MAP_THP);
+    CHECK(small != NULL);
+    CHECK(mem_pool_huge_bytes(small) == 0);
+    MemPoolStats stats;
+    mem_pool_get_stats(&stats);
+    CHECK(stats.mapped_bytes == before.mapped_bytes);
+    mem_pool_free(small);
+
+    const uint32_t flags[3] = { 0, PAGE_MAP_THP, PAGE_MAP_HUGETLB };
+    void* blocks[3];
+    for (int f = 0; f < 3; f++) {
+        size_t size = (size_t)(f + 2) << 20;
+        blocks[f] = mem_pool_alloc_mapped(size, MEM_POOL_NODE_ANY, flags[f]);
+        CHECK(blocks[f] && ((uintptr_t)blocks[f] & (MEM_POOL_ALIGNMENT - 1)) == 0);
+        if (!blocks[f]) continue;
+        CHECK(mem_pool_usable_size(blocks[f]) >= size);
+        memset(blocks[f], f, size);
+        CHECK(mem_pool_huge_bytes(blocks[f]) <= size + MEM_POOL_ALIGNMENT + page_map_hugetlb_size());
+        if (flags[f] == 0) CHECK(mem_pool_huge_bytes(blocks[f]) == 0);
+    }
+    MemPoolStats mapped;
+    mem_pool_get_stats(&mapped);
+    CHECK(mapped.mapped_bytes >= before.mapped_bytes + ((size_t)9 << 20));
+    CHECK(mapped.hugetlb_bytes + mapped.thp_bytes <= mapped.mapped_bytes);
+    CHECK(mapped.hugetlb_bytes + mapped.thp_bytes >= before.hugetlb_bytes + before.thp_bytes);
+
+    for (int f = 0; f < 3; f++) mem_pool_free(blocks[f]);
+    MemPoolStats after;
+    mem_pool_get_stats(&after);
+    CHECK(after.mapped_bytes == before.mapped_bytes);
+    CHECK(after.hugetlb_bytes == before.hugetlb_bytes);
+    CHECK(after.thp_bytes == before.thp_bytes);
+    CHECK(after.allocated_bytes == before.allocated_bytes);
+}
+
+// 释放的映射按选项缓存：选项相同、大小相近时复用同一映射并计入缓存字节数，
+// 选项不同或浪费过多时不复用，trim和缓存上限解除映射
+static void test_mapped_cache(void) {
+    mem_pool_trim(0);
+    MemPoolStats before, stats;
+    mem_pool_get_stats(&before);
+
+    const size_t size = (size_t)3 << 20;
+    void* a = mem_pool_alloc_mapped(size, MEM_POOL_NODE_ANY, PAGE_MAP_THP);
+    CHECK(a != NULL);
+    if (!a) return;
+    mem_pool_free(a);
+    mem_pool_get_stats(&stats);
+    CHECK(stats.mapped_bytes == before.mapped_bytes);
+    CHECK(stats.cached_bytes >= before.cached_bytes + size);
+
+    void* b = mem_pool_alloc_mapped(size - 4096, MEM_POOL_NODE_ANY, PAGE_MAP_THP);
+    CHECK(b == a);
+    CHECK(mem_pool_usable_size(b) >= size - 4096);
+    MemPoolStats reused;
+    mem_pool_get_stats(&reused);
+    CHECK(reused.hits == stats.hits + 1);
+    CHECK(reused.misses == stats.misses);
+    CHECK(reused.cached_bytes == before.cached_bytes);
+    CHECK(reused.mapped_bytes >= before.mapped_bytes + size);
+    mem_pool_free(b);
+
+    void* c = mem_pool_alloc_mapped(size, MEM_POOL_NODE_ANY, 0);
+    void* d = mem_pool_alloc_mapped(size / 2, MEM_POOL_NODE_ANY, PAGE_MAP_THP);
+    CHECK(c && c != a);
+    CHECK(d && d != a);
+    mem_pool_free(c);
+    mem_pool_free(d);
+
+    CHECK(mem_pool_trim(0) >= size);
+    mem_pool_get_stats(&stats);
+    CHECK(stats.cached_bytes == 0);
+    CHECK(stats.mapped_bytes == before.mapped_bytes);
+
+    // 超过缓存上限时释放即解除映射
+    mem_pool_set_cache_limit(size / 2);
+    a = mem_pool_alloc_mapped(size, MEM_POOL_NODE_ANY, PAGE_MAP_THP);
+    mem_pool_free(a);
+    mem_pool_get_stats(&stats);
+    CHECK(stats.cached_bytes <= size / 2);
+    mem_pool_set_cache_limit(MEM_POOL_DEFAULT_CACHE_LIMIT);
+}
+
+static void test_device_flags(HAL_Device* dev) {
+    const uint32_t flags[4] = { 0, HAL_ALLOC_HUGEPAGE, HAL_ALLOC_HUGETLB,
+                                HAL_ALLOC_HUGEPAGE | HAL_ALLOC_INTERLEAVE };
+    const size_t size = (6 << 20) + 17;
+    for (int f = 0; f < 4; f++) {
+        unsigned char* p = dev->allocate_memory_flags(size, flags[f]);
+        CHECK(p && ((uintptr_t)p & (MEM_POOL_ALIGNMENT - 1)) == 0);
+        if (!p) continue;
+        memset(p, 0x11 * f, size);
+        CHECK(p[size - 1] == (unsigned char)(0x11 * f));
+        size_t huge = dev->huge_page_bytes(p);
+        CHECK(huge <= size + MEM_POOL_ALIGNMENT + page_map_hugetlb_size());
+        if (flags[f] == 0) CHECK(huge == 0);
+        dev->free_memory(p);
+    }
+    // 普通分配不是单独映射
+    void* p = dev->allocate_memory(1000);
+    CHECK(dev->huge_page_bytes(p) == 0);
+    dev->free_memory(p);
+}
+
+int main(void) {
+    HAL_Device* dev = test_init_device();
+    if (!dev) return 1;
+
+    test_page_map();
+    test_pool_mapped();
+    test_mapped_cache();
+    test_device_flags(dev);
+
+    return test_finish("test_page_map");
+}
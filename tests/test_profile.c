@@ -0,0 +1,232 @@
+// HAL插桩：启用/禁用时函数指针的替换与恢复、包装后结果不变、按操作汇总的调用次数/
+// 浮点运算数/字节数、按调用点区分的统计、直方图与百分位、reset，以及LOWMEM_PROFILE输出
+
+#include "test_common.h"
+#include "hal_profile.h"
+#include <string.h>
+#include <unistd.h>
+
+#define M 7
+#define N 9
+#define K 5
+
+static float g_a[M * K], g_b[K * N], g_c[M * N], g_c2[M * N], g_w[M * N], g_x[N], g_y[M];
+
+// 每个函数只有一条调用指令，即一个调用点（输出不同，避免相同函数被合并）
+__attribute__((noinline)) static void matmul_site_a(HAL_Device* dev) {
+    dev->matrix_multiply(g_a, g_b, g_c, M, N, K);
+}
+
+__attribute__((noinline)) static void matmul_site_b(HAL_Device* dev) {
+    dev->matrix_multiply(g_a, g_b, g_c2, M, N, K);
+}
+
+__attribute__((noinline)) static void gemv_site(HAL_Device* dev) {
+    dev->gemv(g_w, g_x, g_y, M, N);
+}
+
+static const HalProfileSite* find_site(const HalProfileSite* sites, size_t count,
+                                       HalProfileOp op, const void* site) {
+    for (size_t i = 0; i < count; i++) {
+        if (sites[i].op == op && sites[i].site == site) return &sites[i];
+    }
+    return NULL;
+}
+
+static void check_stats_shape(const HalProfileStats* s) {
+    uint64_t total = 0;
+    for (size_t b = 0; b < HAL_PROFILE_HIST_BUCKETS; b++) total += s->hist[b];
+    CHECK(total == s->calls);
+    if (s->calls == 0) return;
+    CHECK(s->min_ns <= s->max_ns);
+    CHECK(s->total_ns >= s->max_ns);
+    uint64_t p50 = hal_profile_percentile_ns(s, 50);
+    uint64_t p99 = hal_profile_percentile_ns(s, 99);
+    CHECK(p50 <= p99 && p99 <= hal_profile_percentile_ns(s, 100));
+    CHECK(hal_profile_percentile_ns(s, 100) <= s->max_ns);
+}
+
+static void test_wrapping(HAL_Device* dev) {
+    HAL_Device orig = *dev;
+    CHECK(!hal_profile_enabled(dev));
+    CHECK(hal_profile_enable(NULL) == -1);
+    CHECK(hal_profile_enable(dev) == 0);
+    CHECK(hal_profile_enabled(dev));
+    CHECK(hal_profile_enable(dev) == 0);
+    CHECK(dev->matrix_multiply != orig.matrix_multiply);
+    CHECK(dev->gemv != orig.gemv);
+    CHECK(dev->free_memory != orig.free_memory);
+    // 其他操作不受影响
+    CHECK(dev->trim_memory == orig.trim_memory);
+
+    // 同一时间只能插桩一个设备
+    HAL_Device other = orig;
+    CHECK(hal_profile_enable(&other) == -1);
+    CHECK(!hal_profile_enabled(&other));
+
+    // 包装后结果与原函数一致
+    float want[M * N];
+    test_fill(g_a, M * K);
+    test_fill(g_b, K * N);
+    orig.matrix_multiply(g_a, g_b, want, M, N, K);
+    dev->matrix_multiply(g_a, g_b, g_c, M, N, K);
+    test_compare("profiled matrix_multiply", g_c, want, M * N, 0.0f, 0.0f);
+
+    hal_profile_disable(&other);
+    CHECK(hal_profile_enabled(dev));
+    hal_profile_disable(dev);
+    CHECK(!hal_profile_enabled(dev));
+    CHECK(memcmp(dev, &orig, sizeof(orig)) == 0);
+}
+
+static void test_counts_and_sites(HAL_Device* dev) {
+    hal_profile_reset();
+    CHECK(hal_profile_enable(dev) == 0);
+
+    for (int i = 0; i < 3; i++) matmul_site_a(dev);
+    for (int i = 0; i < 5; i++) matmul_site_b(dev);
+    for (int i = 0; i < 2; i++) gemv_site(dev);
+    void* p = dev->allocate_memory(1000);
+    dev->free_memory(p);
+
+    HalProfileStats s;
+    hal_profile_get_stats(HAL_PROFILE_MATMUL, &s);
+    CHECK(s.calls == 8);
+    CHECK(s.flops == 8ull * 2 * M * N * K);
+    CHECK(s.bytes == 8ull * 4 * (M * K + K * N + M * N));
+    check_stats_shape(&s);
+    hal_profile_get_stats(HAL_PROFILE_GEMV, &s);
+    CHECK(s.calls == 2);
+    CHECK(s.flops == 2ull * 2 * M * N);
+    check_stats_shape(&s);
+    hal_profile_get_stats(HAL_PROFILE_ALLOCATE, &s);
+    CHECK(s.calls == 1 && s.bytes == 1000);
+    hal_profile_get_stats(HAL_PROFILE_FREE, &s);
+    CHECK(s.calls == 1);
+    hal_profile_get_stats(HAL_PROFILE_VECTOR_ADD, &s);
+    CHECK(s.calls == 0);
+    hal_profile_get_stats(HAL_PROFILE_OP_COUNT, &s);
+    CHECK(s.calls == 0);
+
+    // 两个调用点分别统计，按累计耗时从高到低排列
+    HalProfileSite sites[16];
+    size_t count = hal_profile_get_sites(sites, 16);
+    size_t matmul_sites = 0;
+    const void* site_a = NULL;
+    const void* site_b = NULL;
+    for (size_t i = 0; i < count; i++) {
+        CHECK(sites[i].site != NULL);
+        if (i > 0) CHECK(sites[i].stats.total_ns <= sites[i - 1].stats.total_ns);
+        if (sites[i].op != HAL_PROFILE_MATMUL) continue;
+        matmul_sites++;
+        if (sites[i].stats.calls == 3) site_a = sites[i].site;
+        if (sites[i].stats.calls == 5) site_b = sites[i].site;
+    }
+    CHECK(count == 5);
+    CHECK(matmul_sites == 2);
+    CHECK(site_a && site_b && site_a != site_b);
+
+    // 同一调用点再次调用计入同一项
+    matmul_site_a(dev);
+    count = hal_profile_get_sites(sites, 16);
+    const HalProfileSite* a = find_site(sites, count, HAL_PROFILE_MATMUL, site_a);
+    const HalProfileSite* b = find_site(sites, count, HAL_PROFILE_MATMUL, site_b);
+    CHECK(a && a->stats.calls == 4);
+    CHECK(b && b->stats.calls == 5);
+
+    // 截断时保留耗时最高的
+    HalProfileSite top;
+    CHECK(hal_profile_get_sites(&top, 1) == 1);
+    CHECK(top.stats.total_ns == sites[0].stats.total_ns);
+
+    // 禁用后不再计数，统计保留
+    hal_profile_disable(dev);
+    matmul_site_a(dev);
+    hal_profile_get_stats(HAL_PROFILE_MATMUL, &s);
+    CHECK(s.calls == 9);
+
+    // 输出包含操作名
+    FILE* fp = tmpfile();
+    CHECK(fp != NULL);
+    if (fp) {
+        hal_profile_dump(fp);
+        rewind(fp);
+        char buf[8192];
+        size_t len = fread(buf, 1, sizeof(buf) - 1, fp);
+        buf[len] = '\0';
+        CHECK(strstr(buf, "HAL profile") != NULL);
+        CHECK(strstr(buf, "matrix_multiply") != NULL);
+        CHECK(strstr(buf, "gemv") != NULL);
+        fclose(fp);
+    }
+
+    hal_profile_reset();
+    hal_profile_get_stats(HAL_PROFILE_MATMUL, &s);
+    CHECK(s.calls == 0 && s.total_ns == 0);
+    CHECK(hal_profile_get_sites(sites, 16) == 0);
+}
+
+static void test_percentile(void) {
+    HalProfileStats s;
+    memset(&s, 0, sizeof(s));
+    CHECK(hal_profile_percentile_ns(&s, 50) == 0);
+    CHECK(hal_profile_percentile_ns(NULL, 50) == 0);
+    // 90次落在 [1024, 2048)，10次落在 [2^20, 2^21)
+    s.calls = 100;
+    s.hist[10] = 90;
+    s.hist[20] = 10;
+    s.min_ns = 1500;
+    s.max_ns = 1500000;
+    CHECK(hal_profile_percentile_ns(&s, 50) == 2048);
+    CHECK(hal_profile_percentile_ns(&s, 90) == 2048);
+    CHECK(hal_profile_percentile_ns(&s, 95) == 1500000);
+    CHECK(hal_profile_percentile_ns(&s, 200) == 1500000);
+    CHECK(hal_profile_percentile_ns(&s, -1) == 2048);
+    CHECK(strcmp(hal_profile_op_name(HAL_PROFILE_GEMV), "gemv") == 0);
+    CHECK(strcmp(hal_profile_op_name(HAL_PROFILE_OP_COUNT), "unknown") == 0);
+}
+
+// LOWMEM_PROFILE为文件路径时，hal_init启用插桩，hal_cleanup写出统计并恢复设备
+static void test_env(void) {
+    char path[] = "/tmp/lowmem_profile_XXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    if (fd < 0) return;
+    close(fd);
+
+    setenv(HAL_PROFILE_ENV, path, 1);
+    HAL_Device* dev = test_init_device();
+    unsetenv(HAL_PROFILE_ENV);
+    CHECK(dev != NULL);
+    if (dev) {
+        CHECK(hal_profile_enabled(dev));
+        matmul_site_a(dev);
+        hal_cleanup();
+        CHECK(!hal_profile_enabled(dev));
+    }
+
+    FILE* fp = fopen(path, "r");
+    CHECK(fp != NULL);
+    if (fp) {
+        char buf[8192];
+        size_t len = fread(buf, 1, sizeof(buf) - 1, fp);
+        buf[len] = '\0';
+        CHECK(strstr(buf, "matrix_multiply") != NULL);
+        fclose(fp);
+    }
+    unlink(path);
+}
+
+int main(void) {
+    unsetenv(HAL_PROFILE_ENV);
+    HAL_Device* dev = test_init_device();
+    if (!dev) return 1;
+
+    test_wrapping(dev);
+    test_counts_and_sites(dev);
+    test_percentile();
+    hal_cleanup();
+    test_env();
+
+    return test_finish("test_profile");
+}
@@ -0,0 +1,116 @@
+// INT8 GEMM对照精确的整数参考：零点校正后的int32结果、反量化的fp32和重新量化的uint8
+
+#include "test_common.h"
+#include "qgemm.h"
+#include <string.h>
+
+// sum_l (a - a_zp) * (b - b_zp)
+static void ref_qgemm(const uint8_t* a, const uint8_t* b, int64_t* c,
+                      size_t m, size_t n, size_t k, int32_t a_zp, int32_t b_zp) {
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            int64_t sum = 0;
+            for (size_t l = 0; l < k; l++) {
+                sum += (int64_t)(a[i * k + l] - a_zp) * (b[l * n + j] - b_zp);
+            }
+            c[i * n + j] = sum;
+        }
+    }
+}
+
+static void fill_u8(uint8_t* data, size_t count) {
+    for (size_t i = 0; i < count; i++) data[i] = (uint8_t)(test_rand_u32() >> 24);
+}
+
+static void test_shape(HAL_Device* dev, size_t m, size_t n, size_t k) {
+    uint8_t* a = malloc(m * k);
+    uint8_t* b = malloc(k * n);
+    int64_t* ref = malloc(m * n * sizeof(int64_t));
+    int32_t* c32 = malloc(m * n * sizeof(int32_t));
+    float* cf = malloc(m * n * sizeof(float));
+    float* want = malloc(m * n * sizeof(float));
+    float* bias = malloc(n * sizeof(float));
+    uint8_t* c8 = malloc(m * n);
+    fill_u8(a, m * k);
+    fill_u8(b, k * n);
+    test_fill(bias, n);
+
+    const int32_t a_zp = 3, b_zp = 129;
+    ref_qgemm(a, b, ref, m, n, k, a_zp, b_zp);
+
+    QGemmParams params = {
+        .output_type = QGEMM_OUTPUT_INT32,
+        .a_scale = 1.0f, .a_zero_point = a_zp,
+        .b_scale = 1.0f, .b_zero_point = b_zp
+    };
+    CHECK(dev->matrix_multiply_int8(a, b, c32, m, n, k, &params) == 0);
+    for (size_t i = 0; i < m * n; i++) {
+        if (c32[i] != ref[i]) {
+            fprintf(stderr, "qgemm int32 %zux%zux%zu: 第%zu个元素 %d，期望 %lld\n",
+                    m, n, k, i, c32[i], (long long)ref[i]);
+            g_test_failures++;
+            break;
+        }
+    }
+
+    params.output_type = QGEMM_OUTPUT_FP32;
+    params.a_scale = 0.02f;
+    params.b_scale = 0.005f;
+    params.bias = bias;
+    float scale = params.a_scale * params.b_scale;
+    for (size_t i = 0; i < m * n; i++) want[i] = (float)ref[i] * scale + bias[i % n];
+    CHECK(dev->matrix_multiply_int8(a, b, cf, m, n, k, &params) == 0);
+    char what[64];
+    snprintf(what, sizeof(what), "qgemm fp32 %zux%zux%zu", m, n, k);
+    test_compare(what, cf, want, m * n, 1e-4f, 1e-5f);
+
+    // 输出范围覆盖 [0, 255] 的两端，检查饱和
+    params.output_type = QGEMM_OUTPUT_UINT8;
+    params.out_scale = 0.05f;
+    params.out_zero_point = 120;
+    CHECK(dev->matrix_multiply_int8(a, b, c8, m, n, k, &params) == 0);
+    for (size_t i = 0; i < m * n; i++) {
+        float q = want[i] / params.out_scale + params.out_zero_point;
+        q = q < 0.0f ? 0.0f : (q > 255.0f ? 255.0f : q);
+        // 累加顺序不同，恰在0.5处可能差1
+        if (fabsf((float)c8[i] - roundf(q)) > 1.0f) {
+            fprintf(stderr, "qgemm uint8 %zux%zux%zu: 第%zu个元素 %u，期望 %g\n",
+                    m, n, k, i, c8[i], q);
+            g_test_failures++;
+            break;
+        }
+    }
+
+    free(a);
+    free(b);
+    free(ref);
+    free(c32);
+    free(cf);
+    free(want);
+    free(bias);
+    free(c8);
+}
+
+int main(void) {
+    HAL_Device* dev = test_init_device();
+    if (!dev) return 1;
+
+    // 覆盖微内核的行列尾部、K不是4的倍数以及多个K分块
+    static const size_t shapes[][3] = {
+        {1, 1, 1}, {1, 300, 257}, {5, 17, 3}, {37, 53, 131}, {64, 64, 64}, {97, 130, 1030}
+    };
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        test_shape(dev, shapes[s][0], shapes[s][1], shapes[s][2]);
+    }
+
+    // 参数检查
+    uint8_t a[4] = {0}, b[4] = {0};
+    int32_t c[4];
+    QGemmParams bad = { .output_type = QGEMM_OUTPUT_UINT8, .a_scale = 1.0f, .b_scale = 1.0f };
+    CHECK(dev->matrix_multiply_int8(a, b, c, 1, 1, 4, &bad) != 0);
+    bad.output_type = QGEMM_OUTPUT_INT32;
+    CHECK(dev->matrix_multiply_int8(a, b, c, 1, 1, QGEMM_MAX_K + 1, &bad) != 0);
+    CHECK(dev->matrix_multiply_int8(a, b, c, 1, 1, 4, NULL) != 0);
+
+    return test_finish("test_qgemm");
+}
@@ -0,0 +1,141 @@
+// INT4 GEMV对照逐元素反量化后的点积：分组scale/零点、组不整除k、
+// 整个张量共享参数（quant_quantize的输出）以及uint8激活
+
+#include "test_common.h"
+#include "qgemv.h"
+#include "quantization.h"
+
+// 第l个半字节，高半字节在前
+static int nibble(const uint8_t* row, size_t l) {
+    uint8_t byte = row[l / 2];
+    return (l & 1) ? (byte & 0x0f) : (byte >> 4);
+}
+
+// x_deq为反量化后的激活
+static void ref_qgemv(const uint8_t* w, const float* x_deq, float* y, size_t m, size_t k,
+                      const Q4GemvParams* p) {
+    size_t num_groups = p->group_size ? (k + p->group_size - 1) / p->group_size : 1;
+    for (size_t r = 0; r < m; r++) {
+        double sum = 0.0;
+        for (size_t l = 0; l < k; l++) {
+            size_t g = p->group_size ? r * num_groups + l / p->group_size : 0;
+            int zp = p->zero_points ? p->zero_points[g] : p->zero_point;
+            sum += (double)(nibble(w + r * (k / 2), l) - zp) * p->scales[g] * x_deq[l];
+        }
+        y[r] = (float)sum;
+    }
+}
+
+static void test_grouped(HAL_Device* dev, size_t m, size_t k, size_t group_size,
+                         int per_group_zp, Q4ActivationType act_type) {
+    size_t num_groups = (k + group_size - 1) / group_size;
+    uint8_t* w = malloc(m * k / 2);
+    float* scales = malloc(m * num_groups * sizeof(float));
+    uint8_t* zps = malloc(m * num_groups);
+    float* x = malloc(k * sizeof(float));
+    uint8_t* x8 = malloc(k);
+    float* y = malloc(m * sizeof(float));
+    float* ref = malloc(m * sizeof(float));
+    for (size_t i = 0; i < m * k / 2; i++) w[i] = (uint8_t)(test_rand_u32() >> 24);
+    for (size_t i = 0; i < m * num_groups; i++) {
+        scales[i] = 0.001f + 0.05f * fabsf(test_rand_float());
+        zps[i] = (uint8_t)(test_rand_u32() >> 28);
+    }
+
+    Q4GemvParams params = {
+        .group_size = group_size,
+        .scales = scales,
+        .zero_points = per_group_zp ? zps : NULL,
+        .zero_point = 8,
+        .act_type = act_type,
+        .act_scale = 0.02f,
+        .act_zero_point = 131
+    };
+    const void* x_in = x;
+    if (act_type == Q4_ACT_UINT8) {
+        for (size_t i = 0; i < k; i++) {
+            x8[i] = (uint8_t)(test_rand_u32() >> 24);
+            x[i] = (x8[i] - params.act_zero_point) * params.act_scale;
+        }
+        x_in = x8;
+    } else {
+        test_fill(x, k);
+    }
+
+    CHECK(dev->gemv_q4(w, x_in, y, m, k, &params) == 0);
+    ref_qgemv(w, x, ref, m, k, &params);
+    char what[80];
+    snprintf(what, sizeof(what), "gemv_q4 %zux%zu group=%zu zp=%d act=%d",
+             m, k, group_size, per_group_zp, (int)act_type);
+    test_compare(what, y, ref, m, 1e-4f * (float)k, 1e-4f);
+
+    free(w);
+    free(scales);
+    free(zps);
+    free(x);
+    free(x8);
+    free(y);
+    free(ref);
+}
+
+// 权重由quant_quantize按整个张量量化为INT4，group_size为0
+static void test_quantized_weights(HAL_Device* dev) {
+    const size_t m = 45, k = 222;
+    float* wf = malloc(m * k * sizeof(float));
+    float* w_deq = malloc(m * k * sizeof(float));
+    uint8_t* w = malloc(quant_get_size(m * k, QUANT_TYPE_INT4));
+    float* x = malloc(k * sizeof(float));
+    float* y = malloc(m * sizeof(float));
+    float* ref = malloc(m * sizeof(float));
+    test_fill(wf, m * k);
+    test_fill(x, k);
+
+    QuantConfig config = { .type = QUANT_TYPE_INT4 };
+    QuantParams qp;
+    CHECK(quant_calibrate(&qp, wf, m * k, &config) == 0);
+    CHECK(quant_quantize(w, wf, m * k, &qp, &config) == 0);
+    CHECK(quant_dequantize(w_deq, w, m * k, &qp, &config) == 0);
+
+    Q4GemvParams params = {
+        .group_size = 0,
+        .scales = &qp.scale,
+        .zero_point = qp.zero_point,
+        .act_type = Q4_ACT_FP32
+    };
+    CHECK(dev->gemv_q4(w, x, y, m, k, &params) == 0);
+    for (size_t r = 0; r < m; r++) {
+        double sum = 0.0;
+        for (size_t l = 0; l < k; l++) sum += (double)w_deq[r * k + l] * x[l];
+        ref[r] = (float)sum;
+    }
+    test_compare("gemv_q4 quant_quantize", y, ref, m, 1e-4f * (float)k, 1e-4f);
+
+    free(wf);
+    free(w_deq);
+    free(w);
+    free(x);
+    free(y);
+    free(ref);
+}
+
+int main(void) {
+    HAL_Device* dev = test_init_device();
+    if (!dev) return 1;
+
+    test_grouped(dev, 1, 64, 32, 1, Q4_ACT_FP32);
+    test_grouped(dev, 70, 256, 32, 1, Q4_ACT_FP32);
+    test_grouped(dev, 33, 4096, 128, 0, Q4_ACT_FP32);
+    // 最后一组不满
+    test_grouped(dev, 17, 200, 64, 1, Q4_ACT_FP32);
+    test_grouped(dev, 70, 256, 32, 1, Q4_ACT_UINT8);
+    test_grouped(dev, 9, 330, 16, 0, Q4_ACT_UINT8);
+    test_quantized_weights(dev);
+
+    // 参数检查：k须为偶数
+    uint8_t w[2] = {0};
+    float x[3] = {0}, y[1], scale = 1.0f;
+    Q4GemvParams odd = { .group_size = 0, .scales = &scale, .act_type = Q4_ACT_FP32 };
+    CHECK(dev->gemv_q4(w, x, y, 1, 3, &odd) != 0);
+
+    return test_finish("test_qgemv");
+}
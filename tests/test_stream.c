@@ -0,0 +1,106 @@
+// 异步命令流：流内按提交顺序执行、参数块复制、跨流事件依赖，
+// 以及流上的复制+矩阵乘与同步matrix_multiply结果一致
+
+#include "test_common.h"
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#define TEST_NUM_LAUNCHES 200
+
+typedef struct {
+    int* log;
+    atomic_int* count;
+    int value;
+} AppendArg;
+
+static void append_cmd(void* arg) {
+    AppendArg* a = (AppendArg*)arg;
+    int idx = atomic_fetch_add(a->count, 1);
+    a->log[idx] = a->value;
+}
+
+// 在主线程放行前阻塞所在的流
+static void gate_cmd(void* arg) {
+    atomic_int* gate = (atomic_int*)arg;
+    while (!atomic_load(gate)) sched_yield();
+}
+
+static void test_ordering(HAL_Device* dev) {
+    struct Stream* stream = dev->stream_create();
+    CHECK(stream != NULL);
+    if (!stream) return;
+
+    int log[TEST_NUM_LAUNCHES];
+    atomic_int count = 0;
+    for (int i = 0; i < TEST_NUM_LAUNCHES; i++) {
+        // 参数块在提交时复制，arg随后被下一次循环覆盖
+        AppendArg arg = { log, &count, i };
+        CHECK(dev->launch_async(stream, append_cmd, &arg, sizeof(arg)) == 0);
+    }
+    CHECK(dev->stream_synchronize(stream) == 0);
+    CHECK(atomic_load(&count) == TEST_NUM_LAUNCHES);
+    for (int i = 0; i < TEST_NUM_LAUNCHES; i++) {
+        if (log[i] != i) {
+            fprintf(stderr, "launch_async: 第%d个命令执行了 %d\n", i, log[i]);
+            g_test_failures++;
+            break;
+        }
+    }
+    dev->stream_destroy(stream);
+}
+
+static void test_cross_stream(HAL_Device* dev) {
+    const size_t m = 33, n = 65, k = 47;
+    float* a = malloc(m * k * sizeof(float));
+    float* staging = malloc(m * k * sizeof(float));
+    float* b = malloc(k * n * sizeof(float));
+    float* c = malloc(m * n * sizeof(float));
+    float* ref = malloc(m * n * sizeof(float));
+    test_fill(a, m * k);
+    test_fill(b, k * n);
+    memset(staging, 0, m * k * sizeof(float));
+    dev->matrix_multiply(a, b, ref, m, n, k);
+
+    struct Stream* copy = dev->stream_create();
+    struct Stream* compute = dev->stream_create();
+    struct StreamEvent* copied = dev->event_create();
+    CHECK(copy && compute && copied);
+    if (!copy || !compute || !copied) goto out;
+
+    // copy流被挡住时，compute流的矩阵乘必须等待复制完成的事件
+    atomic_int gate = 0;
+    CHECK(dev->launch_async(copy, gate_cmd, &gate, 0) == 0);
+    CHECK(dev->memcpy_to_device_async(staging, a, m * k * sizeof(float), copy) == 0);
+    CHECK(dev->event_record(copied, copy) == 0);
+    CHECK(dev->stream_wait_event(compute, copied) == 0);
+    CHECK(dev->matrix_multiply_async(staging, b, c, m, n, k, compute) == 0);
+
+    CHECK(dev->event_query(copied) == 0);
+    atomic_store(&gate, 1);
+    CHECK(dev->stream_synchronize(compute) == 0);
+    CHECK(dev->event_query(copied) == 1);
+    CHECK(dev->event_synchronize(copied) == 0);
+    // 同一设备上的计算结果逐位相同
+    test_compare("matrix_multiply_async", c, ref, m * n, 0.0f, 0.0f);
+
+out:
+    if (copied) dev->event_destroy(copied);
+    if (copy) dev->stream_destroy(copy);
+    if (compute) dev->stream_destroy(compute);
+    free(a);
+    free(staging);
+    free(b);
+    free(c);
+    free(ref);
+}
+
+int main(void) {
+    HAL_Device* dev = test_init_device();
+    if (!dev) return 1;
+
+    test_ordering(dev);
+    test_cross_stream(dev);
+
+    return test_finish("test_stream");
+}